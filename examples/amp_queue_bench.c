@@ -0,0 +1,144 @@
+/*
+ * Host test and benchmark of the AMP queue (src/amp/amp_queue.c)
+ *
+ * Runs the same queue code as the two cores do on the board, between two
+ * threads, ideally on two different host cores. The producer sends numbered
+ * messages as fast as it can, waiting whenever the queue is full, and the
+ * consumer checks that every message arrives once, in order and intact. The
+ * producer stamps each message with the time it was sent, so the consumer also
+ * gets the one way latency through the queue.
+ *
+ * A host cache line is coherent between cores in a way uncached OCM is not
+ * fast, so the throughput here is an upper bound, but ordering bugs and torn
+ * messages show up just the same.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+#include <sched.h>
+
+#include "amp_queue.h"
+
+#define DEFAULT_MESSAGES		10000000
+
+struct payload {
+	uint64_t seq;
+	uint64_t sent_ns;
+	uint8_t fill[AMP_QUEUE_MSG_SIZE - 8 - 16];
+};
+
+struct bench {
+	struct amp_queue q;
+	uint64_t messages;
+	/* Producer results */
+	uint64_t full;
+	/* Consumer results */
+	uint64_t errors;
+	uint64_t latency_sum;
+	uint64_t latency_max;
+	uint64_t empty;
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *producer(void *arg)
+{
+	struct bench *b = arg;
+	struct amp_producer p;
+	struct amp_msg msg;
+	struct payload *payload = (struct payload *) msg.data;
+	uint64_t seq = 0;
+
+	amp_producer_attach(&p, &b->q);
+	for (seq = 0; seq < b->messages; seq++) {
+		msg.type = 1;
+		msg.timestamp = (uint32_t) seq;
+		payload->seq = seq;
+		memset(payload->fill, (int) (seq & 0xFF), sizeof(payload->fill));
+		payload->sent_ns = now_ns();
+		while ( amp_queue_put(&p, &msg) != 0 ) {
+			/* On a single host core the consumer cannot run until we give way */
+			sched_yield();
+		}
+	}
+	/* Every failed put counted as a drop, which here just means the queue was full */
+	b->full = p.dropped;
+	return NULL;
+}
+
+static void *consumer(void *arg)
+{
+	struct bench *b = arg;
+	struct amp_consumer c;
+	struct amp_msg msg;
+	struct payload *payload = (struct payload *) msg.data;
+	uint64_t latency = 0;
+	uint64_t seq = 0;
+	uint32_t i = 0;
+
+	amp_consumer_attach(&c, &b->q);
+	while ( seq < b->messages ) {
+		if ( !amp_queue_get(&c, &msg) ) {
+			b->empty++;
+			sched_yield();
+			continue;
+		}
+		latency = now_ns() - payload->sent_ns;
+		b->latency_sum += latency;
+		if ( latency > b->latency_max ) {
+			b->latency_max = latency;
+		}
+		if ( ( payload->seq != seq ) || ( msg.timestamp != (uint32_t) seq ) ) {
+			b->errors++;
+		}
+		for (i = 0; i < sizeof(payload->fill); i++) {
+			if ( payload->fill[i] != (uint8_t) (seq & 0xFF) ) {
+				b->errors++;
+				break;
+			}
+		}
+		seq++;
+	}
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	static struct bench b;
+	pthread_t threads[2];
+	uint64_t start = 0;
+	uint64_t elapsed = 0;
+
+	b.messages = ( argc > 1 ) ? strtoull(argv[1], NULL, 0) : DEFAULT_MESSAGES;
+	amp_queue_init(&b.q);
+
+	start = now_ns();
+	pthread_create(&threads[1], NULL, consumer, &b);
+	pthread_create(&threads[0], NULL, producer, &b);
+	pthread_join(threads[0], NULL);
+	pthread_join(threads[1], NULL);
+	elapsed = now_ns() - start;
+
+	printf("%-20s%"PRIu64"\n", "Messages", b.messages);
+	printf("%-20s%d x %d bytes\n", "Queue", AMP_QUEUE_LEN, AMP_QUEUE_MSG_SIZE);
+	printf("%-20s%.3f s\n", "Elapsed", elapsed / 1e9);
+	printf("%-20s%.2f M/s\n", "Throughput", b.messages / (elapsed / 1e3));
+	printf("%-20s%.1f MB/s\n", "Bandwidth", (double) b.messages * AMP_QUEUE_MSG_SIZE / (elapsed / 1e3));
+	printf("%-20s%.0f ns\n", "Mean latency", ( b.messages == 0 ) ? 0.0 : (double) b.latency_sum / b.messages);
+	printf("%-20s%"PRIu64" ns\n", "Max latency", b.latency_max);
+	printf("%-20s%"PRIu64"\n", "Queue full", b.full);
+	printf("%-20s%"PRIu64"\n", "Queue empty", b.empty);
+	printf("%-20s%"PRIu64"\n", "Errors", b.errors);
+	return ( b.errors == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+/*
+ * console.h on the host, against a fake UART
+ *
+ * The UART has a 64 byte FIFO that empties a byte at a time on a
+ * SIGALRM timer, which is also its interrupt: when the FIFO has run empty and
+ * the TX interrupt is enabled, the signal handler calls console_tx_isr(), as
+ * the UART interrupt would. Locking the console blocks the signal, so the
+ * lock masks the interrupt exactly as it does on the board. Busy-waiting on
+ * a full FIFO or for the last byte to leave lets the wire move on by a byte,
+ * since the UART keeps sending whatever the CPU is doing.
+ *
+ * Each case checks that every byte the console took came out of the UART,
+ * once and in order, and that the statistics say which path was taken:
+ *
+ * - polled, before console_start()
+ * - drop: a full ring with the interrupt masked drops the rest
+ * - block: waits for the interrupt to make room, and gets everything out
+ * - poll-drain: blocking with the interrupt masked drains by polling
+ * - panic: polls out the ring, and everything after it
+ * - console_printf() turns LF into CR LF
+ *
+ * The Makefile builds it with a 256 byte ring, so every case wraps it:
+ *
+ *   ./console_host
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include "console.h"
+
+#define FIFO_LEN			64
+/* Sent per timer tick, about 115200 baud on a 100us tick */
+#define BYTES_PER_TICK			1
+#define TICK_US				100
+#define MAX_OUTPUT			(64 * 1024)
+
+struct uart {
+	volatile uint32_t fifo;
+	volatile uint32_t irq_enabled;
+	volatile uint32_t overruns;
+	uint8_t output[MAX_OUTPUT];
+	volatile uint32_t sent;
+	uint32_t irqs;
+};
+
+static struct console con;
+static struct uart uart;
+static uint8_t pattern[MAX_OUTPUT];
+
+static void wire(uint32_t bytes)
+{
+	uart.fifo -= ( uart.fifo < bytes ) ? uart.fifo : bytes;
+	return;
+}
+
+/* Moves the wire on by a byte with the interrupt held off, as the CPU spins */
+static void wire_spin(void)
+{
+	sigset_t block;
+	sigset_t old;
+
+	sigemptyset(&block);
+	sigaddset(&block, SIGALRM);
+	sigprocmask(SIG_BLOCK, &block, &old);
+	wire(1);
+	sigprocmask(SIG_SETMASK, &old, NULL);
+	return;
+}
+
+static void on_tick(int sig)
+{
+	wire(BYTES_PER_TICK);
+	if ( uart.irq_enabled && ( uart.fifo == 0 ) ) {
+		uart.irqs++;
+		console_tx_isr(&con);
+	}
+	return;
+}
+
+static uint32_t uart_lock(void *ctx)
+{
+	sigset_t block;
+	sigset_t old;
+
+	sigemptyset(&block);
+	sigaddset(&block, SIGALRM);
+	sigprocmask(SIG_BLOCK, &block, &old);
+	return sigismember(&old, SIGALRM);
+}
+
+static void uart_unlock(void *ctx, uint32_t state)
+{
+	sigset_t unblock;
+
+	if ( state == 0 ) {
+		sigemptyset(&unblock);
+		sigaddset(&unblock, SIGALRM);
+		sigprocmask(SIG_UNBLOCK, &unblock, NULL);
+	}
+	return;
+}
+
+static int uart_tx_full(void *ctx)
+{
+	if ( uart.fifo < FIFO_LEN ) {
+		return 0;
+	}
+	wire_spin();
+	return 1;
+}
+
+static void uart_tx_put(void *ctx, uint8_t c)
+{
+	if ( ( uart.fifo >= FIFO_LEN ) || ( uart.sent >= MAX_OUTPUT ) ) {
+		uart.overruns++;
+		return;
+	}
+	uart.fifo++;
+	uart.output[uart.sent] = c;
+	uart.sent++;
+	return;
+}
+
+static int uart_tx_idle(void *ctx)
+{
+	if ( uart.fifo == 0 ) {
+		return 1;
+	}
+	wire_spin();
+	return 0;
+}
+
+static void uart_tx_irq(void *ctx, int enable)
+{
+	uart.irq_enabled = enable;
+	return;
+}
+
+static const struct console_ops uart_ops = {
+	uart_lock,
+	uart_unlock,
+	uart_tx_full,
+	uart_tx_put,
+	uart_tx_idle,
+	uart_tx_irq,
+};
+
+static void reset(uint32_t policy, uint32_t start)
+{
+	uint32_t state = uart_lock(NULL);
+
+	uart.fifo = 0;
+	uart.irq_enabled = 0;
+	uart.overruns = 0;
+	uart.sent = 0;
+	uart.irqs = 0;
+	console_init(&con, &uart_ops, NULL, policy);
+	if ( start ) {
+		console_start(&con);
+	}
+	uart_unlock(NULL, state);
+	return;
+}
+
+/* The UART sent exactly expected, and nothing was lost in its FIFO */
+static uint32_t check(const char *name, const void *expected, uint32_t len, int ok)
+{
+	struct console_stats stats;
+	uint32_t errors = 0;
+
+	console_get_stats(&con, &stats);
+	if ( ( uart.sent != len ) || ( memcmp(uart.output, expected, len) != 0 ) ) {
+		printf("  %"PRIu32" bytes out, expected %"PRIu32"\n", uart.sent, len);
+		errors++;
+	}
+	if ( uart.overruns != 0 ) {
+		printf("  %"PRIu32" bytes put into a full FIFO\n", uart.overruns);
+		errors++;
+	}
+	if ( !ok ) {
+		errors++;
+	}
+	printf("%-14s%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%s\n", name,
+			stats.written, stats.dropped, stats.blocked, stats.polled, stats.high_water, stats.irqs,
+			( errors == 0 ) ? "ok" : "FAIL");
+	return errors;
+}
+
+/* Odd sized pieces, so the ring wraps at every offset */
+static void write_pieces(uint32_t len, size_t *taken)
+{
+	uint32_t done = 0;
+	uint32_t piece = 0;
+
+	while ( done < len ) {
+		piece = ( len - done < 97 ) ? len - done : 97;
+		*taken += console_write(&con, pattern + done, piece);
+		done += piece;
+	}
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	struct console_stats stats;
+	struct itimerval timer;
+	uint32_t errors = 0;
+	uint32_t state = 0;
+	uint32_t i = 0;
+	size_t taken = 0;
+
+	for (i = 0; i < MAX_OUTPUT; i++) {
+		pattern[i] = (uint8_t) (i * 7 + i / 251);
+	}
+	signal(SIGALRM, on_tick);
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = TICK_US;
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_REAL, &timer, NULL);
+
+	printf("%d byte ring, %d byte FIFO\n\n", CONSOLE_BUF_LEN, FIFO_LEN);
+	printf("%-14s%-10s%-10s%-10s%-10s%-10s%-10s%s\n", "Case", "Written", "Dropped", "Blocked", "Polled",
+			"High", "IRQs", "Result");
+
+	/* Straight to the FIFO, no ring and no interrupt */
+	reset(CONSOLE_BLOCK, 0);
+	taken = console_write(&con, pattern, 1000);
+	console_flush(&con);
+	console_get_stats(&con, &stats);
+	errors += check("polled", pattern, 1000, ( taken == 1000 ) && ( stats.high_water == 0 ) &&
+			( uart.irqs == 0 ));
+
+	/* The ring takes one buffer's worth and the interrupt cannot run, so the rest goes */
+	reset(CONSOLE_DROP, 1);
+	state = uart_lock(NULL);
+	taken = console_write(&con, pattern, 3 * CONSOLE_BUF_LEN);
+	uart_unlock(NULL, state);
+	console_flush(&con);
+	console_get_stats(&con, &stats);
+	errors += check("drop", pattern, CONSOLE_BUF_LEN, ( taken == CONSOLE_BUF_LEN ) &&
+			( stats.dropped == 2 * CONSOLE_BUF_LEN ) && ( stats.blocked == 0 ));
+
+	/* Room is made by the interrupt while the writer waits */
+	reset(CONSOLE_BLOCK, 1);
+	taken = 0;
+	write_pieces(20 * CONSOLE_BUF_LEN, &taken);
+	console_flush(&con);
+	console_get_stats(&con, &stats);
+	errors += check("block", pattern, 20 * CONSOLE_BUF_LEN, ( taken == 20 * CONSOLE_BUF_LEN ) &&
+			( stats.dropped == 0 ) && ( stats.blocked > 0 ) && ( stats.polled == 0 ) && ( stats.irqs > 0 ));
+
+	/* The same from inside a handler, where waiting would never end */
+	reset(CONSOLE_BLOCK, 1);
+	taken = 0;
+	state = uart_lock(NULL);
+	write_pieces(5 * CONSOLE_BUF_LEN, &taken);
+	console_get_stats(&con, &stats);
+	uart_unlock(NULL, state);
+	console_flush(&con);
+	errors += check("poll-drain", pattern, 5 * CONSOLE_BUF_LEN, ( taken == 5 * CONSOLE_BUF_LEN ) &&
+			( stats.dropped == 0 ) && ( stats.blocked == 0 ) && ( stats.polled > 0 ) && ( stats.irqs == 0 ));
+
+	reset(CONSOLE_BLOCK, 1);
+	console_printf(&con, "one\ntwo\n\nthree");
+	console_flush(&con);
+	errors += check("printf", "one\r\ntwo\r\n\r\nthree", 17, 1);
+
+	/* Last, since it leaves the interrupt masked for good */
+	reset(CONSOLE_DROP, 1);
+	state = uart_lock(NULL);
+	taken = console_write(&con, pattern, CONSOLE_BUF_LEN / 2);
+	uart_unlock(NULL, state);
+	console_panic(&con);
+	taken += console_write(&con, pattern + CONSOLE_BUF_LEN / 2, 2 * CONSOLE_BUF_LEN);
+	console_flush(&con);
+	errors += check("panic", pattern, CONSOLE_BUF_LEN / 2 + 2 * CONSOLE_BUF_LEN,
+			( taken == CONSOLE_BUF_LEN / 2 + 2 * CONSOLE_BUF_LEN ) && !uart.irq_enabled);
+
+	printf("\n%s\n", ( errors == 0 ) ? "PASS" : "FAIL");
+	return ( errors == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,342 @@
+/*
+ * dds.h against the TTC model: spectral purity and update rate
+ *
+ * Synthesizes a sine on one channel of the model, with dds_isr() on the
+ * interval interrupt arriving LATENCY ticks after it, and measures every
+ * period's high time from the output edges. The duty cycles, one per
+ * period, are the waveform a low-pass filter would recover, and their
+ * spectrum (Blackman-Harris window, FFT) gives SINAD, SFDR and effective
+ * bits:
+ *
+ * - for each table size, with and without interpolation, on a 100kHz
+ *   carrier, against the duty cycles of an exact sine quantized to the
+ *   same match range
+ * - for carriers from 25kHz up, which trade steps of resolution for sample
+ *   rate, with what the handler would take of the CPU at ISR_CYCLES each
+ *
+ * and then times dds_next() on the host.
+ *
+ *   ./dds_model [samples]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include "pwm.h"
+#include "dds.h"
+#include "ttc_model.h"
+
+#define CLOCK_HZ			111111115
+#define CPU_HZ				666666687
+/* Interrupt entry to the match write, in TTC clock ticks, as dds_examples.c */
+#define LATENCY				150
+/* Handler cost with entry and exit, a guess until dds_examples.c is run on the board */
+#define ISR_CYCLES			300
+#define CARRIER_MHZ			PWM_MHZ(100000)
+#define TONE_MHZ			1234500
+#define DEFAULT_SAMPLES			16384
+/* Periods at the start that still play the flat table dds_init() leaves */
+#define SETTLE				4
+/* Either side of the tone, where the window spreads it */
+#define TONE_BINS			4
+#define TIMING_CALLS			100000000
+
+struct period {
+	uint64_t start;
+	uint64_t high;
+	uint64_t length;
+};
+
+struct result {
+	double sinad;
+	double sfdr;
+	uint32_t glitches;
+	int status;
+};
+
+static const struct pwm_ops model_ops = {
+	ttc_model_write,
+	ttc_model_read,
+};
+
+static struct ttc_model model;
+static struct pwm_engine engine;
+static struct dds dds;
+static struct period *periods;
+static uint32_t period_count;
+static uint32_t period_max;
+static uint64_t last_fall;
+
+static void on_edge(void *arg, uint32_t counter, uint64_t tick, uint32_t level)
+{
+	struct period *p = NULL;
+
+	if ( level ) {
+		if ( period_count > 0 ) {
+			p = &periods[period_count - 1];
+			p->length = tick - p->start;
+			p->high = last_fall - p->start;
+		}
+		if ( period_count < period_max ) {
+			periods[period_count].start = tick;
+			period_count++;
+		}
+	} else {
+		last_fall = tick;
+	}
+	return;
+}
+
+static void on_irq(void *arg, uint32_t counter)
+{
+	dds_isr(&dds);
+	return;
+}
+
+/* In place, n a power of two */
+static void fft(double *re, double *im, uint32_t n)
+{
+	uint32_t i = 0;
+	uint32_t j = 0;
+	uint32_t k = 0;
+	uint32_t len = 0;
+	double t = 0;
+	double wr = 0;
+	double wi = 0;
+	double ur = 0;
+	double ui = 0;
+	double vr = 0;
+	double vi = 0;
+
+	for (i = 1, j = 0; i < n; i++) {
+		for (k = n >> 1; j & k; k >>= 1) {
+			j ^= k;
+		}
+		j ^= k;
+		if ( i < j ) {
+			t = re[i];
+			re[i] = re[j];
+			re[j] = t;
+			t = im[i];
+			im[i] = im[j];
+			im[j] = t;
+		}
+	}
+	for (len = 2; len <= n; len <<= 1) {
+		for (i = 0; i < n; i += len) {
+			for (k = 0; k < len / 2; k++) {
+				wr = cos(-2 * M_PI * k / len);
+				wi = sin(-2 * M_PI * k / len);
+				ur = re[i + k];
+				ui = im[i + k];
+				vr = re[i + k + len / 2] * wr - im[i + k + len / 2] * wi;
+				vi = re[i + k + len / 2] * wi + im[i + k + len / 2] * wr;
+				re[i + k] = ur + vr;
+				im[i + k] = ui + vi;
+				re[i + k + len / 2] = ur - vr;
+				im[i + k + len / 2] = ui - vi;
+			}
+		}
+	}
+	return;
+}
+
+/* SINAD and SFDR of n samples, the tone being the largest bin away from DC */
+static void analyse(const double *x, uint32_t n, struct result *result)
+{
+	double *re = calloc(n, sizeof(double));
+	double *im = calloc(n, sizeof(double));
+	double mean = 0;
+	double signal = 0;
+	double noise = 0;
+	double spur = 0;
+	double p = 0;
+	double w = 0;
+	uint32_t peak = TONE_BINS + 1;
+	uint32_t i = 0;
+
+	for (i = 0; i < n; i++) {
+		mean += x[i] / n;
+	}
+	for (i = 0; i < n; i++) {
+		/* Blackman-Harris, four term */
+		w = 0.35875 - 0.48829 * cos(2 * M_PI * i / n) + 0.14128 * cos(4 * M_PI * i / n) -
+				0.01168 * cos(6 * M_PI * i / n);
+		re[i] = (x[i] - mean) * w;
+	}
+	fft(re, im, n);
+	for (i = TONE_BINS + 1; i < n / 2; i++) {
+		if ( re[i] * re[i] + im[i] * im[i] > re[peak] * re[peak] + im[peak] * im[peak] ) {
+			peak = i;
+		}
+	}
+	for (i = TONE_BINS + 1; i < n / 2; i++) {
+		p = re[i] * re[i] + im[i] * im[i];
+		if ( ( i + TONE_BINS >= peak ) && ( i <= peak + TONE_BINS ) ) {
+			signal += p;
+		} else {
+			noise += p;
+			if ( p > spur ) {
+				spur = p;
+			}
+		}
+	}
+	result->sinad = 10 * log10(signal / noise);
+	result->sfdr = 10 * log10((re[peak] * re[peak] + im[peak] * im[peak]) / spur);
+	free(re);
+	free(im);
+	return;
+}
+
+/* Plays the tone for n samples on a carrier, leaving the duty cycles in x */
+static void simulate(uint64_t carrier_mhz, uint32_t table_log2, uint32_t interp, double *x, uint32_t n,
+		struct result *result)
+{
+	uint64_t period = 0;
+	uint32_t i = 0;
+
+	ttc_model_init(&model);
+	model.edge = on_edge;
+	model.irq = on_irq;
+	model.irq_latency = LATENCY;
+	pwm_init(&engine, &model_ops, &model, CLOCK_HZ);
+	result->glitches = 0;
+	result->status = pwm_configure(&engine, 0, carrier_mhz, 500000);
+	if ( result->status == PWM_OK ) {
+		result->status = dds_init(&dds, &engine, 0, LATENCY);
+	}
+	if ( result->status != PWM_OK ) {
+		return;
+	}
+	dds_set_sine(&dds, table_log2, PWM_DUTY_FULL);
+	dds_set_interp(&dds, interp);
+	dds_set_freq(&dds, TONE_MHZ);
+	period = (uint64_t) engine.channels[0].solution.steps << engine.channels[0].solution.prescale_log2;
+	period_count = 0;
+	period_max = n + SETTLE + 1;
+
+	pwm_start(&engine, 1);
+	ttc_model_run(&model, period * (n + SETTLE) + 1);
+	pwm_stop(&engine, 1);
+
+	for (i = 0; i < n; i++) {
+		if ( periods[SETTLE + i].length != period ) {
+			result->glitches++;
+		}
+		x[i] = (double) periods[SETTLE + i].high / period;
+	}
+	analyse(x, n, result);
+	return;
+}
+
+/* The same tone sampled exactly at the carrier rate, rounded to the same match range */
+static void ideal(uint32_t n, double *x, struct result *result)
+{
+	double rate = (double) CLOCK_HZ / ((uint64_t) engine.channels[0].solution.steps <<
+			engine.channels[0].solution.prescale_log2);
+	double mid = (dds.lo + dds.hi) / 2.0;
+	double amp = (dds.hi - dds.lo) / 2.0;
+	uint32_t i = 0;
+
+	for (i = 0; i < n; i++) {
+		x[i] = round(mid + amp * sin(2 * M_PI * (TONE_MHZ / 1000.0) * (i + 1) / rate)) /
+				engine.channels[0].solution.steps;
+	}
+	result->glitches = 0;
+	analyse(x, n, result);
+	return;
+}
+
+static void print_result(const char *name, const char *interp, const struct result *result)
+{
+	printf("%-12s%-10s%-12.1f%-12.1f%-8.2f%-10"PRIu32"\n", name, interp, result->sinad, result->sfdr,
+			(result->sinad - 1.76) / 6.02, result->glitches);
+	return;
+}
+
+static double time_next(uint32_t interp)
+{
+	struct timespec start;
+	struct timespec end;
+	volatile uint32_t sink = 0;
+	uint32_t i = 0;
+
+	dds_set_interp(&dds, interp);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < TIMING_CALLS; i++) {
+		sink += dds_next(&dds);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / TIMING_CALLS;
+}
+
+int main(int argc, char *argv[])
+{
+	static const uint32_t table_sizes[] = {4, 6, 8, 10, 12};
+	static const uint64_t carriers[] = {PWM_MHZ(25000), PWM_MHZ(50000), PWM_MHZ(100000), PWM_MHZ(200000),
+			PWM_MHZ(400000), PWM_MHZ(800000), PWM_MHZ(1600000)};
+	uint32_t n = ( argc > 1 ) ? strtoul(argv[1], NULL, 0) : DEFAULT_SAMPLES;
+	struct result result;
+	double *x = NULL;
+	char name[16];
+	uint32_t failed = 0;
+	uint32_t i = 0;
+
+	if ( ( n < 64 ) || ( n & (n - 1) ) ) {
+		fprintf(stderr, "samples must be a power of two, 64 or more\n");
+		return 1;
+	}
+	x = calloc(n, sizeof(double));
+	periods = calloc(n + SETTLE + 2, sizeof(periods[0]));
+	if ( ( x == NULL ) || ( periods == NULL ) ) {
+		return 1;
+	}
+
+	printf("%.1f Hz sine, %"PRIu32" samples, handler %d ticks after the interval interrupt\n",
+			TONE_MHZ / 1000.0, n, LATENCY);
+	printf("\nOn a %"PRIu64" Hz carrier\n", CARRIER_MHZ / 1000);
+	printf("%-12s%-10s%-12s%-12s%-8s%-10s\n", "Table", "Interp", "SINAD (dB)", "SFDR (dBc)", "ENOB", "Glitches");
+	for (i = 0; i < sizeof(table_sizes) / sizeof(table_sizes[0]); i++) {
+		simulate(CARRIER_MHZ, table_sizes[i], 0, x, n, &result);
+		snprintf(name, sizeof(name), "%d", 1 << table_sizes[i]);
+		print_result(name, "off", &result);
+		failed += result.glitches;
+		simulate(CARRIER_MHZ, table_sizes[i], 1, x, n, &result);
+		print_result(name, "on", &result);
+		failed += result.glitches;
+	}
+	ideal(n, x, &result);
+	print_result("exact", "-", &result);
+	printf("%-30s%"PRIu32" to %"PRIu32" of %"PRIu32"\n", "Match range", dds.lo, dds.hi,
+			engine.channels[0].solution.steps);
+
+	printf("\nCarriers, table of 1024 with interpolation, handler %d cycles\n", ISR_CYCLES);
+	printf("%-12s%-8s%-8s%-12s%-12s%-10s%-10s\n", "Rate (Hz)", "Steps", "Guard", "SINAD (dB)", "ENOB",
+			"Glitches", "CPU (%)");
+	for (i = 0; i < sizeof(carriers) / sizeof(carriers[0]); i++) {
+		simulate(carriers[i], 10, 1, x, n, &result);
+		if ( result.status != PWM_OK ) {
+			printf("%-12"PRIu64"%-8"PRIu32"%-8s%s\n", carriers[i] / 1000, engine.channels[0].solution.steps, "-",
+					"guard leaves no range");
+			continue;
+		}
+		printf("%-12"PRIu64"%-8"PRIu32"%-8"PRIu32"%-12.1f%-12.2f%-10"PRIu32"%-10.1f\n", carriers[i] / 1000,
+				engine.channels[0].solution.steps, dds.lo, result.sinad, (result.sinad - 1.76) / 6.02,
+				result.glitches, 100.0 * ISR_CYCLES * carriers[i] / 1000 / CPU_HZ);
+		failed += result.glitches;
+	}
+	printf("\n%-30s%.0f Hz\n", "Guard limit", (double) CLOCK_HZ / (LATENCY + 2));
+	printf("%-30s%.0f Hz\n", "Handler limit (100% CPU)", (double) CPU_HZ / ISR_CYCLES);
+
+	printf("\n%-30s%.2f ns\n", "dds_next() on the host", time_next(0));
+	printf("%-30s%.2f ns\n", "  with interpolation", time_next(1));
+
+	printf("\n%s\n", ( failed == 0 ) ? "PASS" : "FAIL");
+	free(x);
+	free(periods);
+	return ( failed == 0 ) ? 0 : 1;
+}
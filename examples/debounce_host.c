@@ -0,0 +1,238 @@
+/*
+ * debounce.h driven by synthetic pin traces on the host
+ *
+ * Plays bouncy input traces into the real state machine and checks that the
+ * events come out exactly as they should: which pin, press or release, and
+ * on which sample tick. Time runs in microseconds with a sample tick every
+ * SAMPLE_US, as the private timer gives debounce_gpiops.c. An edge on an
+ * unmasked pin calls debounce_edge() there and then, as the GPIO interrupt
+ * would, and an edge on a masked pin is lost, as the latched interrupt is
+ * when the pin is unmasked.
+ *
+ * No edge in the traces falls on a tick, so every one is unambiguously
+ * before or after a sample, and the expected ticks can be worked out by
+ * hand from the comments.
+ *
+ *   ./debounce_host
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "debounce.h"
+
+#define SAMPLE_US			1000
+#define NUM_PINS			3
+#define MAX_TRANSITIONS			16
+#define MAX_EVENTS			8
+
+struct transition {
+	uint32_t us;
+	uint32_t pin;
+	uint32_t level;
+};
+
+struct trace {
+	const char *name;
+	struct transition transitions[MAX_TRANSITIONS];
+	uint32_t num_transitions;
+	struct debounce_event expected[MAX_EVENTS];
+	uint32_t num_expected;
+	uint32_t ticks;
+};
+
+struct pin_config {
+	uint32_t active_level;
+	uint32_t samples;
+	uint32_t idle;
+};
+
+struct bank {
+	uint32_t level[NUM_PINS];
+	uint32_t masked[NUM_PINS];
+	uint32_t irqs;
+};
+
+/* A push button to ground, a switch to the supply and a faster button to ground */
+static const struct pin_config pins[NUM_PINS] = {
+	{0, 5, 1},
+	{1, 5, 0},
+	{0, 3, 1},
+};
+
+static const struct trace traces[] = {
+	{
+		"bounce",
+		{
+			/* Press: armed at 10200, samples 0 at 11, 1 at 12, then 0 from 13 to 17 */
+			{10200, 0, 0}, {10300, 0, 1}, {10450, 0, 0}, {11900, 0, 1}, {12100, 0, 0},
+			/* Release: armed at 30100, samples 0 at 31, then 1 from 32 to 36 */
+			{30100, 0, 1}, {30150, 0, 0}, {30400, 0, 1}, {30800, 0, 0}, {31050, 0, 1},
+		},
+		10,
+		{
+			{0, DEBOUNCE_PRESS, 17},
+			{0, DEBOUNCE_RELEASE, 36},
+		},
+		2,
+		50,
+	},
+	{
+		"glitch",
+		{
+			/* Between two samples, settles back at 15 */
+			{10100, 0, 0}, {10300, 0, 1},
+			/* Across sample 21, back from 22, settles at 26 */
+			{20900, 0, 0}, {21100, 0, 1},
+			/* A press too short to count, 0 at 31 and 32, back from 33, settles at 37 */
+			{30100, 0, 0}, {32500, 0, 1},
+			/* And the pin still works */
+			{40500, 0, 0},
+			{50500, 0, 1},
+		},
+		8,
+		{
+			{0, DEBOUNCE_PRESS, 45},
+			{0, DEBOUNCE_RELEASE, 55},
+		},
+		2,
+		60,
+	},
+	{
+		"multi-pin",
+		{
+			/* Pin 1 from 11 to 15 */
+			{10400, 1, 1},
+			/* Pin 2 bounces, 0 from 12 to 14 */
+			{11600, 2, 0}, {11700, 2, 1}, {11800, 2, 0},
+			/* Pin 0 glitches while both are being sampled */
+			{12500, 0, 0}, {12600, 0, 1},
+			/* Both released at once, pin 2 settles at 33 and pin 1 at 35 */
+			{30500, 1, 0}, {30500, 2, 1},
+			/* Pin 0 pressed in the middle of that, 0 from 32 to 36 */
+			{31200, 0, 0}, {31300, 0, 1}, {31400, 0, 0},
+		},
+		11,
+		{
+			{2, DEBOUNCE_PRESS, 14},
+			{1, DEBOUNCE_PRESS, 15},
+			{2, DEBOUNCE_RELEASE, 33},
+			{1, DEBOUNCE_RELEASE, 35},
+			{0, DEBOUNCE_PRESS, 36},
+		},
+		5,
+		50,
+	},
+};
+
+static uint32_t bank_read_pin(void *ctx, uint32_t pin)
+{
+	return ((struct bank *) ctx)->level[pin];
+}
+
+static void bank_mask_pin(void *ctx, uint32_t pin)
+{
+	((struct bank *) ctx)->masked[pin] = 1;
+	return;
+}
+
+static void bank_unmask_pin(void *ctx, uint32_t pin)
+{
+	((struct bank *) ctx)->masked[pin] = 0;
+	return;
+}
+
+static const struct debounce_ops bank_ops = {
+	bank_read_pin,
+	bank_mask_pin,
+	bank_unmask_pin,
+};
+
+static const char *type_name(uint32_t type)
+{
+	return ( type == DEBOUNCE_PRESS ) ? "press" : "release";
+}
+
+/* Returns the number of mismatches */
+static uint32_t run(const struct trace *trace)
+{
+	struct debounce db;
+	struct bank bank;
+	struct debounce_event event;
+	const struct debounce_event *want = NULL;
+	uint32_t next = 0;
+	uint32_t seen = 0;
+	uint32_t errors = 0;
+	uint32_t tick = 0;
+	uint32_t i = 0;
+	const struct transition *t = NULL;
+
+	bank.irqs = 0;
+	for (i = 0; i < NUM_PINS; i++) {
+		bank.level[i] = pins[i].idle;
+		bank.masked[i] = 0;
+	}
+	debounce_init(&db, &bank_ops, &bank);
+	for (i = 0; i < NUM_PINS; i++) {
+		debounce_add_pin(&db, i, pins[i].active_level, pins[i].samples);
+	}
+
+	for (tick = 1; tick <= trace->ticks; tick++) {
+		/* Everything up to this sample */
+		while ( ( next < trace->num_transitions ) && ( trace->transitions[next].us < tick * SAMPLE_US ) ) {
+			t = &trace->transitions[next++];
+			if ( bank.level[t->pin] == t->level ) {
+				continue;
+			}
+			bank.level[t->pin] = t->level;
+			if ( bank.masked[t->pin] == 0 ) {
+				bank.irqs++;
+				debounce_edge(&db, t->pin);
+			}
+		}
+		debounce_tick(&db);
+		while ( debounce_get_event(&db, &event) ) {
+			want = ( seen < trace->num_expected ) ? &trace->expected[seen] : NULL;
+			if ( ( want == NULL ) || ( event.pin != want->pin ) || ( event.type != want->type ) ||
+					( event.tick != want->tick ) ) {
+				printf("  unexpected %s on pin %"PRIu32" at tick %"PRIu32"\n", type_name(event.type),
+						event.pin, event.tick);
+				errors++;
+			}
+			seen++;
+		}
+	}
+	for (i = seen; i < trace->num_expected; i++) {
+		printf("  missing %s on pin %"PRIu32" at tick %"PRIu32"\n", type_name(trace->expected[i].type),
+				trace->expected[i].pin, trace->expected[i].tick);
+		errors++;
+	}
+	/* Once everything has settled, every pin is back on its interrupt */
+	for (i = 0; i < NUM_PINS; i++) {
+		if ( ( bank.masked[i] != 0 ) || ( db.pins[i].armed != 0 ) ) {
+			printf("  pin %"PRIu32" left masked\n", i);
+			errors++;
+		}
+	}
+	if ( db.dropped != 0 ) {
+		errors++;
+	}
+	printf("%-16s%-14"PRIu32"%-10"PRIu32"%-10"PRIu32"%s\n", trace->name, trace->num_transitions, bank.irqs,
+			seen, ( errors == 0 ) ? "ok" : "FAIL");
+	return errors;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t errors = 0;
+	uint32_t i = 0;
+
+	printf("%-16s%-14s%-10s%-10s%s\n", "Trace", "Transitions", "IRQs", "Events", "Result");
+	for (i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+		errors += run(&traces[i]);
+	}
+	printf("\n%s\n", ( errors == 0 ) ? "PASS" : "FAIL");
+	return ( errors == 0 ) ? 0 : 1;
+}
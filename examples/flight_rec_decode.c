@@ -0,0 +1,124 @@
+/*
+ * Host decoder for flight recorder dumps (src/debug/flight_rec.c)
+ *
+ * Reads a captured serial console log on stdin, picks out the flight_rec lines
+ * printed at boot after a watchdog reset and prints the previous run's events
+ * with times relative to the first one. Anything else in the log is ignored.
+ *
+ *   ./flight_rec_decode < console.log
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "flight_rec.h"
+
+#define LINE_LEN			256
+#define MAX_IRQ_ID			1024
+
+static const char *event_names[] = {
+	[FLIGHT_REC_BOOT] = "boot",
+	[FLIGHT_REC_IRQ_ENTRY] = "irq entry",
+	[FLIGHT_REC_IRQ_EXIT] = "irq exit",
+	[FLIGHT_REC_TIMER] = "timer",
+	[FLIGHT_REC_WDT_CHECKIN] = "wdt check-in",
+	[FLIGHT_REC_WDT_KICK] = "wdt kick",
+	[FLIGHT_REC_WDT_LATE] = "wdt late",
+	[FLIGHT_REC_MARKER] = "marker",
+};
+
+static const char *event_name(uint32_t type)
+{
+	if ( ( type < sizeof(event_names) / sizeof(event_names[0]) ) && ( event_names[type] != NULL ) ) {
+		return event_names[type];
+	}
+	return "unknown";
+}
+
+int main(int argc, char *argv[])
+{
+	char line[LINE_LEN];
+	struct flight_rec_entry entry;
+	static uint32_t irq_count[MAX_IRQ_ID];
+	uint32_t len = 0;
+	uint32_t timer_hz = 0;
+	uint32_t boot_count = 0;
+	uint32_t last_timestamp = 0;
+	uint32_t last_irq = MAX_IRQ_ID;
+	uint64_t ticks = 0;
+	uint32_t entries = 0;
+	uint32_t gaps = 0;
+	uint32_t last_seq = 0;
+	int in_dump = 0;
+	uint32_t i = 0;
+
+	while ( fgets(line, sizeof(line), stdin) != NULL ) {
+		if ( sscanf(line, "flight_rec begin %"SCNu32" %"SCNu32" %"SCNu32, &len, &timer_hz, &boot_count) == 3 ) {
+			in_dump = 1;
+			printf("Run after boot %"PRIu32", %"PRIu32" entry ring, timer at %"PRIu32" Hz\n\n",
+					boot_count, len, timer_hz);
+			printf("%-10s%-14s%-12s%-16s%s\n", "Seq", "Time (ms)", "Delta (us)", "Event", "Data");
+			continue;
+		}
+		if ( !in_dump ) {
+			continue;
+		}
+		if ( strncmp(line, "flight_rec end", 14) == 0 ) {
+			break;
+		}
+		if ( sscanf(line, "flight_rec %"SCNx32" %"SCNx32" %"SCNx32" %"SCNx32,
+				&entry.seq, &entry.timestamp, &entry.type, &entry.data) != 4 ) {
+			continue;
+		}
+
+		/* The timestamp is the low word of the global timer, so only differences count */
+		if ( entries != 0 ) {
+			ticks += (uint32_t) (entry.timestamp - last_timestamp);
+			if ( entry.seq != last_seq + 1 ) {
+				gaps++;
+			}
+		}
+		printf("%-10"PRIu32"%-14.3f%-12.1f%-16s", entry.seq,
+				( timer_hz != 0 ) ? 1e3 * ticks / timer_hz : 0.0,
+				( ( timer_hz != 0 ) && ( entries != 0 ) ) ?
+						1e6 * (uint32_t) (entry.timestamp - last_timestamp) / timer_hz : 0.0,
+				event_name(entry.type));
+		if ( entry.type == FLIGHT_REC_MARKER ) {
+			printf("0x%08"PRIx32"\n", entry.data);
+		} else {
+			printf("%"PRIu32"\n", entry.data);
+		}
+
+		if ( entry.type == FLIGHT_REC_IRQ_ENTRY ) {
+			if ( entry.data < MAX_IRQ_ID ) {
+				irq_count[entry.data]++;
+			}
+			last_irq = entry.data;
+		} else if ( entry.type == FLIGHT_REC_IRQ_EXIT ) {
+			last_irq = MAX_IRQ_ID;
+		}
+		last_timestamp = entry.timestamp;
+		last_seq = entry.seq;
+		entries++;
+	}
+
+	if ( entries == 0 ) {
+		fprintf(stderr, "No flight recorder entries found\n");
+		return 1;
+	}
+	printf("\n%-30s%"PRIu32"\n", "Entries", entries);
+	printf("%-30s%"PRIu32"\n", "Sequence gaps (torn entries)", gaps);
+	for (i = 0; i < MAX_IRQ_ID; i++) {
+		if ( irq_count[i] != 0 ) {
+			printf("%-30s%"PRIu32" x %"PRIu32"\n", "Interrupt ID", i, irq_count[i]);
+		}
+	}
+	/* A reset in the middle of a handler leaves an entry without an exit */
+	if ( last_irq != MAX_IRQ_ID ) {
+		printf("%-30s%"PRIu32"\n", "Reset inside interrupt ID", last_irq);
+	}
+	return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * func-to-macro.c, measured instead of read
+ *
+ * Times the quadratic from func-to-macro.c written several ways. Build it at
+ * each optimization level (make func_to_macro_bench_all) to see where the
+ * choice stops mattering:
+ *
+ *   function     quad() exactly as in func-to-macro.c, the compiler may inline it
+ *   noinline     the same, but always a real call
+ *   macro        better_quad(), as in func-to-macro.c
+ *   inline       a static inline function
+ *   constant     coefficients known at compile time. C has no constexpr, this is
+ *                as close as it gets - the compiler folds what it can
+ *   vector       four at a time with GCC vector extensions (SSE on the host,
+ *                NEON on the A9 with -mfpu=neon)
+ *
+ * Every variant stores each result to an array, so no variant is held up by a
+ * chain of dependent additions that the others do not have, and the array is
+ * kept alive with MICROBENCH_CLOBBER(). Coefficients are read from volatiles
+ * at the start of each sample so the compiler cannot fold them, except in the
+ * constant variant where that is the point.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "microbench.h"
+
+/* Power of two, small enough to stay in L1 */
+#define POINTS				1024
+
+/* Same definitions as func-to-macro.c */
+#define better_quad(a, b, c, x) (a*x*x + b*x + c)
+
+float quad(float a, float b, float c, float x)
+{
+	return (a*(x*x)) + b*x + c;
+}
+
+__attribute__((noinline)) float quad_noinline(float a, float b, float c, float x)
+{
+	return (a*(x*x)) + b*x + c;
+}
+
+static inline float quad_inline(float a, float b, float c, float x)
+{
+	return (a*(x*x)) + b*x + c;
+}
+
+#define QUAD_A				1.0f
+#define QUAD_B				2.0f
+#define QUAD_C				3.0f
+
+static inline float quad_constant(float x)
+{
+	return (QUAD_A*(x*x)) + QUAD_B*x + QUAD_C;
+}
+
+typedef float v4sf __attribute__((vector_size(16)));
+
+static inline v4sf quad_vector(v4sf a, v4sf b, v4sf c, v4sf x)
+{
+	return (a*(x*x)) + b*x + c;
+}
+
+static float xs[POINTS] __attribute__((aligned(16)));
+static float ys[POINTS] __attribute__((aligned(16)));
+static volatile float coef_a = QUAD_A;
+static volatile float coef_b = QUAD_B;
+static volatile float coef_c = QUAD_C;
+
+static void bench_function(uint64_t iterations)
+{
+	float a = coef_a;
+	float b = coef_b;
+	float c = coef_c;
+	uint64_t n = 0;
+
+	for (n = 0; n < iterations; n++) {
+		ys[n & (POINTS - 1)] = quad(a, b, c, xs[n & (POINTS - 1)]);
+	}
+	MICROBENCH_CLOBBER();
+	return;
+}
+
+static void bench_noinline(uint64_t iterations)
+{
+	float a = coef_a;
+	float b = coef_b;
+	float c = coef_c;
+	uint64_t n = 0;
+
+	for (n = 0; n < iterations; n++) {
+		ys[n & (POINTS - 1)] = quad_noinline(a, b, c, xs[n & (POINTS - 1)]);
+	}
+	MICROBENCH_CLOBBER();
+	return;
+}
+
+static void bench_macro(uint64_t iterations)
+{
+	float a = coef_a;
+	float b = coef_b;
+	float c = coef_c;
+	float x = 0;
+	uint64_t n = 0;
+
+	for (n = 0; n < iterations; n++) {
+		/* The macro does not parenthesize its arguments, so give it a plain name */
+		x = xs[n & (POINTS - 1)];
+		ys[n & (POINTS - 1)] = better_quad(a, b, c, x);
+	}
+	MICROBENCH_CLOBBER();
+	return;
+}
+
+static void bench_inline(uint64_t iterations)
+{
+	float a = coef_a;
+	float b = coef_b;
+	float c = coef_c;
+	uint64_t n = 0;
+
+	for (n = 0; n < iterations; n++) {
+		ys[n & (POINTS - 1)] = quad_inline(a, b, c, xs[n & (POINTS - 1)]);
+	}
+	MICROBENCH_CLOBBER();
+	return;
+}
+
+static void bench_constant(uint64_t iterations)
+{
+	uint64_t n = 0;
+
+	for (n = 0; n < iterations; n++) {
+		ys[n & (POINTS - 1)] = quad_constant(xs[n & (POINTS - 1)]);
+	}
+	MICROBENCH_CLOBBER();
+	return;
+}
+
+/* Four results per pass, so a quarter of the passes for the same iterations */
+static void bench_vector(uint64_t iterations)
+{
+	v4sf a = {coef_a, coef_a, coef_a, coef_a};
+	v4sf b = {coef_b, coef_b, coef_b, coef_b};
+	v4sf c = {coef_c, coef_c, coef_c, coef_c};
+	v4sf *x = (v4sf *) xs;
+	v4sf *y = (v4sf *) ys;
+	uint64_t n = 0;
+
+	for (n = 0; n < iterations / 4; n++) {
+		y[n & ((POINTS / 4) - 1)] = quad_vector(a, b, c, x[n & ((POINTS / 4) - 1)]);
+	}
+	MICROBENCH_CLOBBER();
+	return;
+}
+
+static const struct {
+	const char *name;
+	void (*bench)(uint64_t iterations);
+} benches[] = {
+	{"function", bench_function},
+	{"noinline", bench_noinline},
+	{"macro", bench_macro},
+	{"inline", bench_inline},
+	{"constant", bench_constant},
+	{"vector", bench_vector},
+};
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-f table|csv|json] [-t tag] [-s samples] [-w warmup] [-n no-header]\n",
+			name);
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	struct microbench_config config;
+	struct microbench_result result;
+	int header = 1;
+	uint32_t i = 0;
+	int arg = 0;
+
+	microbench_default_config(&config);
+	for (arg = 1; arg < argc; arg++) {
+		if ( ( strcmp(argv[arg], "-f") == 0 ) && ( arg + 1 < argc ) ) {
+			arg++;
+			if ( strcmp(argv[arg], "csv") == 0 ) {
+				config.format = MICROBENCH_CSV;
+			} else if ( strcmp(argv[arg], "json") == 0 ) {
+				config.format = MICROBENCH_JSON;
+			}
+		} else if ( ( strcmp(argv[arg], "-t") == 0 ) && ( arg + 1 < argc ) ) {
+			config.tag = argv[++arg];
+		} else if ( ( strcmp(argv[arg], "-s") == 0 ) && ( arg + 1 < argc ) ) {
+			config.samples = strtoul(argv[++arg], NULL, 0);
+		} else if ( ( strcmp(argv[arg], "-w") == 0 ) && ( arg + 1 < argc ) ) {
+			config.warmup = strtoul(argv[++arg], NULL, 0);
+		} else if ( strcmp(argv[arg], "-n") == 0 ) {
+			header = 0;
+		} else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	for (i = 0; i < POINTS; i++) {
+		xs[i] = (float) i / POINTS;
+	}
+
+	if ( header ) {
+		microbench_print_header(&config, stdout);
+	}
+	for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+		if ( microbench_run(&config, benches[i].name, benches[i].bench, &result) != 0 ) {
+			fprintf(stderr, "Could not run %s\n", benches[i].name);
+			return 1;
+		}
+		microbench_print(&config, &result, i == 0, stdout);
+	}
+	if ( header ) {
+		microbench_print_footer(&config, stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * Host model of the GPIO interrupt/polling hybrid (src/gpio/gpio_hybrid.c)
+ *
+ * Runs the real hybrid code against a simulated GPIO bank fed with a random
+ * (Poisson) stream of edges on one pin, and compares three ways of watching it
+ * across a range of edge rates:
+ *
+ *   interrupt - an interrupt per edge, what interrupt_examples.c does
+ *   polling   - a tight loop reading the pin, what gpio_examples.c does
+ *   hybrid    - interrupts, switching to budgeted polling when busy
+ *
+ * The model runs in nanoseconds. Every pin read, interrupt entry and exit and
+ * call into the poll routine advances simulated time by a fixed cost, and edges
+ * keep arriving while it does, so edges that come too close together are lost
+ * exactly as they would be on the board. The costs below are rough figures for
+ * a 666 MHz Cortex-A9 going through XScuGic_InterruptHandler() and
+ * XGpioPs_IntrHandler(), not measurements - adjust them to taste.
+ *
+ * CPU is the share of time spent on the input, the rest is what is left for
+ * the rest of the program. Lost is edges that never showed up as a level
+ * change, and missed is the part of those the hybrid noticed through the
+ * latched status bits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "gpio_hybrid.h"
+
+#define SIM_NS				200000000ULL
+
+/* Costs, in nanoseconds */
+#define IRQ_ENTRY_NS			700
+#define IRQ_EXIT_NS			400
+#define READ_NS				150
+#define POLL_CALL_NS			100
+#define POLL_CHECK_NS			10
+
+/* How often the main loop gets round to calling gpio_hybrid_poll() */
+#define SERVICE_PERIOD_NS		5000
+/*
+ * ...and how often while the hybrid is polling. Edges closer together than
+ * this are lost, so it has to be no longer than an interrupt entry and exit or
+ * polling loses more than the interrupts it replaces.
+ */
+#define POLLING_PERIOD_NS		1000
+
+#define WINDOW_NS			1000000
+/* Where interrupts cost more than polling every POLLING_PERIOD_NS, about 25% */
+#define HYBRID_POLL_ENTER		300
+#define HYBRID_POLL_EXIT		100
+#define HYBRID_EXIT_WINDOWS		3
+#define HYBRID_POLL_BUDGET		8
+
+enum strategy {
+	STRATEGY_INTERRUPT,
+	STRATEGY_POLLING,
+	STRATEGY_HYBRID,
+	NUM_STRATEGIES
+};
+
+static const char *strategy_names[NUM_STRATEGIES] = {"interrupt", "polling", "hybrid"};
+
+static const double edge_rates[] = {
+	100, 1000, 10000, 50000, 100000, 200000, 300000, 500000, 1000000, 2000000
+};
+
+struct model {
+	uint64_t t;
+	uint32_t level;
+	uint32_t status;
+	int irq_enabled;
+	uint64_t next_edge;
+	double mean_interval;
+	uint64_t edges;
+	uint64_t busy;
+	uint64_t rng;
+};
+
+static double model_random(struct model *m)
+{
+	/* xorshift64 */
+	m->rng ^= m->rng << 13;
+	m->rng ^= m->rng >> 7;
+	m->rng ^= m->rng << 17;
+	return (double) (m->rng >> 11) / (double) (1ULL << 53);
+}
+
+static uint64_t model_interval(struct model *m)
+{
+	uint64_t interval = (uint64_t) (-log(1.0 - model_random(m)) * m->mean_interval);
+
+	return ( interval == 0 ) ? 1 : interval;
+}
+
+/* Let time pass, toggling the pin and latching status for every edge on the way */
+static void model_advance(struct model *m, uint64_t ns)
+{
+	uint64_t target = m->t + ns;
+
+	while ( m->next_edge <= target ) {
+		m->level ^= 1;
+		m->status |= 1;
+		m->edges++;
+		m->next_edge += model_interval(m);
+	}
+	m->t = target;
+	return;
+}
+
+/* The level is sampled as the read starts, the rest of the read is bus time */
+static uint32_t model_read_pins(void *ctx)
+{
+	struct model *m = ctx;
+	uint32_t level = m->level;
+
+	model_advance(m, READ_NS);
+	return level;
+}
+
+static uint32_t model_read_status(void *ctx)
+{
+	struct model *m = ctx;
+	uint32_t status = m->status;
+
+	m->status = 0;
+	return status;
+}
+
+static void model_irq_enable(void *ctx)
+{
+	((struct model *) ctx)->irq_enabled = 1;
+	return;
+}
+
+static void model_irq_disable(void *ctx)
+{
+	((struct model *) ctx)->irq_enabled = 0;
+	return;
+}
+
+static const struct gpio_hybrid_ops model_ops = {
+	.read_pins = model_read_pins,
+	.read_status = model_read_status,
+	.irq_enable = model_irq_enable,
+	.irq_disable = model_irq_disable,
+};
+
+struct result {
+	double cpu;
+	double lost;
+	uint64_t edges;
+	uint32_t missed;
+	uint32_t switches;
+	double polling;
+};
+
+static void run(enum strategy strategy, double rate, struct result *result)
+{
+	struct gpio_hybrid_config config;
+	struct gpio_hybrid h;
+	struct model m;
+	uint64_t service_period = SERVICE_PERIOD_NS;
+	uint64_t polling_period = POLLING_PERIOD_NS;
+	uint64_t next_service = 0;
+	uint64_t start = 0;
+	uint64_t target = 0;
+	uint32_t status = 0;
+	uint32_t seen = 0;
+
+	m.t = 0;
+	m.level = 0;
+	m.status = 0;
+	m.irq_enabled = 0;
+	m.mean_interval = 1e9 / rate;
+	m.edges = 0;
+	m.busy = 0;
+	m.rng = 0x2545F4914F6CDD1DULL;
+	m.next_edge = model_interval(&m);
+
+	config.mask = 0x1;
+	config.window = WINDOW_NS;
+	config.poll_enter = HYBRID_POLL_ENTER;
+	config.poll_exit = HYBRID_POLL_EXIT;
+	config.exit_windows = HYBRID_EXIT_WINDOWS;
+	config.poll_budget = HYBRID_POLL_BUDGET;
+	if ( strategy == STRATEGY_INTERRUPT ) {
+		config.poll_enter = GPIO_HYBRID_NEVER;
+	} else if ( strategy == STRATEGY_POLLING ) {
+		config.poll_enter = 0;
+		config.poll_exit = 0;
+		config.poll_budget = 1;
+		service_period = 0;
+		polling_period = 0;
+	}
+	gpio_hybrid_init(&h, &model_ops, &m, &config, 0);
+
+	while ( m.t < SIM_NS ) {
+		if ( m.irq_enabled && m.status ) {
+			/* XGpioPs_IntrHandler() clears the status before calling back */
+			start = m.t;
+			model_advance(&m, IRQ_ENTRY_NS);
+			status = m.status;
+			m.status = 0;
+			gpio_hybrid_irq(&h, status, (uint32_t) m.t);
+			model_advance(&m, IRQ_EXIT_NS);
+			m.busy += m.t - start;
+			continue;
+		}
+		if ( m.t >= next_service ) {
+			start = m.t;
+			model_advance(&m, ( h.mode == GPIO_HYBRID_POLLING ) ? POLL_CALL_NS : POLL_CHECK_NS);
+			gpio_hybrid_poll(&h, (uint32_t) m.t);
+			m.busy += m.t - start;
+			next_service += ( h.mode == GPIO_HYBRID_POLLING ) ? polling_period : service_period;
+			if ( next_service < m.t ) {
+				next_service = m.t;
+			}
+			continue;
+		}
+		/* Nothing to do until the next service call or, with interrupts on, the next edge */
+		target = next_service;
+		if ( m.irq_enabled && ( m.next_edge < target ) ) {
+			target = m.next_edge;
+		}
+		model_advance(&m, ( target > m.t ) ? target - m.t : 1);
+	}
+
+	seen = h.stats.events_irq + h.stats.events_poll;
+	result->edges = m.edges;
+	result->cpu = 100.0 * m.busy / m.t;
+	result->lost = ( m.edges == 0 ) ? 0 : 100.0 * (m.edges - seen) / m.edges;
+	result->missed = h.stats.missed;
+	result->switches = h.stats.to_polling + h.stats.to_interrupt;
+	result->polling = 100.0 * gpio_hybrid_polling_time(&h, (uint32_t) m.t) / m.t;
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	struct result result;
+	uint32_t i = 0;
+	uint32_t s = 0;
+
+	printf("%-12s%-12s%-10s%-10s%-12s%-10s%-10s%-10s\n", "Edges/sec", "Strategy",
+			"CPU %", "Lost %", "Edges", "Missed", "Switches", "Polling %");
+	for (i = 0; i < sizeof(edge_rates) / sizeof(edge_rates[0]); i++) {
+		for (s = 0; s < NUM_STRATEGIES; s++) {
+			run(s, edge_rates[i], &result);
+			printf("%-12.0f%-12s%-10.1f%-10.2f%-12"PRIu64"%-10"PRIu32"%-10"PRIu32"%-10.1f\n",
+					edge_rates[i], strategy_names[s], result.cpu, result.lost,
+					result.edges, result.missed, result.switches, result.polling);
+		}
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * The memprobe.h latency and bandwidth probes on the build host
+ *
+ * Same probes as memprobe_examples.c runs on the board, against ordinary
+ * heap memory, so the A9 numbers have something familiar to be read next to.
+ * Latency is measured for working sets from 1KB up to 64MB, which on most
+ * hosts walks through every cache level into DRAM, bandwidth for each kind of
+ * access the host supports over blocks well past the last level cache.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include "memprobe.h"
+
+#define LINE_SIZE			64
+#define MIN_WORKING_SET			1024
+#define MAX_WORKING_SET			(64 << 20)
+#define LATENCY_LOADS			(1 << 22)
+#define BLOCK_SIZE			(64 << 20)
+#define PASSES				4
+
+static uint64_t host_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static const struct memprobe_clock host_clock = {host_now, 1e9};
+
+int main(int argc, char *argv[])
+{
+	uint8_t *buffer = NULL;
+	uint32_t bytes = 0;
+	uint32_t kind = 0;
+
+	if ( posix_memalign((void **) &buffer, 4096, 2 * BLOCK_SIZE) != 0 ) {
+		fprintf(stderr, "Could not allocate %d bytes\n", 2 * BLOCK_SIZE);
+		return 1;
+	}
+	/* Fault every page in now rather than in the middle of a measurement */
+	memset(buffer, 0, 2 * BLOCK_SIZE);
+
+	printf("%-20s%-20s\n", "Working set", "Latency (ns)");
+	for (bytes = MIN_WORKING_SET; bytes <= MAX_WORKING_SET; bytes *= 2) {
+		printf("%-20"PRIu32"%-20.2f\n", bytes, memprobe_latency(&host_clock, buffer, bytes, LINE_SIZE,
+				LATENCY_LOADS));
+	}
+
+	printf("\n%-20s%-20s\n", "Access", "Bandwidth (MB/s)");
+	for (kind = 0; kind < MEMPROBE_NUM_KINDS; kind++) {
+		if ( !memprobe_kind_supported(kind) ) {
+			printf("%-20s%-20s\n", memprobe_kind_name(kind), "not supported");
+			continue;
+		}
+		printf("%-20s%-20.0f\n", memprobe_kind_name(kind), memprobe_bandwidth(&host_clock, kind,
+				buffer + BLOCK_SIZE, buffer, BLOCK_SIZE, PASSES));
+	}
+
+	free(buffer);
+	return 0;
+}
@@ -0,0 +1,223 @@
+/*
+ * Microbenchmark harness, see microbench.h
+ *
+ * Per-sample time is divided by the iteration count, so the clock only has to
+ * be good to a small fraction of a sample. On the A9 that is the global timer
+ * (3ns), on the host usually much better. With the default 10ms samples either
+ * is far finer than it needs to be. Everything between the two clock reads
+ * that is not the benchmark, one indirect call and the benchmark's own loop,
+ * is part of every result, so compare results with each other rather than
+ * reading them as absolute costs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef MICROBENCH_XILINX
+#include "xtime_l.h"
+#else
+#include <time.h>
+#endif
+
+#include "microbench.h"
+
+/* Never calibrate past this many iterations per sample */
+#define MICROBENCH_MAX_ITERATIONS	(1ULL << 40)
+
+void microbench_default_config(struct microbench_config *config)
+{
+	config->sample_ns = 10000000;
+	config->warmup = 3;
+	config->samples = 30;
+	config->format = MICROBENCH_TABLE;
+	config->tag = "";
+	return;
+}
+
+uint64_t microbench_now_ns(void)
+{
+#ifdef MICROBENCH_XILINX
+	XTime now = 0;
+
+	XTime_GetTime(&now);
+	return (uint64_t) ((double) now * 1e9 / COUNTS_PER_SECOND);
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static uint64_t microbench_time(void (*bench)(uint64_t iterations), uint64_t iterations)
+{
+	uint64_t start = microbench_now_ns();
+
+	bench(iterations);
+	return microbench_now_ns() - start;
+}
+
+static int microbench_compare(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+/* Linear interpolation between order statistics of a sorted array */
+static double microbench_quantile(const double *sorted, uint32_t n, double q)
+{
+	double pos = q * (n - 1);
+	uint32_t i = (uint32_t) pos;
+
+	if ( i + 1 >= n ) {
+		return sorted[n - 1];
+	}
+	return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+/* Two sided 95% Student's t for n - 1 degrees of freedom */
+static double microbench_t95(uint32_t n)
+{
+	static const double t[] = {
+		0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+		2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+		2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045,
+	};
+
+	if ( n < 2 ) {
+		return 0;
+	}
+	if ( n - 1 < sizeof(t) / sizeof(t[0]) ) {
+		return t[n - 1];
+	}
+	return 1.96;
+}
+
+int microbench_run(const struct microbench_config *config, const char *name,
+		void (*bench)(uint64_t iterations), struct microbench_result *result)
+{
+	double samples[MICROBENCH_MAX_SAMPLES];
+	double kept[MICROBENCH_MAX_SAMPLES];
+	uint64_t iterations = 1;
+	uint64_t elapsed = 0;
+	uint32_t n = config->samples;
+	uint32_t k = 0;
+	uint32_t i = 0;
+	double q1 = 0;
+	double q3 = 0;
+	double low = 0;
+	double high = 0;
+	double sum = 0;
+	double sum_sq = 0;
+
+	if ( ( n == 0 ) || ( n > MICROBENCH_MAX_SAMPLES ) ) {
+		return -1;
+	}
+
+	/* Double the iterations until one sample takes at least a tenth of the target */
+	for (;;) {
+		elapsed = microbench_time(bench, iterations);
+		if ( ( elapsed * 10 >= config->sample_ns ) || ( iterations >= MICROBENCH_MAX_ITERATIONS ) ) {
+			break;
+		}
+		iterations *= 2;
+	}
+	if ( elapsed == 0 ) {
+		elapsed = 1;
+	}
+	iterations = (uint64_t) ((double) iterations * config->sample_ns / elapsed);
+	if ( iterations == 0 ) {
+		iterations = 1;
+	}
+
+	/* Caches, branch predictors and CPU frequency settle */
+	for (i = 0; i < config->warmup; i++) {
+		microbench_time(bench, iterations);
+	}
+	for (i = 0; i < n; i++) {
+		samples[i] = (double) microbench_time(bench, iterations) / iterations;
+	}
+
+	qsort(samples, n, sizeof(samples[0]), microbench_compare);
+	q1 = microbench_quantile(samples, n, 0.25);
+	q3 = microbench_quantile(samples, n, 0.75);
+	low = q1 - 1.5 * (q3 - q1);
+	high = q3 + 1.5 * (q3 - q1);
+	for (i = 0; i < n; i++) {
+		if ( ( samples[i] >= low ) && ( samples[i] <= high ) ) {
+			kept[k++] = samples[i];
+			sum += samples[i];
+			sum_sq += samples[i] * samples[i];
+		}
+	}
+
+	result->name = name;
+	result->iterations = iterations;
+	result->samples = k;
+	result->outliers = n - k;
+	result->mean = sum / k;
+	result->median = microbench_quantile(kept, k, 0.5);
+	result->min = kept[0];
+	result->max = kept[k - 1];
+	result->stddev = ( k > 1 ) ? sqrt(fmax(0, (sum_sq - (sum * sum / k)) / (k - 1))) : 0;
+	result->ci95 = ( k > 1 ) ? microbench_t95(k) * result->stddev / sqrt(k) : 0;
+	return 0;
+}
+
+void microbench_print_header(const struct microbench_config *config, FILE *out)
+{
+	switch ( config->format ) {
+	case MICROBENCH_CSV:
+		fprintf(out, "tag,name,iterations,samples,outliers,mean_ns,ci95_ns,median_ns,stddev_ns,"
+				"min_ns,max_ns\n");
+		break;
+	case MICROBENCH_JSON:
+		fprintf(out, "[\n");
+		break;
+	default:
+		fprintf(out, "%-8s%-24s%-12s%-10s%-12s%-12s%-12s%-12s\n", "Tag", "Benchmark", "Mean (ns)",
+				"+/- 95%", "Median", "Min", "Max", "Outliers");
+		break;
+	}
+	return;
+}
+
+void microbench_print(const struct microbench_config *config, const struct microbench_result *result,
+		int first, FILE *out)
+{
+	switch ( config->format ) {
+	case MICROBENCH_CSV:
+		fprintf(out, "%s,%s,%llu,%u,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n", config->tag, result->name,
+				(unsigned long long) result->iterations, (unsigned int) result->samples,
+				(unsigned int) result->outliers, result->mean, result->ci95, result->median,
+				result->stddev, result->min, result->max);
+		break;
+	case MICROBENCH_JSON:
+		fprintf(out, "%s  {\"tag\": \"%s\", \"name\": \"%s\", \"iterations\": %llu, \"samples\": %u, "
+				"\"outliers\": %u, \"mean_ns\": %.4f, \"ci95_ns\": %.4f, \"median_ns\": %.4f, "
+				"\"stddev_ns\": %.4f, \"min_ns\": %.4f, \"max_ns\": %.4f}", first ? "" : ",\n",
+				config->tag, result->name, (unsigned long long) result->iterations,
+				(unsigned int) result->samples, (unsigned int) result->outliers, result->mean,
+				result->ci95, result->median, result->stddev, result->min, result->max);
+		break;
+	default:
+		fprintf(out, "%-8s%-24s%-12.3f%-10.3f%-12.3f%-12.3f%-12.3f%-12u\n", config->tag, result->name,
+				result->mean, result->ci95, result->median, result->min, result->max,
+				(unsigned int) result->outliers);
+		break;
+	}
+	return;
+}
+
+void microbench_print_footer(const struct microbench_config *config, FILE *out)
+{
+	if ( config->format == MICROBENCH_JSON ) {
+		fprintf(out, "\n]\n");
+	}
+	return;
+}
@@ -0,0 +1,71 @@
+#ifndef MICROBENCH_H_
+#define MICROBENCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * Small microbenchmark harness, for questions like the one func-to-macro.c
+ * asks. Each benchmark is a function that runs the code under test a given
+ * number of times. The harness calibrates that number so one sample is long
+ * enough to time, runs warmup samples, takes the samples, throws out outliers
+ * (Tukey's fences) and reports the time per iteration with a 95% confidence
+ * interval, as a table, CSV or JSON.
+ *
+ * Builds for the host (clock_gettime()) and, with MICROBENCH_XILINX defined,
+ * for the standalone BSP on the A9 (the global timer through XTime_GetTime()).
+ */
+
+#define MICROBENCH_MAX_SAMPLES		256
+
+#define MICROBENCH_TABLE		0
+#define MICROBENCH_CSV			1
+#define MICROBENCH_JSON			2
+
+/*
+ * Keeps the compiler from deleting a computation whose result is otherwise
+ * unused, or from hoisting it out of the benchmark loop, without adding any
+ * instructions of its own. Also forces the value out of registers the compiler
+ * might otherwise keep it in across iterations.
+ */
+#define MICROBENCH_KEEP(value)		__asm__ volatile ("" :: "g" (value) : "memory")
+/* Makes the compiler assume anything in memory may have changed */
+#define MICROBENCH_CLOBBER()		__asm__ volatile ("" ::: "memory")
+
+struct microbench_config {
+	/* Each sample should take about this long, in nanoseconds */
+	uint64_t sample_ns;
+	uint32_t warmup;
+	uint32_t samples;
+	int format;
+	/* Shown in every result row, e.g. the optimization level */
+	const char *tag;
+};
+
+struct microbench_result {
+	const char *name;
+	uint64_t iterations;
+	uint32_t samples;
+	uint32_t outliers;
+	/* Nanoseconds per iteration */
+	double mean;
+	double median;
+	double stddev;
+	double min;
+	double max;
+	double ci95;
+};
+
+void microbench_default_config(struct microbench_config *config);
+uint64_t microbench_now_ns(void);
+
+int microbench_run(const struct microbench_config *config, const char *name,
+		void (*bench)(uint64_t iterations), struct microbench_result *result);
+
+void microbench_print_header(const struct microbench_config *config, FILE *out);
+/* first is needed to get the commas in JSON right */
+void microbench_print(const struct microbench_config *config, const struct microbench_result *result,
+		int first, FILE *out);
+void microbench_print_footer(const struct microbench_config *config, FILE *out);
+
+#endif /* MICROBENCH_H_ */
@@ -0,0 +1,156 @@
+/*
+ * pmu_scope.h on the build host, through the perf_event_open() backend
+ *
+ * Two pairs of loops that do the same amount of work and differ only in how
+ * the hardware copes with them - walking an array in order or at random, and
+ * a branch that always goes the same way or goes either way at random. The
+ * cycle counts say which of each pair is slower, and the event counts say why.
+ * Every event is asked for at once, more than the counters there are, so the
+ * multiplexing gets exercised too.
+ *
+ * Hosts without hardware counters (most VMs and containers) only get task
+ * clock nanoseconds in place of cycles, and every event shows up as not
+ * supported. perf_event_paranoid may also have to be lowered.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "pmu_scope.h"
+#include "pmu_perf.h"
+
+/* 4MB, well past L2 on most hosts, in 32-bit words */
+#define WALK_WORDS			(1024 * 1024)
+#define BRANCH_COUNT			4096
+#define RUNS				64
+#define CALIBRATION_RUNS		256
+
+static const uint32_t all_events[] = {
+	PMU_INSTRUCTIONS,
+	PMU_BRANCHES,
+	PMU_BRANCH_MISSES,
+	PMU_L1D_ACCESS,
+	PMU_L1D_REFILL,
+	PMU_L1I_REFILL,
+	PMU_DTLB_REFILL,
+	PMU_ITLB_REFILL,
+	PMU_STALL_FRONTEND,
+	PMU_STALL_BACKEND,
+};
+
+static uint32_t *walk;
+static uint8_t *coins;
+static volatile uint32_t sink;
+
+/* A single cycle through every word, in order or shuffled */
+static void make_walk(int shuffle)
+{
+	uint32_t *order = malloc(WALK_WORDS * sizeof(*order));
+	uint32_t i = 0;
+	uint32_t j = 0;
+	uint32_t tmp = 0;
+
+	for (i = 0; i < WALK_WORDS; i++) {
+		order[i] = i;
+	}
+	for (i = WALK_WORDS - 1; shuffle && ( i > 1 ); i--) {
+		j = 1 + (rand() % i);
+		tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+	for (i = 0; i < WALK_WORDS; i++) {
+		walk[order[i]] = order[(i + 1) % WALK_WORDS];
+	}
+	free(order);
+	return;
+}
+
+static void run_walk(void)
+{
+	uint32_t next = 0;
+	uint32_t i = 0;
+
+	for (i = 0; i < WALK_WORDS; i++) {
+		next = walk[next];
+	}
+	sink = next;
+	return;
+}
+
+static void make_coins(int random)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < BRANCH_COUNT; i++) {
+		coins[i] = random ? (rand() & 1) : 1;
+	}
+	return;
+}
+
+static void run_branches(void)
+{
+	uint32_t total = 0;
+	uint32_t i = 0;
+
+	for (i = 0; i < BRANCH_COUNT; i++) {
+		if ( coins[i] ) {
+			total += i;
+		} else {
+			total ^= i;
+		}
+	}
+	sink = total;
+	return;
+}
+
+static void measure(struct pmu *pmu, const char *name, void (*setup)(int), int arg, void (*body)(void))
+{
+	struct pmu_scope scope;
+	uint32_t i = 0;
+
+	setup(arg);
+	pmu_scope_init(pmu, &scope, name, all_events, sizeof(all_events) / sizeof(all_events[0]));
+	pmu_scope_calibrate(pmu, &scope, CALIBRATION_RUNS);
+	for (i = 0; i < RUNS; i++) {
+		pmu_scope_begin(pmu, &scope);
+		body();
+		pmu_scope_end(pmu, &scope);
+	}
+	pmu_scope_print(&scope);
+	printf("\n");
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	struct pmu_perf perf;
+	struct pmu pmu;
+
+	if ( ( pmu_perf_init(&perf) != 0 ) || ( pmu_init(&pmu, &pmu_perf_ops, &perf) != 0 ) ) {
+		fprintf(stderr, "No performance counters available\n");
+		return 1;
+	}
+	if ( perf.task_clock ) {
+		printf("No hardware cycle counter, cycles are task clock nanoseconds\n\n");
+	}
+	walk = malloc(WALK_WORDS * sizeof(*walk));
+	coins = malloc(BRANCH_COUNT);
+	if ( ( walk == NULL ) || ( coins == NULL ) ) {
+		fprintf(stderr, "Could not allocate memory\n");
+		return 1;
+	}
+	srand(1);
+
+	measure(&pmu, "Sequential walk", make_walk, 0, run_walk);
+	measure(&pmu, "Random walk", make_walk, 1, run_walk);
+	measure(&pmu, "Predictable branch", make_coins, 0, run_branches);
+	measure(&pmu, "Random branch", make_coins, 1, run_branches);
+
+	pmu_perf_close(&perf);
+	free(coins);
+	free(walk);
+	return 0;
+}
@@ -0,0 +1,284 @@
+/*
+ * pwm.h against the TTC model, no board needed
+ *
+ * Programs the six channels of pwm_examples.c into ttc_model.h, runs the
+ * model for long enough to see several periods of the slowest one, and
+ * measures every period and high time from the output edges. Each must be
+ * exactly what the solution says the registers give.
+ *
+ * Then a sweep of random frequencies and duty cycles: each solution is
+ * checked against a search of every prescaler and interval for the one
+ * nearest the frequency asked for, some are run on the model as well, and
+ * the frequency error is reported by decade.
+ *
+ *   ./pwm_model [cases]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "pwm.h"
+#include "ttc_model.h"
+
+/* The TTC input clock on a MicroZed, CPU_1x */
+#define CLOCK_HZ			111111115
+#define DEFAULT_CASES			200
+/* Sweep cases that are also run on the model */
+#define MODEL_EVERY			10
+#define PERIODS				4
+#define DECADES				10
+
+struct pwm_request {
+	uint64_t freq_mhz;
+	uint32_t duty_ppm;
+	uint32_t min_steps;
+};
+
+/* The same as pwm_examples.c */
+static const struct pwm_request requests[PWM_CHANNELS] = {
+	{PWM_MHZ(50), 75000, 1000},
+	{PWM_MHZ(25000), 250000, 0},
+	{PWM_MHZ(440), 100000, 0},
+	{PWM_MHZ(1000), 500000, 0},
+	{PWM_MHZ(1000000), 333333, 0},
+	{500, 900000, 0},
+};
+
+/* Edges seen on one output */
+struct measure {
+	uint64_t last_rise;
+	uint64_t last_fall;
+	uint32_t rises;
+	uint32_t periods;
+	uint64_t period_min;
+	uint64_t period_max;
+	uint64_t high_min;
+	uint64_t high_max;
+};
+
+static const struct pwm_ops model_ops = {
+	ttc_model_write,
+	ttc_model_read,
+};
+
+static struct ttc_model model;
+static struct pwm_engine engine;
+static struct measure measures[PWM_CHANNELS];
+
+static void on_edge(void *arg, uint32_t counter, uint64_t tick, uint32_t level)
+{
+	struct measure *m = &measures[counter];
+	uint64_t period = 0;
+
+	if ( level ) {
+		if ( m->rises > 0 ) {
+			period = tick - m->last_rise;
+			if ( ( m->periods == 0 ) || ( period < m->period_min ) ) {
+				m->period_min = period;
+			}
+			if ( ( m->periods == 0 ) || ( period > m->period_max ) ) {
+				m->period_max = period;
+			}
+			m->periods++;
+		}
+		m->last_rise = tick;
+		m->rises++;
+	} else if ( m->rises > 0 ) {
+		period = tick - m->last_rise;
+		if ( ( m->high_min == 0 ) || ( period < m->high_min ) ) {
+			m->high_min = period;
+		}
+		if ( period > m->high_max ) {
+			m->high_max = period;
+		}
+		m->last_fall = tick;
+	}
+	return;
+}
+
+static uint64_t period_ticks(const struct pwm_solution *s)
+{
+	return (uint64_t) (s->interval + 1) << s->prescale_log2;
+}
+
+static uint64_t high_ticks(const struct pwm_solution *s)
+{
+	return (uint64_t) s->match << s->prescale_log2;
+}
+
+/* Runs the configured channels for PERIODS of the slowest, returns how many measured wrong */
+static uint32_t run_model(uint32_t mask, int verbose)
+{
+	const struct pwm_solution *s = NULL;
+	struct measure *m = NULL;
+	uint64_t longest = 0;
+	uint32_t failed = 0;
+	uint32_t ok = 0;
+	uint32_t i = 0;
+
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		measures[i] = (struct measure) {0};
+		s = pwm_get(&engine, i);
+		if ( ( mask & (1 << i) ) && ( s != NULL ) && ( period_ticks(s) > longest ) ) {
+			longest = period_ticks(s);
+		}
+	}
+	pwm_start(&engine, mask);
+	ttc_model_run(&model, longest * PERIODS + 1);
+	pwm_stop(&engine, mask);
+
+	if ( verbose ) {
+		printf("\n%-4s%-12s%-24s%-12s%-24s%-10s\n", "Ch", "Period", "Measured min/max", "High",
+				"Measured min/max", "Periods");
+	}
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		s = pwm_get(&engine, i);
+		if ( !(mask & (1 << i)) || ( s == NULL ) ) {
+			continue;
+		}
+		m = &measures[i];
+		ok = ( m->periods >= PERIODS - 1 ) && ( m->period_min == period_ticks(s) ) &&
+				( m->period_max == period_ticks(s) ) && ( m->high_min == high_ticks(s) ) &&
+				( m->high_max == high_ticks(s) );
+		if ( !ok ) {
+			failed++;
+		}
+		if ( verbose || !ok ) {
+			printf("%-4"PRIu32"%-12"PRIu64"%-12"PRIu64"%-12"PRIu64"%-12"PRIu64"%-12"PRIu64"%-12"PRIu64"%-10"PRIu32"%s\n",
+					i, period_ticks(s), m->period_min, m->period_max, high_ticks(s), m->high_min, m->high_max,
+					m->periods, ok ? "OK" : "FAIL");
+		}
+	}
+	return failed;
+}
+
+/* Smallest error in nHz from any prescaler and interval with at least min_steps steps */
+static uint64_t best_error(uint64_t freq_mhz, uint32_t min_steps)
+{
+	uint64_t want = freq_mhz * 1000000ULL;
+	uint64_t best = UINT64_MAX;
+	uint64_t actual = 0;
+	uint64_t error = 0;
+	uint32_t log2 = 0;
+	uint32_t counts = 0;
+
+	for (log2 = 0; log2 <= PWM_PRESCALE_MAX_LOG2; log2++) {
+		for (counts = ( min_steps > 2 ) ? min_steps : 2; counts <= PWM_INTERVAL_MAX + 1; counts++) {
+			actual = (uint64_t) CLOCK_HZ * 1000000000ULL / ((uint64_t) counts << log2);
+			error = ( actual > want ) ? actual - want : want - actual;
+			if ( error < best ) {
+				best = error;
+			}
+		}
+	}
+	return best;
+}
+
+static uint64_t solution_error(const struct pwm_solution *s, uint64_t freq_mhz)
+{
+	uint64_t want = freq_mhz * 1000000ULL;
+	uint64_t actual = (uint64_t) CLOCK_HZ * 1000000000ULL / period_ticks(s);
+
+	return ( actual > want ) ? actual - want : want - actual;
+}
+
+static uint32_t sweep(uint32_t cases)
+{
+	static const uint32_t min_steps[] = {0, 100, 1000, 10000};
+	const struct pwm_solution *s = NULL;
+	double worst[DECADES] = {0};
+	double sum_steps[DECADES] = {0};
+	uint32_t count[DECADES] = {0};
+	uint32_t out_of_range = 0;
+	uint32_t not_best = 0;
+	uint32_t failed = 0;
+	uint32_t modelled = 0;
+	uint64_t freq_mhz = 0;
+	uint32_t duty_ppm = 0;
+	uint32_t steps = 0;
+	uint32_t decade = 0;
+	uint32_t i = 0;
+	double error = 0;
+
+	srand(1);
+	for (i = 0; i < cases; i++) {
+		/* Log uniform from 10 mHz to 10 MHz */
+		freq_mhz = (uint64_t) pow(10, 1 + 9.0 * rand() / RAND_MAX);
+		duty_ppm = rand() % (PWM_DUTY_FULL + 1);
+		steps = min_steps[rand() % 4];
+		pwm_set_min_steps(&engine, 0, steps);
+		if ( pwm_configure(&engine, 0, freq_mhz, duty_ppm) != PWM_OK ) {
+			out_of_range++;
+			continue;
+		}
+		s = pwm_get(&engine, 0);
+		if ( solution_error(s, freq_mhz) != best_error(freq_mhz, steps) ) {
+			printf("%"PRIu64" mHz with %"PRIu32" steps: %"PRIu64" nHz off, %"PRIu64" possible\n", freq_mhz,
+					steps, solution_error(s, freq_mhz), best_error(freq_mhz, steps));
+			not_best++;
+		}
+		error = fabs((double) CLOCK_HZ * 1000 / period_ticks(s) / freq_mhz - 1) * 1e6;
+		decade = (uint32_t) log10((double) freq_mhz);
+		if ( decade >= DECADES ) {
+			decade = DECADES - 1;
+		}
+		if ( error > worst[decade] ) {
+			worst[decade] = error;
+		}
+		sum_steps[decade] += s->steps;
+		count[decade]++;
+		/* The slow ones take a while to run */
+		if ( ( i % MODEL_EVERY == 0 ) && ( freq_mhz >= 1000 ) ) {
+			failed += run_model(1, 0);
+			modelled++;
+		}
+	}
+
+	printf("\n%-24s%-8s%-20s%-12s\n", "Frequency (Hz)", "Cases", "Worst error (ppm)", "Mean steps");
+	for (decade = 1; decade < DECADES; decade++) {
+		if ( count[decade] == 0 ) {
+			continue;
+		}
+		printf("%-12g%-12g%-8"PRIu32"%-20.3f%-12.0f\n", pow(10, decade) / 1000, pow(10, decade + 1) / 1000,
+				count[decade], worst[decade], sum_steps[decade] / count[decade]);
+	}
+	printf("\n%-30s%"PRIu32"\n", "Cases", cases);
+	printf("%-30s%"PRIu32"\n", "Out of range", out_of_range);
+	printf("%-30s%"PRIu32"\n", "Not the nearest possible", not_best);
+	printf("%-30s%"PRIu32"\n", "Run on the model", modelled);
+	printf("%-30s%"PRIu32"\n", "Measured wrong", failed);
+	return not_best + failed;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t cases = ( argc > 1 ) ? strtoul(argv[1], NULL, 0) : DEFAULT_CASES;
+	uint32_t failed = 0;
+	uint32_t i = 0;
+	int status = PWM_OK;
+
+	ttc_model_init(&model);
+	model.edge = on_edge;
+	pwm_init(&engine, &model_ops, &model, CLOCK_HZ);
+
+	printf("Six channels from a %d Hz clock\n\n", CLOCK_HZ);
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		pwm_set_min_steps(&engine, i, requests[i].min_steps);
+		status = pwm_configure(&engine, i, requests[i].freq_mhz, requests[i].duty_ppm);
+		if ( status != PWM_OK ) {
+			printf("Channel %"PRIu32" cannot do %"PRIu64" mHz (%d)\n", i, requests[i].freq_mhz, status);
+			failed++;
+		}
+	}
+	pwm_print(&engine);
+	failed += run_model((1 << PWM_CHANNELS) - 1, 1);
+
+	printf("\nSweep of %"PRIu32" cases on channel 0\n", cases);
+	failed += sweep(cases);
+
+	printf("\n%s\n", ( failed == 0 ) ? "PASS" : "FAIL");
+	return ( failed == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/*
+ * Duty cycle updates on a running PWM channel, against the TTC model
+ *
+ * Runs one channel of pwm.h on ttc_model.h and changes its duty cycle at
+ * random moments, three ways:
+ *
+ * - direct: match 1 written straight away, as XTtcPs_SetMatchValue() would
+ * - buffered: through pwm_set_duty() and pwm_isr() on the interval
+ *   interrupt, arriving LATENCY ticks after it
+ * - every period: buffered, with a new value each period, a sine
+ *
+ * and then buffered again with the interrupt three times later than
+ * pwm_sync_enable() was told, so the handler has to hold updates back.
+ *
+ * Every period is measured from the output edges. A glitch is a period of
+ * the wrong length, which is what a missed match gives. For the buffered
+ * runs each period's high time must also be exactly the last duty cycle set
+ * before that period's handler ran.
+ *
+ *   ./pwm_update [periods]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "pwm.h"
+#include "ttc_model.h"
+
+#define CLOCK_HZ			111111115
+#define FREQ_MHZ			PWM_MHZ(20000)
+#define CHANNEL				0
+/* Interrupt entry and pwm_isr() up to the match write, in input clock ticks, ~1.8us */
+#define LATENCY				200
+#define DEFAULT_PERIODS			20000
+
+enum method {
+	DIRECT,
+	BUFFERED,
+	EVERY_PERIOD,
+	LATE,
+};
+
+static const char *method_names[] = {
+	"direct",
+	"buffered",
+	"every period",
+	"buffered, 3x latency",
+};
+
+/* Duty cycles set, in order */
+struct post {
+	uint64_t tick;
+	uint32_t match;
+};
+
+/* Periods seen at the output */
+struct period {
+	uint64_t start;
+	uint64_t length;
+	uint64_t high;
+};
+
+static struct ttc_model model;
+static struct pwm_engine engine;
+static struct post *posts;
+static struct period *periods;
+static uint32_t post_count;
+static uint32_t period_count;
+static uint32_t period_max;
+static uint64_t last_fall;
+
+static uint32_t accesses;
+static uint32_t isr_accesses_max;
+static uint64_t isr_accesses;
+
+static void counted_write(void *ctx, uint32_t channel, uint32_t offset, uint32_t val)
+{
+	accesses++;
+	ttc_model_write(ctx, channel, offset, val);
+	return;
+}
+
+static uint32_t counted_read(void *ctx, uint32_t channel, uint32_t offset)
+{
+	accesses++;
+	return ttc_model_read(ctx, channel, offset);
+}
+
+static const struct pwm_ops model_ops = {
+	counted_write,
+	counted_read,
+};
+
+static void on_edge(void *arg, uint32_t counter, uint64_t tick, uint32_t level)
+{
+	struct period *p = NULL;
+
+	if ( level ) {
+		if ( period_count > 0 ) {
+			p = &periods[period_count - 1];
+			p->length = tick - p->start;
+			p->high = last_fall - p->start;
+		}
+		if ( period_count < period_max ) {
+			periods[period_count].start = tick;
+			period_count++;
+		}
+	} else {
+		last_fall = tick;
+	}
+	return;
+}
+
+static void on_irq(void *arg, uint32_t counter)
+{
+	uint32_t before = accesses;
+
+	pwm_isr(&engine, counter);
+	if ( accesses - before > isr_accesses_max ) {
+		isr_accesses_max = accesses - before;
+	}
+	isr_accesses += accesses - before;
+	return;
+}
+
+static void post(uint32_t duty_ppm)
+{
+	const struct pwm_channel *ch = &engine.channels[CHANNEL];
+
+	pwm_set_duty(&engine, CHANNEL, duty_ppm);
+	posts[post_count].tick = model.now;
+	posts[post_count].match = ch->sync ? ch->pending_match : ch->solution.match;
+	post_count++;
+	return;
+}
+
+static void run(enum method method, uint32_t count)
+{
+	const struct pwm_channel *ch = &engine.channels[CHANNEL];
+	uint64_t period = 0;
+	uint32_t initial = 0;
+	uint32_t glitches = 0;
+	uint32_t wrong = 0;
+	uint32_t next = 0;
+	uint32_t match = 0;
+	uint32_t i = 0;
+
+	ttc_model_init(&model);
+	model.edge = on_edge;
+	model.irq = on_irq;
+	model.irq_latency = ( method == LATE ) ? 3 * LATENCY : LATENCY;
+	pwm_init(&engine, &model_ops, &model, CLOCK_HZ);
+	pwm_configure(&engine, CHANNEL, FREQ_MHZ, 500000);
+	if ( method != DIRECT ) {
+		pwm_sync_enable(&engine, CHANNEL, LATENCY);
+	}
+	initial = ch->solution.match;
+	period = (uint64_t) ch->solution.steps << ch->solution.prescale_log2;
+	post_count = 0;
+	period_count = 0;
+	period_max = count + 1;
+	isr_accesses = 0;
+	isr_accesses_max = 0;
+
+	pwm_start(&engine, 1 << CHANNEL);
+	for (i = 0; i < count; i++) {
+		if ( method == EVERY_PERIOD ) {
+			/* Somewhere in each period, as a loop paced by something else would */
+			ttc_model_run(&model, period * (i + 1) - model.now + rand() % period);
+			post(500000 + 450000 * sin(i * 2 * M_PI / 100));
+		} else {
+			/* Anywhere from straight after the last one to two periods on, small duty cycles more often */
+			ttc_model_run(&model, rand() % (2 * period));
+			post(( rand() % 4 == 0 ) ? rand() % 20000 : rand() % (PWM_DUTY_FULL + 1));
+		}
+		if ( period_count >= count ) {
+			break;
+		}
+	}
+	ttc_model_run(&model, 2 * period);
+	pwm_stop(&engine, 1 << CHANNEL);
+
+	/* The last period has no end */
+	for (i = 0; i + 1 < period_count; i++) {
+		if ( periods[i].length != period ) {
+			glitches++;
+		}
+		if ( method == DIRECT ) {
+			continue;
+		}
+		/* The first period has no interrupt at its start */
+		match = initial;
+		if ( i > 0 ) {
+			while ( ( next < post_count ) && ( posts[next].tick < periods[i].start + model.irq_latency ) ) {
+				next++;
+			}
+			match = ( next > 0 ) ? posts[next - 1].match : initial;
+		}
+		if ( ( method != LATE ) && ( periods[i].high != (uint64_t) match << ch->solution.prescale_log2 ) ) {
+			wrong++;
+		}
+	}
+	printf("%-22s%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10s%-8"PRIu32"%-10"PRIu32"%.2f/%"PRIu32"\n",
+			method_names[method], period_count - 1, post_count, glitches,
+			( method == DIRECT ) ? "-" : ( method == LATE ) ? "n/a" : ( wrong == 0 ) ? "yes" : "NO",
+			ch->late, ch->commits, ( ch->irqs == 0 ) ? 0.0 : (double) isr_accesses / ch->irqs, isr_accesses_max);
+	if ( ( method != DIRECT ) && ( ( glitches != 0 ) || ( wrong != 0 ) ) ) {
+		exit(1);
+	}
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t count = ( argc > 1 ) ? strtoul(argv[1], NULL, 0) : DEFAULT_PERIODS;
+
+	posts = calloc(2 * count + 1, sizeof(posts[0]));
+	periods = calloc(count + 2, sizeof(periods[0]));
+	if ( ( posts == NULL ) || ( periods == NULL ) ) {
+		return 1;
+	}
+	srand(1);
+	printf("%"PRIu64" mHz from a %d Hz clock, handler %d ticks after the interval interrupt\n\n",
+			(uint64_t) FREQ_MHZ, CLOCK_HZ, LATENCY);
+	printf("%-22s%-10s%-10s%-10s%-10s%-8s%-10s%s\n", "Method", "Periods", "Updates", "Glitches", "Exact",
+			"Late", "Commits", "ISR accesses mean/max");
+	run(DIRECT, count);
+	run(BUFFERED, count);
+	run(EVERY_PERIOD, count);
+	run(LATE, count);
+	printf("\nPASS\n");
+	free(posts);
+	free(periods);
+	return 0;
+}
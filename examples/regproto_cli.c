@@ -0,0 +1,321 @@
+/*
+ * Register access from the host over regproto.h
+ *
+ * Talks to regproto_examples.c on the board, or to regproto_loopback on a pty
+ * without one:
+ *
+ *   ./regproto_cli [-b baud] device peek addr...
+ *   ./regproto_cli [-b baud] device poke addr value [addr value]...
+ *   ./regproto_cli [-b baud] device read addr count
+ *   ./regproto_cli [-b baud] device write addr value...
+ *   ./regproto_cli [-b baud] device maps
+ *   ./regproto_cli [-b baud] device snapshot map
+ *   ./regproto_cli [-b baud] device bench map [reads]
+ *
+ * A map is given by name or index. bench reads the map's registers over and
+ * over, one per request, as many as fit in a request, and as snapshots, and
+ * reports reads per second and what each one cost on the wire.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#include "regproto.h"
+#include "regproto_client.h"
+
+#define DEFAULT_BENCH_READS		20000
+
+static struct regproto_client client;
+static struct regproto_map_info info;
+
+static uint32_t parse(const char *str)
+{
+	return strtoul(str, NULL, 0);
+}
+
+static int check(int status, const char *what)
+{
+	if ( status != REGPROTO_OK ) {
+		fprintf(stderr, "%s: %s\n", what, regproto_status_name(status));
+		return 1;
+	}
+	return 0;
+}
+
+static int cmd_peek(int count, char *args[])
+{
+	uint32_t addrs[count];
+	uint32_t values[count];
+	int i = 0;
+
+	for (i = 0; i < count; i++) {
+		addrs[i] = parse(args[i]);
+	}
+	if ( check(regproto_peek(&client, addrs, values, count), "peek") ) {
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		printf("0x%08"PRIx32"  0x%08"PRIx32"\n", addrs[i], values[i]);
+	}
+	return 0;
+}
+
+static int cmd_poke(int count, char *args[])
+{
+	uint32_t addrs[count / 2 + 1];
+	uint32_t values[count / 2 + 1];
+	int i = 0;
+
+	if ( ( count == 0 ) || ( count % 2 != 0 ) ) {
+		fprintf(stderr, "poke takes address and value pairs\n");
+		return 1;
+	}
+	for (i = 0; i < count / 2; i++) {
+		addrs[i] = parse(args[i * 2]);
+		values[i] = parse(args[i * 2 + 1]);
+	}
+	return check(regproto_poke(&client, addrs, values, count / 2), "poke");
+}
+
+static int cmd_read(int count, char *args[])
+{
+	uint32_t *values = NULL;
+	uint32_t addr = 0;
+	uint32_t words = 0;
+	uint32_t i = 0;
+
+	if ( count != 2 ) {
+		fprintf(stderr, "read takes an address and a word count\n");
+		return 1;
+	}
+	addr = parse(args[0]);
+	words = parse(args[1]);
+	values = calloc(words + 1, sizeof(values[0]));
+	if ( ( values == NULL ) || check(regproto_read(&client, addr, values, words), "read") ) {
+		free(values);
+		return 1;
+	}
+	for (i = 0; i < words; i++) {
+		if ( i % 4 == 0 ) {
+			printf("%s0x%08"PRIx32":", ( i == 0 ) ? "" : "\n", addr + i * 4);
+		}
+		printf(" %08"PRIx32, values[i]);
+	}
+	printf("\n");
+	free(values);
+	return 0;
+}
+
+static int cmd_write(int count, char *args[])
+{
+	uint32_t values[count + 1];
+	int i = 0;
+
+	if ( count < 2 ) {
+		fprintf(stderr, "write takes an address and at least one value\n");
+		return 1;
+	}
+	for (i = 1; i < count; i++) {
+		values[i - 1] = parse(args[i]);
+	}
+	return check(regproto_write(&client, parse(args[0]), values, count - 1), "write");
+}
+
+static int cmd_maps(void)
+{
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	printf("%-6s%-20s%-14s%s\n", "Index", "Name", "Base", "Registers");
+	for (i = 0; i < 256; i++) {
+		status = regproto_map_info(&client, i, &info);
+		if ( status == REGPROTO_NOT_FOUND ) {
+			break;
+		}
+		if ( check(status, "maps") ) {
+			return 1;
+		}
+		printf("%-6"PRIu32"%-20s0x%08"PRIx32"    %"PRIu32"\n", i, info.name, info.base, info.count);
+	}
+	return 0;
+}
+
+/* By index or by name, leaves the map's layout in info; returns the index or -1 */
+static int find_map(const char *arg)
+{
+	char *end = NULL;
+	uint32_t index = strtoul(arg, &end, 0);
+	int status = REGPROTO_OK;
+
+	if ( *end == '\0' ) {
+		return check(regproto_map_info(&client, index, &info), arg) ? -1 : (int) index;
+	}
+	for (index = 0; index < 256; index++) {
+		status = regproto_map_info(&client, index, &info);
+		if ( status == REGPROTO_NOT_FOUND ) {
+			break;
+		}
+		if ( check(status, "maps") ) {
+			return -1;
+		}
+		if ( strcmp(info.name, arg) == 0 ) {
+			return index;
+		}
+	}
+	fprintf(stderr, "No map called %s\n", arg);
+	return -1;
+}
+
+static int cmd_snapshot(const char *arg)
+{
+	uint32_t values[REGPROTO_READ_MAX];
+	int index = find_map(arg);
+	uint32_t i = 0;
+
+	if ( ( index < 0 ) || check(regproto_snapshot(&client, index, values), "snapshot") ) {
+		return 1;
+	}
+	printf("%s at 0x%08"PRIx32"\n", info.name, info.base);
+	for (i = 0; i < info.count; i++) {
+		printf("  %-20s0x%03"PRIx16"  0x%08"PRIx32"\n", info.reg_names[i], info.offsets[i], values[i]);
+	}
+	return 0;
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_bench(const char *name, uint32_t reads, uint32_t requests, uint64_t bytes, double seconds)
+{
+	printf("%-22s%-10"PRIu32"%-10"PRIu32"%-12.1f%-12.0f%-10.1f\n", name, reads, requests, seconds * 1000,
+			reads / seconds, (double) bytes / reads);
+	return;
+}
+
+/* One run: reads of the map's registers in requests of batch addresses, or snapshots with batch 0 */
+static int bench_run(const char *name, int index, uint32_t reads, uint32_t batch)
+{
+	uint32_t addrs[REGPROTO_PEEK_MAX];
+	uint32_t values[REGPROTO_PEEK_MAX];
+	struct regproto_client_stats before = client.stats;
+	uint32_t done = 0;
+	uint32_t i = 0;
+	double start = 0;
+	int status = REGPROTO_OK;
+
+	for (i = 0; i < REGPROTO_PEEK_MAX; i++) {
+		addrs[i] = info.base + info.offsets[i % info.count];
+	}
+	start = now_s();
+	while ( ( done < reads ) && ( status == REGPROTO_OK ) ) {
+		if ( batch == 0 ) {
+			status = regproto_snapshot(&client, index, values);
+			done += info.count;
+		} else {
+			status = regproto_peek(&client, addrs, values, batch);
+			done += batch;
+		}
+	}
+	if ( check(status, name) ) {
+		return 1;
+	}
+	print_bench(name, done, client.stats.requests - before.requests,
+			(client.stats.tx_bytes - before.tx_bytes) + (client.stats.rx_bytes - before.rx_bytes),
+			now_s() - start);
+	return 0;
+}
+
+static int cmd_bench(int count, char *args[])
+{
+	uint32_t reads = ( count > 1 ) ? parse(args[1]) : DEFAULT_BENCH_READS;
+	int index = ( count > 0 ) ? find_map(args[0]) : -1;
+
+	if ( index < 0 ) {
+		fprintf(stderr, "bench takes a map\n");
+		return 1;
+	}
+	if ( info.count == 0 ) {
+		fprintf(stderr, "Map %s has no registers\n", info.name);
+		return 1;
+	}
+	printf("%"PRIu32" reads of the %"PRIu32" registers of %s\n\n", reads, info.count, info.name);
+	printf("%-22s%-10s%-10s%-12s%-12s%-10s\n", "Method", "Reads", "Requests", "Time (ms)", "Reads/s",
+			"Bytes/read");
+	/* One at a time is slow, so it gets fewer */
+	if ( bench_run("peek, 1 per request", index, reads / 10, 1) ||
+			bench_run("peek, batched", index, reads, REGPROTO_PEEK_MAX) ||
+			bench_run("snapshot", index, reads, 0) ) {
+		return 1;
+	}
+	printf("\n%-30s%"PRIu32"\n", "Retries", client.stats.retries);
+	printf("%-30s%"PRIu32"\n", "Stale answers", client.stats.stale);
+	printf("%-30s%"PRIu32"\n", "Bad frames", client.rx.errors);
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-b baud] device command [args]\n"
+			"  peek addr...\n"
+			"  poke addr value [addr value]...\n"
+			"  read addr count\n"
+			"  write addr value...\n"
+			"  maps\n"
+			"  snapshot map\n"
+			"  bench map [reads]\n", name);
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t baud = 0;
+	const char *cmd = NULL;
+	char **args = NULL;
+	int count = 0;
+	int arg = 1;
+	int ret = 1;
+
+	if ( ( argc > 2 ) && ( strcmp(argv[1], "-b") == 0 ) ) {
+		baud = parse(argv[2]);
+		arg = 3;
+	}
+	if ( argc - arg < 2 ) {
+		usage(argv[0]);
+		return 1;
+	}
+	if ( regproto_client_open(&client, argv[arg], baud) != 0 ) {
+		return 1;
+	}
+	cmd = argv[arg + 1];
+	args = &argv[arg + 2];
+	count = argc - arg - 2;
+
+	if ( ( strcmp(cmd, "peek") == 0 ) && ( count > 0 ) ) {
+		ret = cmd_peek(count, args);
+	} else if ( strcmp(cmd, "poke") == 0 ) {
+		ret = cmd_poke(count, args);
+	} else if ( strcmp(cmd, "read") == 0 ) {
+		ret = cmd_read(count, args);
+	} else if ( strcmp(cmd, "write") == 0 ) {
+		ret = cmd_write(count, args);
+	} else if ( strcmp(cmd, "maps") == 0 ) {
+		ret = cmd_maps();
+	} else if ( ( strcmp(cmd, "snapshot") == 0 ) && ( count == 1 ) ) {
+		ret = cmd_snapshot(args[0]);
+	} else if ( strcmp(cmd, "bench") == 0 ) {
+		ret = cmd_bench(count, args);
+	} else {
+		usage(argv[0]);
+	}
+	regproto_client_close(&client);
+	return ret;
+}
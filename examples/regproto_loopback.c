@@ -0,0 +1,221 @@
+/*
+ * regproto.h agent on a pty, standing in for the board
+ *
+ * Runs the same agent as regproto_examples.c, over pretend registers: a TTC
+ * at the TTC0 address, whose counters move every time they are read, and
+ * 64KB of scratch memory at the bottom of DDR. Anything else is refused, as
+ * the board refuses addresses outside its windows. Prints the pty to point
+ * regproto_cli at, then serves requests until interrupted.
+ *
+ * A pty moves bytes as fast as the host can, so -b paces the answers at a
+ * baud rate to give numbers that mean something for a real UART, and -e
+ * corrupts one answer in every N to exercise the client's retries.
+ *
+ *   ./regproto_loopback [-b baud] [-e N]
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "regproto.h"
+
+#define TTC_BASE			0xF8001000
+#define TTC_SIZE			0x84
+#define TTC_COUNTER_OFFSET		0x18
+#define RAM_BASE			0x00100000
+#define RAM_SIZE			0x10000
+
+struct target {
+	uint32_t ttc[TTC_SIZE / 4];
+	uint32_t ram[RAM_SIZE / 4];
+	uint32_t baud;
+	uint32_t corrupt_every;
+	uint32_t frames;
+	int fd;
+};
+
+static const struct regproto_reg ttc_regs[] = {
+	{"CLK_CTRL_0", 0x00},
+	{"CLK_CTRL_1", 0x04},
+	{"CLK_CTRL_2", 0x08},
+	{"CNT_CTRL_0", 0x0C},
+	{"CNT_CTRL_1", 0x10},
+	{"CNT_CTRL_2", 0x14},
+	{"COUNTER_0", 0x18},
+	{"COUNTER_1", 0x1C},
+	{"COUNTER_2", 0x20},
+	{"INTERVAL_0", 0x24},
+	{"INTERVAL_1", 0x28},
+	{"INTERVAL_2", 0x2C},
+	{"MATCH_1_0", 0x30},
+	{"MATCH_1_1", 0x34},
+	{"MATCH_1_2", 0x38},
+	{"IER_0", 0x60},
+	{"IER_1", 0x64},
+	{"IER_2", 0x68},
+};
+
+static const struct regproto_reg ram_regs[] = {
+	{"WORD_0", 0x00},
+	{"WORD_1", 0x04},
+	{"WORD_2", 0x08},
+	{"WORD_3", 0x0C},
+};
+
+static const struct regproto_map maps[] = {
+	{"ttc0", TTC_BASE, ttc_regs, sizeof(ttc_regs) / sizeof(ttc_regs[0])},
+	{"ram", RAM_BASE, ram_regs, sizeof(ram_regs) / sizeof(ram_regs[0])},
+};
+
+static uint32_t *lookup(struct target *target, uint32_t addr)
+{
+	if ( ( addr >= TTC_BASE ) && ( addr - TTC_BASE < TTC_SIZE ) ) {
+		return &target->ttc[(addr - TTC_BASE) / 4];
+	}
+	if ( ( addr >= RAM_BASE ) && ( addr - RAM_BASE < RAM_SIZE ) ) {
+		return &target->ram[(addr - RAM_BASE) / 4];
+	}
+	return NULL;
+}
+
+static uint32_t target_read32(void *ctx, uint32_t addr)
+{
+	struct target *target = ctx;
+	uint32_t *reg = lookup(target, addr);
+
+	/* Free running 16-bit counters, like the TTC's */
+	if ( ( addr >= TTC_BASE + TTC_COUNTER_OFFSET ) && ( addr < TTC_BASE + TTC_COUNTER_OFFSET + 12 ) ) {
+		*reg = (*reg + 1) & 0xFFFF;
+	}
+	return *reg;
+}
+
+static void target_write32(void *ctx, uint32_t addr, uint32_t val)
+{
+	*lookup(ctx, addr) = val;
+	return;
+}
+
+static int in_window(uint32_t addr, uint32_t bytes, uint32_t base, uint32_t size)
+{
+	return ( addr >= base ) && ( addr - base < size ) && ( bytes <= size - (addr - base) );
+}
+
+static int target_access_ok(void *ctx, uint32_t addr, uint32_t bytes)
+{
+	return in_window(addr, bytes, TTC_BASE, TTC_SIZE) || in_window(addr, bytes, RAM_BASE, RAM_SIZE);
+}
+
+static void target_tx(void *ctx, const uint8_t *data, size_t len)
+{
+	struct target *target = ctx;
+	uint8_t frame[REGPROTO_FRAME_MAX];
+	struct timespec wire;
+	uint64_t ns = 0;
+	ssize_t done = 0;
+
+	memcpy(frame, data, len);
+	target->frames++;
+	if ( ( target->corrupt_every != 0 ) && ( target->frames % target->corrupt_every == 0 ) ) {
+		frame[len / 2] ^= 0x5A;
+	}
+	/* Ten bits a byte on the wire, start and stop included */
+	if ( target->baud != 0 ) {
+		ns = (uint64_t) len * 10 * 1000000000ULL / target->baud;
+		wire.tv_sec = ns / 1000000000ULL;
+		wire.tv_nsec = ns % 1000000000ULL;
+		nanosleep(&wire, NULL);
+	}
+	while ( len > 0 ) {
+		done = write(target->fd, frame, len);
+		if ( done < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			perror("write");
+			return;
+		}
+		memmove(frame, frame + done, len - done);
+		len -= done;
+	}
+	return;
+}
+
+static const struct regproto_agent_ops target_ops = {
+	target_read32,
+	target_write32,
+	target_access_ok,
+	target_tx,
+};
+
+int main(int argc, char *argv[])
+{
+	static struct target target;
+	static struct regproto_agent agent;
+	struct termios tio;
+	uint8_t buf[4096];
+	ssize_t got = 0;
+	ssize_t i = 0;
+	int slave = -1;
+	int opt = 0;
+
+	while ( ( opt = getopt(argc, argv, "b:e:") ) != -1 ) {
+		switch ( opt ) {
+		case 'b':
+			target.baud = strtoul(optarg, NULL, 0);
+			break;
+		case 'e':
+			target.corrupt_every = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-b baud] [-e N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	target.fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if ( ( target.fd < 0 ) || ( grantpt(target.fd) != 0 ) || ( unlockpt(target.fd) != 0 ) ) {
+		perror("posix_openpt");
+		return 1;
+	}
+	/* Held open so the master does not see a hangup between clients, and raw so nothing is echoed */
+	slave = open(ptsname(target.fd), O_RDWR | O_NOCTTY);
+	if ( ( slave < 0 ) || ( tcgetattr(slave, &tio) != 0 ) ) {
+		perror("open");
+		return 1;
+	}
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+
+	regproto_agent_init(&agent, &target_ops, &target, maps, sizeof(maps) / sizeof(maps[0]));
+	printf("%s\n", ptsname(target.fd));
+	fflush(stdout);
+
+	for (;;) {
+		got = read(target.fd, buf, sizeof(buf));
+		if ( got < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			perror("read");
+			break;
+		}
+		for (i = 0; i < got; i++) {
+			regproto_agent_rx(&agent, buf[i]);
+		}
+	}
+	fprintf(stderr, "%"PRIu32" requests, %"PRIu32" bad frames\n", agent.requests, agent.rx.errors);
+	close(slave);
+	close(target.fd);
+	return 0;
+}
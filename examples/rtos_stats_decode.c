@@ -0,0 +1,184 @@
+/*
+ * Host decoder for run-time statistics dumps (src/rtos/rtos_stats.c)
+ *
+ * Reads a captured serial console log on stdin, picks out the rtos_stats lines
+ * printed by the "stats-dump" command and prints the same report as "stats",
+ * with the totals in seconds rather than microseconds. If the log holds more
+ * than one dump, the differences between the last two are printed as well,
+ * which is the load over that interval rather than since boot.
+ *
+ *   ./rtos_stats_decode < console.log
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "rtos_stats.h"
+
+#define LINE_LEN			256
+
+static int parse_hex(const char *p, uint8_t *buf, size_t *used, size_t len)
+{
+	unsigned int byte = 0;
+
+	while ( sscanf(p, "%2x", &byte) == 1 ) {
+		if ( *used >= len ) {
+			return -1;
+		}
+		buf[(*used)++] = (uint8_t) byte;
+		p += 2;
+	}
+	return 0;
+}
+
+/* Unpacks what rtos_stats_dump() packed */
+static int unpack(const uint8_t *buf, size_t len, struct rtos_stats_snapshot *snapshot)
+{
+	struct rtos_stats_header *header = &snapshot->header;
+	size_t tasks = 0;
+	size_t irqs = 0;
+
+	memset(snapshot, 0, sizeof(*snapshot));
+	if ( len < sizeof(*header) ) {
+		return -1;
+	}
+	memcpy(header, buf, sizeof(*header));
+	if ( ( header->magic != RTOS_STATS_MAGIC ) || ( header->version != RTOS_STATS_VERSION ) ||
+			( header->tasks > RTOS_STATS_MAX_TASKS ) || ( header->irqs > RTOS_STATS_MAX_IRQS ) ) {
+		return -1;
+	}
+	tasks = header->tasks * sizeof(snapshot->tasks[0]);
+	irqs = header->irqs * sizeof(snapshot->irqs[0]);
+	if ( len != sizeof(*header) + tasks + irqs ) {
+		return -1;
+	}
+	memcpy(snapshot->tasks, buf + sizeof(*header), tasks);
+	memcpy(snapshot->irqs, buf + sizeof(*header) + tasks, irqs);
+	return 0;
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+	return ( whole != 0 ) ? 100.0 * part / whole : 0.0;
+}
+
+static void report(const struct rtos_stats_snapshot *snapshot, uint64_t elapsed)
+{
+	const struct rtos_stats_header *header = &snapshot->header;
+	double hz = ( header->hz != 0 ) ? (double) header->hz : 1.0;
+	uint64_t busy = 0;
+	uint32_t i = 0;
+
+	printf("%-18s%-14s%-10s%-12s\n", "Task", "Time (s)", "CPU %", "Switches");
+	for (i = 0; i < header->tasks; i++) {
+		printf("%-16.*s%-2s%-14.6f%-10.2f%-12"PRIu32"\n", RTOS_STATS_NAME_LEN, snapshot->tasks[i].name,
+				snapshot->tasks[i].alive ? "" : "*", snapshot->tasks[i].time / hz,
+				percent(snapshot->tasks[i].time, elapsed), snapshot->tasks[i].switches);
+		busy += snapshot->tasks[i].time;
+	}
+	printf("\n%-18s%-14s%-10s%-12s%-12s\n", "Interrupt ID", "Time (s)", "CPU %", "Count", "Max (us)");
+	for (i = 0; i < header->irqs; i++) {
+		printf("%-18"PRIu32"%-14.6f%-10.2f%-12"PRIu32"%-12.2f\n", snapshot->irqs[i].id,
+				snapshot->irqs[i].time / hz, percent(snapshot->irqs[i].time, elapsed),
+				snapshot->irqs[i].count, 1e6 * snapshot->irqs[i].max / hz);
+	}
+	busy += header->irq_time;
+	printf("\n%-30s%.6f s, %"PRIu32" context switches\n", "Elapsed", elapsed / hz, header->switches);
+	printf("%-30s%.2f%%\n", "Interrupts", percent(header->irq_time, elapsed));
+	printf("%-30s%"PRIu32" hooks, %.1f ns each, %.3f%% of CPU\n", "Statistics overhead",
+			header->overhead_events,
+			( header->overhead_events != 0 ) ? 1e9 * header->overhead / hz / header->overhead_events : 0.0,
+			percent(header->overhead, elapsed));
+	/* Tasks and interrupts between them should account for every count */
+	printf("%-30s%.3f%%\n", "Unaccounted", ( elapsed != 0 ) ? 100.0 - percent(busy, elapsed) : 0.0);
+	return;
+}
+
+/* last less first, matching tasks by name and interrupts by ID */
+static void difference(const struct rtos_stats_snapshot *first, const struct rtos_stats_snapshot *last,
+		struct rtos_stats_snapshot *delta)
+{
+	struct rtos_stats_header *header = &delta->header;
+	uint32_t i = 0;
+	uint32_t j = 0;
+
+	*delta = *last;
+	header->irq_time -= first->header.irq_time;
+	header->overhead -= first->header.overhead;
+	header->overhead_events -= first->header.overhead_events;
+	header->switches -= first->header.switches;
+	for (i = 0; i < header->tasks; i++) {
+		for (j = 0; j < first->header.tasks; j++) {
+			if ( strncmp(delta->tasks[i].name, first->tasks[j].name, RTOS_STATS_NAME_LEN) == 0 ) {
+				delta->tasks[i].time -= first->tasks[j].time;
+				delta->tasks[i].switches -= first->tasks[j].switches;
+				break;
+			}
+		}
+	}
+	for (i = 0; i < header->irqs; i++) {
+		for (j = 0; j < first->header.irqs; j++) {
+			if ( delta->irqs[i].id == first->irqs[j].id ) {
+				delta->irqs[i].time -= first->irqs[j].time;
+				delta->irqs[i].count -= first->irqs[j].count;
+				break;
+			}
+		}
+	}
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	char line[LINE_LEN];
+	static uint8_t buf[sizeof(struct rtos_stats_snapshot)];
+	static struct rtos_stats_snapshot snapshots[2];
+	static struct rtos_stats_snapshot delta;
+	const struct rtos_stats_snapshot *last = NULL;
+	size_t expected = 0;
+	size_t used = 0;
+	uint32_t dumps = 0;
+	int in_dump = 0;
+
+	while ( fgets(line, sizeof(line), stdin) != NULL ) {
+		if ( sscanf(line, "rtos_stats begin %zu", &expected) == 1 ) {
+			in_dump = 1;
+			used = 0;
+			continue;
+		}
+		if ( !in_dump ) {
+			continue;
+		}
+		if ( strncmp(line, "rtos_stats end", 14) == 0 ) {
+			in_dump = 0;
+			/* Into delta first, so that a damaged dump does not overwrite a good one */
+			if ( ( used != expected ) || ( unpack(buf, used, &delta) != 0 ) ) {
+				fprintf(stderr, "Skipping a damaged dump (%zu of %zu bytes)\n", used, expected);
+				continue;
+			}
+			snapshots[dumps % 2] = delta;
+			dumps++;
+			continue;
+		}
+		if ( ( strncmp(line, "rtos_stats ", 11) != 0 ) || ( parse_hex(line + 11, buf, &used, sizeof(buf)) != 0 ) ) {
+			in_dump = 0;
+		}
+	}
+
+	if ( dumps == 0 ) {
+		fprintf(stderr, "No run-time statistics dump found\n");
+		return 1;
+	}
+	last = &snapshots[(dumps - 1) % 2];
+	printf("Since boot, at %"PRIu64" Hz\n\n", last->header.hz);
+	report(last, last->header.now - last->header.start);
+	if ( dumps > 1 ) {
+		difference(&snapshots[dumps % 2], last, &delta);
+		printf("\nBetween the last two dumps\n\n");
+		report(&delta, last->header.now - snapshots[dumps % 2].header.now);
+	}
+	return 0;
+}
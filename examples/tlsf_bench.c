@@ -0,0 +1,271 @@
+/*
+ * Allocation latency, tlsf.h against the C library's malloc()
+ *
+ * Runs the same randomized workload through both: a fixed number of slots,
+ * each either empty or holding one allocation, with every step picking a slot
+ * at random and filling or emptying it. Sizes follow what an embedded
+ * application keeps on the heap: mostly small objects (timers, messages), some
+ * log buffers, and now and then a sample ring of several kilobytes. Every
+ * allocation and free is timed on its own, and the report gives percentiles
+ * rather than a mean, since the worst case is what a real-time path pays.
+ *
+ * On the host the C library is glibc, whose per-thread caches make its common
+ * case fast; the board's newlib has no such caches, so the host tails are the
+ * kinder comparison. Times include the clock read, which is measured and
+ * taken off.
+ *
+ *   ./tlsf_bench [steps] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "tlsf.h"
+#include "microbench.h"
+
+#define POOL_SIZE			(16 << 20)
+#define SLOTS				1024
+#define DEFAULT_STEPS			1000000
+#define DEFAULT_SEED			1
+#define CHECK_EVERY			65536
+
+struct allocator {
+	const char *name;
+	void *(*alloc)(size_t size);
+	void (*release)(void *ptr);
+};
+
+struct latencies {
+	uint32_t *ns;
+	uint32_t count;
+};
+
+static struct tlsf *pool;
+static uint64_t clock_cost;
+/* TLSF free space with the workload's last live set still allocated */
+static size_t loaded_free;
+static size_t loaded_largest;
+
+static void *tlsf_alloc(size_t size)
+{
+	return tlsf_malloc(pool, size);
+}
+
+static void tlsf_release(void *ptr)
+{
+	tlsf_free(pool, ptr);
+	return;
+}
+
+static void libc_release(void *ptr)
+{
+	free(ptr);
+	return;
+}
+
+static const struct allocator allocators[] = {
+	{"tlsf", tlsf_alloc, tlsf_release},
+	{"libc malloc", malloc, libc_release},
+};
+
+/* xorshift32, so both allocators see exactly the same workload */
+static uint32_t next_random(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+static size_t random_size(uint32_t *state)
+{
+	uint32_t kind = next_random(state) % 100;
+
+	if ( kind < 70 ) {
+		return 16 + next_random(state) % 112;
+	} else if ( kind < 95 ) {
+		return 128 + next_random(state) % 896;
+	}
+	return 1024 + next_random(state) % (15 * 1024);
+}
+
+/* Smallest cost of reading the clock twice in a row */
+static uint64_t measure_clock(void)
+{
+	uint64_t best = UINT64_MAX;
+	uint64_t start = 0;
+	uint64_t stop = 0;
+	uint32_t i = 0;
+
+	for (i = 0; i < 100000; i++) {
+		start = microbench_now_ns();
+		stop = microbench_now_ns();
+		if ( stop - start < best ) {
+			best = stop - start;
+		}
+	}
+	return best;
+}
+
+static void record(struct latencies *lat, uint64_t start, uint64_t stop)
+{
+	uint64_t ns = stop - start;
+
+	ns = ( ns > clock_cost ) ? ns - clock_cost : 0;
+	lat->ns[lat->count++] = ( ns > UINT32_MAX ) ? UINT32_MAX : (uint32_t) ns;
+	return;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+static uint32_t percentile(const struct latencies *lat, double p)
+{
+	return lat->ns[(uint32_t) (p * (lat->count - 1))];
+}
+
+static void print_latencies(const char *name, const char *op, struct latencies *lat)
+{
+	uint64_t sum = 0;
+	uint32_t i = 0;
+
+	if ( lat->count == 0 ) {
+		return;
+	}
+	qsort(lat->ns, lat->count, sizeof(lat->ns[0]), compare_u32);
+	for (i = 0; i < lat->count; i++) {
+		sum += lat->ns[i];
+	}
+	printf("%-14s%-8s%-10.1f%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"\n", name, op,
+			(double) sum / lat->count, percentile(lat, 0.5), percentile(lat, 0.9), percentile(lat, 0.99),
+			percentile(lat, 0.999), lat->ns[lat->count - 1]);
+	return;
+}
+
+static int run(const struct allocator *allocator, uint32_t steps, uint32_t seed, struct latencies *allocs,
+		struct latencies *frees, uint32_t *failures)
+{
+	static void *slots[SLOTS];
+	uint32_t state = seed;
+	uint64_t start = 0;
+	uint64_t stop = 0;
+	uint32_t slot = 0;
+	size_t size = 0;
+	uint32_t i = 0;
+
+	memset(slots, 0, sizeof(slots));
+	allocs->count = 0;
+	frees->count = 0;
+	*failures = 0;
+	for (i = 0; i < steps; i++) {
+		slot = next_random(&state) % SLOTS;
+		if ( slots[slot] == NULL ) {
+			size = random_size(&state);
+			start = microbench_now_ns();
+			slots[slot] = allocator->alloc(size);
+			stop = microbench_now_ns();
+			record(allocs, start, stop);
+			if ( slots[slot] == NULL ) {
+				(*failures)++;
+				continue;
+			}
+			/* Touch the block, as a real user would, and so that a bad pointer shows */
+			memset(slots[slot], (int) i, size);
+		} else {
+			start = microbench_now_ns();
+			allocator->release(slots[slot]);
+			stop = microbench_now_ns();
+			record(frees, start, stop);
+			slots[slot] = NULL;
+		}
+		if ( ( allocator->alloc == tlsf_alloc ) && ( i % CHECK_EVERY == 0 ) &&
+				( tlsf_check(pool, NULL, NULL) != 0 ) ) {
+			fprintf(stderr, "TLSF pool corrupt after %"PRIu32" steps\n", i);
+			return -1;
+		}
+	}
+	if ( ( allocator->alloc == tlsf_alloc ) && ( tlsf_check(pool, &loaded_free, &loaded_largest) != 0 ) ) {
+		fprintf(stderr, "TLSF pool corrupt at the end of the run\n");
+		return -1;
+	}
+	for (slot = 0; slot < SLOTS; slot++) {
+		allocator->release(slots[slot]);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct latencies allocs;
+	struct latencies frees;
+	struct tlsf_stats stats;
+	void *mem = NULL;
+	uint32_t steps = ( argc > 1 ) ? (uint32_t) strtoul(argv[1], NULL, 0) : DEFAULT_STEPS;
+	uint32_t seed = ( argc > 2 ) ? (uint32_t) strtoul(argv[2], NULL, 0) : DEFAULT_SEED;
+	uint32_t failures = 0;
+	size_t free_bytes = 0;
+	size_t largest = 0;
+	uint32_t i = 0;
+
+	if ( seed == 0 ) {
+		seed = DEFAULT_SEED;
+	}
+	mem = malloc(POOL_SIZE);
+	allocs.ns = malloc(steps * sizeof(allocs.ns[0]));
+	frees.ns = malloc(steps * sizeof(frees.ns[0]));
+	if ( ( mem == NULL ) || ( allocs.ns == NULL ) || ( frees.ns == NULL ) ) {
+		fprintf(stderr, "Could not allocate memory for %"PRIu32" steps\n", steps);
+		return 1;
+	}
+	/* Fault the pages in, as they would be on the board */
+	memset(mem, 0, POOL_SIZE);
+	pool = tlsf_create(mem, POOL_SIZE);
+	if ( pool == NULL ) {
+		fprintf(stderr, "Could not create the TLSF pool\n");
+		return 1;
+	}
+	clock_cost = measure_clock();
+
+	printf("%"PRIu32" steps over %d slots, seed %"PRIu32", clock read %"PRIu64" ns taken off\n\n", steps,
+			SLOTS, seed, clock_cost);
+	printf("%-14s%-8s%-10s%-10s%-10s%-10s%-10s%-10s\n", "Allocator", "Op", "Mean", "p50", "p90", "p99",
+			"p99.9", "Max (ns)");
+	for (i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+		if ( run(&allocators[i], steps, seed, &allocs, &frees, &failures) != 0 ) {
+			return 1;
+		}
+		print_latencies(allocators[i].name, "alloc", &allocs);
+		print_latencies(allocators[i].name, "free", &frees);
+		if ( failures != 0 ) {
+			printf("%-14s%"PRIu32" allocations failed\n", allocators[i].name, failures);
+		}
+	}
+
+	/* Everything was freed at the end of the run, so the pool should be back to one block */
+	tlsf_get_stats(pool, &stats);
+	if ( tlsf_check(pool, &free_bytes, &largest) != 0 ) {
+		fprintf(stderr, "TLSF pool corrupt at the end\n");
+		return 1;
+	}
+	printf("\n%-30s%zu of %zu bytes\n", "TLSF peak use", stats.peak, stats.size);
+	printf("%-30s%zu bytes, largest block %zu (%.1f%% fragmented)\n", "TLSF free under load", loaded_free,
+			loaded_largest, ( loaded_free != 0 ) ? 100.0 * (1.0 - (double) loaded_largest / loaded_free) : 0.0);
+	printf("%-30s%zu bytes, largest block %zu\n", "TLSF free when emptied", free_bytes, largest);
+	printf("%-30s%"PRIu32" allocs, %"PRIu32" frees, %"PRIu32" failed\n", "TLSF counts", stats.allocs,
+			stats.frees, stats.failures);
+	free(frees.ns);
+	free(allocs.ns);
+	free(mem);
+	return 0;
+}
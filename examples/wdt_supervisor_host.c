@@ -0,0 +1,201 @@
+/*
+ * wdt_supervisor.h on the host, in virtual time
+ *
+ * Runs the real supervisor against a plain tick counter: clients check in
+ * every so many ticks and stop (and maybe start again) when the scenario says,
+ * and the supervisor is checked every CHECK_PERIOD ticks. Each scenario says
+ * which client should be the first one late, at which check and by how much,
+ * and the run is held to exactly that:
+ *
+ * - the watchdog is kicked at every check up to the late one, and at no other
+ *   time
+ * - the first late client and how far over its deadline it was are recorded,
+ *   and a client going late after it does not replace it
+ * - once late, every check fails, even when the client comes back
+ *
+ * The wrap scenario starts just short of 2^32, so the deadlines are worked out
+ * across the counter wrapping; a plain now > last + deadline would go late
+ * early there.
+ *
+ *   ./wdt_supervisor_host
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "wdt_supervisor.h"
+
+#define CHECK_PERIOD			50
+#define MAX_PLANS			4
+#define NEVER				UINT32_MAX
+
+struct plan {
+	const char *name;
+	uint32_t deadline;
+	uint32_t period;
+	/* Last tick the client checks in on, and the tick it starts again */
+	uint32_t stop;
+	uint32_t resume;
+};
+
+struct scenario {
+	const char *name;
+	uint32_t start;
+	uint32_t ticks;
+	struct plan plans[MAX_PLANS];
+	uint32_t num_plans;
+	int late;
+	/* Relative to start */
+	uint32_t late_at;
+	uint32_t overdue;
+};
+
+struct watchdog {
+	uint32_t now;
+	uint32_t kicks;
+	uint32_t wrong;
+	uint32_t start;
+};
+
+static const struct scenario scenarios[] = {
+	{
+		"healthy",
+		0,
+		10000,
+		{
+			{"fast", 100, 40, NEVER, NEVER},
+			{"slow", 1000, 600, NEVER, NEVER},
+		},
+		2,
+		WDT_SUPERVISOR_NONE,
+		0,
+		0,
+	},
+	{
+		/*
+		 * fast is last seen at the check at 2000, idle 150 > 100 at 2150.
+		 * slow is last seen at 1200 and would be late at 2250, after fast.
+		 */
+		"late",
+		0,
+		5000,
+		{
+			{"fast", 100, 40, 2000, 3000},
+			{"slow", 1000, 600, 1200, NEVER},
+		},
+		2,
+		0,
+		2150,
+		50,
+	},
+	{
+		/* Last seen at 200, before the wrap at 256, late at 350 after it */
+		"wrap",
+		0xFFFFFF00,
+		1000,
+		{
+			{"fast", 100, 40, 200, NEVER},
+		},
+		1,
+		0,
+		350,
+		50,
+	},
+};
+
+static void kick(void *ctx)
+{
+	struct watchdog *wd = ctx;
+
+	/* Only ever at a check, and only while nothing is late */
+	if ( ( wd->now - wd->start ) != (wd->kicks + 1) * CHECK_PERIOD ) {
+		wd->wrong++;
+	}
+	wd->kicks++;
+	return;
+}
+
+/* Returns the number of failures */
+static uint32_t run(const struct scenario *s)
+{
+	struct wdt_supervisor sup;
+	struct watchdog wd;
+	const struct plan *p = NULL;
+	uint32_t failed_checks = 0;
+	uint32_t errors = 0;
+	uint32_t checks = 0;
+	uint32_t kicks = 0;
+	uint32_t r = 0;
+	uint32_t i = 0;
+	int ids[MAX_PLANS];
+	int expect_late = 0;
+	int status = 0;
+
+	wd.now = s->start;
+	wd.kicks = 0;
+	wd.wrong = 0;
+	wd.start = s->start;
+	wdt_supervisor_init(&sup, kick, &wd);
+	for (i = 0; i < s->num_plans; i++) {
+		ids[i] = wdt_supervisor_register(&sup, s->plans[i].name, s->plans[i].deadline, s->start);
+	}
+
+	for (r = 1; r <= s->ticks; r++) {
+		wd.now = s->start + r;
+		for (i = 0; i < s->num_plans; i++) {
+			p = &s->plans[i];
+			if ( ( ( r % p->period ) == 0 ) && ( ( r <= p->stop ) || ( r >= p->resume ) ) ) {
+				wdt_supervisor_checkin(&sup, ids[i]);
+			}
+		}
+		if ( ( r % CHECK_PERIOD ) != 0 ) {
+			continue;
+		}
+		checks++;
+		status = wdt_supervisor_check(&sup, wd.now);
+		expect_late = ( s->late != WDT_SUPERVISOR_NONE ) && ( r >= s->late_at );
+		if ( status != ( expect_late ? -1 : 0 ) ) {
+			printf("  check at %"PRIu32" returned %d\n", r, status);
+			errors++;
+		}
+		if ( status != 0 ) {
+			failed_checks++;
+		}
+	}
+
+	kicks = ( s->late == WDT_SUPERVISOR_NONE ) ? checks : s->late_at / CHECK_PERIOD - 1;
+	if ( ( wd.kicks != kicks ) || ( sup.kicks != kicks ) || ( wd.wrong != 0 ) ) {
+		printf("  %"PRIu32" kicks, %"PRIu32" out of turn, expected %"PRIu32"\n", wd.kicks, wd.wrong, kicks);
+		errors++;
+	}
+	if ( sup.late != s->late ) {
+		printf("  late client %d, expected %d\n", sup.late, s->late);
+		errors++;
+	} else if ( ( s->late != WDT_SUPERVISOR_NONE ) &&
+			( ( sup.late_time != s->start + s->late_at ) || ( sup.late_overdue != s->overdue ) ) ) {
+		printf("  late at %"PRIu32" by %"PRIu32", expected %"PRIu32" by %"PRIu32"\n",
+				sup.late_time - s->start, sup.late_overdue, s->late_at, s->overdue);
+		errors++;
+	}
+	printf("%-12s%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-12s%-10"PRIu32"%-10"PRIu32"%s\n", s->name, checks,
+			wd.kicks, failed_checks, ( sup.late == WDT_SUPERVISOR_NONE ) ? "-" : sup.clients[sup.late].name,
+			( sup.late == WDT_SUPERVISOR_NONE ) ? 0 : sup.late_time - s->start, sup.late_overdue,
+			( errors == 0 ) ? "ok" : "FAIL");
+	return errors;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t errors = 0;
+	uint32_t i = 0;
+
+	printf("%-12s%-10s%-10s%-10s%-12s%-10s%-10s%s\n", "Scenario", "Checks", "Kicks", "Failed", "Late",
+			"At", "Overdue", "Result");
+	for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+		errors += run(&scenarios[i]);
+	}
+	printf("\n%s\n", ( errors == 0 ) ? "PASS" : "FAIL");
+	return ( errors == 0 ) ? 0 : 1;
+}
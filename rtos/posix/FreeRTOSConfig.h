@@ -0,0 +1,54 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+#include <limits.h>
+
+/*
+ * Kernel configuration for running src/rtos on the FreeRTOS POSIX port (see
+ * rtos_drivers_posix.c). The board uses the RTOSDemo project's own
+ * FreeRTOSConfig.h, which needs configUSE_IDLE_HOOK set for the CPU idle
+ * figures and nothing else changed.
+ */
+
+#define configUSE_PREEMPTION				1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION		0
+#define configUSE_IDLE_HOOK				1
+#define configUSE_TICK_HOOK				1
+#define configTICK_RATE_HZ				1000
+#define configMAX_PRIORITIES				7
+#define configMINIMAL_STACK_SIZE			((unsigned short) PTHREAD_STACK_MIN)
+/* The tasks take four times PTHREAD_STACK_MIN, more than the default uint16_t holds */
+#define configSTACK_DEPTH_TYPE				uint32_t
+#define configTOTAL_HEAP_SIZE				((size_t) (256 * 1024))
+#define configMAX_TASK_NAME_LEN				16
+#define configUSE_16_BIT_TICKS				0
+#define configIDLE_SHOULD_YIELD				1
+#define configUSE_MUTEXES				1
+#define configUSE_RECURSIVE_MUTEXES			0
+#define configUSE_COUNTING_SEMAPHORES			0
+#define configUSE_TASK_NOTIFICATIONS			1
+#define configQUEUE_REGISTRY_SIZE			0
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configSUPPORT_STATIC_ALLOCATION			0
+#define configCHECK_FOR_STACK_OVERFLOW			0
+#define configUSE_MALLOC_FAILED_HOOK			1
+#define configUSE_TRACE_FACILITY			1
+#define configGENERATE_RUN_TIME_STATS			0
+#define configUSE_TIMERS				0
+#define configUSE_CO_ROUTINES				0
+
+#define INCLUDE_vTaskDelete				1
+#define INCLUDE_vTaskDelay				1
+#define INCLUDE_vTaskDelayUntil				1
+#define INCLUDE_vTaskSuspend				1
+#define INCLUDE_xTaskGetSchedulerState			1
+#define INCLUDE_xTaskGetCurrentTaskHandle		1
+
+void vAssertCalled(const char *file, unsigned long line);
+#define configASSERT(x)					if ( !(x) ) vAssertCalled(__FILE__, __LINE__)
+
+/* Run-time statistics, see rtos_stats.h */
+#include "rtos_stats_trace.h"
+
+#endif /* FREERTOS_CONFIG_H */
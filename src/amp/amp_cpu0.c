@@ -0,0 +1,128 @@
+/*
+ * CPU0 end of the AMP service link
+ *
+ * Starts CPU1 and then hands it log messages, text and dump requests instead
+ * of calling printf(). Queueing a message is a 64 byte copy into OCM, a few
+ * hundred cycles, where formatting and sending it at 115200 baud holds CPU0 up
+ * for close to 100us a line. Each queue has one producer, so everything here
+ * has to be called from the same context - from the main loop, say, with
+ * interrupt handlers leaving their reporting to deferred work (deferred.h).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xil_mmu.h"
+#include "xil_cache.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "amp.h"
+
+/* How long to wait for CPU1 to come up, in global timer ticks */
+#define AMP_START_TIMEOUT		(COUNTS_PER_SECOND / 10)
+
+static struct amp_producer to_cpu1;
+static struct amp_consumer to_cpu0;
+
+int amp_cpu0_start(uint32_t xadc_period_ms)
+{
+	struct amp_shared *shared = (struct amp_shared *) AMP_SHARED_BASE;
+	uint32_t start = 0;
+
+	/* CPU1 does the same before it touches anything in here */
+	Xil_SetTlbAttributes(OCM_HIGH_SECTION, NORM_NONCACHE);
+
+	shared->cpu1_state = AMP_CPU1_OFF;
+	shared->cpu1_loops = 0;
+	shared->xadc_period_ms = xadc_period_ms;
+	amp_queue_init(&shared->to_cpu1);
+	amp_queue_init(&shared->to_cpu0);
+	amp_producer_attach(&to_cpu1, &shared->to_cpu1);
+	amp_consumer_attach(&to_cpu0, &shared->to_cpu0);
+	__sync_synchronize();
+	shared->magic = AMP_MAGIC;
+
+	/* Release CPU1 from the BootROM, which jumps to whatever is at the release address */
+	Xil_Out32(AMP_CPU1_RELEASE_ADDR, AMP_CPU1_ENTRY);
+	__asm__ __volatile__ ("dsb\n\tsev" ::: "memory");
+
+	start = gtimer_read_lo();
+	while ( shared->cpu1_state != AMP_CPU1_READY ) {
+		if ( ( gtimer_read_lo() - start ) > AMP_START_TIMEOUT ) {
+			fprintf(stderr, "CPU1 did not start from 0x%08x\n", (unsigned int) AMP_CPU1_ENTRY);
+			return XST_FAILURE;
+		}
+	}
+	return XST_SUCCESS;
+}
+
+int amp_log_args(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4,
+		uint32_t a5, ...)
+{
+	struct amp_msg msg;
+	struct amp_log *log = (struct amp_log *) msg.data;
+
+	msg.type = AMP_MSG_LOG;
+	msg.timestamp = gtimer_read_lo();
+	log->fmt = fmt;
+	log->args[0] = a0;
+	log->args[1] = a1;
+	log->args[2] = a2;
+	log->args[3] = a3;
+	log->args[4] = a4;
+	log->args[5] = a5;
+	return amp_queue_put(&to_cpu1, &msg);
+}
+
+/* Copied, so unlike a log format it can come from a buffer that is about to change */
+int amp_text(const char *text)
+{
+	struct amp_msg msg;
+
+	msg.type = AMP_MSG_TEXT;
+	msg.timestamp = gtimer_read_lo();
+	strncpy((char *) msg.data, text, sizeof(msg.data) - 1);
+	msg.data[sizeof(msg.data) - 1] = '\0';
+	return amp_queue_put(&to_cpu1, &msg);
+}
+
+int amp_dump(uint32_t addr, uint32_t words)
+{
+	struct amp_msg msg;
+	struct amp_dump *dump = (struct amp_dump *) msg.data;
+
+	/* CPU1 reads from memory, so anything only in CPU0's cache has to get there first */
+	Xil_DCacheFlushRange((INTPTR) addr, words * 4);
+
+	msg.type = AMP_MSG_DUMP;
+	msg.timestamp = gtimer_read_lo();
+	dump->addr = addr;
+	dump->words = words;
+	return amp_queue_put(&to_cpu1, &msg);
+}
+
+/* Returns 1 and fills in xadc if a new sample has come in from CPU1 */
+int amp_get_xadc(struct amp_xadc *xadc)
+{
+	struct amp_msg msg;
+	int got = 0;
+
+	/* Only the latest sample matters */
+	while ( amp_queue_get(&to_cpu0, &msg) ) {
+		if ( msg.type == AMP_MSG_XADC ) {
+			memcpy(xadc, msg.data, sizeof(*xadc));
+			got = 1;
+		}
+	}
+	return got;
+}
+
+uint32_t amp_dropped(void)
+{
+	return to_cpu1.dropped;
+}
@@ -0,0 +1,171 @@
+/*
+ * CPU1 service loop for the AMP examples
+ *
+ * Built as its own standalone application for ps7_cortexa9_1, with USE_AMP=1
+ * in the BSP and linked at AMP_CPU1_ENTRY, and started by amp_cpu0_start() on
+ * CPU0. From then on it is the only one using the UART. It formats and prints
+ * whatever CPU0 queues, and samples the XADC and passes the raw readings back.
+ * Floating point is fine in here, nothing on this core is time critical.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xil_mmu.h"
+#include "xadcps.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "amp.h"
+
+#define XADC_DEVICE_ID			XPAR_XADCPS_0_DEVICE_ID
+
+/* Every so many samples the readings are printed here as well */
+#define XADC_PRINT_EVERY		10
+
+/* Missing prototypes from the XADC driver API, as in xadc_summary.c */
+void XAdcPs_SetSequencerMode(XAdcPs *, uint8_t);
+void XAdcPs_SetAlarmEnables(XAdcPs *, uint16_t);
+int XAdcPs_SetSeqChEnables(XAdcPs *, uint32_t);
+
+static XAdcPs xadc;
+
+static const uint8_t xadc_channels[AMP_XADC_CHANNELS] = {
+	XADCPS_CH_TEMP,
+	XADCPS_CH_VCCINT,
+	XADCPS_CH_VCCAUX,
+	XADCPS_CH_VBRAM,
+	XADCPS_CH_VCCPINT,
+	XADCPS_CH_VCCPAUX,
+	XADCPS_CH_VCCPDRO,
+};
+
+static int setup_xadc(void)
+{
+	XAdcPs_Config *config = XAdcPs_LookupConfig(XADC_DEVICE_ID);
+
+	if ( ( config == NULL ) || ( XAdcPs_CfgInitialize(&xadc, config, config->BaseAddress) != XST_SUCCESS ) ) {
+		return XST_FAILURE;
+	}
+	/* Let the sequencer convert everything in turn, and just pick up the latest results */
+	XAdcPs_SetSequencerMode(&xadc, XADCPS_SEQ_MODE_SAFE);
+	XAdcPs_SetAlarmEnables(&xadc, 0);
+	XAdcPs_SetSeqChEnables(&xadc, XADCPS_SEQ_CH_TEMP | XADCPS_SEQ_CH_VCCINT | XADCPS_SEQ_CH_VCCAUX |
+			XADCPS_SEQ_CH_VBRAM | XADCPS_SEQ_CH_VCCPINT | XADCPS_SEQ_CH_VCCPAUX |
+			XADCPS_SEQ_CH_VCCPDRO);
+	XAdcPs_SetSequencerMode(&xadc, XADCPS_SEQ_MODE_CONTINPASS);
+	return XST_SUCCESS;
+}
+
+static void sample_xadc(struct amp_producer *to_cpu0, uint32_t sample)
+{
+	struct amp_msg msg;
+	struct amp_xadc *reading = (struct amp_xadc *) msg.data;
+	uint32_t i = 0;
+
+	msg.type = AMP_MSG_XADC;
+	msg.timestamp = gtimer_read_lo();
+	for (i = 0; i < AMP_XADC_CHANNELS; i++) {
+		reading->raw[i] = XAdcPs_GetAdcData(&xadc, xadc_channels[i]);
+	}
+	reading->sample = sample;
+	/* CPU0 not keeping up just means it misses a reading */
+	amp_queue_put(to_cpu0, &msg);
+
+	if ( ( sample % XADC_PRINT_EVERY ) == 0 ) {
+		printf("[cpu1] %-12s%.2fC %-10s%.3fV %-10s%.3fV\n", "Temperature",
+				XAdcPs_RawToTemperature(reading->raw[AMP_XADC_TEMP]), "VCCINT",
+				XAdcPs_RawToVoltage(reading->raw[AMP_XADC_VCCINT]), "VCCPINT",
+				XAdcPs_RawToVoltage(reading->raw[AMP_XADC_VCCPINT]));
+	}
+	return;
+}
+
+static void print_dump(const struct amp_dump *dump)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < dump->words; i++) {
+		if ( ( i % 4 ) == 0 ) {
+			printf("%s0x%08"PRIx32":", ( i == 0 ) ? "" : "\n", dump->addr + (i * 4));
+		}
+		printf(" %08"PRIx32, *(volatile uint32_t *) (dump->addr + (i * 4)));
+	}
+	printf("\n");
+	return;
+}
+
+static void handle(const struct amp_msg *msg)
+{
+	const struct amp_log *log = (const struct amp_log *) msg->data;
+
+	switch ( msg->type ) {
+	case AMP_MSG_LOG:
+		printf(log->fmt, log->args[0], log->args[1], log->args[2], log->args[3], log->args[4],
+				log->args[5]);
+		break;
+	case AMP_MSG_TEXT:
+		printf("%s", (const char *) msg->data);
+		break;
+	case AMP_MSG_DUMP:
+		print_dump((const struct amp_dump *) msg->data);
+		break;
+	default:
+		printf("[cpu1] Unknown message type %"PRIu32"\n", msg->type);
+		break;
+	}
+	return;
+}
+
+int main(int args, char *argv[])
+{
+	struct amp_shared *shared = (struct amp_shared *) AMP_SHARED_BASE;
+	struct amp_consumer to_cpu1;
+	struct amp_producer to_cpu0;
+	struct amp_msg msg;
+	uint32_t xadc_period = 0;
+	uint32_t last_sample = 0;
+	uint32_t samples = 0;
+	uint32_t dropped = 0;
+
+	init_platform();
+	Xil_SetTlbAttributes(OCM_HIGH_SECTION, NORM_NONCACHE);
+
+	if ( shared->magic != AMP_MAGIC ) {
+		printf("[cpu1] No AMP block at 0x%08x\n", (unsigned int) AMP_SHARED_BASE);
+		return XST_FAILURE;
+	}
+	amp_consumer_attach(&to_cpu1, &shared->to_cpu1);
+	amp_producer_attach(&to_cpu0, &shared->to_cpu0);
+	xadc_period = (COUNTS_PER_SECOND / 1000) * shared->xadc_period_ms;
+	if ( setup_xadc() != XST_SUCCESS ) {
+		printf("[cpu1] Could not initialize XADC, no readings will be sent\n");
+		xadc_period = 0;
+	}
+
+	__sync_synchronize();
+	shared->cpu1_state = AMP_CPU1_READY;
+	last_sample = gtimer_read_lo();
+
+	for (;;) {
+		shared->cpu1_loops++;
+		while ( amp_queue_get(&to_cpu1, &msg) ) {
+			handle(&msg);
+		}
+		if ( shared->to_cpu1.dropped != dropped ) {
+			dropped = shared->to_cpu1.dropped;
+			printf("[cpu1] CPU0 has dropped %"PRIu32" messages\n", dropped);
+		}
+		if ( ( xadc_period != 0 ) && ( ( gtimer_read_lo() - last_sample ) >= xadc_period ) ) {
+			last_sample += xadc_period;
+			sample_xadc(&to_cpu0, ++samples);
+		}
+	}
+
+	cleanup_platform();
+	return XST_SUCCESS;
+}
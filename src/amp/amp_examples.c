@@ -0,0 +1,117 @@
+/*
+ * Offloading console output and XADC monitoring to CPU1
+ *
+ * CPU0 application to go with amp_cpu1.c. It times a few lines of ordinary
+ * printf() output, starts CPU1, and from then on does all of its output through
+ * the AMP queues, timing those too. Meanwhile CPU1 samples the XADC and sends
+ * the readings back, and CPU0 turns the die temperature into millidegrees with
+ * integer arithmetic only, the way an interrupt handler would have to.
+ *
+ * Load both ELFs (this one for ps7_cortexa9_0, amp_cpu1.c for ps7_cortexa9_1)
+ * before running this one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xtime_l.h"
+
+#include "pmu.h"
+#include "amp.h"
+
+#define XADC_PERIOD_MS			100
+#define LOG_PERIOD_MS			250
+#define RUN_SECONDS			10
+
+/* Lines timed through each path */
+#define TIMED_LINES			8
+
+#define ASCII_ESC			27
+
+/* XADC temperature transfer function, raw * 503.975 / 65536 - 273.15, in millidegrees */
+static int32_t xadc_raw_to_mdeg(uint16_t raw)
+{
+	return (int32_t) (((uint32_t) raw * 503975) >> 16) - 273150;
+}
+
+int main(int args, char *argv[])
+{
+	struct amp_xadc xadc;
+	uint32_t printf_max = 0;
+	uint32_t printf_total = 0;
+	uint32_t amp_max = 0;
+	uint32_t amp_total = 0;
+	uint32_t amp_count = 0;
+	uint32_t cycles = 0;
+	uint32_t lines = 0;
+	uint32_t readings = 0;
+	int32_t mdeg = 0;
+	XTime start = 0;
+	XTime last_log = 0;
+	XTime now = 0;
+
+	init_platform();
+	pmu_cycles_enable();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("AMP Console and XADC Offload\n");
+	printf("----------------------------\n");
+
+	for (lines = 0; lines < TIMED_LINES; lines++) {
+		cycles = pmu_cycles();
+		printf("printf from CPU0, line %"PRIu32"\n", lines);
+		cycles = pmu_cycles() - cycles;
+		printf_total += cycles;
+		if ( cycles > printf_max ) {
+			printf_max = cycles;
+		}
+	}
+
+	/* From here on CPU1 owns the UART */
+	if ( amp_cpu0_start(XADC_PERIOD_MS) != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+	AMP_LOG("CPU1 started, sampling the XADC every %u ms\n", XADC_PERIOD_MS);
+
+	XTime_GetTime(&start);
+	last_log = start;
+	do {
+		if ( amp_get_xadc(&xadc) ) {
+			readings++;
+			mdeg = xadc_raw_to_mdeg(xadc.raw[AMP_XADC_TEMP]);
+		}
+
+		XTime_GetTime(&now);
+		if ( ( now - last_log ) < (XTime) (COUNTS_PER_SECOND / 1000) * LOG_PERIOD_MS ) {
+			continue;
+		}
+		last_log = now;
+
+		cycles = pmu_cycles();
+		AMP_LOG("[cpu0] %u readings, die temperature %d.%03u C\n", readings, mdeg / 1000,
+				abs(mdeg % 1000));
+		cycles = pmu_cycles() - cycles;
+		amp_total += cycles;
+		amp_count++;
+		if ( cycles > amp_max ) {
+			amp_max = cycles;
+		}
+	} while ( ( now - start ) < (XTime) RUN_SECONDS * COUNTS_PER_SECOND );
+
+	AMP_LOG("\n%-20s%-14s%-14s\n", (uint32_t) "", (uint32_t) "Mean cycles", (uint32_t) "Max cycles");
+	AMP_LOG("%-20s%-14u%-14u\n", (uint32_t) "printf", printf_total / TIMED_LINES, printf_max);
+	AMP_LOG("%-20s%-14u%-14u\n", (uint32_t) "AMP_LOG", ( amp_count == 0 ) ? 0 : amp_total / amp_count,
+			amp_max);
+	AMP_LOG("Dropped %u messages\n\n", amp_dropped());
+
+	amp_text("Start of the shared AMP block\n");
+	amp_dump(AMP_SHARED_BASE, 16);
+
+	cleanup_platform();
+	return XST_SUCCESS;
+}
@@ -0,0 +1,88 @@
+/*
+ * Shared memory message queue between the two cores
+ *
+ * Lamport's single producer, single consumer ring. The producer fills in a
+ * slot and then publishes it by moving head, the consumer copies a slot out and
+ * then releases it by moving tail. Each index has one writer, so there are no
+ * atomic read-modify-writes, only ordering. __sync_synchronize() is a DMB on
+ * the Cortex-A9, which orders the slot accesses against the index update as
+ * seen from the other core, and it does the same job between host threads.
+ *
+ * None of this makes the data coherent if either side caches it. On the board
+ * the whole queue sits in OCM mapped non-cacheable on both cores (amp.h).
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "amp_queue.h"
+
+void amp_queue_init(struct amp_queue *q)
+{
+	q->head = 0;
+	q->dropped = 0;
+	q->tail = 0;
+	__sync_synchronize();
+	return;
+}
+
+void amp_producer_attach(struct amp_producer *p, struct amp_queue *q)
+{
+	p->q = q;
+	p->head = q->head;
+	p->tail_seen = q->tail;
+	p->put = 0;
+	p->dropped = 0;
+	return;
+}
+
+void amp_consumer_attach(struct amp_consumer *c, struct amp_queue *q)
+{
+	c->q = q;
+	c->tail = q->tail;
+	c->head_seen = q->head;
+	c->got = 0;
+	return;
+}
+
+int amp_queue_put(struct amp_producer *p, const struct amp_msg *msg)
+{
+	struct amp_queue *q = p->q;
+
+	if ( ( p->head - p->tail_seen ) >= AMP_QUEUE_LEN ) {
+		p->tail_seen = q->tail;
+		if ( ( p->head - p->tail_seen ) >= AMP_QUEUE_LEN ) {
+			p->dropped++;
+			q->dropped = p->dropped;
+			return -1;
+		}
+		/* The consumer's copy out happens before its tail update */
+		__sync_synchronize();
+	}
+	memcpy(&q->slots[p->head & (AMP_QUEUE_LEN - 1)], msg, sizeof(*msg));
+	__sync_synchronize();
+	p->head++;
+	q->head = p->head;
+	p->put++;
+	return 0;
+}
+
+int amp_queue_get(struct amp_consumer *c, struct amp_msg *msg)
+{
+	struct amp_queue *q = c->q;
+
+	if ( c->tail == c->head_seen ) {
+		c->head_seen = q->head;
+		if ( c->tail == c->head_seen ) {
+			return 0;
+		}
+		/* The producer's slot write happens before its head update */
+		__sync_synchronize();
+	}
+	memcpy(msg, &q->slots[c->tail & (AMP_QUEUE_LEN - 1)], sizeof(*msg));
+	__sync_synchronize();
+	c->tail++;
+	q->tail = c->tail;
+	c->got++;
+	return 1;
+}
@@ -0,0 +1,80 @@
+/*
+ * Always-on flight recorder - ring management and extraction
+ *
+ * Logging itself is the inline flight_rec_log() in flight_rec.h. Everything in
+ * here runs once at boot, so none of it has to be fast.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "flight_rec.h"
+
+struct flight_rec *flight_rec_active = NULL;
+volatile uint32_t flight_rec_seq = 0;
+
+int flight_rec_valid(const struct flight_rec *rec)
+{
+	return ( rec->magic == FLIGHT_REC_MAGIC ) && ( rec->version == FLIGHT_REC_VERSION ) &&
+			( rec->len == FLIGHT_REC_LEN );
+}
+
+void flight_rec_init(struct flight_rec *rec, uint32_t timer_hz)
+{
+	uint32_t boot_count = 0;
+	uint32_t i = 0;
+
+	flight_rec_active = NULL;
+	if ( flight_rec_valid(rec) ) {
+		boot_count = rec->boot_count + 1;
+	}
+	rec->magic = FLIGHT_REC_MAGIC;
+	rec->version = FLIGHT_REC_VERSION;
+	rec->len = FLIGHT_REC_LEN;
+	rec->timer_hz = timer_hz;
+	rec->boot_count = boot_count;
+	for (i = 0; i < FLIGHT_REC_LEN; i++) {
+		rec->entries[i].seq = 0;
+	}
+	flight_rec_seq = 0;
+	flight_rec_active = rec;
+
+	flight_rec_log(FLIGHT_REC_BOOT, boot_count);
+	return;
+}
+
+void flight_rec_dump(const struct flight_rec *rec)
+{
+	const struct flight_rec_entry *entry = NULL;
+	uint32_t newest = 0;
+	uint32_t seq = 0;
+	uint32_t i = 0;
+
+	if ( !flight_rec_valid(rec) ) {
+		printf("flight_rec invalid\n");
+		return;
+	}
+	/* Slots are written in sequence order, so the newest is the largest sequence number */
+	for (i = 0; i < FLIGHT_REC_LEN; i++) {
+		if ( rec->entries[i].seq > newest ) {
+			newest = rec->entries[i].seq;
+		}
+	}
+
+	printf("flight_rec begin %"PRIu32" %"PRIu32" %"PRIu32"\n",
+			rec->len, rec->timer_hz, rec->boot_count);
+	seq = ( newest > FLIGHT_REC_LEN ) ? newest - FLIGHT_REC_LEN + 1 : 1;
+	for (; ( newest != 0 ) && ( seq <= newest ); seq++) {
+		entry = &rec->entries[seq & (FLIGHT_REC_LEN - 1)];
+		/* Overwritten by a later entry, or torn by the reset */
+		if ( entry->seq != seq ) {
+			continue;
+		}
+		printf("flight_rec %08"PRIx32" %08"PRIx32" %08"PRIx32" %08"PRIx32"\n",
+				entry->seq, entry->timestamp, entry->type, entry->data);
+	}
+	printf("flight_rec end\n");
+	return;
+}
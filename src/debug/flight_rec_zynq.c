@@ -0,0 +1,53 @@
+/*
+ * Flight recorder placement and boot-time extraction on the Zynq
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xil_io.h"
+#include "xil_mmu.h"
+#include "xscugic.h"
+#include "xscuwdt.h"
+#include "xtime_l.h"
+
+#include "ocm_map.h"
+#include "flight_rec.h"
+#include "flight_rec_zynq.h"
+
+/* Highest priority pending interrupt, which is the one the GIC handler is about to take */
+#define GIC_CPU_BASE			XPAR_SCUGIC_0_CPU_BASEADDR
+#define GIC_CPU_HPPIR			(GIC_CPU_BASE + 0x00000018)
+#define GIC_INTR_ID_MASK		0x000003FF
+
+int flight_rec_zynq_boot(XScuWdt *wdt)
+{
+	struct flight_rec *rec = (struct flight_rec *) OCM_FLIGHT_REC_BASE;
+	int dumped = 0;
+
+	/* Everything in the section is OCM, which nothing else here runs from */
+	Xil_SetTlbAttributes(OCM_HIGH_SECTION, NORM_NONCACHE);
+
+	if ( XScuWdt_ReadReg(wdt->Config.BaseAddr, XSCUWDT_RST_STS_OFFSET) &
+			XSCUWDT_RST_STS_RESET_FLAG_MASK ) {
+		printf("Watchdog reset, flight recorder from the previous run follows\n");
+		flight_rec_dump(rec);
+		dumped = 1;
+		/* Write one to clear, so the next boot knows whether it happened again */
+		XScuWdt_WriteReg(wdt->Config.BaseAddr, XSCUWDT_RST_STS_OFFSET,
+				XSCUWDT_RST_STS_RESET_FLAG_MASK);
+	}
+	flight_rec_init(rec, COUNTS_PER_SECOND);
+	return dumped;
+}
+
+void flight_rec_zynq_irq_handler(void *gic)
+{
+	uint32_t id = Xil_In32(GIC_CPU_HPPIR) & GIC_INTR_ID_MASK;
+
+	flight_rec_log(FLIGHT_REC_IRQ_ENTRY, id);
+	XScuGic_InterruptHandler((XScuGic *) gic);
+	flight_rec_log(FLIGHT_REC_IRQ_EXIT, id);
+	return;
+}
@@ -0,0 +1,389 @@
+/*
+ * Memory latency and bandwidth probes
+ *
+ * Latency is a pointer chase. Every cache line of the buffer holds a pointer
+ * to another line, in a single random cycle (Sattolo's shuffle), and the next
+ * load cannot start until the last one is done. The lines are visited in
+ * random order, so the time per load is the full latency of whatever level the
+ * buffer fits in.
+ *
+ * Bandwidth is a plain loop of native word or 128-bit accesses over the buffer,
+ * unrolled so that loop overhead is small next to the accesses. The wide
+ * variants need the buffers 16 byte aligned. Copies count the bytes both read
+ * and written, as STREAM does.
+ *
+ * The A9 only gets the NEON variants when built with -mfpu=neon. ARMv7 has no
+ * non-temporal stores. The nearest thing there is a non-cacheable mapping,
+ * which is one of the policies memprobe_examples.c runs through.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MEMPROBE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MEMPROBE_SSE2
+#endif
+
+#include "memprobe.h"
+
+static volatile uintptr_t memprobe_sink;
+/* Zero, but the compiler cannot know that */
+static volatile uint32_t memprobe_zero = 0;
+
+static const char *memprobe_kind_names[MEMPROBE_NUM_KINDS] = {
+	"read",
+	"write",
+	"copy",
+	"read wide",
+	"write wide",
+	"copy wide",
+	"write nt",
+};
+
+const char *memprobe_kind_name(enum memprobe_kind kind)
+{
+	return ( kind < MEMPROBE_NUM_KINDS ) ? memprobe_kind_names[kind] : "unknown";
+}
+
+int memprobe_kind_supported(enum memprobe_kind kind)
+{
+	switch ( kind ) {
+	case MEMPROBE_READ_WIDE:
+	case MEMPROBE_WRITE_WIDE:
+	case MEMPROBE_COPY_WIDE:
+#if defined(MEMPROBE_NEON) || defined(MEMPROBE_SSE2)
+		return 1;
+#else
+		return 0;
+#endif
+	case MEMPROBE_WRITE_NT:
+#if defined(MEMPROBE_SSE2)
+		return 1;
+#else
+		return 0;
+#endif
+	default:
+		return kind < MEMPROBE_NUM_KINDS;
+	}
+}
+
+static uint32_t memprobe_random(uint32_t *state)
+{
+	/* xorshift32 */
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void memprobe_build_chain(void *buf, size_t bytes, uint32_t line)
+{
+	uint8_t *base = buf;
+	size_t lines = bytes / line;
+	size_t i = 0;
+	size_t j = 0;
+	uintptr_t tmp = 0;
+	uint32_t state = 2463534242U;
+
+	/* Line numbers first, shuffled in place into one cycle, then turned into addresses */
+	for (i = 0; i < lines; i++) {
+		*(uintptr_t *) (base + (i * line)) = i;
+	}
+	for (i = lines - 1; i > 0; i--) {
+		j = memprobe_random(&state) % i;
+		tmp = *(uintptr_t *) (base + (i * line));
+		*(uintptr_t *) (base + (i * line)) = *(uintptr_t *) (base + (j * line));
+		*(uintptr_t *) (base + (j * line)) = tmp;
+	}
+	for (i = 0; i < lines; i++) {
+		tmp = *(uintptr_t *) (base + (i * line));
+		*(uintptr_t *) (base + (i * line)) = (uintptr_t) (base + (tmp * line));
+	}
+	return;
+}
+
+static void *memprobe_chase(void *start, uint32_t loads)
+{
+	void **p = start;
+	uint32_t i = 0;
+
+	for (i = 0; i < loads / 8; i++) {
+		p = *p;
+		p = *p;
+		p = *p;
+		p = *p;
+		p = *p;
+		p = *p;
+		p = *p;
+		p = *p;
+	}
+	return p;
+}
+
+double memprobe_latency(const struct memprobe_clock *clock, void *buf, size_t bytes, uint32_t line,
+		uint32_t loads)
+{
+	uint64_t start = 0;
+	uint64_t stop = 0;
+	void *p = buf;
+
+	if ( ( line < sizeof(void *) ) || ( bytes < 2 * line ) || ( loads < 8 ) ) {
+		return 0;
+	}
+	memprobe_build_chain(buf, bytes, line);
+
+	/* Once round first, so the buffer is wherever it is going to be */
+	p = memprobe_chase(p, (uint32_t) (bytes / line));
+
+	start = clock->now();
+	p = memprobe_chase(p, loads);
+	stop = clock->now();
+
+	memprobe_sink = (uintptr_t) p;
+	return (double) (stop - start) * 1e9 / clock->hz / ((loads / 8) * 8);
+}
+
+double memprobe_latency_ro(const struct memprobe_clock *clock, const volatile void *buf, size_t bytes,
+		uint32_t loads)
+{
+	const volatile uint32_t *words = buf;
+	uint32_t mask = (uint32_t) (bytes / sizeof(uint32_t)) - 1;
+	uint32_t zero = memprobe_zero;
+	uint32_t offset = 0;
+	uint32_t value = 0;
+	uint64_t start = 0;
+	uint64_t stop = 0;
+	uint32_t i = 0;
+
+	/* Power of two windows only, so that the mask works */
+	if ( ( bytes < sizeof(uint32_t) ) || ( ( mask & (mask + 1) ) != 0 ) || ( loads == 0 ) ) {
+		return 0;
+	}
+	start = clock->now();
+	for (i = 0; i < loads; i++) {
+		value = words[offset];
+		offset = (offset + 1 + (value & zero)) & mask;
+	}
+	stop = clock->now();
+
+	memprobe_sink = offset;
+	return (double) (stop - start) * 1e9 / clock->hz / loads;
+}
+
+static void memprobe_read(const void *src, size_t bytes)
+{
+	const uintptr_t *p = src;
+	size_t n = bytes / sizeof(*p);
+	uintptr_t sum = 0;
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		sum += p[i] ^ p[i + 1] ^ p[i + 2] ^ p[i + 3];
+	}
+	memprobe_sink = sum;
+	return;
+}
+
+static void memprobe_write(void *dst, size_t bytes)
+{
+	uintptr_t *p = dst;
+	size_t n = bytes / sizeof(*p);
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		p[i] = i;
+		p[i + 1] = i;
+		p[i + 2] = i;
+		p[i + 3] = i;
+	}
+	return;
+}
+
+static void memprobe_copy(void *dst, const void *src, size_t bytes)
+{
+	uintptr_t *d = dst;
+	const uintptr_t *s = src;
+	size_t n = bytes / sizeof(*d);
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		d[i] = s[i];
+		d[i + 1] = s[i + 1];
+		d[i + 2] = s[i + 2];
+		d[i + 3] = s[i + 3];
+	}
+	return;
+}
+
+#if defined(MEMPROBE_NEON)
+
+static void memprobe_read_wide(const void *src, size_t bytes)
+{
+	const uint32_t *p = src;
+	uint32x4_t sum = vdupq_n_u32(0);
+	size_t i = 0;
+
+	for (i = 0; i + 16 <= bytes / sizeof(*p); i += 16) {
+		sum = veorq_u32(sum, vld1q_u32(p + i));
+		sum = veorq_u32(sum, vld1q_u32(p + i + 4));
+		sum = veorq_u32(sum, vld1q_u32(p + i + 8));
+		sum = veorq_u32(sum, vld1q_u32(p + i + 12));
+	}
+	memprobe_sink = vgetq_lane_u32(sum, 0);
+	return;
+}
+
+static void memprobe_write_wide(void *dst, size_t bytes)
+{
+	uint32_t *p = dst;
+	uint32x4_t value = vdupq_n_u32(0x5A5A5A5A);
+	size_t i = 0;
+
+	for (i = 0; i + 16 <= bytes / sizeof(*p); i += 16) {
+		vst1q_u32(p + i, value);
+		vst1q_u32(p + i + 4, value);
+		vst1q_u32(p + i + 8, value);
+		vst1q_u32(p + i + 12, value);
+	}
+	return;
+}
+
+static void memprobe_copy_wide(void *dst, const void *src, size_t bytes)
+{
+	uint32_t *d = dst;
+	const uint32_t *s = src;
+	size_t i = 0;
+
+	for (i = 0; i + 16 <= bytes / sizeof(*d); i += 16) {
+		vst1q_u32(d + i, vld1q_u32(s + i));
+		vst1q_u32(d + i + 4, vld1q_u32(s + i + 4));
+		vst1q_u32(d + i + 8, vld1q_u32(s + i + 8));
+		vst1q_u32(d + i + 12, vld1q_u32(s + i + 12));
+	}
+	return;
+}
+
+#elif defined(MEMPROBE_SSE2)
+
+static void memprobe_read_wide(const void *src, size_t bytes)
+{
+	const __m128i *p = src;
+	__m128i sum = _mm_setzero_si128();
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= bytes / sizeof(*p); i += 4) {
+		sum = _mm_xor_si128(sum, _mm_load_si128(p + i));
+		sum = _mm_xor_si128(sum, _mm_load_si128(p + i + 1));
+		sum = _mm_xor_si128(sum, _mm_load_si128(p + i + 2));
+		sum = _mm_xor_si128(sum, _mm_load_si128(p + i + 3));
+	}
+	memprobe_sink = (uintptr_t) _mm_cvtsi128_si32(sum);
+	return;
+}
+
+static void memprobe_write_wide(void *dst, size_t bytes)
+{
+	__m128i *p = dst;
+	__m128i value = _mm_set1_epi32(0x5A5A5A5A);
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= bytes / sizeof(*p); i += 4) {
+		_mm_store_si128(p + i, value);
+		_mm_store_si128(p + i + 1, value);
+		_mm_store_si128(p + i + 2, value);
+		_mm_store_si128(p + i + 3, value);
+	}
+	return;
+}
+
+static void memprobe_copy_wide(void *dst, const void *src, size_t bytes)
+{
+	__m128i *d = dst;
+	const __m128i *s = src;
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= bytes / sizeof(*d); i += 4) {
+		_mm_store_si128(d + i, _mm_load_si128(s + i));
+		_mm_store_si128(d + i + 1, _mm_load_si128(s + i + 1));
+		_mm_store_si128(d + i + 2, _mm_load_si128(s + i + 2));
+		_mm_store_si128(d + i + 3, _mm_load_si128(s + i + 3));
+	}
+	return;
+}
+
+static void memprobe_write_nt(void *dst, size_t bytes)
+{
+	__m128i *p = dst;
+	__m128i value = _mm_set1_epi32(0x5A5A5A5A);
+	size_t i = 0;
+
+	for (i = 0; i + 4 <= bytes / sizeof(*p); i += 4) {
+		_mm_stream_si128(p + i, value);
+		_mm_stream_si128(p + i + 1, value);
+		_mm_stream_si128(p + i + 2, value);
+		_mm_stream_si128(p + i + 3, value);
+	}
+	/* Streaming stores are weakly ordered, they are only done once fenced */
+	_mm_sfence();
+	return;
+}
+
+#endif
+
+double memprobe_bandwidth(const struct memprobe_clock *clock, enum memprobe_kind kind, void *dst,
+		const void *src, size_t bytes, uint32_t passes)
+{
+	uint64_t start = 0;
+	uint64_t stop = 0;
+	double traffic = (double) bytes * passes;
+	uint32_t i = 0;
+
+	if ( !memprobe_kind_supported(kind) || ( passes == 0 ) ) {
+		return 0;
+	}
+	start = clock->now();
+	for (i = 0; i < passes; i++) {
+		switch ( kind ) {
+		case MEMPROBE_READ:
+			memprobe_read(src, bytes);
+			break;
+		case MEMPROBE_WRITE:
+			memprobe_write(dst, bytes);
+			break;
+		case MEMPROBE_COPY:
+			memprobe_copy(dst, src, bytes);
+			break;
+#if defined(MEMPROBE_NEON) || defined(MEMPROBE_SSE2)
+		case MEMPROBE_READ_WIDE:
+			memprobe_read_wide(src, bytes);
+			break;
+		case MEMPROBE_WRITE_WIDE:
+			memprobe_write_wide(dst, bytes);
+			break;
+		case MEMPROBE_COPY_WIDE:
+			memprobe_copy_wide(dst, src, bytes);
+			break;
+#endif
+#if defined(MEMPROBE_SSE2)
+		case MEMPROBE_WRITE_NT:
+			memprobe_write_nt(dst, bytes);
+			break;
+#endif
+		default:
+			break;
+		}
+	}
+	stop = clock->now();
+
+	if ( ( kind == MEMPROBE_COPY ) || ( kind == MEMPROBE_COPY_WIDE ) ) {
+		traffic *= 2;
+	}
+	if ( stop == start ) {
+		return 0;
+	}
+	return traffic / ((double) (stop - start) / clock->hz) / 1e6;
+}
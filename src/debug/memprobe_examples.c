@@ -0,0 +1,204 @@
+/*
+ * What touching OCM, DDR and the PL costs
+ *
+ * Runs the memprobe.h latency and bandwidth probes against on-chip memory, a
+ * DDR buffer and the register window of the PL peripheral at 0x43C10000, under
+ * each cache policy the MMU and the L2 controller (PL310) offer, and prints a
+ * table per region. The numbers are meant for deciding where DMA buffers, the
+ * logs and interrupt handler data should live.
+ *
+ * The policy is set per 1MB section with Xil_SetTlbAttributes(), so each
+ * region gets sections of its own: the DDR buffer is section aligned and a
+ * whole number of sections long, and the OCM region is in the low OCM
+ * (0x00010000 - 0x0002FFFF), which nothing runs from when the application is
+ * linked into DDR. The PL window is only ever read, and only as strongly
+ * ordered or device memory, since caching registers would be wrong. Everything
+ * is put back to write-back cacheable with the L2 on at the end.
+ *
+ * The A9 has no non-temporal stores. Writes to a non-cacheable mapping are the
+ * nearest thing, so that row of each table is the one to compare. The wide
+ * (NEON) rows need -mfpu=neon, otherwise they are left out.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xil_cache.h"
+#include "xil_mmu.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "memprobe.h"
+
+/* Cortex-A9 L1 and PL310 line size */
+#define LINE_SIZE			32
+
+#define SECTION_SIZE			0x00100000
+
+/* 192KB of low OCM starts at 0, keep clear of the first 64KB */
+#define OCM_PROBE_BASE			0x00010000
+#define OCM_PROBE_SIZE			0x00020000
+
+/* Eight times the 512KB L2 */
+#define DDR_PROBE_SIZE			0x00400000
+
+/* slv_reg0 - slv_reg3 of the Taylor peripheral, which have no side effects on reads */
+#define PL_PROBE_BASE			0x43C10000
+#define PL_PROBE_SIZE			16
+
+#define LATENCY_LOADS			(1 << 18)
+#define PL_LOADS			(1 << 16)
+#define MIN_WORKING_SET			1024
+#define MAX_SIZES			13
+#define MAX_POLICIES			5
+
+#define ASCII_ESC			27
+
+struct policy {
+	const char *name;
+	uint32_t attributes;
+	int l2;
+};
+
+static const struct policy memory_policies[] = {
+	{"WB L1+L2", NORM_WB_CACHE, 1},
+	{"WB L1", NORM_WB_CACHE, 0},
+	{"WT", NORM_WT_CACHE, 1},
+	{"Non-cache", NORM_NONCACHE, 1},
+	{"Strong", STRONG_ORDERED, 1},
+};
+
+static const struct policy pl_policies[] = {
+	{"Strong", STRONG_ORDERED, 1},
+	{"Device", DEVICE_MEMORY, 1},
+};
+
+struct region {
+	const char *name;
+	uint8_t *base;
+	uint32_t size;
+	uint32_t passes;
+};
+
+static uint8_t ddr_buffer[DDR_PROBE_SIZE] __attribute__((aligned(SECTION_SIZE)));
+
+static double latency[MAX_POLICIES][MAX_SIZES];
+static double bandwidth[MAX_POLICIES][MEMPROBE_NUM_KINDS];
+
+static uint64_t probe_now(void)
+{
+	return gtimer_read();
+}
+
+static const struct memprobe_clock probe_clock = {probe_now, COUNTS_PER_SECOND};
+
+static void set_policy(uintptr_t base, uint32_t size, const struct policy *policy)
+{
+	uintptr_t section = base & ~(uintptr_t) (SECTION_SIZE - 1);
+
+	/* Nothing cached may be left behind for the new mapping to miss */
+	Xil_DCacheFlush();
+	for (; section < base + size; section += SECTION_SIZE) {
+		Xil_SetTlbAttributes(section, policy->attributes);
+	}
+	if ( policy->l2 ) {
+		Xil_L2CacheEnable();
+	} else {
+		Xil_L2CacheDisable();
+	}
+	return;
+}
+
+static void probe_region(const struct region *region)
+{
+	uint32_t half = region->size / 2;
+	uint32_t policy = 0;
+	uint32_t kind = 0;
+	uint32_t bytes = 0;
+	uint32_t size = 0;
+
+	for (policy = 0; policy < MAX_POLICIES; policy++) {
+		set_policy((uintptr_t) region->base, region->size, &memory_policies[policy]);
+		for (bytes = MIN_WORKING_SET, size = 0; bytes <= region->size; bytes *= 2, size++) {
+			latency[policy][size] = memprobe_latency(&probe_clock, region->base, bytes, LINE_SIZE,
+					LATENCY_LOADS);
+		}
+		for (kind = 0; kind < MEMPROBE_NUM_KINDS; kind++) {
+			bandwidth[policy][kind] = memprobe_bandwidth(&probe_clock, kind, region->base + half,
+					region->base, half, region->passes);
+		}
+	}
+
+	printf("\n%s, latency in ns\n", region->name);
+	printf("%-20s", "Working set");
+	for (policy = 0; policy < MAX_POLICIES; policy++) {
+		printf("%-12s", memory_policies[policy].name);
+	}
+	printf("\n");
+	for (bytes = MIN_WORKING_SET, size = 0; bytes <= region->size; bytes *= 2, size++) {
+		printf("%-20"PRIu32, bytes);
+		for (policy = 0; policy < MAX_POLICIES; policy++) {
+			printf("%-12.1f", latency[policy][size]);
+		}
+		printf("\n");
+	}
+
+	printf("\n%s, %"PRIu32" byte blocks, bandwidth in MB/s\n", region->name, half);
+	for (kind = 0; kind < MEMPROBE_NUM_KINDS; kind++) {
+		if ( !memprobe_kind_supported(kind) ) {
+			continue;
+		}
+		printf("%-20s", memprobe_kind_name(kind));
+		for (policy = 0; policy < MAX_POLICIES; policy++) {
+			printf("%-12.1f", bandwidth[policy][kind]);
+		}
+		printf("\n");
+	}
+	return;
+}
+
+static void probe_pl(void)
+{
+	uint32_t policy = 0;
+
+	printf("\nPL window at 0x%08X, %u bytes, read only\n", PL_PROBE_BASE, PL_PROBE_SIZE);
+	printf("%-20s%-20s%-20s\n", "Policy", "Latency (ns)", "Read (MB/s)");
+	for (policy = 0; policy < sizeof(pl_policies) / sizeof(pl_policies[0]); policy++) {
+		set_policy(PL_PROBE_BASE, PL_PROBE_SIZE, &pl_policies[policy]);
+		printf("%-20s%-20.1f%-20.1f\n", pl_policies[policy].name,
+				memprobe_latency_ro(&probe_clock, (const volatile void *) PL_PROBE_BASE,
+						PL_PROBE_SIZE, PL_LOADS),
+				memprobe_bandwidth(&probe_clock, MEMPROBE_READ, NULL, (const void *) PL_PROBE_BASE,
+						PL_PROBE_SIZE, PL_LOADS));
+	}
+	/* What the standalone BSP maps the PL as */
+	set_policy(PL_PROBE_BASE, PL_PROBE_SIZE, &pl_policies[0]);
+	return;
+}
+
+int main(int args, char *argv[])
+{
+	const struct region ocm = {"OCM", (uint8_t *) OCM_PROBE_BASE, OCM_PROBE_SIZE, 64};
+	const struct region ddr = {"DDR", ddr_buffer, DDR_PROBE_SIZE, 4};
+
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("Memory Latency and Bandwidth\n");
+	printf("----------------------------\n");
+	printf("%d byte lines, %d loads per latency point\n", LINE_SIZE, LATENCY_LOADS);
+
+	probe_region(&ocm);
+	probe_region(&ddr);
+	probe_pl();
+
+	set_policy(OCM_PROBE_BASE, OCM_PROBE_SIZE, &memory_policies[0]);
+	set_policy((uintptr_t) ddr_buffer, DDR_PROBE_SIZE, &memory_policies[0]);
+
+	cleanup_platform();
+	return XST_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/*
+ * Cortex-A9 PMU backend for pmu_scope.c
+ *
+ * The A9 has the cycle counter and six event counters, all 32 bits wide. The
+ * cycle counter wraps in about six seconds at 666 MHz and the event counters
+ * can too, so every read checks the overflow flags and counts the wraps.
+ * Counters are extended to 64 bits that way, as long as each one is read at
+ * least once per wrap - pmu_scope_end() does that for anything shorter than a
+ * few seconds. The flag is checked after the value and the value read again if
+ * it was set, so a wrap between the two reads is never counted twice or missed.
+ *
+ * irq_prof.c also uses the cycle counter and resets it on start up, so start
+ * that first if both are used.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "pmu.h"
+#include "pmu_a9.h"
+
+/* Cortex-A9 TRM event numbers for the generic events */
+static const uint32_t pmu_a9_events[PMU_NUM_EVENTS] = {
+	[PMU_INSTRUCTIONS] = 0x68,	/* Instructions out of the rename stage */
+	[PMU_BRANCHES] = 0x0C,		/* Software change of the PC */
+	[PMU_BRANCH_MISSES] = 0x10,
+	[PMU_L1D_ACCESS] = 0x04,
+	[PMU_L1D_REFILL] = 0x03,
+	[PMU_L1I_REFILL] = 0x01,
+	[PMU_DTLB_REFILL] = 0x05,
+	[PMU_ITLB_REFILL] = 0x02,
+	[PMU_STALL_FRONTEND] = 0x60,	/* Instruction side stalls */
+	[PMU_STALL_BACKEND] = 0x66,	/* Dispatch stalls */
+};
+
+static uint32_t pmu_a9_counters(void *ctx)
+{
+	return ((struct pmu_a9 *) ctx)->counters;
+}
+
+static int pmu_a9_supported(void *ctx, uint32_t event)
+{
+	return PMU_IS_RAW(event) || ( event < PMU_NUM_EVENTS );
+}
+
+static int pmu_a9_program(void *ctx, const uint32_t *events, uint32_t count)
+{
+	struct pmu_a9 *a9 = ctx;
+	uint32_t mask = (1 << a9->counters) - 1;
+	uint32_t i = 0;
+
+	if ( count > a9->counters ) {
+		return -1;
+	}
+	pmu_counters_disable(mask);
+	for (i = 0; i < count; i++) {
+		pmu_select(i);
+		pmu_set_event(PMU_IS_RAW(events[i]) ? PMU_RAW_EVENT(events[i]) : pmu_a9_events[events[i]]);
+	}
+	/* Event counters only, the cycle counter keeps running */
+	pmu_write_pmcr(pmu_read_pmcr() | PMU_PMCR_EVENT_RESET);
+	pmu_clear_overflow(mask);
+	for (i = 1; i <= PMU_A9_MAX_COUNTERS; i++) {
+		a9->wraps[i] = 0;
+	}
+	a9->programmed = count;
+	pmu_counters_enable((1 << count) - 1);
+	return 0;
+}
+
+static void pmu_a9_read(void *ctx, uint64_t *values)
+{
+	struct pmu_a9 *a9 = ctx;
+	uint32_t value = 0;
+	uint32_t i = 0;
+
+	value = pmu_cycles();
+	if ( pmu_read_overflow() & PMU_CNTEN_CYCLES ) {
+		pmu_clear_overflow(PMU_CNTEN_CYCLES);
+		a9->wraps[0]++;
+		value = pmu_cycles();
+	}
+	values[0] = ((uint64_t) a9->wraps[0] << 32) | value;
+
+	for (i = 0; i < a9->programmed; i++) {
+		pmu_select(i);
+		value = pmu_read_counter();
+		if ( pmu_read_overflow() & (1 << i) ) {
+			pmu_clear_overflow(1 << i);
+			a9->wraps[1 + i]++;
+			value = pmu_read_counter();
+		}
+		values[1 + i] = ((uint64_t) a9->wraps[1 + i] << 32) | value;
+	}
+	return;
+}
+
+const struct pmu_ops pmu_a9_ops = {
+	.counters = pmu_a9_counters,
+	.supported = pmu_a9_supported,
+	.program = pmu_a9_program,
+	.read = pmu_a9_read,
+};
+
+void pmu_a9_init(struct pmu_a9 *a9)
+{
+	uint32_t i = 0;
+
+	a9->counters = (pmu_read_pmcr() >> PMU_PMCR_N_SHIFT) & PMU_PMCR_N_MASK;
+	if ( a9->counters > PMU_A9_MAX_COUNTERS ) {
+		a9->counters = PMU_A9_MAX_COUNTERS;
+	}
+	a9->programmed = 0;
+	for (i = 0; i <= PMU_A9_MAX_COUNTERS; i++) {
+		a9->wraps[i] = 0;
+	}
+	pmu_clear_overflow(PMU_CNTEN_CYCLES | ((1 << a9->counters) - 1));
+	pmu_write_pmcr(pmu_read_pmcr() | PMU_PMCR_ENABLE);
+	pmu_counters_enable(PMU_CNTEN_CYCLES);
+	return;
+}
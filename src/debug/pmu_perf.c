@@ -0,0 +1,199 @@
+/*
+ * Linux perf_event_open() backend for pmu_scope.c
+ *
+ * Host builds only. Every program() opens a fresh group with cycles as the
+ * leader and the events as members, so the kernel schedules them onto the
+ * hardware together, and read() gets them all in one system call. The counts
+ * are already 64 bits. A system call per read is a lot more overhead than the
+ * A9's coprocessor reads, which is what pmu_scope_calibrate() is for.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "pmu_perf.h"
+
+#define PMU_PERF_CACHE(cache, op, result) \
+		((cache) | (PERF_COUNT_HW_CACHE_OP_ ## op << 8) | (PERF_COUNT_HW_CACHE_RESULT_ ## result << 16))
+
+struct pmu_perf_event {
+	uint32_t type;
+	uint64_t config;
+};
+
+static const struct pmu_perf_event pmu_perf_events[PMU_NUM_EVENTS] = {
+	[PMU_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+	[PMU_BRANCHES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+	[PMU_BRANCH_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+	[PMU_L1D_ACCESS] = {PERF_TYPE_HW_CACHE, PMU_PERF_CACHE(PERF_COUNT_HW_CACHE_L1D, READ, ACCESS)},
+	[PMU_L1D_REFILL] = {PERF_TYPE_HW_CACHE, PMU_PERF_CACHE(PERF_COUNT_HW_CACHE_L1D, READ, MISS)},
+	[PMU_L1I_REFILL] = {PERF_TYPE_HW_CACHE, PMU_PERF_CACHE(PERF_COUNT_HW_CACHE_L1I, READ, MISS)},
+	[PMU_DTLB_REFILL] = {PERF_TYPE_HW_CACHE, PMU_PERF_CACHE(PERF_COUNT_HW_CACHE_DTLB, READ, MISS)},
+	[PMU_ITLB_REFILL] = {PERF_TYPE_HW_CACHE, PMU_PERF_CACHE(PERF_COUNT_HW_CACHE_ITLB, READ, MISS)},
+	[PMU_STALL_FRONTEND] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+	[PMU_STALL_BACKEND] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+};
+
+static int pmu_perf_open(uint32_t type, uint64_t config, int group)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.read_format = PERF_FORMAT_GROUP;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	/* The leader starts everything, members follow it */
+	attr.disabled = ( group == -1 ) ? 1 : 0;
+	return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+static void pmu_perf_event(uint32_t event, uint32_t *type, uint64_t *config)
+{
+	if ( PMU_IS_RAW(event) ) {
+		*type = PERF_TYPE_RAW;
+		*config = PMU_RAW_EVENT(event);
+	} else {
+		*type = pmu_perf_events[event].type;
+		*config = pmu_perf_events[event].config;
+	}
+	return;
+}
+
+static int pmu_perf_open_leader(struct pmu_perf *perf)
+{
+	if ( perf->task_clock ) {
+		return pmu_perf_open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1);
+	}
+	return pmu_perf_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+}
+
+static void pmu_perf_close_all(struct pmu_perf *perf)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i <= PMU_PERF_COUNTERS; i++) {
+		if ( perf->fds[i] >= 0 ) {
+			close(perf->fds[i]);
+			perf->fds[i] = -1;
+		}
+	}
+	perf->programmed = 0;
+	return;
+}
+
+static uint32_t pmu_perf_counters(void *ctx)
+{
+	return PMU_PERF_COUNTERS;
+}
+
+/* Tried on its own, in a group of its own */
+static int pmu_perf_supported(void *ctx, uint32_t event)
+{
+	uint32_t type = 0;
+	uint64_t config = 0;
+	int fd = -1;
+
+	if ( !PMU_IS_RAW(event) && ( event >= PMU_NUM_EVENTS ) ) {
+		return 0;
+	}
+	pmu_perf_event(event, &type, &config);
+	fd = pmu_perf_open(type, config, -1);
+	if ( fd < 0 ) {
+		return 0;
+	}
+	close(fd);
+	return 1;
+}
+
+static int pmu_perf_program(void *ctx, const uint32_t *events, uint32_t count)
+{
+	struct pmu_perf *perf = ctx;
+	uint32_t type = 0;
+	uint64_t config = 0;
+	uint32_t i = 0;
+
+	if ( count > PMU_PERF_COUNTERS ) {
+		return -1;
+	}
+	pmu_perf_close_all(perf);
+	perf->fds[0] = pmu_perf_open_leader(perf);
+	if ( perf->fds[0] < 0 ) {
+		return -1;
+	}
+	for (i = 0; i < count; i++) {
+		pmu_perf_event(events[i], &type, &config);
+		perf->fds[1 + i] = pmu_perf_open(type, config, perf->fds[0]);
+		if ( perf->fds[1 + i] < 0 ) {
+			pmu_perf_close_all(perf);
+			return -1;
+		}
+	}
+	perf->programmed = count;
+	ioctl(perf->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(perf->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return 0;
+}
+
+static void pmu_perf_read(void *ctx, uint64_t *values)
+{
+	struct pmu_perf *perf = ctx;
+	/* Number of values, then the values in the order the group was opened */
+	uint64_t buf[2 + PMU_PERF_COUNTERS];
+	uint32_t i = 0;
+
+	if ( ( perf->fds[0] < 0 ) || ( read(perf->fds[0], buf, sizeof(buf)) < (ssize_t) sizeof(uint64_t) ) ) {
+		memset(values, 0, (1 + perf->programmed) * sizeof(*values));
+		return;
+	}
+	for (i = 0; ( i <= perf->programmed ) && ( i < buf[0] ); i++) {
+		values[i] = buf[1 + i];
+	}
+	return;
+}
+
+const struct pmu_ops pmu_perf_ops = {
+	.counters = pmu_perf_counters,
+	.supported = pmu_perf_supported,
+	.program = pmu_perf_program,
+	.read = pmu_perf_read,
+};
+
+int pmu_perf_init(struct pmu_perf *perf)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i <= PMU_PERF_COUNTERS; i++) {
+		perf->fds[i] = -1;
+	}
+	perf->programmed = 0;
+	perf->task_clock = 0;
+
+	/* Make sure there is something to lead a group with */
+	perf->fds[0] = pmu_perf_open_leader(perf);
+	if ( perf->fds[0] < 0 ) {
+		perf->task_clock = 1;
+		perf->fds[0] = pmu_perf_open_leader(perf);
+	}
+	if ( perf->fds[0] < 0 ) {
+		perror("perf_event_open");
+		return -1;
+	}
+	pmu_perf_close_all(perf);
+	return 0;
+}
+
+void pmu_perf_close(struct pmu_perf *perf)
+{
+	pmu_perf_close_all(perf);
+	return;
+}
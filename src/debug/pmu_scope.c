@@ -0,0 +1,270 @@
+/*
+ * Scoped hardware event counting over a pluggable counter backend
+ *
+ * Everything that touches the counters goes through struct pmu_ops. Between
+ * runs the only work is reprogramming the counters when a different scope or
+ * group comes along. Inside a run it is two backend reads, so begin and end
+ * stay cheap enough to put around a few dozen instructions, and
+ * pmu_scope_calibrate() takes off what is left.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "pmu_scope.h"
+
+static const char *pmu_event_names[PMU_NUM_EVENTS] = {
+	"instructions",
+	"branches",
+	"branch misses",
+	"L1D accesses",
+	"L1D refills",
+	"L1I refills",
+	"DTLB refills",
+	"ITLB refills",
+	"frontend stalls",
+	"backend stalls",
+};
+
+int pmu_init(struct pmu *pmu, const struct pmu_ops *ops, void *ctx)
+{
+	pmu->ops = ops;
+	pmu->ctx = ctx;
+	pmu->counters = ops->counters(ctx);
+	if ( pmu->counters > PMU_MAX_COUNTERS ) {
+		pmu->counters = PMU_MAX_COUNTERS;
+	}
+	pmu->programmed = NULL;
+	pmu->programmed_group = 0;
+	return ( pmu->counters == 0 ) ? -1 : 0;
+}
+
+const char *pmu_event_name(uint32_t event)
+{
+	static char raw[16];
+
+	if ( PMU_IS_RAW(event) ) {
+		snprintf(raw, sizeof(raw), "raw 0x%04"PRIx32, PMU_RAW_EVENT(event));
+		return raw;
+	}
+	if ( event < PMU_NUM_EVENTS ) {
+		return pmu_event_names[event];
+	}
+	return "unknown";
+}
+
+void pmu_scope_reset(struct pmu_scope *scope)
+{
+	uint32_t i = 0;
+
+	scope->group = 0;
+	scope->runs = 0;
+	scope->cycles = 0;
+	scope->min_cycles = UINT64_MAX;
+	scope->max_cycles = 0;
+	for (i = 0; i < PMU_MAX_EVENTS; i++) {
+		scope->count[i] = 0;
+		scope->enabled[i] = 0;
+	}
+	return;
+}
+
+int pmu_scope_init(struct pmu *pmu, struct pmu_scope *scope, const char *name,
+		const uint32_t *events, uint32_t count)
+{
+	uint32_t i = 0;
+
+	if ( count > PMU_MAX_EVENTS ) {
+		return -1;
+	}
+	scope->name = name;
+	scope->num_events = 0;
+	scope->num_missing = 0;
+	for (i = 0; i < count; i++) {
+		if ( pmu->ops->supported(pmu->ctx, events[i]) ) {
+			scope->events[scope->num_events++] = events[i];
+		} else {
+			scope->missing[scope->num_missing++] = events[i];
+		}
+	}
+	scope->groups = (scope->num_events + pmu->counters - 1) / pmu->counters;
+	if ( scope->groups == 0 ) {
+		scope->groups = 1;
+	}
+	scope->overhead_cycles = 0;
+	for (i = 0; i < PMU_MAX_EVENTS; i++) {
+		scope->overhead[i] = 0;
+	}
+	pmu_scope_reset(scope);
+	return 0;
+}
+
+/* First event and number of events in the scope's current group */
+static uint32_t pmu_scope_group(const struct pmu *pmu, const struct pmu_scope *scope, uint32_t *first)
+{
+	uint32_t n = 0;
+
+	*first = scope->group * pmu->counters;
+	n = scope->num_events - *first;
+	return ( n > pmu->counters ) ? pmu->counters : n;
+}
+
+void pmu_scope_begin(struct pmu *pmu, struct pmu_scope *scope)
+{
+	uint32_t first = 0;
+	uint32_t n = pmu_scope_group(pmu, scope, &first);
+
+	if ( ( pmu->programmed != scope ) || ( pmu->programmed_group != scope->group ) ) {
+		pmu->ops->program(pmu->ctx, &scope->events[first], n);
+		pmu->programmed = scope;
+		pmu->programmed_group = scope->group;
+	}
+	/* Last, so that as little as possible of the above is counted */
+	pmu->ops->read(pmu->ctx, scope->start);
+	return;
+}
+
+static uint64_t pmu_less_overhead(uint64_t value, uint64_t overhead)
+{
+	return ( value > overhead ) ? value - overhead : 0;
+}
+
+void pmu_scope_end(struct pmu *pmu, struct pmu_scope *scope)
+{
+	uint64_t stop[1 + PMU_MAX_COUNTERS];
+	uint64_t cycles = 0;
+	uint32_t first = 0;
+	uint32_t n = 0;
+	uint32_t i = 0;
+
+	/* First, for the same reason */
+	pmu->ops->read(pmu->ctx, stop);
+
+	n = pmu_scope_group(pmu, scope, &first);
+	cycles = pmu_less_overhead(stop[0] - scope->start[0], scope->overhead_cycles);
+	for (i = 0; i < n; i++) {
+		scope->count[first + i] += pmu_less_overhead(stop[1 + i] - scope->start[1 + i],
+				scope->overhead[first + i]);
+		scope->enabled[first + i] += cycles;
+	}
+	scope->cycles += cycles;
+	if ( cycles < scope->min_cycles ) {
+		scope->min_cycles = cycles;
+	}
+	if ( cycles > scope->max_cycles ) {
+		scope->max_cycles = cycles;
+	}
+	scope->runs++;
+	scope->group = (scope->group + 1) % scope->groups;
+	return;
+}
+
+void pmu_scope_calibrate(struct pmu *pmu, struct pmu_scope *scope, uint32_t runs)
+{
+	uint64_t least[PMU_MAX_EVENTS];
+	uint32_t first = 0;
+	uint32_t n = 0;
+	uint32_t i = 0;
+	uint32_t r = 0;
+
+	scope->overhead_cycles = 0;
+	for (i = 0; i < PMU_MAX_EVENTS; i++) {
+		scope->overhead[i] = 0;
+		least[i] = UINT64_MAX;
+	}
+	pmu_scope_reset(scope);
+
+	/* The least any empty run counted, every group gets the same number of runs */
+	for (r = 0; r < runs * scope->groups; r++) {
+		n = pmu_scope_group(pmu, scope, &first);
+		pmu_scope_begin(pmu, scope);
+		pmu_scope_end(pmu, scope);
+		for (i = 0; i < n; i++) {
+			if ( scope->count[first + i] < least[first + i] ) {
+				least[first + i] = scope->count[first + i];
+			}
+			scope->count[first + i] = 0;
+		}
+	}
+	scope->overhead_cycles = ( scope->min_cycles == UINT64_MAX ) ? 0 : scope->min_cycles;
+	for (i = 0; i < scope->num_events; i++) {
+		scope->overhead[i] = ( least[i] == UINT64_MAX ) ? 0 : least[i];
+	}
+	pmu_scope_reset(scope);
+	return;
+}
+
+double pmu_scope_total(const struct pmu_scope *scope, uint32_t i)
+{
+	if ( ( i >= scope->num_events ) || ( scope->enabled[i] == 0 ) ) {
+		return 0;
+	}
+	return (double) scope->count[i] * scope->cycles / scope->enabled[i];
+}
+
+double pmu_scope_per_run(const struct pmu_scope *scope, uint32_t i)
+{
+	if ( scope->runs == 0 ) {
+		return 0;
+	}
+	return pmu_scope_total(scope, i) / scope->runs;
+}
+
+int pmu_scope_find(const struct pmu_scope *scope, uint32_t event)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < scope->num_events; i++) {
+		if ( scope->events[i] == event ) {
+			return (int) i;
+		}
+	}
+	return -1;
+}
+
+void pmu_scope_print(const struct pmu_scope *scope)
+{
+	double cycles = 0;
+	double instructions = 0;
+	double branches = 0;
+	uint32_t i = 0;
+	int index = -1;
+
+	printf("%s, %"PRIu64" runs", scope->name, scope->runs);
+	if ( scope->groups > 1 ) {
+		printf(", %"PRIu32" groups multiplexed", scope->groups);
+	}
+	printf("\n");
+	if ( scope->runs == 0 ) {
+		return;
+	}
+	cycles = (double) scope->cycles / scope->runs;
+	printf("%-20s%-14s%-14s\n", "Event", "Per run", "Counted %");
+	printf("%-20s%-14.1f%-14.1f(min %"PRIu64", max %"PRIu64")\n", "cycles", cycles, 100.0,
+			scope->min_cycles, scope->max_cycles);
+	for (i = 0; i < scope->num_events; i++) {
+		printf("%-20s%-14.1f%-14.1f\n", pmu_event_name(scope->events[i]), pmu_scope_per_run(scope, i),
+				( scope->cycles == 0 ) ? 0.0 : 100.0 * scope->enabled[i] / scope->cycles);
+	}
+	for (i = 0; i < scope->num_missing; i++) {
+		printf("%-20s%-14s\n", pmu_event_name(scope->missing[i]), "not supported");
+	}
+
+	index = pmu_scope_find(scope, PMU_INSTRUCTIONS);
+	if ( index >= 0 ) {
+		instructions = pmu_scope_per_run(scope, index);
+		if ( instructions > 0 ) {
+			printf("%-20s%-14.2f\n", "IPC", instructions / cycles);
+		}
+	}
+	index = pmu_scope_find(scope, PMU_BRANCH_MISSES);
+	if ( ( index >= 0 ) && ( pmu_scope_find(scope, PMU_BRANCHES) >= 0 ) ) {
+		branches = pmu_scope_per_run(scope, pmu_scope_find(scope, PMU_BRANCHES));
+		if ( branches > 0 ) {
+			printf("%-20s%-14.2f\n", "Mispredict %", 100.0 * pmu_scope_per_run(scope, index) / branches);
+		}
+	}
+	return;
+}
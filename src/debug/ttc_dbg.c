@@ -24,6 +24,9 @@
 #define TTC_DBG_EVENT_CTRL_OFFSET	0x0000006C
 #define TTC_DBG_EVENT_CNT_OFFSET	0x00000078
 
+/* Three counters per TTC, each counter's registers 4 bytes on from the previous one's */
+#define TTC_DBG_NUM_COUNTERS		3
+
 /* When you need a value to return when you weren't able to read something */
 #define TTC_DBG_ERROR				0xDEADBEEF
 
@@ -98,8 +101,8 @@ uint32_t *ttc_dbg_get_addr(uint32_t ttc_id, uint32_t counter_id, uint32_t offset
 	} else {
 		base = NULL;
 	}
-	if ( base != NULL ) {
-		addr = (uint32_t *) base + (offset / sizeof(offset));
+	if ( ( base != NULL ) && ( counter_id < TTC_DBG_NUM_COUNTERS ) ) {
+		addr = (uint32_t *) base + (offset / sizeof(offset)) + counter_id;
 	} else {
 		addr = NULL;
 	}
@@ -184,7 +187,10 @@ uint32_t ttc_dbg_ier(uint32_t ttc_id, uint32_t counter_id)
 void ttc_dbg_set_clk_ctrl(uint32_t ttc_id, uint32_t counter_id, uint32_t val)
 {
 	uint32_t *addr = ttc_dbg_get_addr(ttc_id, counter_id, TTC_DBG_CLK_CTRL_OFFSET);
-	*addr = (0x7F & val);
+
+	if ( addr != NULL ) {
+		*addr = (0x7F & val);
+	}
 	return;
 }
 
@@ -192,7 +198,10 @@ void ttc_dbg_set_clk_ctrl(uint32_t ttc_id, uint32_t counter_id, uint32_t val)
 void ttc_dbg_set_cnt_ctrl(uint32_t ttc_id, uint32_t counter_id, uint32_t val)
 {
 	uint32_t *addr = ttc_dbg_get_addr(ttc_id, counter_id, TTC_DBG_CNT_CTRL_OFFSET);
-	*addr = (0x7F & val);
+
+	if ( addr != NULL ) {
+		*addr = (0x7F & val);
+	}
 	return;
 }
 
@@ -200,14 +209,17 @@ void ttc_dbg_set_cnt_ctrl(uint32_t ttc_id, uint32_t counter_id, uint32_t val)
 void ttc_dbg_set_interval_val(uint32_t ttc_id, uint32_t counter_id, uint16_t val)
 {
 	uint32_t *addr = ttc_dbg_get_addr(ttc_id, counter_id, TTC_DBG_INTERVAL_VAL_OFFSET);
-	*addr = val;
+
+	if ( addr != NULL ) {
+		*addr = val;
+	}
 	return;
 }
 
 void ttc_dbg_rst(uint32_t ttc_id, uint32_t counter_id)
 {
 	/* Per the TRM, it appears that the disable bit needs to be set before any others */
-	ttc_dbg_set_cnt_ctrl(0, 0, 0x00000021);
-	ttc_dbg_set_clk_ctrl(0, 0, 0x00000000);
+	ttc_dbg_set_cnt_ctrl(ttc_id, counter_id, 0x00000021);
+	ttc_dbg_set_clk_ctrl(ttc_id, counter_id, 0x00000000);
 	return;
 }
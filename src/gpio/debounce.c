@@ -0,0 +1,148 @@
+/*
+ * Multi-pin switch debouncing without sleeping in an interrupt handler
+ *
+ * The first edge on a pin masks further interrupts from that pin and arms it.
+ * From then on a periodic timer samples the pin, and once the level has been
+ * the same for the configured number of samples the pin is considered settled.
+ * If the settled level differs from the last one, a press or release event is
+ * queued for the application. Either way the pin interrupt is unmasked again
+ * and the sampler forgets about the pin until the next edge, so an idle switch
+ * costs nothing at all.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "debounce.h"
+
+void debounce_init(struct debounce *db, const struct debounce_ops *ops, void *ctx)
+{
+	db->ops = ops;
+	db->ctx = ctx;
+	db->num_pins = 0;
+	db->tick = 0;
+	db->head = 0;
+	db->tail = 0;
+	db->dropped = 0;
+	return;
+}
+
+int debounce_add_pin(struct debounce *db, uint32_t pin, uint32_t active_level, uint32_t samples)
+{
+	struct debounce_pin *p = NULL;
+
+	if ( ( db->num_pins >= DEBOUNCE_MAX_PINS ) || ( samples == 0 ) ) {
+		return -1;
+	}
+	p = &db->pins[db->num_pins];
+	p->pin = pin;
+	p->active_level = active_level;
+	p->samples = samples;
+	/* Whatever the pin is doing now is taken as settled */
+	p->level = db->ops->read_pin(db->ctx, pin);
+	p->candidate = p->level;
+	p->count = 0;
+	p->armed = 0;
+
+	return db->num_pins++;
+}
+
+static struct debounce_pin *debounce_find(struct debounce *db, uint32_t pin)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < db->num_pins; i++) {
+		if ( db->pins[i].pin == pin ) {
+			return &db->pins[i];
+		}
+	}
+	return NULL;
+}
+
+int debounce_edge(struct debounce *db, uint32_t pin)
+{
+	struct debounce_pin *p = debounce_find(db, pin);
+
+	if ( p == NULL ) {
+		return -1;
+	}
+	db->ops->mask_pin(db->ctx, pin);
+	if ( p->armed == 0 ) {
+		p->candidate = p->level;
+		p->count = 0;
+		p->armed = 1;
+	}
+	return 0;
+}
+
+static void debounce_push(struct debounce *db, struct debounce_pin *p)
+{
+	uint32_t head = db->head;
+
+	if ( ( head - db->tail ) >= DEBOUNCE_QUEUE_LEN ) {
+		db->dropped++;
+		return;
+	}
+	db->queue[head & (DEBOUNCE_QUEUE_LEN - 1)].pin = p->pin;
+	db->queue[head & (DEBOUNCE_QUEUE_LEN - 1)].type =
+			( p->level == p->active_level ) ? DEBOUNCE_PRESS : DEBOUNCE_RELEASE;
+	db->queue[head & (DEBOUNCE_QUEUE_LEN - 1)].tick = db->tick;
+	/* The event has to be visible before the consumer can see the new head */
+	__sync_synchronize();
+	db->head = head + 1;
+	return;
+}
+
+void debounce_tick(struct debounce *db)
+{
+	struct debounce_pin *p = NULL;
+	uint32_t level = 0;
+	uint32_t i = 0;
+
+	db->tick++;
+	for (i = 0; i < db->num_pins; i++) {
+		p = &db->pins[i];
+		if ( p->armed == 0 ) {
+			continue;
+		}
+		level = db->ops->read_pin(db->ctx, p->pin);
+		if ( level == p->candidate ) {
+			p->count++;
+		} else {
+			p->candidate = level;
+			p->count = 1;
+		}
+		if ( p->count < p->samples ) {
+			continue;
+		}
+		/* Settled - a bounce that came back to where it started is not an event */
+		if ( p->candidate != p->level ) {
+			p->level = p->candidate;
+			debounce_push(db, p);
+		}
+		p->armed = 0;
+		db->ops->unmask_pin(db->ctx, p->pin);
+		/*
+		 * An edge between the last sample and the unmask was thrown away with
+		 * the latched interrupt, so look once more and rearm if it moved
+		 */
+		if ( db->ops->read_pin(db->ctx, p->pin) != p->level ) {
+			debounce_edge(db, p->pin);
+		}
+	}
+	return;
+}
+
+int debounce_get_event(struct debounce *db, struct debounce_event *event)
+{
+	uint32_t tail = db->tail;
+
+	if ( tail == db->head ) {
+		return 0;
+	}
+	__sync_synchronize();
+	*event = db->queue[tail & (DEBOUNCE_QUEUE_LEN - 1)];
+	__sync_synchronize();
+	db->tail = tail + 1;
+	return 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * Binds the debounce state machine to the PS GPIO controller and the Cortex-A9
+ * private timer. Pins should be configured for XGPIOPS_IRQ_TYPE_EDGE_BOTH so
+ * that releases are seen as well as presses.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xgpiops.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xtime_l.h"
+
+#include "gpio_fast.h"
+#include "debounce.h"
+#include "debounce_gpiops.h"
+
+#define TIMER_DEVICE_ID			XPAR_XSCUTIMER_0_DEVICE_ID
+#define TIMER_INTR_ID			XPS_SCU_TMR_INT_ID
+
+/* Only one sample timer per program, so it is kept here rather than in the callers */
+static struct {
+	struct debounce *db;
+	XScuTimer *timer;
+} tick_ref;
+
+static uint32_t gpiops_read_pin(void *ctx, uint32_t pin)
+{
+	return XGpioPs_ReadPin((XGpioPs *) ctx, pin);
+}
+
+static void gpiops_mask_pin(void *ctx, uint32_t pin)
+{
+	XGpioPs_IntrDisablePin((XGpioPs *) ctx, pin);
+	XGpioPs_IntrClearPin((XGpioPs *) ctx, pin);
+	return;
+}
+
+static void gpiops_unmask_pin(void *ctx, uint32_t pin)
+{
+	/* Status latches while masked, so drop anything seen while sampling */
+	XGpioPs_IntrClearPin((XGpioPs *) ctx, pin);
+	XGpioPs_IntrEnablePin((XGpioPs *) ctx, pin);
+	return;
+}
+
+const struct debounce_ops debounce_gpiops_ops = {
+	.read_pin = gpiops_read_pin,
+	.mask_pin = gpiops_mask_pin,
+	.unmask_pin = gpiops_unmask_pin,
+};
+
+uint32_t debounce_gpiops_edges(struct debounce *db, uint32_t bank, uint32_t status)
+{
+	uint32_t handled = 0;
+	uint32_t bit = 0;
+
+	if ( bank >= GPIO_FAST_NUM_BANKS ) {
+		return 0;
+	}
+	for (bit = 0; status != 0; bit++, status >>= 1) {
+		if ( ( status & 1 ) && ( debounce_edge(db, gpio_fast_bank_first_pin[bank] + bit) == 0 ) ) {
+			handled++;
+		}
+	}
+	return handled;
+}
+
+void debounce_gpiops_handler(void *callback_ref, u32 bank, u32 status)
+{
+	debounce_gpiops_edges((struct debounce *) callback_ref, bank, status);
+	return;
+}
+
+static void debounce_gpiops_tick_handler(void *callback_ref)
+{
+	XScuTimer_ClearInterruptStatus(tick_ref.timer);
+	debounce_tick(tick_ref.db);
+	return;
+}
+
+int debounce_gpiops_tick_init(struct debounce *db, XScuGic *gic, XScuTimer *timer,
+		uint32_t period_us)
+{
+	XScuTimer_Config *timer_config = NULL;
+
+	timer_config = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+	if ( timer_config == NULL ) {
+		fprintf(stderr, "Could not find configuration for timer device ID %d\n", TIMER_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	if ( XScuTimer_CfgInitialize(timer, timer_config, timer_config->BaseAddr) != XST_SUCCESS ) {
+		/* Left running by a previous launch, which is fine since we reload it below */
+		XScuTimer_Stop(timer);
+	}
+	tick_ref.db = db;
+	tick_ref.timer = timer;
+
+	/* Private timers run from the same CPU_3x2x clock as the global timer */
+	XScuTimer_DisableInterrupt(timer);
+	XScuTimer_ClearInterruptStatus(timer);
+	XScuTimer_EnableAutoReload(timer);
+	XScuTimer_LoadTimer(timer, (COUNTS_PER_SECOND / 1000000) * period_us);
+
+	if ( XScuGic_Connect(gic, TIMER_INTR_ID,
+			(Xil_ExceptionHandler) debounce_gpiops_tick_handler, NULL) != XST_SUCCESS ) {
+		fprintf(stderr, "Could not connect debounce timer interrupt handler\n");
+		return XST_FAILURE;
+	}
+	XScuTimer_EnableInterrupt(timer);
+	XScuGic_Enable(gic, TIMER_INTR_ID);
+	XScuTimer_Start(timer);
+
+	return XST_SUCCESS;
+}
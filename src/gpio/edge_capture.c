@@ -0,0 +1,189 @@
+/*
+ * Timestamped GPIO edge capture
+ *
+ * The interrupt handler stamps each edge with the global timer and drops a
+ * (pin, edge, timestamp) sample into a lock-free ring. Everything that costs
+ * time - pairing edges up into pulse widths and periods, statistics - is done
+ * by whoever drains the ring.
+ *
+ * A GPIO interrupt only tells us that at least one edge happened. The edge
+ * direction comes from reading the pin in the handler, so if two edges land
+ * before the handler runs the level appears not to have changed. Those are
+ * counted as lost rather than silently producing a double-length pulse.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "edge_capture.h"
+
+void edge_capture_init(struct edge_capture *ec)
+{
+	ec->head = 0;
+	ec->tail = 0;
+	ec->num_pins = 0;
+	ec->captured = 0;
+	ec->lost_full = 0;
+	ec->lost_coalesced = 0;
+	return;
+}
+
+int edge_capture_add_pin(struct edge_capture *ec, uint32_t pin, uint32_t level)
+{
+	if ( ec->num_pins >= EDGE_CAPTURE_MAX_PINS ) {
+		return -1;
+	}
+	ec->pins[ec->num_pins] = pin;
+	ec->level[ec->num_pins] = level;
+	/* There is no previous edge to measure from */
+	ec->gap[ec->num_pins] = EDGE_CAPTURE_GAP;
+	return ec->num_pins++;
+}
+
+void edge_capture_record(struct edge_capture *ec, uint32_t pin, uint32_t level, uint64_t timestamp)
+{
+	struct edge_sample *sample = NULL;
+	uint32_t head = ec->head;
+	uint32_t i = 0;
+
+	for (i = 0; i < ec->num_pins; i++) {
+		if ( ec->pins[i] == pin ) {
+			break;
+		}
+	}
+	if ( i == ec->num_pins ) {
+		return;
+	}
+
+	if ( level == ec->level[i] ) {
+		/* Went away and came back before we looked, so one edge each way is gone */
+		ec->lost_coalesced += 2;
+		ec->gap[i] = EDGE_CAPTURE_GAP;
+		return;
+	}
+	ec->level[i] = level;
+
+	if ( ( head - ec->tail ) >= EDGE_CAPTURE_RING_LEN ) {
+		ec->lost_full++;
+		ec->gap[i] = EDGE_CAPTURE_GAP;
+		return;
+	}
+	sample = &ec->ring[head & (EDGE_CAPTURE_RING_LEN - 1)];
+	sample->timestamp = timestamp;
+	sample->pin = pin;
+	sample->edge = ( level ? EDGE_CAPTURE_RISING : EDGE_CAPTURE_FALLING ) | ec->gap[i];
+	ec->gap[i] = 0;
+	ec->captured++;
+
+	__sync_synchronize();
+	ec->head = head + 1;
+	return;
+}
+
+int edge_capture_get(struct edge_capture *ec, struct edge_sample *sample)
+{
+	uint32_t tail = ec->tail;
+
+	if ( tail == ec->head ) {
+		return 0;
+	}
+	__sync_synchronize();
+	*sample = ec->ring[tail & (EDGE_CAPTURE_RING_LEN - 1)];
+	__sync_synchronize();
+	ec->tail = tail + 1;
+	return 1;
+}
+
+static void edge_stat_init(struct edge_stat *stat)
+{
+	stat->count = 0;
+	stat->min = UINT64_MAX;
+	stat->max = 0;
+	stat->sum = 0;
+	stat->sum_sq = 0;
+	return;
+}
+
+static void edge_stat_add(struct edge_stat *stat, uint64_t ticks)
+{
+	stat->count++;
+	if ( ticks < stat->min ) {
+		stat->min = ticks;
+	}
+	if ( ticks > stat->max ) {
+		stat->max = ticks;
+	}
+	stat->sum += ticks;
+	stat->sum_sq += (double) ticks * (double) ticks;
+	return;
+}
+
+double edge_stat_mean(const struct edge_stat *stat)
+{
+	if ( stat->count == 0 ) {
+		return 0;
+	}
+	return (double) stat->sum / stat->count;
+}
+
+/* Standard deviation - for a steady input this is the timestamp jitter */
+double edge_stat_stddev(const struct edge_stat *stat)
+{
+	double mean = edge_stat_mean(stat);
+	double var = 0;
+
+	if ( stat->count < 2 ) {
+		return 0;
+	}
+	var = (stat->sum_sq / stat->count) - (mean * mean);
+	return ( var > 0 ) ? sqrt(var) : 0;
+}
+
+void edge_pulse_init(struct edge_pulse *pulse)
+{
+	pulse->last_rise = 0;
+	pulse->last_fall = 0;
+	pulse->have_rise = 0;
+	pulse->have_fall = 0;
+	edge_stat_init(&pulse->high);
+	edge_stat_init(&pulse->low);
+	edge_stat_init(&pulse->period);
+	return;
+}
+
+void edge_pulse_update(struct edge_pulse *pulse, const struct edge_sample *sample)
+{
+	if ( sample->edge & EDGE_CAPTURE_GAP ) {
+		pulse->have_rise = 0;
+		pulse->have_fall = 0;
+	}
+
+	if ( sample->edge & EDGE_CAPTURE_RISING ) {
+		if ( pulse->have_fall ) {
+			edge_stat_add(&pulse->low, sample->timestamp - pulse->last_fall);
+		}
+		if ( pulse->have_rise ) {
+			edge_stat_add(&pulse->period, sample->timestamp - pulse->last_rise);
+		}
+		pulse->last_rise = sample->timestamp;
+		pulse->have_rise = 1;
+	} else {
+		if ( pulse->have_rise ) {
+			edge_stat_add(&pulse->high, sample->timestamp - pulse->last_rise);
+		}
+		pulse->last_fall = sample->timestamp;
+		pulse->have_fall = 1;
+	}
+	return;
+}
+
+double edge_pulse_frequency(const struct edge_pulse *pulse, double ticks_per_sec)
+{
+	double mean = edge_stat_mean(&pulse->period);
+
+	if ( mean == 0 ) {
+		return 0;
+	}
+	return ticks_per_sec / mean;
+}
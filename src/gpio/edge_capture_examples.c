@@ -0,0 +1,171 @@
+/*
+ * Pulse width and frequency measurement with timestamped GPIO edges
+ *
+ * Captures both edges on the user push button and on PMOD JA pin 1 for a fixed
+ * time and then reports what was seen. To characterize the capture path itself,
+ * feed PMOD JA pin 1 from a known square wave (the TTC waveform output driven by
+ * ttc_pwm.c works) and raise the frequency until edges start getting lost:
+ *
+ *  - edges/sec is the sustained capture rate
+ *  - lost (ring full) means the consumer below could not keep up
+ *  - lost (coalesced) means interrupts could not keep up with the input
+ *  - the standard deviation of the period is the timestamp jitter, since the
+ *    input itself is crystal controlled
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xgpiops.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xtime_l.h"
+
+#include "edge_capture.h"
+#include "edge_capture_gpiops.h"
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define GPIOPS_DEVICE_ID		XPAR_XGPIOPS_0_DEVICE_ID
+
+#define GPIO_UZED_PBSW			51
+/* Assumes pmod_ja[0] is brought out through EMIO GPIO 0 in the block design */
+#define GPIO_PMOD_JA1			54
+
+#define CAPTURE_SECONDS			10
+
+#define ASCII_ESC			27
+
+static XScuGic gic;
+static XGpioPs gpio;
+static struct edge_capture capture;
+
+/* Pulse measurements are kept per pin, in the same order the pins were added */
+static const uint32_t capture_pins[] = {GPIO_UZED_PBSW, GPIO_PMOD_JA1};
+#define NUM_CAPTURE_PINS		(sizeof(capture_pins) / sizeof(capture_pins[0]))
+static struct edge_pulse pulses[NUM_CAPTURE_PINS];
+
+static double ticks_to_ns(double ticks)
+{
+	return ticks * 1e9 / COUNTS_PER_SECOND;
+}
+
+static void print_stat(const char *name, const struct edge_stat *stat)
+{
+	if ( stat->count == 0 ) {
+		printf("%-10s%-10s\n", name, "-");
+		return;
+	}
+	printf("%-10s%-10"PRIu32"%-14.0f%-14.0f%-14.0f%-14.1f\n", name, stat->count,
+			ticks_to_ns(stat->min), ticks_to_ns(edge_stat_mean(stat)),
+			ticks_to_ns(stat->max), ticks_to_ns(edge_stat_stddev(stat)));
+	return;
+}
+
+static int setup_intr_system(void)
+{
+	XScuGic_Config *gic_config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+
+	if ( ( gic_config == NULL ) ||
+			( XScuGic_CfgInitialize(&gic, gic_config, gic_config->CpuBaseAddress) != XST_SUCCESS ) ) {
+		fprintf(stderr, "Could not initialize GIC device ID %d\n", GIC_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT,
+			(Xil_ExceptionHandler) XScuGic_InterruptHandler, &gic);
+	return XST_SUCCESS;
+}
+
+static int setup_gpio_system(void)
+{
+	XGpioPs_Config *gpio_config = XGpioPs_LookupConfig(GPIOPS_DEVICE_ID);
+	uint32_t i = 0;
+
+	if ( ( gpio_config == NULL ) ||
+			( XGpioPs_CfgInitialize(&gpio, gpio_config, gpio_config->BaseAddr) != XST_SUCCESS ) ) {
+		fprintf(stderr, "Could not initialize GPIO device ID %d\n", GPIOPS_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	for (i = 0; i < XGPIOPS_MAX_BANKS; i++) {
+		XGpioPs_IntrDisable(&gpio, i, 0xFFFFFFFF);
+		XGpioPs_IntrClear(&gpio, i, 0xFFFFFFFF);
+	}
+	return XST_SUCCESS;
+}
+
+int main(int args, char *argv[])
+{
+	struct edge_capture_isr_cost cost;
+	struct edge_sample sample;
+	uint32_t backlog = 0;
+	uint32_t high_water = 0;
+	XTime start = 0;
+	XTime now = 0;
+	uint32_t i = 0;
+
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("GPIO Edge Capture\n");
+	printf("-----------------\n");
+
+	if ( ( setup_intr_system() != XST_SUCCESS ) || ( setup_gpio_system() != XST_SUCCESS ) ) {
+		return XST_FAILURE;
+	}
+	if ( edge_capture_gpiops_init(&capture, &gic) != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+	for (i = 0; i < NUM_CAPTURE_PINS; i++) {
+		edge_pulse_init(&pulses[i]);
+		if ( edge_capture_gpiops_add_pin(&capture, &gpio, capture_pins[i]) != XST_SUCCESS ) {
+			fprintf(stderr, "Could not capture GPIO pin %"PRIu32"\n", capture_pins[i]);
+		}
+	}
+	Xil_ExceptionEnableMask(XIL_EXCEPTION_IRQ);
+
+	printf("Capturing for %d seconds...\n", CAPTURE_SECONDS);
+	XTime_GetTime(&start);
+	do {
+		backlog = capture.head - capture.tail;
+		if ( backlog > high_water ) {
+			high_water = backlog;
+		}
+		while ( edge_capture_get(&capture, &sample) ) {
+			for (i = 0; i < NUM_CAPTURE_PINS; i++) {
+				if ( capture_pins[i] == sample.pin ) {
+					edge_pulse_update(&pulses[i], &sample);
+				}
+			}
+		}
+		XTime_GetTime(&now);
+	} while ( ( now - start ) < (XTime) CAPTURE_SECONDS * COUNTS_PER_SECOND );
+	Xil_ExceptionDisableMask(XIL_EXCEPTION_IRQ);
+
+	edge_capture_gpiops_isr_cost(&cost);
+	printf("\n");
+	printf("%-30s%"PRIu32"\n", "Edges captured", capture.captured);
+	printf("%-30s%"PRIu32"\n", "Edges/sec", capture.captured / CAPTURE_SECONDS);
+	printf("%-30s%"PRIu32"\n", "Lost (ring full)", capture.lost_full);
+	printf("%-30s%"PRIu32"\n", "Lost (coalesced)", capture.lost_coalesced);
+	printf("%-30s%"PRIu32" of %d\n", "Ring high water", high_water, EDGE_CAPTURE_RING_LEN);
+	if ( cost.count != 0 ) {
+		printf("%-30s%.0f ns mean, %.0f ns max\n", "Handler cost",
+				ticks_to_ns((double) cost.sum / cost.count), ticks_to_ns(cost.max));
+	}
+
+	for (i = 0; i < NUM_CAPTURE_PINS; i++) {
+		printf("\nGPIO pin %"PRIu32" (%.3f Hz)\n", capture_pins[i],
+				edge_pulse_frequency(&pulses[i], COUNTS_PER_SECOND));
+		printf("%-10s%-10s%-14s%-14s%-14s%-14s\n", "", "Count", "Min (ns)", "Mean (ns)", "Max (ns)", "Jitter (ns)");
+		print_stat("High", &pulses[i].high);
+		print_stat("Low", &pulses[i].low);
+		print_stat("Period", &pulses[i].period);
+	}
+
+	cleanup_platform();
+	return XST_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/*
+ * GPIO interrupt handler for edge capture
+ *
+ * This is connected to the GIC in place of XGpioPs_IntrHandler(). The driver
+ * handler walks every bank through several function calls before a callback
+ * gets control, and all of that would land between the edge and its timestamp.
+ * Here the global timer is read first and the GPIO registers are accessed
+ * directly, only for the banks that have capture pins in them.
+ *
+ * No floating point in the handler - the standalone BSP does not save the VFP
+ * registers on interrupt entry.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xgpiops.h"
+#include "xscugic.h"
+
+#include "gtimer.h"
+#include "gpio_fast.h"
+#include "edge_capture.h"
+#include "edge_capture_gpiops.h"
+
+#define GPIO_INTR_ID			XPS_GPIO_INT_ID
+
+#define GPIO_DATA_RO(bank)		(GPIO_FAST_BASE + 0x00000060 + ((bank) * 4))
+#define GPIO_INT_STAT(bank)		(GPIO_FAST_BASE + 0x00000218 + ((bank) * 0x40))
+
+#define GPIO_INPUT			0
+
+/* Pins being captured, per bank */
+static uint32_t bank_capture_mask[GPIO_FAST_NUM_BANKS];
+
+static volatile struct edge_capture_isr_cost isr_cost;
+
+static void edge_capture_gpiops_handler(void *callback_ref)
+{
+	struct edge_capture *ec = callback_ref;
+	uint64_t timestamp = gtimer_read();
+	uint32_t status = 0;
+	uint32_t levels = 0;
+	uint32_t bank = 0;
+	uint32_t bit = 0;
+	uint32_t cost = 0;
+
+	for (bank = 0; bank < GPIO_FAST_NUM_BANKS; bank++) {
+		if ( bank_capture_mask[bank] == 0 ) {
+			continue;
+		}
+		status = Xil_In32(GPIO_INT_STAT(bank)) & bank_capture_mask[bank];
+		if ( status == 0 ) {
+			continue;
+		}
+		/* Clear before sampling, so an edge after the sample raises a new interrupt */
+		Xil_Out32(GPIO_INT_STAT(bank), status);
+		levels = Xil_In32(GPIO_DATA_RO(bank));
+		for (bit = 0; status != 0; bit++, status >>= 1) {
+			if ( status & 1 ) {
+				edge_capture_record(ec, gpio_fast_bank_first_pin[bank] + bit, (levels >> bit) & 1, timestamp);
+			}
+		}
+	}
+
+	cost = gtimer_read_lo() - (uint32_t) timestamp;
+	isr_cost.count++;
+	isr_cost.sum += cost;
+	if ( cost > isr_cost.max ) {
+		isr_cost.max = cost;
+	}
+	return;
+}
+
+int edge_capture_gpiops_init(struct edge_capture *ec, XScuGic *gic)
+{
+	uint32_t bank = 0;
+
+	edge_capture_init(ec);
+	for (bank = 0; bank < GPIO_FAST_NUM_BANKS; bank++) {
+		bank_capture_mask[bank] = 0;
+	}
+	isr_cost.count = 0;
+	isr_cost.max = 0;
+	isr_cost.sum = 0;
+
+	if ( XScuGic_Connect(gic, GPIO_INTR_ID,
+			(Xil_ExceptionHandler) edge_capture_gpiops_handler, (void *) ec) != XST_SUCCESS ) {
+		fprintf(stderr, "Could not connect edge capture interrupt handler\n");
+		return XST_FAILURE;
+	}
+	XScuGic_Enable(gic, GPIO_INTR_ID);
+	return XST_SUCCESS;
+}
+
+int edge_capture_gpiops_add_pin(struct edge_capture *ec, XGpioPs *gpio, uint32_t pin)
+{
+	uint32_t bank = 0;
+	uint32_t bit = 0;
+
+	if ( gpio_fast_pin_to_bank(pin, &bank, &bit) != 0 ) {
+		return XST_FAILURE;
+	}
+	XGpioPs_IntrDisablePin(gpio, pin);
+	XGpioPs_SetDirectionPin(gpio, pin, GPIO_INPUT);
+	XGpioPs_SetIntrTypePin(gpio, pin, XGPIOPS_IRQ_TYPE_EDGE_BOTH);
+	if ( edge_capture_add_pin(ec, pin, XGpioPs_ReadPin(gpio, pin)) < 0 ) {
+		return XST_FAILURE;
+	}
+	bank_capture_mask[bank] |= (1u << bit);
+	XGpioPs_IntrClearPin(gpio, pin);
+	XGpioPs_IntrEnablePin(gpio, pin);
+	return XST_SUCCESS;
+}
+
+void edge_capture_gpiops_isr_cost(struct edge_capture_isr_cost *cost)
+{
+	cost->count = isr_cost.count;
+	cost->max = isr_cost.max;
+	cost->sum = isr_cost.sum;
+	return;
+}
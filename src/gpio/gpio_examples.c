@@ -8,6 +8,9 @@
 #include "xstatus.h"
 #include "xgpiops.h"
 
+#include "gpio_fast.h"
+#include "dev_pool.h"
+
 /* Define the Microzed user LED and user pushbutton switch pin numbers */
 #define GPIO_UZED_LED 47
 #define GPIO_UZED_PBSW 51
@@ -69,9 +72,13 @@ int gpio_blink_led(XGpioPs *gpio_ptr, uint32_t pin, unsigned long tms)
 
 void gpio_toggle_led(XGpioPs *gpio_ptr, uint32_t pin)
 {
-	uint32_t current;
-	current = XGpioPs_ReadPin(gpio_ptr, pin);
-	XGpioPs_WritePin(gpio_ptr, pin, !current);
+	uint32_t bank;
+	uint32_t bit;
+
+	/* One read and one masked write instead of two driver calls */
+	if (gpio_fast_pin_to_bank(pin, &bank, &bit) == 0) {
+		gpio_fast_toggle(bank, 1u << bit);
+	}
 	return;
 }
 
@@ -108,15 +115,8 @@ int main(int args, char *argv[])
 	fprintf(stdout, "GPIO Examples\n");
 	fprintf(stdout, "========================\n");
 
-	/* 
-	 * Allocate some heap memory for the GPIO driver instance - there is
-	 * probably a memory allocator in the Xilinx SDK, but we will use the
-	 * one from the standard library anyway
-	 */
-	gpio_ptr = malloc(sizeof(XGpioPs));
-	if (gpio_ptr == NULL) {
-		return XST_FAILURE;
-	}
+	/* The GPIO driver instance comes from the static pool rather than the heap */
+	gpio_ptr = dev_pool_gpiops(XPAR_PS7_GPIO_0_DEVICE_ID);
 
 	/*
 	 * The GPIO config requires a device ID and returns a struct
@@ -132,6 +132,8 @@ int main(int args, char *argv[])
 		/* Print out GPIO summary */
 		gpio_summary(gpio_ptr);
 		fprintf(stdout, "\n");
+		dev_pool_report();
+		fprintf(stdout, "\n");
 		/* Driver was initialized correctly, so run self test */
 		status = XGpioPs_SelfTest(gpio_ptr);
 		if (status == XST_SUCCESS) {
@@ -141,7 +143,6 @@ int main(int args, char *argv[])
 		}
 	} else {
 		fprintf(stderr, "Could not initialize GPIO %d\n", XPAR_PS7_GPIO_0_DEVICE_ID);
-		free(gpio_ptr);
 		return XST_FAILURE;
 	}
 
@@ -172,7 +173,6 @@ int main(int args, char *argv[])
 	}
 	fprintf(stdout, "Completed pushbutton / LED toggle\n");
 
-	free(gpio_ptr);
 	fprintf(stdout, "Done.\n");
 	cleanup_platform();
 
@@ -0,0 +1,115 @@
+/*
+ * Bank-wide GPIO updates through the MASK_DATA registers
+ *
+ * The XGpioPs pin functions look up the bank for every call and touch one pin
+ * at a time, so changing several pins costs a driver call and a bus access per
+ * pin, and the pins do not change together. The controller has a better way -
+ * each bank has a pair of MASK_DATA registers where the upper 16 bits of the
+ * written word select which of 16 pins are left alone and the lower 16 bits
+ * hold the new values. Any subset of a bank can therefore be changed with at
+ * most two stores and without reading anything back first, and pins that are
+ * not in the mask (possibly owned by an interrupt handler) are never disturbed.
+ */
+
+#include <stdint.h>
+
+#include "xil_io.h"
+
+#include "gpio_fast.h"
+
+#define GPIO_FAST_MASK_DATA_LSW(bank)	(GPIO_FAST_BASE + 0x00000000 + ((bank) * 8))
+#define GPIO_FAST_MASK_DATA_MSW(bank)	(GPIO_FAST_BASE + 0x00000004 + ((bank) * 8))
+#define GPIO_FAST_DATA(bank)		(GPIO_FAST_BASE + 0x00000040 + ((bank) * 4))
+#define GPIO_FAST_DATA_RO(bank)		(GPIO_FAST_BASE + 0x00000060 + ((bank) * 4))
+
+/* Bank 0 is MIO 0-31, bank 1 is MIO 32-53, banks 2 and 3 are EMIO 54-117 */
+static const uint32_t gpio_fast_bank_pins[GPIO_FAST_NUM_BANKS] = {32, 22, 32, 32};
+const uint32_t gpio_fast_bank_first_pin[GPIO_FAST_NUM_BANKS] = {0, 32, 54, 86};
+
+int gpio_fast_pin_to_bank(uint32_t pin, uint32_t *bank, uint32_t *bit)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < GPIO_FAST_NUM_BANKS; i++) {
+		if ( pin < gpio_fast_bank_pins[i] ) {
+			*bank = i;
+			*bit = pin;
+			return 0;
+		}
+		pin -= gpio_fast_bank_pins[i];
+	}
+	return -1;
+}
+
+int gpio_fast_pattern_compile(struct gpio_fast_pattern *pattern,
+		uint32_t bank, uint32_t mask, uint32_t value)
+{
+	uint32_t half = 0;
+
+	if ( bank >= GPIO_FAST_NUM_BANKS ) {
+		return -1;
+	}
+	pattern->count = 0;
+
+	/* A set bit in the upper half of a MASK_DATA word means 'leave this pin alone' */
+	half = mask & 0x0000FFFF;
+	if ( half != 0 ) {
+		pattern->addr[pattern->count] = GPIO_FAST_MASK_DATA_LSW(bank);
+		pattern->word[pattern->count] = ((~half & 0x0000FFFF) << 16) | (value & half);
+		pattern->count++;
+	}
+	half = mask >> 16;
+	if ( half != 0 ) {
+		pattern->addr[pattern->count] = GPIO_FAST_MASK_DATA_MSW(bank);
+		pattern->word[pattern->count] = ((~half & 0x0000FFFF) << 16) | ((value >> 16) & half);
+		pattern->count++;
+	}
+	return 0;
+}
+
+void gpio_fast_pattern_apply(const struct gpio_fast_pattern *patterns, uint32_t count)
+{
+	uint32_t i = 0;
+	uint32_t j = 0;
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < patterns[i].count; j++) {
+			Xil_Out32(patterns[i].addr[j], patterns[i].word[j]);
+		}
+	}
+	return;
+}
+
+int gpio_fast_write(uint32_t bank, uint32_t mask, uint32_t value)
+{
+	struct gpio_fast_pattern pattern;
+
+	if ( gpio_fast_pattern_compile(&pattern, bank, mask, value) != 0 ) {
+		return -1;
+	}
+	gpio_fast_pattern_apply(&pattern, 1);
+	return 0;
+}
+
+int gpio_fast_toggle(uint32_t bank, uint32_t mask)
+{
+	uint32_t current = 0;
+
+	if ( bank >= GPIO_FAST_NUM_BANKS ) {
+		return -1;
+	}
+	/*
+	 * DATA reads back what was last driven on outputs, which is what we want to
+	 * invert - DATA_RO would return the pad level and lag behind a slow edge
+	 */
+	current = Xil_In32(GPIO_FAST_DATA(bank));
+	return gpio_fast_write(bank, mask, ~current);
+}
+
+uint32_t gpio_fast_read(uint32_t bank)
+{
+	if ( bank >= GPIO_FAST_NUM_BANKS ) {
+		return 0;
+	}
+	return Xil_In32(GPIO_FAST_DATA_RO(bank));
+}
@@ -0,0 +1,176 @@
+/*
+ * Maximum GPIO toggle rate - XGpioPs pin functions versus gpio_fast
+ *
+ * Each method toggles the same outputs GPIO_BENCH_TOGGLES times with nothing
+ * else in the loop, timed by the 64-bit global timer, so the result is the
+ * fastest edge rate software can produce with that method. A scope on the LED
+ * or PMOD JA is a useful cross check, since a posted store can retire long
+ * before the pad actually moves.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xgpiops.h"
+#include "xtime_l.h"
+
+#include "gpio_fast.h"
+
+#define GPIO_UZED_LED			47
+
+/*
+ * Assumes the block design brings pmod_ja[7:0] out through EMIO GPIO 0-7,
+ * which are pins 54-61 as far as the GPIO controller is concerned
+ */
+#define GPIO_PMOD_JA_BASE		54
+#define GPIO_PMOD_JA_PINS		8
+
+#define GPIO_OUTPUT			1
+#define GPIO_OUTPUT_ENABLE		1
+
+#define GPIO_BENCH_TOGGLES		100000
+
+#define ASCII_ESC			27
+
+static XGpioPs gpio;
+
+static void print_rate(const char *name, uint32_t pins, XTime start, XTime stop)
+{
+	uint64_t ticks = stop - start;
+	uint64_t rate = 0;
+
+	if ( ticks != 0 ) {
+		rate = ((uint64_t) GPIO_BENCH_TOGGLES * COUNTS_PER_SECOND) / ticks;
+	}
+	printf("%-30s%-6"PRIu32"%-14"PRIu64"%-12"PRIu64"\n",
+			name, pins, ticks / GPIO_BENCH_TOGGLES, rate);
+	return;
+}
+
+/* The gpio_toggle_led() approach from gpio_examples.c */
+static void bench_xgpiops_read_write(uint32_t pin)
+{
+	XTime start = 0;
+	XTime stop = 0;
+	uint32_t i = 0;
+
+	XTime_GetTime(&start);
+	for (i = 0; i < GPIO_BENCH_TOGGLES; i++) {
+		XGpioPs_WritePin(&gpio, pin, !XGpioPs_ReadPin(&gpio, pin));
+	}
+	XTime_GetTime(&stop);
+	print_rate("XGpioPs read + write", 1, start, stop);
+	return;
+}
+
+/* Every pin of PMOD JA, one driver call each */
+static void bench_xgpiops_multi(void)
+{
+	XTime start = 0;
+	XTime stop = 0;
+	uint32_t i = 0;
+	uint32_t j = 0;
+	uint32_t level = 0;
+
+	XTime_GetTime(&start);
+	for (i = 0; i < GPIO_BENCH_TOGGLES; i++) {
+		level = !level;
+		for (j = 0; j < GPIO_PMOD_JA_PINS; j++) {
+			XGpioPs_WritePin(&gpio, GPIO_PMOD_JA_BASE + j, level);
+		}
+	}
+	XTime_GetTime(&stop);
+	print_rate("XGpioPs write per pin", GPIO_PMOD_JA_PINS, start, stop);
+	return;
+}
+
+static void bench_fast_toggle(uint32_t bank, uint32_t mask, uint32_t pins)
+{
+	XTime start = 0;
+	XTime stop = 0;
+	uint32_t i = 0;
+
+	XTime_GetTime(&start);
+	for (i = 0; i < GPIO_BENCH_TOGGLES; i++) {
+		gpio_fast_toggle(bank, mask);
+	}
+	XTime_GetTime(&stop);
+	print_rate("gpio_fast_toggle", pins, start, stop);
+	return;
+}
+
+/* Alternate between two precompiled patterns, which is nothing but stores */
+static void bench_fast_pattern(uint32_t bank, uint32_t mask, uint32_t pins)
+{
+	struct gpio_fast_pattern pattern[2];
+	XTime start = 0;
+	XTime stop = 0;
+	uint32_t i = 0;
+
+	gpio_fast_pattern_compile(&pattern[0], bank, mask, 0xFFFFFFFF);
+	gpio_fast_pattern_compile(&pattern[1], bank, mask, 0x00000000);
+
+	XTime_GetTime(&start);
+	for (i = 0; i < GPIO_BENCH_TOGGLES; i++) {
+		gpio_fast_pattern_apply(&pattern[i & 1], 1);
+	}
+	XTime_GetTime(&stop);
+	print_rate("gpio_fast_pattern_apply", pins, start, stop);
+	return;
+}
+
+int main(int args, char *argv[])
+{
+	XGpioPs_Config *gpio_cfg_ptr = NULL;
+	uint32_t led_bank = 0;
+	uint32_t led_bit = 0;
+	uint32_t ja_bank = 0;
+	uint32_t ja_bit = 0;
+	uint32_t i = 0;
+
+	init_platform();
+
+	fprintf(stdout, "%c[2J", ASCII_ESC);
+	fprintf(stdout, "GPIO Toggle Rate\n");
+	fprintf(stdout, "================\n");
+
+	gpio_cfg_ptr = XGpioPs_LookupConfig(XPAR_PS7_GPIO_0_DEVICE_ID);
+	if ( ( gpio_cfg_ptr == NULL ) ||
+			( XGpioPs_CfgInitialize(&gpio, gpio_cfg_ptr, gpio_cfg_ptr->BaseAddr) != XST_SUCCESS ) ) {
+		fprintf(stderr, "Could not initialize GPIO %d\n", XPAR_PS7_GPIO_0_DEVICE_ID);
+		return XST_FAILURE;
+	}
+
+	XGpioPs_SetDirectionPin(&gpio, GPIO_UZED_LED, GPIO_OUTPUT);
+	XGpioPs_SetOutputEnablePin(&gpio, GPIO_UZED_LED, GPIO_OUTPUT_ENABLE);
+	for (i = 0; i < GPIO_PMOD_JA_PINS; i++) {
+		XGpioPs_SetDirectionPin(&gpio, GPIO_PMOD_JA_BASE + i, GPIO_OUTPUT);
+		XGpioPs_SetOutputEnablePin(&gpio, GPIO_PMOD_JA_BASE + i, GPIO_OUTPUT_ENABLE);
+	}
+	gpio_fast_pin_to_bank(GPIO_UZED_LED, &led_bank, &led_bit);
+	gpio_fast_pin_to_bank(GPIO_PMOD_JA_BASE, &ja_bank, &ja_bit);
+
+	printf("%"PRIu32" toggles per method, %"PRIu32" timer ticks per second\n\n",
+			(uint32_t) GPIO_BENCH_TOGGLES, (uint32_t) COUNTS_PER_SECOND);
+	printf("%-30s%-6s%-14s%-12s\n", "Method", "Pins", "Ticks/toggle", "Toggles/sec");
+	printf("%-30s%-6s%-14s%-12s\n", "------", "----", "------------", "-----------");
+
+	bench_xgpiops_read_write(GPIO_UZED_LED);
+	bench_fast_toggle(led_bank, 1u << led_bit, 1);
+	bench_fast_pattern(led_bank, 1u << led_bit, 1);
+
+	bench_xgpiops_multi();
+	bench_fast_toggle(ja_bank, 0xFFu << ja_bit, GPIO_PMOD_JA_PINS);
+	bench_fast_pattern(ja_bank, 0xFFu << ja_bit, GPIO_PMOD_JA_PINS);
+
+	gpio_fast_write(led_bank, 1u << led_bit, 0);
+	fprintf(stdout, "Done.\n");
+	cleanup_platform();
+
+	return XST_SUCCESS;
+}
@@ -0,0 +1,222 @@
+/*
+ * GPIO input that switches between interrupts and budgeted polling
+ *
+ * At low edge rates an interrupt per edge is the cheapest way to notice an
+ * input change. At high rates the same interrupts turn into a storm that leaves
+ * nothing for the rest of the program, while a tight polling loop (what
+ * gpio_examples.c does) burns the core even when the input is idle. This
+ * starts out interrupt driven and counts edges over a fixed window. When a
+ * window gets too busy the handler masks the pins and leaves them to
+ * gpio_hybrid_poll(), which reads them at most poll_budget times per call, so
+ * the cost is set by how often the caller polls rather than by the input. That
+ * has to be often, or polling loses more edges than interrupts did. Once
+ * enough consecutive windows have been quiet, interrupts are turned back on.
+ * The enter and exit thresholds are separate so that an input hovering around
+ * one rate does not flip back and forth.
+ *
+ * Either way, edges are detected as level changes against the last level seen.
+ * The controller latches edges in its status register even while the interrupt
+ * is masked, so a status bit with no level change means the pin went and came
+ * back between two looks. Those are counted as missed rather than ignored.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "gpio_hybrid.h"
+
+int gpio_hybrid_init(struct gpio_hybrid *h, const struct gpio_hybrid_ops *ops, void *ctx,
+		const struct gpio_hybrid_config *config, uint32_t now)
+{
+	if ( ( config->mask == 0 ) || ( config->window == 0 ) || ( config->poll_budget == 0 ) ) {
+		return -1;
+	}
+	h->ops = ops;
+	h->ctx = ctx;
+	h->config = *config;
+	h->on_change = NULL;
+	h->arg = NULL;
+
+	h->irq_window_start = now;
+	h->irq_window_events = 0;
+	h->poll_window_start = now;
+	h->poll_window_events = 0;
+	h->quiet_windows = 0;
+	h->polling_since = now;
+	h->early = 0;
+
+	h->stats.irqs = 0;
+	h->stats.polls = 0;
+	h->stats.reads = 0;
+	h->stats.events_irq = 0;
+	h->stats.events_poll = 0;
+	h->stats.missed = 0;
+	h->stats.to_polling = 0;
+	h->stats.to_interrupt = 0;
+	h->stats.polling_time = 0;
+
+	/* Whatever the pins are doing now is the starting point */
+	h->ops->read_status(h->ctx);
+	h->level = h->ops->read_pins(h->ctx) & h->config.mask;
+
+	if ( h->config.poll_enter == 0 ) {
+		h->mode = GPIO_HYBRID_POLLING;
+		h->ops->irq_disable(h->ctx);
+	} else {
+		h->mode = GPIO_HYBRID_INTERRUPT;
+		h->ops->irq_enable(h->ctx);
+	}
+	return 0;
+}
+
+void gpio_hybrid_set_callback(struct gpio_hybrid *h,
+		void (*on_change)(void *arg, uint32_t changed, uint32_t level), void *arg)
+{
+	h->on_change = on_change;
+	h->arg = arg;
+	return;
+}
+
+/*
+ * Compare a fresh pin level against the last one. Status has to be read before
+ * the pins, so an edge that lands between the two shows up as a level change
+ * now and as a status bit next time. Those are remembered in 'early' so they
+ * are not mistaken for a missed pair. Returns the number of edges known to have
+ * happened, seen or not, which is what the rate windows count.
+ */
+static uint32_t gpio_hybrid_process(struct gpio_hybrid *h, uint32_t status, uint32_t level,
+		uint32_t *events)
+{
+	uint32_t mask = h->config.mask;
+	uint32_t changed = 0;
+	uint32_t missed = 0;
+	uint32_t seen = 0;
+
+	level &= mask;
+	status &= mask;
+	changed = level ^ h->level;
+	missed = status & ~changed & ~h->early;
+	h->early = changed & ~status;
+	h->level = level;
+
+	seen = __builtin_popcount(changed);
+	*events += seen;
+	/* At least one edge each way */
+	h->stats.missed += 2 * __builtin_popcount(missed);
+
+	if ( ( changed != 0 ) && ( h->on_change != NULL ) ) {
+		h->on_change(h->arg, changed, level);
+	}
+	return seen + 2 * __builtin_popcount(missed);
+}
+
+void gpio_hybrid_irq(struct gpio_hybrid *h, uint32_t status, uint32_t now)
+{
+	uint32_t edges = 0;
+
+	h->stats.irqs++;
+	/* Raised just before we masked it, the poll side has the pins now */
+	if ( h->mode != GPIO_HYBRID_INTERRUPT ) {
+		return;
+	}
+	edges = gpio_hybrid_process(h, status, h->ops->read_pins(h->ctx), &h->stats.events_irq);
+
+	if ( ( now - h->irq_window_start ) >= h->config.window ) {
+		h->irq_window_start = now;
+		h->irq_window_events = 0;
+	}
+	h->irq_window_events += edges;
+	if ( h->irq_window_events < h->config.poll_enter ) {
+		return;
+	}
+
+	/* Too busy, stop taking an interrupt per edge */
+	h->ops->irq_disable(h->ctx);
+	h->poll_window_start = now;
+	h->poll_window_events = 0;
+	h->quiet_windows = 0;
+	h->polling_since = now;
+	h->stats.to_polling++;
+	__sync_synchronize();
+	h->mode = GPIO_HYBRID_POLLING;
+	return;
+}
+
+uint32_t gpio_hybrid_poll(struct gpio_hybrid *h, uint32_t now)
+{
+	uint32_t events = 0;
+	uint32_t edges = 0;
+	uint32_t i = 0;
+
+	if ( h->mode != GPIO_HYBRID_POLLING ) {
+		return 0;
+	}
+	h->stats.polls++;
+
+	/* Keep reading while the pins keep changing, but no more than the budget */
+	for (i = 0; i < h->config.poll_budget; i++) {
+		uint32_t status = h->ops->read_status(h->ctx);
+		uint32_t known = 0;
+
+		h->stats.reads++;
+		known = gpio_hybrid_process(h, status, h->ops->read_pins(h->ctx), &events);
+		edges += known;
+		if ( known == 0 ) {
+			break;
+		}
+	}
+	h->stats.events_poll += events;
+	h->poll_window_events += edges;
+
+	if ( ( now - h->poll_window_start ) < h->config.window ) {
+		return events;
+	}
+	if ( h->poll_window_events < h->config.poll_exit ) {
+		h->quiet_windows++;
+	} else {
+		h->quiet_windows = 0;
+	}
+	h->poll_window_start = now;
+	h->poll_window_events = 0;
+	if ( h->quiet_windows < h->config.exit_windows ) {
+		return events;
+	}
+
+	/*
+	 * Quiet again. The handler owns the pins as soon as the mode changes, and
+	 * anything latched from here on raises an interrupt the moment it is enabled.
+	 */
+	h->stats.polling_time += now - h->polling_since;
+	h->stats.to_interrupt++;
+	h->irq_window_start = now;
+	h->irq_window_events = 0;
+	__sync_synchronize();
+	h->mode = GPIO_HYBRID_INTERRUPT;
+	h->ops->irq_enable(h->ctx);
+	return events;
+}
+
+uint64_t gpio_hybrid_polling_time(const struct gpio_hybrid *h, uint32_t now)
+{
+	if ( h->mode == GPIO_HYBRID_POLLING ) {
+		return h->stats.polling_time + (uint32_t) (now - h->polling_since);
+	}
+	return h->stats.polling_time;
+}
+
+void gpio_hybrid_print_stats(const struct gpio_hybrid *h, uint32_t now)
+{
+	printf("%-20s%s\n", "Mode", ( h->mode == GPIO_HYBRID_POLLING ) ? "polling" : "interrupt");
+	printf("%-20s%"PRIu32"\n", "Interrupts", h->stats.irqs);
+	printf("%-20s%"PRIu32"\n", "Polls", h->stats.polls);
+	printf("%-20s%"PRIu32"\n", "Pin reads", h->stats.reads);
+	printf("%-20s%"PRIu32"\n", "Edges (interrupt)", h->stats.events_irq);
+	printf("%-20s%"PRIu32"\n", "Edges (polling)", h->stats.events_poll);
+	printf("%-20s%"PRIu32"\n", "Edges missed", h->stats.missed);
+	printf("%-20s%"PRIu32"\n", "To polling", h->stats.to_polling);
+	printf("%-20s%"PRIu32"\n", "To interrupt", h->stats.to_interrupt);
+	printf("%-20s%"PRIu64"\n", "Time polling", gpio_hybrid_polling_time(h, now));
+	return;
+}
@@ -0,0 +1,152 @@
+/*
+ * Watching a fast or noisy input with the GPIO interrupt/polling hybrid
+ *
+ * Watches PMOD JA through gpio_hybrid and mirrors activity on the LED. The main
+ * loop stands in for an application that calls gpio_hybrid_poll() between other
+ * work, and prints the hybrid statistics once a second, so driving PMOD JA from
+ * a signal generator and turning the frequency up and down shows the switch
+ * to polling and back. examples/gpio_hybrid_bench.c is the host model of the
+ * same thing, for choosing the thresholds.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xgpiops.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "gpio_fast.h"
+#include "gpio_hybrid.h"
+#include "gpio_hybrid_gpiops.h"
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define GPIOPS_DEVICE_ID		XPAR_XGPIOPS_0_DEVICE_ID
+#define GPIO_INTR_ID			XPS_GPIO_INT_ID
+
+#define GPIO_UZED_LED			47
+/* Assumes pmod_ja[7:0] is brought out through EMIO GPIO 0-7, which is bank 2 */
+#define GPIO_PMOD_JA_BANK		2
+#define GPIO_PMOD_JA_MASK		0x000000FF
+
+#define GPIO_OUTPUT			1
+#define GPIO_OUTPUT_ENABLE		1
+
+/* Rates are measured over 1 ms windows */
+#define HYBRID_WINDOW_US		1000
+/* From examples/gpio_hybrid_bench.c, where interrupts cost more than polling every 1us */
+#define HYBRID_POLL_ENTER		300
+#define HYBRID_POLL_EXIT		100
+#define HYBRID_EXIT_WINDOWS		3
+#define HYBRID_POLL_BUDGET		8
+
+#define RUN_SECONDS			30
+
+#define ASCII_ESC			27
+
+static XScuGic gic;
+static XGpioPs gpio;
+static struct gpio_hybrid hybrid;
+static struct gpio_hybrid_gpiops hybrid_ctx;
+
+/* Called from the interrupt handler or from gpio_hybrid_poll(), depending on the mode */
+static void pmod_ja_changed(void *arg, uint32_t changed, uint32_t level)
+{
+	uint32_t bank = 0;
+	uint32_t bit = 0;
+
+	gpio_fast_pin_to_bank(GPIO_UZED_LED, &bank, &bit);
+	gpio_fast_toggle(bank, 1u << bit);
+	return;
+}
+
+static int setup_system(void)
+{
+	XScuGic_Config *gic_config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+	XGpioPs_Config *gpio_config = XGpioPs_LookupConfig(GPIOPS_DEVICE_ID);
+
+	if ( ( gic_config == NULL ) ||
+			( XScuGic_CfgInitialize(&gic, gic_config, gic_config->CpuBaseAddress) != XST_SUCCESS ) ) {
+		fprintf(stderr, "Could not initialize GIC device ID %d\n", GIC_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	if ( ( gpio_config == NULL ) ||
+			( XGpioPs_CfgInitialize(&gpio, gpio_config, gpio_config->BaseAddr) != XST_SUCCESS ) ) {
+		fprintf(stderr, "Could not initialize GPIO device ID %d\n", GPIOPS_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT,
+			(Xil_ExceptionHandler) XScuGic_InterruptHandler, &gic);
+	XScuGic_Connect(&gic, GPIO_INTR_ID, (Xil_ExceptionHandler) XGpioPs_IntrHandler, (void *) &gpio);
+	XGpioPs_SetCallbackHandler(&gpio, (void *) &hybrid, (XGpioPs_Handler) gpio_hybrid_gpiops_handler);
+
+	XGpioPs_SetDirectionPin(&gpio, GPIO_UZED_LED, GPIO_OUTPUT);
+	XGpioPs_SetOutputEnablePin(&gpio, GPIO_UZED_LED, GPIO_OUTPUT_ENABLE);
+	return XST_SUCCESS;
+}
+
+int main(int args, char *argv[])
+{
+	struct gpio_hybrid_config config;
+	uint32_t last_mode = GPIO_HYBRID_INTERRUPT;
+	XTime start = 0;
+	XTime report = 0;
+	XTime now = 0;
+
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("GPIO Interrupt / Polling Hybrid\n");
+	printf("-------------------------------\n");
+
+	if ( setup_system() != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+
+	/* The hybrid is timed by the low word of the global timer */
+	config.mask = GPIO_PMOD_JA_MASK;
+	config.window = (COUNTS_PER_SECOND / 1000000) * HYBRID_WINDOW_US;
+	config.poll_enter = HYBRID_POLL_ENTER;
+	config.poll_exit = HYBRID_POLL_EXIT;
+	config.exit_windows = HYBRID_EXIT_WINDOWS;
+	config.poll_budget = HYBRID_POLL_BUDGET;
+
+	hybrid_ctx.gpio = &gpio;
+	hybrid_ctx.bank = GPIO_PMOD_JA_BANK;
+	if ( gpio_hybrid_gpiops_init(&hybrid, &hybrid_ctx, &config) != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+	gpio_hybrid_set_callback(&hybrid, pmod_ja_changed, NULL);
+
+	XScuGic_Enable(&gic, GPIO_INTR_ID);
+	Xil_ExceptionEnableMask(XIL_EXCEPTION_IRQ);
+
+	XTime_GetTime(&start);
+	report = start;
+	do {
+		/* Other work would go here, and while polling it has to come back within about 1us */
+		gpio_hybrid_poll(&hybrid, gtimer_read_lo());
+
+		if ( hybrid.mode != last_mode ) {
+			last_mode = hybrid.mode;
+			printf("Switched to %s\n", ( last_mode == GPIO_HYBRID_POLLING ) ? "polling" : "interrupts");
+		}
+		XTime_GetTime(&now);
+		if ( ( now - report ) >= COUNTS_PER_SECOND ) {
+			report = now;
+			printf("\n");
+			gpio_hybrid_print_stats(&hybrid, gtimer_read_lo());
+		}
+	} while ( ( now - start ) < (XTime) RUN_SECONDS * COUNTS_PER_SECOND );
+
+	Xil_ExceptionDisableMask(XIL_EXCEPTION_IRQ);
+	cleanup_platform();
+	return XST_SUCCESS;
+}
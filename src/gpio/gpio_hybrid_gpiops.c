@@ -0,0 +1,107 @@
+/*
+ * Binds the interrupt/polling hybrid to one bank of the PS GPIO controller.
+ *
+ * Polling reads the bank registers directly, since each read is on the poll
+ * budget. Interrupts still go through XGpioPs_IntrHandler(), which has already
+ * cleared the status bits it hands to the callback.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xgpiops.h"
+
+#include "gtimer.h"
+#include "gpio_fast.h"
+#include "gpio_hybrid.h"
+#include "gpio_hybrid_gpiops.h"
+
+#define GPIO_DATA_RO(bank)		(GPIO_FAST_BASE + 0x00000060 + ((bank) * 4))
+#define GPIO_INT_EN(bank)		(GPIO_FAST_BASE + 0x00000210 + ((bank) * 0x40))
+#define GPIO_INT_DIS(bank)		(GPIO_FAST_BASE + 0x00000214 + ((bank) * 0x40))
+#define GPIO_INT_STAT(bank)		(GPIO_FAST_BASE + 0x00000218 + ((bank) * 0x40))
+
+#define GPIO_INPUT			0
+
+/* Pins the hybrid was started on, per bank, so only those are enabled and cleared */
+static uint32_t bank_hybrid_mask[GPIO_FAST_NUM_BANKS];
+
+static uint32_t gpiops_read_pins(void *ctx)
+{
+	return Xil_In32(GPIO_DATA_RO(((struct gpio_hybrid_gpiops *) ctx)->bank));
+}
+
+static uint32_t gpiops_read_status(void *ctx)
+{
+	uint32_t bank = ((struct gpio_hybrid_gpiops *) ctx)->bank;
+	uint32_t status = Xil_In32(GPIO_INT_STAT(bank)) & bank_hybrid_mask[bank];
+
+	/* Write one to clear, leaving anything latched for other pins in the bank */
+	Xil_Out32(GPIO_INT_STAT(bank), status);
+	return status;
+}
+
+static void gpiops_irq_enable(void *ctx)
+{
+	uint32_t bank = ((struct gpio_hybrid_gpiops *) ctx)->bank;
+
+	Xil_Out32(GPIO_INT_EN(bank), bank_hybrid_mask[bank]);
+	return;
+}
+
+static void gpiops_irq_disable(void *ctx)
+{
+	uint32_t bank = ((struct gpio_hybrid_gpiops *) ctx)->bank;
+
+	Xil_Out32(GPIO_INT_DIS(bank), bank_hybrid_mask[bank]);
+	return;
+}
+
+const struct gpio_hybrid_ops gpio_hybrid_gpiops_ops = {
+	.read_pins = gpiops_read_pins,
+	.read_status = gpiops_read_status,
+	.irq_enable = gpiops_irq_enable,
+	.irq_disable = gpiops_irq_disable,
+};
+
+int gpio_hybrid_gpiops_init(struct gpio_hybrid *h, struct gpio_hybrid_gpiops *ctx,
+		const struct gpio_hybrid_config *config)
+{
+	uint32_t pin = 0;
+	uint32_t bit = 0;
+
+	if ( ctx->bank >= GPIO_FAST_NUM_BANKS ) {
+		return XST_FAILURE;
+	}
+	bank_hybrid_mask[ctx->bank] = config->mask;
+	gpiops_irq_disable(ctx);
+
+	for (bit = 0; bit < 32; bit++) {
+		if ( ( config->mask & (1u << bit) ) == 0 ) {
+			continue;
+		}
+		pin = gpio_fast_bank_first_pin[ctx->bank] + bit;
+		XGpioPs_SetDirectionPin(ctx->gpio, pin, GPIO_INPUT);
+		XGpioPs_SetIntrTypePin(ctx->gpio, pin, XGPIOPS_IRQ_TYPE_EDGE_BOTH);
+	}
+
+	if ( gpio_hybrid_init(h, &gpio_hybrid_gpiops_ops, ctx, config, gtimer_read_lo()) != 0 ) {
+		fprintf(stderr, "Invalid GPIO hybrid configuration for bank %u\n", (unsigned int) ctx->bank);
+		return XST_FAILURE;
+	}
+	return XST_SUCCESS;
+}
+
+void gpio_hybrid_gpiops_handler(void *callback_ref, u32 bank, u32 status)
+{
+	struct gpio_hybrid *h = callback_ref;
+
+	if ( bank != ((struct gpio_hybrid_gpiops *) h->ctx)->bank ) {
+		return;
+	}
+	gpio_hybrid_irq(h, status, gtimer_read_lo());
+	return;
+}
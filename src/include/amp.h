@@ -0,0 +1,95 @@
+#ifndef AMP_H_
+#define AMP_H_
+
+#include <stdint.h>
+
+#include "amp_queue.h"
+#include "ocm_map.h"
+
+/*
+ * Asymmetric multiprocessing - CPU0 runs the time critical program and CPU1
+ * runs a service loop (amp_cpu1.c) that owns the UART and the XADC. The two
+ * only share the block below in OCM, made non-cacheable by both cores before
+ * use, so nothing ever has to be flushed or invalidated for it.
+ *
+ * Both programs are built as standalone applications, CPU1 against a BSP with
+ * USE_AMP=1 (so it leaves the GIC and the L2 cache to CPU0) and linked at
+ * AMP_CPU1_ENTRY, clear of CPU0's DDR. CPU0 releases it from the BootROM wait
+ * loop with amp_cpu0_start().
+ */
+
+#define AMP_MAGIC			0x414D5031
+#define AMP_SHARED_BASE			OCM_AMP_BASE
+
+/* Where the BootROM looks for CPU1's entry point when woken by SEV */
+#define AMP_CPU1_RELEASE_ADDR		0xFFFFFFF0
+#define AMP_CPU1_ENTRY			0x02000000
+
+#define AMP_CPU1_OFF			0
+#define AMP_CPU1_READY			1
+
+/* CPU0 to CPU1 */
+#define AMP_MSG_LOG			1
+#define AMP_MSG_TEXT			2
+#define AMP_MSG_DUMP			3
+/* CPU1 to CPU0 */
+#define AMP_MSG_XADC			16
+
+#define AMP_LOG_ARGS			6
+
+/*
+ * The format string is only a pointer, and is formatted by CPU1 from CPU0's
+ * copy, so it has to be a string literal. The arguments are 32-bit words, so
+ * integers or, for %s, more string literals.
+ */
+struct amp_log {
+	const char *fmt;
+	uint32_t args[AMP_LOG_ARGS];
+};
+
+/* Words from a physical address, printed by CPU1 as a hex dump */
+struct amp_dump {
+	uint32_t addr;
+	uint32_t words;
+};
+
+#define AMP_XADC_TEMP			0
+#define AMP_XADC_VCCINT			1
+#define AMP_XADC_VCCAUX			2
+#define AMP_XADC_VCCBRAM		3
+#define AMP_XADC_VCCPINT		4
+#define AMP_XADC_VCCPAUX		5
+#define AMP_XADC_VCCPDRO		6
+#define AMP_XADC_CHANNELS		7
+
+/* Raw 16-bit conversions, so CPU0 never has to touch the XADC driver */
+struct amp_xadc {
+	uint16_t raw[AMP_XADC_CHANNELS];
+	uint32_t sample;
+};
+
+struct amp_shared {
+	uint32_t magic;
+	volatile uint32_t cpu1_state;
+	/* CPU1 service loop passes, a sign of life */
+	volatile uint32_t cpu1_loops;
+	/* How often CPU1 samples the XADC */
+	uint32_t xadc_period_ms;
+	uint8_t pad[AMP_QUEUE_LINE - 16];
+	struct amp_queue to_cpu1;
+	struct amp_queue to_cpu0;
+};
+
+/* Pads out the arguments, AMP_LOG("Count %u\n", count) */
+#define AMP_LOG(...)			amp_log_args(__VA_ARGS__, 0, 0, 0, 0, 0, 0)
+
+/* CPU0 side, amp_cpu0.c. Nothing here waits, a full queue is a dropped message */
+int amp_cpu0_start(uint32_t xadc_period_ms);
+int amp_log_args(const char *fmt, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4,
+		uint32_t a5, ...);
+int amp_text(const char *text);
+int amp_dump(uint32_t addr, uint32_t words);
+int amp_get_xadc(struct amp_xadc *xadc);
+uint32_t amp_dropped(void);
+
+#endif /* AMP_H_ */
@@ -0,0 +1,65 @@
+#ifndef AMP_QUEUE_H_
+#define AMP_QUEUE_H_
+
+#include <stdint.h>
+
+/*
+ * Single producer, single consumer queue of fixed size messages in memory shared
+ * between two cores (or two threads, for the host benchmark). The queue itself
+ * holds only what both sides have to see. Each side keeps its own index and its
+ * last look at the other side's index in a producer or consumer handle in its
+ * own memory, so the shared indices are only read when the cached one says the
+ * queue is full or empty. On the board the shared memory is uncached OCM,
+ * where every read is a round trip to the interconnect.
+ */
+
+/* Must be a power of two */
+#define AMP_QUEUE_LEN			128
+#define AMP_QUEUE_MSG_SIZE		64
+/* Covers both the Cortex-A9 (32 byte) and host (64 byte) cache lines */
+#define AMP_QUEUE_LINE			64
+
+struct amp_msg {
+	uint32_t type;
+	uint32_t timestamp;
+	uint8_t data[AMP_QUEUE_MSG_SIZE - 8];
+};
+
+struct amp_queue {
+	/* Written by the producer only */
+	volatile uint32_t head;
+	volatile uint32_t dropped;
+	uint8_t pad0[AMP_QUEUE_LINE - 8];
+	/* Written by the consumer only */
+	volatile uint32_t tail;
+	uint8_t pad1[AMP_QUEUE_LINE - 4];
+	struct amp_msg slots[AMP_QUEUE_LEN];
+};
+
+struct amp_producer {
+	struct amp_queue *q;
+	uint32_t head;
+	uint32_t tail_seen;
+	uint32_t put;
+	uint32_t dropped;
+};
+
+struct amp_consumer {
+	struct amp_queue *q;
+	uint32_t tail;
+	uint32_t head_seen;
+	uint32_t got;
+};
+
+/* Done once, by one side, before either attaches */
+void amp_queue_init(struct amp_queue *q);
+
+void amp_producer_attach(struct amp_producer *p, struct amp_queue *q);
+void amp_consumer_attach(struct amp_consumer *c, struct amp_queue *q);
+
+/* Never waits - returns 0, or -1 and counts a drop if the queue is full */
+int amp_queue_put(struct amp_producer *p, const struct amp_msg *msg);
+/* Returns 1 and fills in msg if one was waiting */
+int amp_queue_get(struct amp_consumer *c, struct amp_msg *msg);
+
+#endif /* AMP_QUEUE_H_ */
@@ -0,0 +1,86 @@
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Buffered, interrupt-driven console output
+ *
+ * Writes go into a ring buffer and return; the UART's interrupt moves them
+ * into its FIFO as it empties. Until console_start() there is no interrupt,
+ * and writes go straight to the FIFO, waiting on it as stdio does, so the
+ * console can be used from the first line of main(). When the ring is full a
+ * write either drops what does not fit (CONSOLE_DROP) or waits for room
+ * (CONSOLE_BLOCK). Waiting with interrupts masked, in a handler say, would
+ * never end, so there the console drains the ring by polling instead.
+ *
+ * console_panic() is for when nothing else is going to run again: it masks
+ * interrupts for good and polls out whatever is still in the ring, then
+ * everything after it. The UART itself is behind console_ops; see
+ * console_uartps.h for the Zynq PS UART.
+ */
+
+/* Must be a power of two */
+#ifndef CONSOLE_BUF_LEN
+#define CONSOLE_BUF_LEN			4096
+#endif
+/* Longest console_printf() output, anything past it is cut off */
+#define CONSOLE_LINE_LEN		256
+
+#define CONSOLE_DROP			0
+#define CONSOLE_BLOCK			1
+
+struct console_ops {
+	/* Mask the console's interrupt, returning non-zero if it was already masked */
+	uint32_t (*lock)(void *ctx);
+	void (*unlock)(void *ctx, uint32_t state);
+	int (*tx_full)(void *ctx);
+	void (*tx_put)(void *ctx, uint8_t c);
+	/* Everything sent, FIFO and shift register both empty */
+	int (*tx_idle)(void *ctx);
+	/* Interrupt for the FIFO running empty */
+	void (*tx_irq)(void *ctx, int enable);
+};
+
+struct console_stats {
+	uint32_t written;
+	uint32_t dropped;
+	/* Writes that had to wait for room, and those that drained by polling */
+	uint32_t blocked;
+	uint32_t polled;
+	uint32_t high_water;
+	uint32_t irqs;
+};
+
+struct console {
+	const struct console_ops *ops;
+	void *ctx;
+	uint32_t policy;
+	/* Free running, the ring index is taken modulo CONSOLE_BUF_LEN */
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	volatile uint32_t tx_active;
+	uint32_t started;
+	uint32_t panicked;
+	struct console_stats stats;
+	uint8_t buf[CONSOLE_BUF_LEN];
+};
+
+void console_init(struct console *con, const struct console_ops *ops, void *ctx, uint32_t policy);
+/* Once the interrupt is connected and enabled, switches from polling to the ring buffer */
+void console_start(struct console *con);
+
+/* Returns how many bytes were taken, which is less than len only when dropping */
+size_t console_write(struct console *con, const void *data, size_t len);
+int console_printf(struct console *con, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+/* Waits until everything written so far has left the UART */
+void console_flush(struct console *con);
+void console_panic(struct console *con);
+
+/* From the UART interrupt handler */
+void console_tx_isr(struct console *con);
+
+void console_get_stats(const struct console *con, struct console_stats *stats);
+
+#endif /* CONSOLE_H_ */
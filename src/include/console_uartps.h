@@ -0,0 +1,26 @@
+#ifndef CONSOLE_UARTPS_H_
+#define CONSOLE_UARTPS_H_
+
+#include <stdint.h>
+
+#include "xscugic.h"
+
+#include "console.h"
+
+/*
+ * console.h on the PS UART that the BSP uses for stdout (UART1 on the
+ * MicroZed). This file also takes over the BSP's outbyte(), so printf() and
+ * xil_printf() go through the same ring and stay in order with
+ * console_printf().
+ */
+
+extern struct console console_uart;
+
+/* Polled output from here on, usable before the GIC is set up */
+void console_uartps_init(uint32_t policy);
+/* Connects the UART interrupt and switches to buffered output */
+int console_uartps_start(XScuGic *gic);
+/* Flushes what is buffered with interrupts masked for good, then prints msg */
+void console_uartps_panic(const char *msg);
+
+#endif /* CONSOLE_UARTPS_H_ */
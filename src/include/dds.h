@@ -0,0 +1,96 @@
+#ifndef DDS_H_
+#define DDS_H_
+
+#include <stdint.h>
+
+#include "pwm.h"
+
+/*
+ * Direct digital synthesis on a PWM channel of pwm.h
+ *
+ * The channel runs as configured by pwm_configure(), in interval and match
+ * mode with the waveform high until match 1 (0x4A in CNT_CTRL, as in
+ * ttc_pwm.c), and its period is the sample period. On every interval
+ * interrupt the handler writes the next sample to match 1, so the duty cycle
+ * follows the waveform and a low-pass filter on the output gives it back.
+ *
+ * A 32-bit phase accumulator steps through a table of 2^n samples (n from
+ * DDS_TABLE_MIN_LOG2 to DDS_TABLE_MAX_LOG2) by the tuning word each sample,
+ * with or without linear interpolation between neighbouring entries. The
+ * table holds match values ready to write, between the pwm_sync_enable()
+ * guard and one short of the period, so the handler does no scaling and its
+ * match always lands ahead of the count. The handler writes the sample it
+ * worked out last time first, then works out the next one, which keeps the
+ * write as soon after the interrupt as it can be.
+ *
+ * Floating point is only used setting up, never in the handler.
+ */
+
+#define DDS_TABLE_MIN_LOG2		2
+#define DDS_TABLE_MAX_LOG2		12
+
+/* Arbitrary waveforms are given as signed 16-bit samples, full scale */
+#define DDS_SAMPLE_MIN			-32768
+#define DDS_SAMPLE_MAX			32767
+
+struct dds {
+	struct pwm_engine *engine;
+	uint32_t channel;
+
+	uint32_t phase;
+	uint32_t step;
+	/* 32 - table_log2, the phase bits that index the table */
+	uint32_t shift;
+	uint32_t table_log2;
+	uint32_t interp;
+	/* Written by the next interrupt */
+	uint32_t next_match;
+
+	/* Match range the table is scaled to */
+	uint32_t lo;
+	uint32_t hi;
+
+	uint32_t samples;
+	/* One extra entry, a copy of the first, so interpolation never wraps the index */
+	uint16_t table[(1 << DDS_TABLE_MAX_LOG2) + 1];
+};
+
+/*
+ * Takes over a configured channel: enables its interval interrupt through
+ * pwm_sync_enable() with latency_ticks, and starts on a flat table at mid
+ * scale. Connect the interrupt to dds_isr() (dds_ttc.h on the board) rather
+ * than to pwm_isr().
+ */
+int dds_init(struct dds *dds, struct pwm_engine *engine, uint32_t channel, uint32_t latency_ticks);
+
+/* 2^table_log2 samples from DDS_SAMPLE_MIN to DDS_SAMPLE_MAX, scaled to the match range */
+int dds_set_table(struct dds *dds, const int16_t *samples, uint32_t table_log2);
+/* A sine of amplitude_ppm of full scale */
+int dds_set_sine(struct dds *dds, uint32_t table_log2, uint32_t amplitude_ppm);
+/* Output frequency, below half the sample rate */
+int dds_set_freq(struct dds *dds, uint64_t freq_mhz);
+void dds_set_interp(struct dds *dds, uint32_t interp);
+
+/* Sample rate in millihertz, the channel's PWM frequency */
+uint64_t dds_sample_rate_mhz(const struct dds *dds);
+
+/* Interval interrupt handler through pwm_ops, for the host model */
+void dds_isr(struct dds *dds);
+
+/* The next sample as a match value, and on to the one after */
+static inline uint32_t dds_next(struct dds *dds)
+{
+	uint32_t i = dds->phase >> dds->shift;
+	uint32_t match = dds->table[i];
+	int32_t frac = 0;
+
+	if ( dds->interp ) {
+		/* 15 bits of the phase below the index, so the product fits in 32 */
+		frac = (dds->phase << dds->table_log2) >> 17;
+		match += ((int32_t) (dds->table[i + 1] - match) * frac) >> 15;
+	}
+	dds->phase += dds->step;
+	return match;
+}
+
+#endif /* DDS_H_ */
@@ -0,0 +1,15 @@
+#ifndef DDS_TTC_H_
+#define DDS_TTC_H_
+
+#include "xscugic.h"
+
+#include "dds.h"
+
+/*
+ * dds.h on the board: connects the channel's TTC interrupt to a handler that
+ * goes straight to the registers rather than through pwm_ops, two accesses
+ * and dds_next() in all
+ */
+int dds_ttc_connect(struct dds *dds, XScuGic *gic);
+
+#endif /* DDS_TTC_H_ */
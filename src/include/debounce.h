@@ -0,0 +1,73 @@
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <stdint.h>
+
+/*
+ * Nothing in here (or in debounce.c) refers to the Xilinx drivers, so the state
+ * machine can be built on the host and driven by synthetic pin traces. The
+ * XGpioPs / private timer binding lives in debounce_gpiops.c.
+ */
+
+#define DEBOUNCE_MAX_PINS		8
+/* Must be a power of two */
+#define DEBOUNCE_QUEUE_LEN		16
+
+#define DEBOUNCE_RELEASE		0
+#define DEBOUNCE_PRESS			1
+
+struct debounce_event {
+	uint32_t pin;
+	uint32_t type;
+	/* Value of the sample tick counter when the new state was accepted */
+	uint32_t tick;
+};
+
+/* Pin access - mask must also discard any interrupt latched for the pin */
+struct debounce_ops {
+	uint32_t (*read_pin)(void *ctx, uint32_t pin);
+	void (*mask_pin)(void *ctx, uint32_t pin);
+	void (*unmask_pin)(void *ctx, uint32_t pin);
+};
+
+struct debounce_pin {
+	uint32_t pin;
+	/* Pin level that means 'pressed' */
+	uint32_t active_level;
+	/* Consecutive identical samples needed before a new level is believed */
+	uint32_t samples;
+	/* Debounced level and the level currently being counted */
+	uint32_t level;
+	uint32_t candidate;
+	uint32_t count;
+	/* Set by an edge, cleared by the sampler once the pin has settled */
+	volatile uint32_t armed;
+};
+
+struct debounce {
+	const struct debounce_ops *ops;
+	void *ctx;
+
+	struct debounce_pin pins[DEBOUNCE_MAX_PINS];
+	uint32_t num_pins;
+	uint32_t tick;
+
+	/* Single producer (the sampler) and single consumer event queue */
+	struct debounce_event queue[DEBOUNCE_QUEUE_LEN];
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint32_t dropped;
+};
+
+void debounce_init(struct debounce *db, const struct debounce_ops *ops, void *ctx);
+int debounce_add_pin(struct debounce *db, uint32_t pin, uint32_t active_level, uint32_t samples);
+
+/* Interrupt side - never blocks, only masks the pin and arms the sampler */
+int debounce_edge(struct debounce *db, uint32_t pin);
+/* Timer side - call once per sample period */
+void debounce_tick(struct debounce *db);
+
+/* Thread side - returns 1 and fills in event if one was waiting */
+int debounce_get_event(struct debounce *db, struct debounce_event *event);
+
+#endif /* DEBOUNCE_H_ */
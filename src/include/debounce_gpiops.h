@@ -0,0 +1,22 @@
+#ifndef DEBOUNCE_GPIOPS_H_
+#define DEBOUNCE_GPIOPS_H_
+
+#include "xgpiops.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+
+#include "debounce.h"
+
+/* Pin access through the XGpioPs driver, the context is the XGpioPs instance */
+extern const struct debounce_ops debounce_gpiops_ops;
+
+/* Hand every registered pin with a pending interrupt to the debouncer */
+uint32_t debounce_gpiops_edges(struct debounce *db, uint32_t bank, uint32_t status);
+/* Same thing, usable directly with XGpioPs_SetCallbackHandler() */
+void debounce_gpiops_handler(void *callback_ref, u32 bank, u32 status);
+
+/* Run debounce_tick() from the private timer interrupt every period_us */
+int debounce_gpiops_tick_init(struct debounce *db, XScuGic *gic, XScuTimer *timer,
+		uint32_t period_us);
+
+#endif /* DEBOUNCE_GPIOPS_H_ */
@@ -0,0 +1,91 @@
+#ifndef DEFERRED_H_
+#define DEFERRED_H_
+
+#include <stdint.h>
+
+/*
+ * Deferred work for interrupt handlers. A handler does the minimum with IRQs
+ * masked (acknowledge, capture, count) and queues a work item for the rest,
+ * which deferred_run() later calls from the main loop or a task.
+ *
+ * Work items belong to whoever queues them, usually as a static next to the
+ * driver state, so queueing never allocates and never fails. A work item that
+ * is queued again before it has run is only run once. Handlers that want every
+ * occurrence seen have to count them in their own state, the way the GPIO
+ * status bits are accumulated.
+ *
+ * Like the other portable modules there is nothing Xilinx in here. Time comes
+ * from the clock passed to deferred_init(), in whatever units it counts.
+ */
+
+/* Priority 0 runs first */
+#define DEFERRED_PRIORITIES		4
+
+#define DEFERRED_PRIO_HIGH		0
+#define DEFERRED_PRIO_NORMAL		1
+#define DEFERRED_PRIO_LOW		2
+#define DEFERRED_PRIO_IDLE		3
+
+struct deferred_work {
+	/* Link in the queue, owned by the queue while pending */
+	struct deferred_work *volatile next;
+	void (*func)(void *arg);
+	void *arg;
+	uint32_t priority;
+	volatile uint32_t pending;
+	uint32_t queued_at;
+	const char *name;
+};
+
+struct deferred_stats {
+	uint32_t queued;
+	/* Queued again while still pending */
+	uint32_t coalesced;
+	uint32_t run;
+	uint32_t max_depth;
+	/* Time from queueing to the start of the work, and time spent in it */
+	uint64_t latency;
+	uint32_t max_latency;
+	uint32_t max_run;
+};
+
+/*
+ * Intrusive multiple producer, single consumer queue (Vyukov). Producers only
+ * swap the head, so a handler that preempts another producer, or nests inside
+ * one, still gets its item in without waiting.
+ */
+struct deferred_queue {
+	struct deferred_work *volatile head;
+	struct deferred_work *tail;
+	struct deferred_work stub;
+	volatile uint32_t depth;
+	struct deferred_stats stats;
+};
+
+struct deferred {
+	struct deferred_queue queues[DEFERRED_PRIORITIES];
+	uint32_t (*clock)(void);
+};
+
+/* clock may be NULL, in which case no times are recorded */
+void deferred_init(struct deferred *d, uint32_t (*clock)(void));
+int deferred_work_init(struct deferred_work *work, const char *name, void (*func)(void *arg),
+		void *arg, uint32_t priority);
+
+/*
+ * Safe from any interrupt handler or thread on this core. Returns 1 if the work
+ * was queued, 0 if it was already pending.
+ */
+int deferred_queue(struct deferred *d, struct deferred_work *work);
+
+/*
+ * Runs up to budget work items, highest priority first, checking again from the
+ * top after each one so that urgent work queued meanwhile goes next. Only ever
+ * called from one context. Returns the number run.
+ */
+uint32_t deferred_run(struct deferred *d, uint32_t budget);
+
+uint32_t deferred_pending(const struct deferred *d);
+void deferred_print_stats(const struct deferred *d);
+
+#endif /* DEFERRED_H_ */
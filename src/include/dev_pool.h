@@ -0,0 +1,56 @@
+#ifndef DEV_POOL_H_
+#define DEV_POOL_H_
+
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xscuwdt.h"
+#include "xttcps.h"
+#include "xgpiops.h"
+
+/*
+ * Statically allocated driver instances for the PS peripherals
+ *
+ * One instance per device ID, sized at compile time from the BSP's
+ * xparameters.h and living in .bss, so no driver path needs the heap. Each
+ * instance starts on a cache line of its own, which keeps an instance that is
+ * shared with the other core or flushed around DMA from sharing a line with
+ * anything else. Asking for the same device ID twice gives the same instance,
+ * so a module can look up the GIC rather than have it passed down; the caller
+ * still runs the driver's CfgInitialize() on it.
+ *
+ * Returns NULL for a device ID the BSP does not have. dev_pool_report() prints
+ * what the pools take against what the same instances cost from malloc().
+ */
+
+/* Cortex-A9 L1 and PL310 line size */
+#define DEV_POOL_ALIGN			32
+
+#ifndef DEV_POOL_GIC_COUNT
+#define DEV_POOL_GIC_COUNT		XPAR_XSCUGIC_NUM_INSTANCES
+#endif
+#ifndef DEV_POOL_SCUTIMER_COUNT
+#define DEV_POOL_SCUTIMER_COUNT		XPAR_XSCUTIMER_NUM_INSTANCES
+#endif
+#ifndef DEV_POOL_SCUWDT_COUNT
+#define DEV_POOL_SCUWDT_COUNT		XPAR_XSCUWDT_NUM_INSTANCES
+#endif
+/* Three counters per TTC, each its own device ID */
+#ifndef DEV_POOL_TTC_COUNT
+#define DEV_POOL_TTC_COUNT		XPAR_XTTCPS_NUM_INSTANCES
+#endif
+#ifndef DEV_POOL_GPIOPS_COUNT
+#define DEV_POOL_GPIOPS_COUNT		XPAR_XGPIOPS_NUM_INSTANCES
+#endif
+
+XScuGic *dev_pool_gic(uint16_t device_id);
+XScuTimer *dev_pool_scutimer(uint16_t device_id);
+XScuWdt *dev_pool_scuwdt(uint16_t device_id);
+XTtcPs *dev_pool_ttc(uint16_t device_id);
+XGpioPs *dev_pool_gpiops(uint16_t device_id);
+
+void dev_pool_report(void);
+
+#endif /* DEV_POOL_H_ */
@@ -0,0 +1,81 @@
+#ifndef EDGE_CAPTURE_H_
+#define EDGE_CAPTURE_H_
+
+#include <stdint.h>
+
+/*
+ * Like debounce.h, this is free of Xilinx driver references so the capture
+ * ring and the pulse arithmetic can be exercised on the host. The GPIO
+ * interrupt handler lives in edge_capture_gpiops.c.
+ */
+
+#define EDGE_CAPTURE_MAX_PINS		8
+/* Must be a power of two */
+#define EDGE_CAPTURE_RING_LEN		1024
+
+#define EDGE_CAPTURE_FALLING		0x0
+#define EDGE_CAPTURE_RISING		0x1
+/* Set on the first sample after edges were lost, so widths are not measured across it */
+#define EDGE_CAPTURE_GAP		0x2
+
+struct edge_sample {
+	uint64_t timestamp;
+	uint32_t pin;
+	uint32_t edge;
+};
+
+struct edge_capture {
+	/* Single producer (the GPIO handler) and single consumer ring */
+	struct edge_sample ring[EDGE_CAPTURE_RING_LEN];
+	volatile uint32_t head;
+	volatile uint32_t tail;
+
+	uint32_t pins[EDGE_CAPTURE_MAX_PINS];
+	uint32_t level[EDGE_CAPTURE_MAX_PINS];
+	uint32_t gap[EDGE_CAPTURE_MAX_PINS];
+	uint32_t num_pins;
+
+	uint32_t captured;
+	/* Edges dropped because the ring was full */
+	uint32_t lost_full;
+	/* Edges that must have happened since the level did not alternate */
+	uint32_t lost_coalesced;
+};
+
+/* Running statistics of one kind of interval, in timer ticks */
+struct edge_stat {
+	uint32_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+	double sum_sq;
+};
+
+/* Pulse measurements for one pin, fed from the capture ring */
+struct edge_pulse {
+	uint64_t last_rise;
+	uint64_t last_fall;
+	int have_rise;
+	int have_fall;
+	struct edge_stat high;
+	struct edge_stat low;
+	struct edge_stat period;
+};
+
+void edge_capture_init(struct edge_capture *ec);
+int edge_capture_add_pin(struct edge_capture *ec, uint32_t pin, uint32_t level);
+
+/* Interrupt side - record the level a pin was found at after an edge */
+void edge_capture_record(struct edge_capture *ec, uint32_t pin, uint32_t level, uint64_t timestamp);
+/* Thread side - returns 1 and fills in sample if one was waiting */
+int edge_capture_get(struct edge_capture *ec, struct edge_sample *sample);
+
+void edge_pulse_init(struct edge_pulse *pulse);
+void edge_pulse_update(struct edge_pulse *pulse, const struct edge_sample *sample);
+
+double edge_stat_mean(const struct edge_stat *stat);
+double edge_stat_stddev(const struct edge_stat *stat);
+/* Frequency from the mean period, given the timestamp clock rate */
+double edge_pulse_frequency(const struct edge_pulse *pulse, double ticks_per_sec);
+
+#endif /* EDGE_CAPTURE_H_ */
@@ -0,0 +1,20 @@
+#ifndef EDGE_CAPTURE_GPIOPS_H_
+#define EDGE_CAPTURE_GPIOPS_H_
+
+#include "xgpiops.h"
+#include "xscugic.h"
+
+#include "edge_capture.h"
+
+/* Time spent in the GPIO handler itself, in global timer ticks */
+struct edge_capture_isr_cost {
+	uint32_t count;
+	uint32_t max;
+	uint64_t sum;
+};
+
+int edge_capture_gpiops_init(struct edge_capture *ec, XScuGic *gic);
+int edge_capture_gpiops_add_pin(struct edge_capture *ec, XGpioPs *gpio, uint32_t pin);
+void edge_capture_gpiops_isr_cost(struct edge_capture_isr_cost *cost);
+
+#endif /* EDGE_CAPTURE_GPIOPS_H_ */
@@ -0,0 +1,30 @@
+#ifndef FIQ_H_
+#define FIQ_H_
+
+#include <stdint.h>
+
+#include "xscugic.h"
+
+/*
+ * Fast interrupt path for one chosen source
+ *
+ * The chosen interrupt is left in group 0 and signalled as FIQ, while every
+ * other interrupt is moved to group 1 and keeps going through IRQ and the GIC
+ * driver as before. The FIQ vector branches straight to a small handler here,
+ * so there is no exception table lookup, no driver and no handler table walk
+ * between the interrupt and the function given to fiq_init().
+ *
+ * fiq_init() also raises the source to the highest priority, 0x00, so it is
+ * still signalled while an IRQ handler runs at the default priority. It fails
+ * if any other source is already at 0x00, and every other source has to stay
+ * below it afterwards. fiq_release() puts the old priority back.
+ *
+ * That function runs in FIQ mode with IRQs masked and FIQs still pending. It
+ * must clear the interrupt at its source, must not use floating point, and
+ * should be short - it preempts every IRQ handler in the system.
+ */
+int fiq_init(XScuGic *gic, uint32_t intr_id, void (*handler)(void));
+/* Put the source back on the IRQ path and restore the original FIQ vector */
+void fiq_release(XScuGic *gic);
+
+#endif /* FIQ_H_ */
@@ -0,0 +1,87 @@
+#ifndef FLIGHT_REC_H_
+#define FLIGHT_REC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "gtimer.h"
+
+/*
+ * Always-on flight recorder
+ *
+ * A ring of fixed size entries at a fixed OCM address (see ocm_map.h) that
+ * survives a watchdog reset. The layout below is also what the host decoder
+ * (examples/flight_rec_decode.c) understands, so any change to it needs
+ * FLIGHT_REC_VERSION bumped.
+ */
+
+#define FLIGHT_REC_MAGIC		0x464C5452
+#define FLIGHT_REC_VERSION		1
+/* Must be a power of two */
+#define FLIGHT_REC_LEN			512
+
+/* Event types, data is given for each */
+#define FLIGHT_REC_BOOT			0x01	/* boot count */
+#define FLIGHT_REC_IRQ_ENTRY		0x02	/* interrupt ID */
+#define FLIGHT_REC_IRQ_EXIT		0x03	/* interrupt ID */
+#define FLIGHT_REC_TIMER		0x04	/* caller defined timer number */
+#define FLIGHT_REC_WDT_CHECKIN		0x05	/* supervisor client ID */
+#define FLIGHT_REC_WDT_KICK		0x06	/* number of kicks so far */
+#define FLIGHT_REC_WDT_LATE		0x07	/* supervisor client ID */
+#define FLIGHT_REC_MARKER		0x08	/* anything */
+
+/* A sequence number of zero marks a slot that was never written */
+struct flight_rec_entry {
+	uint32_t seq;
+	uint32_t timestamp;
+	uint32_t type;
+	uint32_t data;
+};
+
+struct flight_rec {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t len;
+	/* Timestamp clock, so the decoder can turn ticks into time */
+	uint32_t timer_hz;
+	uint32_t boot_count;
+	uint32_t reserved[3];
+	struct flight_rec_entry entries[FLIGHT_REC_LEN];
+};
+
+/* NULL until flight_rec_init(), so logging before then costs one load and a branch */
+extern struct flight_rec *flight_rec_active;
+extern volatile uint32_t flight_rec_seq;
+
+/*
+ * The sequence counter lives in ordinary cached memory, where an exclusive
+ * load / store pair is cheap and safe against an interrupt handler logging in
+ * the middle. The sequence number is stored last, so an entry torn by a reset
+ * looks like the old one rather than like a new one with garbage in it.
+ */
+static inline void flight_rec_log(uint32_t type, uint32_t data)
+{
+	struct flight_rec *rec = flight_rec_active;
+	struct flight_rec_entry *entry = NULL;
+	uint32_t seq = 0;
+
+	if ( rec == NULL ) {
+		return;
+	}
+	seq = __sync_add_and_fetch(&flight_rec_seq, 1);
+	entry = &rec->entries[seq & (FLIGHT_REC_LEN - 1)];
+	entry->timestamp = gtimer_read_lo();
+	entry->type = type;
+	entry->data = data;
+	__asm__ volatile ("" ::: "memory");
+	entry->seq = seq;
+}
+
+/* Nonzero if mem holds a recorder with a layout this code understands */
+int flight_rec_valid(const struct flight_rec *rec);
+/* Clear the ring and start logging into it, carrying the boot count over if valid */
+void flight_rec_init(struct flight_rec *rec, uint32_t timer_hz);
+/* Print every entry, oldest first, in the form the host decoder reads */
+void flight_rec_dump(const struct flight_rec *rec);
+
+#endif /* FLIGHT_REC_H_ */
@@ -0,0 +1,17 @@
+#ifndef FLIGHT_REC_ZYNQ_H_
+#define FLIGHT_REC_ZYNQ_H_
+
+#include "xscuwdt.h"
+
+#include "flight_rec.h"
+
+/*
+ * Map the recorder, dump the previous run's buffer if the private watchdog
+ * caused the last reset, then start a new run. Returns 1 if a dump was made.
+ */
+int flight_rec_zynq_boot(XScuWdt *wdt);
+
+/* Drop-in for XScuGic_InterruptHandler() that logs IRQ entry and exit */
+void flight_rec_zynq_irq_handler(void *gic);
+
+#endif /* FLIGHT_REC_ZYNQ_H_ */
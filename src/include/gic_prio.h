@@ -0,0 +1,52 @@
+#ifndef GIC_PRIO_H_
+#define GIC_PRIO_H_
+
+#include <stdint.h>
+
+#include "xil_exception.h"
+#include "xscugic.h"
+
+/*
+ * The Zynq GIC implements the top five bits of each priority byte, so there are
+ * 32 levels in steps of 8. Lower is more urgent. The driver leaves the priority
+ * mask at 0xF0, so anything at 0xF0 or above is never signalled at all.
+ */
+#define GIC_PRIO_HIGHEST		0x00
+#define GIC_PRIO_LOWEST			0xE8
+#define GIC_PRIO_DEFAULT		0xA0
+#define GIC_PRIO_STEP			0x08
+#define GIC_PRIO_MASK			0xF8
+
+/* Target CPU bits, only meaningful for shared peripheral interrupts (ID 32 and up) */
+#define GIC_PRIO_CPU0			0x01
+#define GIC_PRIO_CPU1			0x02
+
+struct gic_prio_entry {
+	uint32_t id;
+	uint8_t priority;
+	/* Zero leaves the current targets alone */
+	uint8_t targets;
+};
+
+/*
+ * Set priority and CPU targets for a whole table of sources. Four sources
+ * share each distributor word, so every word involved is read once, updated
+ * for all its sources and written back once, instead of a read-modify-write
+ * per source and per field as XScuGic_SetPriorityTriggerType() does.
+ * Returns the number of distributor writes, or -1 for a bad entry.
+ */
+int gic_prio_apply(XScuGic *gic, const struct gic_prio_entry *table, uint32_t count);
+
+/*
+ * A handler that lets higher priority interrupts in while it runs. Connect
+ * with gic_prio_connect_nested() instead of XScuGic_Connect().
+ */
+struct gic_prio_nested {
+	Xil_InterruptHandler handler;
+	void *callback_ref;
+};
+
+int gic_prio_connect_nested(XScuGic *gic, uint32_t id, struct gic_prio_nested *nested,
+		Xil_InterruptHandler handler, void *callback_ref);
+
+#endif /* GIC_PRIO_H_ */
@@ -0,0 +1,38 @@
+#ifndef GPIO_FAST_H_
+#define GPIO_FAST_H_
+
+#include <stdint.h>
+
+/* PS GPIO controller (see UG585 appendix B, gpio) */
+#define GPIO_FAST_BASE			0xE000A000
+#define GPIO_FAST_NUM_BANKS		4
+
+/* First pin number in each bank (MIO 0 and 32, EMIO 54 and 86) */
+extern const uint32_t gpio_fast_bank_first_pin[GPIO_FAST_NUM_BANKS];
+
+/*
+ * A compiled bank update - at most one store to each half of the bank (the
+ * MASK_DATA_n_LSW and MASK_DATA_n_MSW registers only reach 16 pins apiece)
+ */
+struct gpio_fast_pattern {
+	uint32_t addr[2];
+	uint32_t word[2];
+	uint32_t count;
+};
+
+/* Convert a MIO / EMIO pin number (0-117) to a bank and bit position */
+int gpio_fast_pin_to_bank(uint32_t pin, uint32_t *bank, uint32_t *bit);
+
+/* Set every pin in mask to the matching bit in value, leaving all others alone */
+int gpio_fast_write(uint32_t bank, uint32_t mask, uint32_t value);
+/* Invert every pin in mask, leaving all others alone */
+int gpio_fast_toggle(uint32_t bank, uint32_t mask);
+/* Current level of all pins in a bank, inputs and outputs alike */
+uint32_t gpio_fast_read(uint32_t bank);
+
+/* Precompute the register writes for an update so applying it is only stores */
+int gpio_fast_pattern_compile(struct gpio_fast_pattern *pattern,
+		uint32_t bank, uint32_t mask, uint32_t value);
+void gpio_fast_pattern_apply(const struct gpio_fast_pattern *patterns, uint32_t count);
+
+#endif /* GPIO_FAST_H_ */
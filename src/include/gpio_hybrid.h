@@ -0,0 +1,107 @@
+#ifndef GPIO_HYBRID_H_
+#define GPIO_HYBRID_H_
+
+#include <stdint.h>
+
+/*
+ * Like debounce.h, this is free of Xilinx driver references so that the mode
+ * switching can be driven by a simulated input on the host (see
+ * examples/gpio_hybrid_bench.c). The XGpioPs binding lives in
+ * gpio_hybrid_gpiops.c.
+ */
+
+#define GPIO_HYBRID_INTERRUPT		0
+#define GPIO_HYBRID_POLLING		1
+
+/* As poll_enter, never give up interrupts (a poll_exit of 0 never gives up polling) */
+#define GPIO_HYBRID_NEVER		UINT32_MAX
+
+/*
+ * Access to one group of pins. read_status() returns and clears the edges the
+ * controller latched since the last call, which it does whether or not the
+ * interrupt is enabled, and is how edges between two polls are noticed.
+ */
+struct gpio_hybrid_ops {
+	uint32_t (*read_pins)(void *ctx);
+	uint32_t (*read_status)(void *ctx);
+	void (*irq_enable)(void *ctx);
+	void (*irq_disable)(void *ctx);
+};
+
+struct gpio_hybrid_config {
+	/* Pins of interest within what read_pins() returns */
+	uint32_t mask;
+	/* Length of the rate measurement window, in the caller's time base */
+	uint32_t window;
+	/* Edges per window at which interrupts are given up for polling */
+	uint32_t poll_enter;
+	/* Go back to interrupts once a window sees fewer edges than this... */
+	uint32_t poll_exit;
+	/* ...for this many windows in a row */
+	uint32_t exit_windows;
+	/* Most pin reads a single gpio_hybrid_poll() may make */
+	uint32_t poll_budget;
+};
+
+struct gpio_hybrid_stats {
+	uint32_t irqs;
+	uint32_t polls;
+	/* Pin reads made by gpio_hybrid_poll(), including those that saw nothing */
+	uint32_t reads;
+	uint32_t events_irq;
+	uint32_t events_poll;
+	/* Edges known to have happened that were not seen as a level change */
+	uint32_t missed;
+	uint32_t to_polling;
+	uint32_t to_interrupt;
+	/* Time spent in polling mode, updated on each switch back */
+	uint64_t polling_time;
+};
+
+struct gpio_hybrid {
+	const struct gpio_hybrid_ops *ops;
+	void *ctx;
+	struct gpio_hybrid_config config;
+	void (*on_change)(void *arg, uint32_t changed, uint32_t level);
+	void *arg;
+
+	/* Only changed by the interrupt side going to polling and the poll side coming back */
+	volatile uint32_t mode;
+	uint32_t level;
+
+	/* Rate window kept by the interrupt handler */
+	uint32_t irq_window_start;
+	uint32_t irq_window_events;
+	/* Rate window kept by gpio_hybrid_poll() while polling */
+	uint32_t poll_window_start;
+	uint32_t poll_window_events;
+	uint32_t quiet_windows;
+	uint32_t polling_since;
+	/* Level changes seen before their status bit was read, see gpio_hybrid.c */
+	uint32_t early;
+
+	struct gpio_hybrid_stats stats;
+};
+
+/* Starts in interrupt mode, or in polling mode if poll_enter is 0 */
+int gpio_hybrid_init(struct gpio_hybrid *h, const struct gpio_hybrid_ops *ops, void *ctx,
+		const struct gpio_hybrid_config *config, uint32_t now);
+void gpio_hybrid_set_callback(struct gpio_hybrid *h,
+		void (*on_change)(void *arg, uint32_t changed, uint32_t level), void *arg);
+
+/* Interrupt side - status is the edges that raised the interrupt, already cleared */
+void gpio_hybrid_irq(struct gpio_hybrid *h, uint32_t status, uint32_t now);
+/*
+ * Thread side - call regularly in either mode, returns the number of edges seen.
+ * While polling, two edges between calls are one lost pair, so calls need to
+ * come at least as often as an interrupt entry and exit takes, about 1us on the
+ * A9, or polling loses more than the interrupts it replaced. poll_enter should
+ * be the rate at which interrupts cost more than that.
+ */
+uint32_t gpio_hybrid_poll(struct gpio_hybrid *h, uint32_t now);
+
+/* Total time spent polling, including the current stretch if still polling */
+uint64_t gpio_hybrid_polling_time(const struct gpio_hybrid *h, uint32_t now);
+void gpio_hybrid_print_stats(const struct gpio_hybrid *h, uint32_t now);
+
+#endif /* GPIO_HYBRID_H_ */
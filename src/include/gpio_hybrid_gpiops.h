@@ -0,0 +1,27 @@
+#ifndef GPIO_HYBRID_GPIOPS_H_
+#define GPIO_HYBRID_GPIOPS_H_
+
+#include "xgpiops.h"
+
+#include "gpio_hybrid.h"
+
+/* The pins of one bank, which is the unit the controller masks and latches in */
+struct gpio_hybrid_gpiops {
+	XGpioPs *gpio;
+	uint32_t bank;
+};
+
+/* Register level pin access, the context is a struct gpio_hybrid_gpiops */
+extern const struct gpio_hybrid_ops gpio_hybrid_gpiops_ops;
+
+/*
+ * Make every pin in config->mask a both-edges input and start the hybrid on it,
+ * timed by the low word of the global timer. The caller connects
+ * XGpioPs_IntrHandler() to the GIC and installs gpio_hybrid_gpiops_handler()
+ * with XGpioPs_SetCallbackHandler(), with the struct gpio_hybrid as reference.
+ */
+int gpio_hybrid_gpiops_init(struct gpio_hybrid *h, struct gpio_hybrid_gpiops *ctx,
+		const struct gpio_hybrid_config *config);
+void gpio_hybrid_gpiops_handler(void *callback_ref, u32 bank, u32 status);
+
+#endif /* GPIO_HYBRID_GPIOPS_H_ */
@@ -0,0 +1,48 @@
+#ifndef GTIMER_H_
+#define GTIMER_H_
+
+#include <stdint.h>
+
+/*
+ * Cortex-A9 64-bit global timer, read directly rather than through XTime_GetTime()
+ * so that it can be used at the very top of an interrupt handler. The timer runs
+ * from the CPU_3x2x clock (COUNTS_PER_SECOND in xtime_l.h).
+ */
+#define GTIMER_BASE			0xF8F00200
+#define GTIMER_COUNTER_LO		(GTIMER_BASE + 0x00)
+#define GTIMER_COUNTER_HI		(GTIMER_BASE + 0x04)
+#define GTIMER_CONTROL			(GTIMER_BASE + 0x08)
+#define GTIMER_ISR			(GTIMER_BASE + 0x0C)
+/* The comparator and its interrupt are banked, each CPU has its own */
+#define GTIMER_COMPARATOR_LO		(GTIMER_BASE + 0x10)
+#define GTIMER_COMPARATOR_HI		(GTIMER_BASE + 0x14)
+#define GTIMER_AUTO_INCREMENT		(GTIMER_BASE + 0x18)
+
+#define GTIMER_CONTROL_ENABLE		0x00000001
+#define GTIMER_CONTROL_COMP_ENABLE	0x00000002
+#define GTIMER_CONTROL_IRQ_ENABLE	0x00000004
+#define GTIMER_CONTROL_AUTO_INCREMENT	0x00000008
+#define GTIMER_ISR_EVENT		0x00000001
+#define GTIMER_INTR_ID			27
+
+/* The low word alone, for intervals known to be shorter than ~12 seconds */
+static inline uint32_t gtimer_read_lo(void)
+{
+	return *(volatile uint32_t *) GTIMER_COUNTER_LO;
+}
+
+/* Per the TRM, reread the upper word until it is stable across the lower one */
+static inline uint64_t gtimer_read(void)
+{
+	uint32_t hi = 0;
+	uint32_t lo = 0;
+
+	do {
+		hi = *(volatile uint32_t *) GTIMER_COUNTER_HI;
+		lo = *(volatile uint32_t *) GTIMER_COUNTER_LO;
+	} while ( hi != *(volatile uint32_t *) GTIMER_COUNTER_HI );
+
+	return ((uint64_t) hi << 32) | lo;
+}
+
+#endif /* GTIMER_H_ */
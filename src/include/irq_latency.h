@@ -0,0 +1,40 @@
+#ifndef IRQ_LATENCY_H_
+#define IRQ_LATENCY_H_
+
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xscugic.h"
+
+/*
+ * Interrupt latency measurement shared by fiq_examples.c and
+ * gic_prio_examples.c
+ *
+ * TTC0 counter 0 runs in interval mode and interrupts every time it wraps,
+ * after which it keeps counting up from zero. So the counter value read first
+ * thing in the handler is how long the interrupt took to get there. The
+ * private timer is the load: its handler busy-waits for a while every period,
+ * which is what any slow handler does to everything else.
+ *
+ * Nothing is connected or enabled in the GIC here, since how the handlers are
+ * reached is what the examples compare.
+ */
+
+#define IRQ_LATENCY_TTC_IRQ_ID		XPS_TTC0_0_INT_ID
+#define IRQ_LATENCY_LOAD_IRQ_ID		XPS_SCU_TMR_INT_ID
+#define IRQ_LATENCY_RUN_SECONDS		2
+
+/* Sets up both timers, stopped, for a GIC that has already been initialized */
+int irq_latency_init(XScuGic *gic, uint32_t ttc_rate_hz, uint32_t load_period_us, uint32_t load_busy_us);
+
+/* For XScuGic_Connect(), to IRQ_LATENCY_TTC_IRQ_ID and IRQ_LATENCY_LOAD_IRQ_ID */
+void irq_latency_ttc_handler(void *callback_ref);
+void irq_latency_load_handler(void *callback_ref);
+/* The TTC handler for fiq_init() - integer only, the FIQ path saves no VFP registers either */
+void irq_latency_sample(void);
+
+void irq_latency_print_header(const char *title);
+/* Runs the TTC, and the load if loaded, for IRQ_LATENCY_RUN_SECONDS and prints a row of results */
+void irq_latency_run(const char *name, uint32_t loaded);
+
+#endif /* IRQ_LATENCY_H_ */
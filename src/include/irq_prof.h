@@ -0,0 +1,32 @@
+#ifndef IRQ_PROF_H_
+#define IRQ_PROF_H_
+
+#include <stdint.h>
+
+#include "xscugic.h"
+
+struct irq_prof_stats {
+	uint32_t count;
+	/* Handler time in CPU cycles, not counting any interrupts that nested inside it */
+	uint64_t cycles;
+	uint32_t max_cycles;
+	/* Deepest nesting this interrupt was taken at, 1 being not nested at all */
+	uint32_t max_depth;
+};
+
+/*
+ * Register the profiling dispatcher with the CPU in place of
+ * XScuGic_InterruptHandler(). Handlers are still connected with
+ * XScuGic_Connect() as usual.
+ */
+int irq_prof_init(XScuGic *gic);
+void irq_prof_handler(void *gic);
+
+/* Consistent copy of one interrupt's statistics, safe to call with interrupts running */
+void irq_prof_read(uint32_t id, struct irq_prof_stats *stats);
+/* Interrupts that arrived with nothing pending (ID 1023) */
+uint32_t irq_prof_spurious(void);
+/* Table of every interrupt seen so far, with the share of the elapsed time (XTime ticks) each used */
+void irq_prof_print(uint64_t elapsed_ticks);
+
+#endif /* IRQ_PROF_H_ */
@@ -0,0 +1,57 @@
+#ifndef MEMPROBE_H_
+#define MEMPROBE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Memory latency and bandwidth probes. The probes only see a buffer and a
+ * clock, so what is being measured - which memory, which cache policy - is up
+ * to the caller (memprobe_examples.c on the board, examples/memprobe_host.c on
+ * the build host).
+ */
+
+enum memprobe_kind {
+	MEMPROBE_READ,
+	MEMPROBE_WRITE,
+	MEMPROBE_COPY,
+	/* 128-bit loads and stores, NEON on the A9 and SSE2 on x86 */
+	MEMPROBE_READ_WIDE,
+	MEMPROBE_WRITE_WIDE,
+	MEMPROBE_COPY_WIDE,
+	/* Stores that bypass the cache, where the instruction set has them */
+	MEMPROBE_WRITE_NT,
+	MEMPROBE_NUM_KINDS
+};
+
+struct memprobe_clock {
+	uint64_t (*now)(void);
+	/* Ticks per second */
+	double hz;
+};
+
+const char *memprobe_kind_name(enum memprobe_kind kind);
+int memprobe_kind_supported(enum memprobe_kind kind);
+
+/*
+ * Average time of one load in a chain of dependent loads that visits every
+ * line of the buffer once, in random order, so neither the prefetcher nor
+ * memory level parallelism hides any of it. Writes the chain into the buffer.
+ * Returns nanoseconds per load.
+ */
+double memprobe_latency(const struct memprobe_clock *clock, void *buf, size_t bytes, uint32_t line,
+		uint32_t loads);
+
+/*
+ * The same for memory that can only be read (a PL register window). The load
+ * addresses still depend on the previous load, through a zero that the
+ * compiler cannot see is zero, but walk the window in order.
+ */
+double memprobe_latency_ro(const struct memprobe_clock *clock, const volatile void *buf, size_t bytes,
+		uint32_t loads);
+
+/* Streams over bytes (src for reads and copies, dst otherwise) passes times, returns MB/s */
+double memprobe_bandwidth(const struct memprobe_clock *clock, enum memprobe_kind kind, void *dst,
+		const void *src, size_t bytes, uint32_t passes);
+
+#endif /* MEMPROBE_H_ */
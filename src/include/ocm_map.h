@@ -0,0 +1,26 @@
+#ifndef OCM_MAP_H_
+#define OCM_MAP_H_
+
+/*
+ * Fixed allocations in the upper 64KB of on-chip memory
+ *
+ * Nothing here is part of any linker section, so neither the C startup code nor
+ * the FSBL touches it, and what was written before a reset is still there
+ * after it. The BootROM parks CPU1 in the top 512 bytes (0xFFFFFE00), which
+ * stays clear. All of it should be made non-cacheable before use, since L1
+ * contents are lost on reset rather than written back. The smallest unit
+ * Xil_SetTlbAttributes() works on is the 1MB section at OCM_HIGH_SECTION.
+ */
+#define OCM_HIGH_BASE			0xFFFF0000
+#define OCM_HIGH_SIZE			0x00010000
+#define OCM_HIGH_SECTION		0xFFF00000
+
+/* Queues between CPU0 and CPU1, see amp.h */
+#define OCM_AMP_BASE			0xFFFF0000
+#define OCM_AMP_SIZE			0x00008000
+
+/* Always-on trace buffer, see flight_rec.h */
+#define OCM_FLIGHT_REC_BASE		0xFFFF8000
+#define OCM_FLIGHT_REC_SIZE		0x00004000
+
+#endif /* OCM_MAP_H_ */
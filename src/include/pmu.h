@@ -0,0 +1,99 @@
+#ifndef PMU_H_
+#define PMU_H_
+
+#include <stdint.h>
+
+/*
+ * Cortex-A9 performance monitor cycle counter (PMCCNTR), read with a single
+ * coprocessor instruction so it can be used inside interrupt handlers. Counts
+ * CPU clock cycles and wraps every few seconds, so only take differences over
+ * short intervals.
+ */
+
+/* PMCR bits */
+#define PMU_PMCR_ENABLE			0x00000001
+#define PMU_PMCR_EVENT_RESET		0x00000002
+#define PMU_PMCR_CYCLE_RESET		0x00000004
+/* Number of event counters, six on the Cortex-A9 */
+#define PMU_PMCR_N_SHIFT		11
+#define PMU_PMCR_N_MASK			0x1F
+/* PMCNTENSET, PMCNTENCLR and PMOVSR bit for the cycle counter */
+#define PMU_CNTEN_CYCLES		0x80000000
+
+static inline void pmu_cycles_enable(void)
+{
+	uint32_t pmcr = 0;
+
+	__asm__ volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+	pmcr |= PMU_PMCR_ENABLE | PMU_PMCR_CYCLE_RESET;
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 0" :: "r" (pmcr));
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 1" :: "r" (PMU_CNTEN_CYCLES));
+}
+
+static inline uint32_t pmu_cycles(void)
+{
+	uint32_t cycles = 0;
+
+	__asm__ volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (cycles));
+	return cycles;
+}
+
+/* The event counters, see pmu_a9.c for what they are used for */
+static inline uint32_t pmu_read_pmcr(void)
+{
+	uint32_t pmcr = 0;
+
+	__asm__ volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+	return pmcr;
+}
+
+static inline void pmu_write_pmcr(uint32_t pmcr)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 0" :: "r" (pmcr));
+}
+
+static inline void pmu_counters_enable(uint32_t mask)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 1" :: "r" (mask));
+}
+
+static inline void pmu_counters_disable(uint32_t mask)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 2" :: "r" (mask));
+}
+
+/* Overflow flags, one per counter, write one to clear */
+static inline uint32_t pmu_read_overflow(void)
+{
+	uint32_t flags = 0;
+
+	__asm__ volatile ("mrc p15, 0, %0, c9, c12, 3" : "=r" (flags));
+	return flags;
+}
+
+static inline void pmu_clear_overflow(uint32_t mask)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 3" :: "r" (mask));
+}
+
+static inline void pmu_select(uint32_t counter)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c9, c12, 5" :: "r" (counter));
+	__asm__ volatile ("isb");
+}
+
+/* Both act on the counter last selected */
+static inline void pmu_set_event(uint32_t event)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c9, c13, 1" :: "r" (event));
+}
+
+static inline uint32_t pmu_read_counter(void)
+{
+	uint32_t count = 0;
+
+	__asm__ volatile ("mrc p15, 0, %0, c9, c13, 2" : "=r" (count));
+	return count;
+}
+
+#endif /* PMU_H_ */
@@ -0,0 +1,24 @@
+#ifndef PMU_A9_H_
+#define PMU_A9_H_
+
+#include <stdint.h>
+
+#include "pmu_scope.h"
+
+/* Cortex-A9 PMU backend for pmu_scope.h */
+
+#define PMU_A9_MAX_COUNTERS		6
+
+struct pmu_a9 {
+	uint32_t counters;
+	uint32_t programmed;
+	/* Overflows seen so far, the cycle counter first */
+	uint32_t wraps[1 + PMU_A9_MAX_COUNTERS];
+};
+
+extern const struct pmu_ops pmu_a9_ops;
+
+/* Enables the counters, after which pmu_init(pmu, &pmu_a9_ops, a9) */
+void pmu_a9_init(struct pmu_a9 *a9);
+
+#endif /* PMU_A9_H_ */
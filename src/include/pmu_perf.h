@@ -0,0 +1,31 @@
+#ifndef PMU_PERF_H_
+#define PMU_PERF_H_
+
+#include <stdint.h>
+
+#include "pmu_scope.h"
+
+/*
+ * Linux perf_event_open() backend for pmu_scope.h, so the measurement code in
+ * the examples can be tried on the build host. Counts the calling thread only,
+ * in user space only.
+ */
+
+/* Fewer than most x86 cores have, so events are never multiplexed by the kernel as well */
+#define PMU_PERF_COUNTERS		4
+
+struct pmu_perf {
+	/* Group leader counts cycles, the rest are members of its group */
+	int fds[1 + PMU_PERF_COUNTERS];
+	uint32_t programmed;
+	/* No hardware cycle counter (a VM, say), task clock nanoseconds stand in */
+	int task_clock;
+};
+
+extern const struct pmu_ops pmu_perf_ops;
+
+/* Returns -1 if there is no way of counting at all */
+int pmu_perf_init(struct pmu_perf *perf);
+void pmu_perf_close(struct pmu_perf *perf);
+
+#endif /* PMU_PERF_H_ */
@@ -0,0 +1,109 @@
+#ifndef PMU_SCOPE_H_
+#define PMU_SCOPE_H_
+
+#include <stdint.h>
+
+/*
+ * Scoped hardware event counting. Wrap the code under test in
+ * pmu_scope_begin() and pmu_scope_end(), run it as many times as needed, and
+ * pmu_scope_print() says what it cost per run in cycles, instructions, cache
+ * refills, branch mispredicts and so on.
+ *
+ * The counters themselves are reached through a backend, pmu_a9.c on the board
+ * and pmu_perf.c (Linux perf_event_open) on the build host, so the same
+ * measurement code runs on both. Backends extend every counter to 64 bits.
+ *
+ * A scope can ask for more events than the hardware can count at once (six on
+ * the Cortex-A9). They are then split into groups, one group is counted per
+ * run, in turn, and each total is scaled up by the share of cycles its group
+ * was counted for. The more runs, and the more alike they are, the better the
+ * estimate - a single run only ever sees the first group.
+ */
+
+#define PMU_MAX_EVENTS			16
+#define PMU_MAX_COUNTERS		8
+
+/* Backend specific event number, for anything not in the list below */
+#define PMU_RAW(n)			(0x80000000 | (n))
+#define PMU_IS_RAW(e)			(((e) & 0x80000000) != 0)
+#define PMU_RAW_EVENT(e)		((e) & 0x7FFFFFFF)
+
+enum pmu_event {
+	PMU_INSTRUCTIONS,
+	PMU_BRANCHES,
+	PMU_BRANCH_MISSES,
+	PMU_L1D_ACCESS,
+	PMU_L1D_REFILL,
+	PMU_L1I_REFILL,
+	PMU_DTLB_REFILL,
+	PMU_ITLB_REFILL,
+	PMU_STALL_FRONTEND,
+	PMU_STALL_BACKEND,
+	PMU_NUM_EVENTS
+};
+
+struct pmu_ops {
+	/* Event counters available at once, not counting the cycle counter */
+	uint32_t (*counters)(void *ctx);
+	int (*supported)(void *ctx, uint32_t event);
+	/* Starts counting the given events from zero */
+	int (*program)(void *ctx, const uint32_t *events, uint32_t count);
+	/* values[0] is cycles, then one for each programmed event */
+	void (*read)(void *ctx, uint64_t *values);
+};
+
+struct pmu {
+	const struct pmu_ops *ops;
+	void *ctx;
+	uint32_t counters;
+	/* Which scope and group the counters are set up for now */
+	const void *programmed;
+	uint32_t programmed_group;
+};
+
+struct pmu_scope {
+	const char *name;
+	uint32_t events[PMU_MAX_EVENTS];
+	uint32_t num_events;
+	/* Asked for but not countable with this backend */
+	uint32_t missing[PMU_MAX_EVENTS];
+	uint32_t num_missing;
+
+	uint32_t groups;
+	uint32_t group;
+	uint64_t start[1 + PMU_MAX_COUNTERS];
+
+	uint64_t runs;
+	uint64_t cycles;
+	uint64_t min_cycles;
+	uint64_t max_cycles;
+	uint64_t count[PMU_MAX_EVENTS];
+	/* Cycles over the runs each event was counted in */
+	uint64_t enabled[PMU_MAX_EVENTS];
+
+	/* What an empty scope counts, taken off every run */
+	uint64_t overhead_cycles;
+	uint64_t overhead[PMU_MAX_EVENTS];
+};
+
+int pmu_init(struct pmu *pmu, const struct pmu_ops *ops, void *ctx);
+const char *pmu_event_name(uint32_t event);
+
+int pmu_scope_init(struct pmu *pmu, struct pmu_scope *scope, const char *name,
+		const uint32_t *events, uint32_t count);
+void pmu_scope_reset(struct pmu_scope *scope);
+/* Measures empty scopes so that the cost of measuring is left out of the results */
+void pmu_scope_calibrate(struct pmu *pmu, struct pmu_scope *scope, uint32_t runs);
+
+void pmu_scope_begin(struct pmu *pmu, struct pmu_scope *scope);
+void pmu_scope_end(struct pmu *pmu, struct pmu_scope *scope);
+
+/* Estimated total of the i-th event over all runs, scaled up if it was multiplexed */
+double pmu_scope_total(const struct pmu_scope *scope, uint32_t i);
+double pmu_scope_per_run(const struct pmu_scope *scope, uint32_t i);
+/* Index of an event in the scope, or -1 */
+int pmu_scope_find(const struct pmu_scope *scope, uint32_t event);
+
+void pmu_scope_print(const struct pmu_scope *scope);
+
+#endif /* PMU_SCOPE_H_ */
@@ -0,0 +1,169 @@
+#ifndef PWM_H_
+#define PWM_H_
+
+#include <stdint.h>
+
+/*
+ * PWM on all six TTC counters (TTC0 and TTC1, three counters each)
+ *
+ * Each counter runs in interval mode with its waveform output enabled: the
+ * output is high from the start of a period until the count reaches match 1,
+ * then low until it reaches the interval and starts again. A period is
+ * interval + 1 prescaled ticks and the high time is match ticks, so the
+ * output frequency is clock / (prescale * (interval + 1)) and the duty cycle
+ * match / (interval + 1). Once started the counters run on their own, with
+ * no interrupts and nothing for the CPU to do.
+ *
+ * Every counter has its own clock control, so each channel has its own
+ * prescaler and clock source. What the period and the duty cycle do share is
+ * that prescaler: the larger it is, the lower the frequency the 16-bit
+ * interval reaches and the fewer steps the duty cycle has. pwm_solve() tries
+ * every prescaler and takes the one closest to the frequency asked for,
+ * favouring the smallest prescaler, and so the finest duty cycle, on a tie.
+ *
+ * All arithmetic is integer, frequencies in millihertz and duty cycles in
+ * parts per million, so the solution is exact for the input clock given.
+ * The engine only writes counter registers through pwm_ops (pwm_ttc.c on the
+ * board, ttc_model.h on the host). Routing the waveform outputs to pins, over
+ * MIO or EMIO, is up to the hardware design.
+ *
+ * Writing match 1 while a channel runs can cut a pulse short or lose it: a
+ * value below the count misses this period's match, and the output stays
+ * high into the next. With pwm_sync_enable() a channel takes duty cycle
+ * changes through pwm_set_duty() into a buffer instead, and pwm_isr() on the
+ * interval interrupt writes it at the start of the next period. The match
+ * is then always ahead of the count when it is written, provided it is at
+ * least the interrupt latency, which pwm_sync_enable() is told and holds
+ * every duty cycle to. The handler costs three register accesses whatever
+ * the update rate, so the duty cycle can change every period.
+ */
+
+#define PWM_CHANNELS			6
+#define PWM_COUNTERS_PER_TTC		3
+
+/* Prescale is a power of two, 2^1 to 2^16, or 2^0 with the prescaler off */
+#define PWM_PRESCALE_MAX_LOG2		16
+#define PWM_INTERVAL_MAX		0xFFFF
+#define PWM_DUTY_FULL			1000000
+
+#define PWM_MHZ(hz)			((uint64_t) (hz) * 1000)
+
+/* Per-counter register offsets, counter n is at offset + 4 * n */
+#define PWM_TTC_CLK_CTRL		0x00
+#define PWM_TTC_CNT_CTRL		0x0C
+#define PWM_TTC_COUNTER			0x18
+#define PWM_TTC_INTERVAL		0x24
+#define PWM_TTC_MATCH_1			0x30
+/* Cleared by reading */
+#define PWM_TTC_ISR			0x54
+#define PWM_TTC_IER			0x60
+
+#define PWM_CLK_CTRL_PS_EN		0x01
+#define PWM_CLK_CTRL_PS_SHIFT		1
+#define PWM_CLK_CTRL_PS_MASK		0x1E
+#define PWM_CLK_CTRL_SRC_EXT		0x20
+
+#define PWM_CNT_CTRL_DIS		0x01
+#define PWM_CNT_CTRL_INT		0x02
+#define PWM_CNT_CTRL_DEC		0x04
+#define PWM_CNT_CTRL_MATCH		0x08
+#define PWM_CNT_CTRL_RST		0x10
+/* Active low, set to turn the waveform output off */
+#define PWM_CNT_CTRL_WAVE_DIS		0x20
+/* Set for high until the match, low after it */
+#define PWM_CNT_CTRL_WAVE_POL		0x40
+
+#define PWM_IXR_INTERVAL		0x01
+
+/* Errors from pwm_solve() and pwm_configure() */
+#define PWM_OK				0
+#define PWM_EINVAL			-1
+/* No prescaler reaches the frequency with min_steps of duty cycle resolution */
+#define PWM_ERANGE			-2
+
+struct pwm_ops {
+	void (*write)(void *ctx, uint32_t channel, uint32_t offset, uint32_t val);
+	uint32_t (*read)(void *ctx, uint32_t channel, uint32_t offset);
+};
+
+struct pwm_solution {
+	/* log2 of the prescale, 0 with the prescaler off */
+	uint32_t prescale_log2;
+	uint16_t interval;
+	uint16_t match;
+	/* What the registers actually give */
+	uint64_t freq_mhz;
+	uint32_t duty_ppm;
+	/* Frequency error, achieved against asked for */
+	int32_t error_ppm;
+	/* Distinct duty cycles at this frequency, interval + 1 */
+	uint32_t steps;
+};
+
+struct pwm_channel {
+	uint32_t clock_hz;
+	uint32_t external;
+	uint32_t min_steps;
+	struct pwm_solution solution;
+	uint32_t configured;
+
+	/* Duty cycle buffer, written by pwm_set_duty() and taken by pwm_isr() */
+	volatile uint32_t pending;
+	volatile uint32_t pending_match;
+	volatile uint32_t pending_duty_ppm;
+	uint32_t sync;
+	/* Least match, in counts, for the write to land before it */
+	uint32_t guard;
+	uint32_t irqs;
+	uint32_t commits;
+	/* Updates held over a period because the count was already past them */
+	uint32_t late;
+};
+
+struct pwm_engine {
+	const struct pwm_ops *ops;
+	void *ctx;
+	struct pwm_channel channels[PWM_CHANNELS];
+};
+
+/*
+ * Best registers for freq_mhz at duty_ppm from a clock_hz input, with at
+ * least min_steps duty cycle steps (2 at the least). Duty cycles of 0 and
+ * 100% cannot be made and come out as one step from either end.
+ */
+int pwm_solve(uint32_t clock_hz, uint64_t freq_mhz, uint32_t duty_ppm, uint32_t min_steps,
+		struct pwm_solution *solution);
+
+/* Stops every counter; channels start on the internal clock_hz with 2 duty steps at the least */
+void pwm_init(struct pwm_engine *engine, const struct pwm_ops *ops, void *ctx, uint32_t clock_hz);
+/* Clock for one channel, external being the counter's clock input pin */
+int pwm_set_clock(struct pwm_engine *engine, uint32_t channel, uint32_t clock_hz, uint32_t external);
+int pwm_set_min_steps(struct pwm_engine *engine, uint32_t channel, uint32_t min_steps);
+
+/* Solves and writes the channel's registers, leaving it stopped and with sync off */
+int pwm_configure(struct pwm_engine *engine, uint32_t channel, uint64_t freq_mhz, uint32_t duty_ppm);
+/* Starts or stops the channels in mask (bit n for channel n) back to back */
+void pwm_start(struct pwm_engine *engine, uint32_t mask);
+void pwm_stop(struct pwm_engine *engine, uint32_t mask);
+
+/*
+ * Duty cycle updates on the channel through the buffer from now on, with
+ * latency_ticks of the input clock the most there will ever be between the
+ * interval interrupt and pwm_isr() writing match 1. Enables the interval
+ * interrupt; connecting it to pwm_isr() is up to the caller (pwm_ttc.h on
+ * the board).
+ */
+int pwm_sync_enable(struct pwm_engine *engine, uint32_t channel, uint32_t latency_ticks);
+/*
+ * New duty cycle for a configured channel, from the next period with sync
+ * enabled and straight away without, which is only safe while it is stopped.
+ * Clamped to the guard and to one step short of 100%.
+ */
+int pwm_set_duty(struct pwm_engine *engine, uint32_t channel, uint32_t duty_ppm);
+/* Interval interrupt handler for a channel, commits a buffered duty cycle */
+void pwm_isr(struct pwm_engine *engine, uint32_t channel);
+
+const struct pwm_solution *pwm_get(const struct pwm_engine *engine, uint32_t channel);
+void pwm_print(const struct pwm_engine *engine);
+
+#endif /* PWM_H_ */
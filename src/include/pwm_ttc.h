@@ -0,0 +1,18 @@
+#ifndef PWM_TTC_H_
+#define PWM_TTC_H_
+
+#include "xscugic.h"
+
+#include "pwm.h"
+
+/*
+ * pwm.h on the board's TTCs, channel n being XTtcPs device ID n: TTC0
+ * counters 0 to 2, then TTC1 counters 0 to 2
+ */
+
+/* Takes each channel's registers and clock from the BSP configuration and stops every counter */
+int pwm_ttc_init(struct pwm_engine *engine);
+/* Connects and enables the interrupts of the channels in mask to pwm_isr(), for pwm_sync_enable() */
+int pwm_ttc_connect(struct pwm_engine *engine, XScuGic *gic, uint32_t mask);
+
+#endif /* PWM_TTC_H_ */
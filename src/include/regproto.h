@@ -0,0 +1,143 @@
+#ifndef REGPROTO_H_
+#define REGPROTO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Framed binary register access over a serial line
+ *
+ * A frame is a request or response payload followed by its CRC-16
+ * (CCITT, low byte first), COBS encoded so that it holds no zero bytes, then
+ * a single zero to end it. A receiver that starts mid-frame or sees a
+ * corrupt one loses only that frame and is back in step at the next zero.
+ *
+ * Requests are [seq][op][arguments], responses [seq][op | REGPROTO_RESPONSE]
+ * [status][results], the sequence number echoed so the host can throw away
+ * an answer to a request it already gave up on. All words are little endian.
+ * Every request carries up to REGPROTO_MAX_DATA bytes, so a frame is never
+ * longer than REGPROTO_FRAME_MAX and both sides can use fixed buffers.
+ *
+ *   PEEK      addr...              ->  value...
+ *   POKE      (addr value)...      ->
+ *   READ      addr count(u16)      ->  value...      consecutive words
+ *   WRITE     addr value...        ->
+ *   MAP_INFO  index(u8)            ->  count(u8) base name (offset(u16) name)...
+ *   SNAPSHOT  index(u8)            ->  value...      every register of the map
+ *
+ * Names are NUL terminated. MAP_INFO for an index past the last map answers
+ * REGPROTO_NOT_FOUND, which is how the host finds out how many there are.
+ *
+ * regproto.c has the framing and the agent, which only sees the target
+ * through regproto_agent_ops (regproto_zynq.c on the board, an array of
+ * pretend registers in examples/regproto_loopback.c). regproto_client.h is
+ * the host side.
+ */
+
+#define REGPROTO_MAX_DATA		1020
+/* Header, data, CRC, COBS overhead and the terminating zero */
+#define REGPROTO_PAYLOAD_MAX		(3 + REGPROTO_MAX_DATA)
+#define REGPROTO_FRAME_MAX		(REGPROTO_PAYLOAD_MAX + 2 + ((REGPROTO_PAYLOAD_MAX + 2) / 254) + 1 + 1)
+
+#define REGPROTO_PEEK			0x01
+#define REGPROTO_POKE			0x02
+#define REGPROTO_READ			0x03
+#define REGPROTO_WRITE			0x04
+#define REGPROTO_MAP_INFO		0x05
+#define REGPROTO_SNAPSHOT		0x06
+#define REGPROTO_RESPONSE		0x80
+
+/* Most words one request can carry */
+#define REGPROTO_PEEK_MAX		(REGPROTO_MAX_DATA / 4)
+#define REGPROTO_POKE_MAX		(REGPROTO_MAX_DATA / 8)
+#define REGPROTO_READ_MAX		(REGPROTO_MAX_DATA / 4)
+#define REGPROTO_WRITE_MAX		((REGPROTO_MAX_DATA - 4) / 4)
+
+/* Response status */
+#define REGPROTO_OK			0
+#define REGPROTO_BAD_OP			1
+#define REGPROTO_BAD_LENGTH		2
+/* Unaligned, or outside what the agent allows; nothing was accessed */
+#define REGPROTO_BAD_ADDR		3
+#define REGPROTO_NOT_FOUND		4
+
+struct regproto_reg {
+	const char *name;
+	uint16_t offset;
+};
+
+struct regproto_map {
+	const char *name;
+	uint32_t base;
+	const struct regproto_reg *regs;
+	uint32_t count;
+};
+
+/* Receive side of the framing, shared by the agent and the host */
+struct regproto_rx {
+	uint8_t buf[REGPROTO_FRAME_MAX];
+	uint32_t len;
+	uint32_t overflow;
+	/* Frames thrown away for a bad encoding, a bad CRC or for being too long */
+	uint32_t errors;
+};
+
+uint16_t regproto_crc16(const uint8_t *data, size_t len);
+
+/* COBS, returning the encoded or decoded length; decoding gives -1 if src is not valid COBS */
+size_t regproto_cobs_encode(const uint8_t *src, size_t len, uint8_t *dst);
+int regproto_cobs_decode(const uint8_t *src, size_t len, uint8_t *dst);
+
+/* Payload to a complete frame, returns its length, at most REGPROTO_FRAME_MAX */
+size_t regproto_frame(const uint8_t *payload, size_t len, uint8_t *frame);
+
+void regproto_rx_init(struct regproto_rx *rx);
+/*
+ * Feed one received byte. Returns the payload length once a frame with a good
+ * CRC is complete, with the payload in payload (REGPROTO_PAYLOAD_MAX bytes),
+ * and 0 otherwise.
+ */
+int regproto_rx_byte(struct regproto_rx *rx, uint8_t c, uint8_t *payload);
+
+static inline void regproto_put32(uint8_t *p, uint32_t val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+	p[2] = val >> 16;
+	p[3] = val >> 24;
+	return;
+}
+
+static inline uint32_t regproto_get32(const uint8_t *p)
+{
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+struct regproto_agent_ops {
+	uint32_t (*read32)(void *ctx, uint32_t addr);
+	void (*write32)(void *ctx, uint32_t addr, uint32_t val);
+	/* Whether bytes at addr can be touched at all; reading an unmapped address on the A9 never returns */
+	int (*access_ok)(void *ctx, uint32_t addr, uint32_t bytes);
+	void (*tx)(void *ctx, const uint8_t *data, size_t len);
+};
+
+struct regproto_agent {
+	const struct regproto_agent_ops *ops;
+	void *ctx;
+	const struct regproto_map *maps;
+	uint32_t map_count;
+	struct regproto_rx rx;
+	uint8_t request[REGPROTO_PAYLOAD_MAX];
+	uint8_t response[REGPROTO_PAYLOAD_MAX];
+	uint8_t frame[REGPROTO_FRAME_MAX];
+	uint32_t requests;
+};
+
+void regproto_agent_init(struct regproto_agent *agent, const struct regproto_agent_ops *ops, void *ctx,
+		const struct regproto_map *maps, uint32_t map_count);
+/* Feed one received byte, answers through ops->tx() when it completes a request */
+void regproto_agent_rx(struct regproto_agent *agent, uint8_t c);
+/* One request payload to its response payload, returns the response length */
+size_t regproto_agent_handle(struct regproto_agent *agent, const uint8_t *req, size_t len, uint8_t *resp);
+
+#endif /* REGPROTO_H_ */
@@ -0,0 +1,70 @@
+#ifndef REGPROTO_CLIENT_H_
+#define REGPROTO_CLIENT_H_
+
+#include <stdint.h>
+
+#include "regproto.h"
+
+/*
+ * Host side of regproto.h, over a serial port or pty (regproto_posix.c)
+ *
+ * Calls carry any number of words, split into as many requests as it takes,
+ * and wait for each answer in turn. Requests that only read are sent again if
+ * no answer comes within the timeout; those that write are not, since a write
+ * that did land the first time can have side effects the second time. Every
+ * call returns REGPROTO_OK, the agent's status, or REGPROTO_NO_ANSWER.
+ */
+
+#define REGPROTO_NO_ANSWER		-1
+#define REGPROTO_TIMEOUT_MS		500
+#define REGPROTO_RETRIES		2
+
+#define REGPROTO_NAME_LEN		24
+
+struct regproto_client_stats {
+	uint32_t requests;
+	uint32_t retries;
+	/* Answers to an earlier request that had been given up on */
+	uint32_t stale;
+	uint64_t tx_bytes;
+	uint64_t rx_bytes;
+};
+
+struct regproto_client {
+	int fd;
+	uint8_t seq;
+	int timeout_ms;
+	struct regproto_rx rx;
+	uint8_t payload[REGPROTO_PAYLOAD_MAX];
+	uint8_t frame[REGPROTO_FRAME_MAX];
+	uint8_t in[4096];
+	uint32_t in_len;
+	uint32_t in_pos;
+	struct regproto_client_stats stats;
+};
+
+struct regproto_map_info {
+	char name[REGPROTO_NAME_LEN];
+	uint32_t base;
+	uint32_t count;
+	uint16_t offsets[REGPROTO_READ_MAX];
+	char reg_names[REGPROTO_READ_MAX][REGPROTO_NAME_LEN];
+};
+
+/* A baud rate of 0 leaves the line settings alone, other than making it raw */
+int regproto_client_open(struct regproto_client *client, const char *path, uint32_t baud);
+void regproto_client_close(struct regproto_client *client);
+
+int regproto_peek(struct regproto_client *client, const uint32_t *addrs, uint32_t *values, uint32_t count);
+int regproto_poke(struct regproto_client *client, const uint32_t *addrs, const uint32_t *values, uint32_t count);
+int regproto_read(struct regproto_client *client, uint32_t addr, uint32_t *values, uint32_t count);
+int regproto_write(struct regproto_client *client, uint32_t addr, const uint32_t *values, uint32_t count);
+
+/* REGPROTO_NOT_FOUND for an index past the agent's last map */
+int regproto_map_info(struct regproto_client *client, uint8_t index, struct regproto_map_info *info);
+/* values has room for info.count words */
+int regproto_snapshot(struct regproto_client *client, uint8_t index, uint32_t *values);
+
+const char *regproto_status_name(int status);
+
+#endif /* REGPROTO_CLIENT_H_ */
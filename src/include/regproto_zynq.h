@@ -0,0 +1,28 @@
+#ifndef REGPROTO_ZYNQ_H_
+#define REGPROTO_ZYNQ_H_
+
+#include <stdint.h>
+
+#include "regproto.h"
+
+/*
+ * regproto.h agent on the Zynq, on the PS UART that the BSP uses for stdout
+ *
+ * The agent owns the UART once it runs, so nothing else may print. Only
+ * addresses inside one of the windows can be read or written: an access to
+ * something that is not there, a PL address with no bitstream loaded say,
+ * stalls the bus or takes a data abort rather than returning an error.
+ */
+
+struct regproto_window {
+	uint32_t base;
+	uint32_t size;
+};
+
+/* Waits for stdout to drain, then switches the UART to baud (0 leaves it as it is) */
+int regproto_zynq_init(struct regproto_agent *agent, const struct regproto_map *maps, uint32_t map_count,
+		const struct regproto_window *windows, uint32_t window_count, uint32_t baud);
+/* Serves requests, never returns */
+void regproto_zynq_run(struct regproto_agent *agent);
+
+#endif /* REGPROTO_ZYNQ_H_ */
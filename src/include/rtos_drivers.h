@@ -0,0 +1,75 @@
+#ifndef RTOS_DRIVERS_H_
+#define RTOS_DRIVERS_H_
+
+#include <stdint.h>
+
+/*
+ * FreeRTOS versions of the timer, GPIO and XADC examples
+ *
+ * The bare metal examples end in spin loops waiting for a flag an interrupt
+ * handler sets. Here every flow is a task that blocks until there is something
+ * to do. The interrupt handlers do no more than clear the hardware and hand
+ * off, through a direct-to-task notification (the timers) or a stream buffer
+ * (GPIO edges, which carry data). The XADC is sampled by a task on a fixed
+ * period with vTaskDelayUntil().
+ *
+ * Nothing in rtos_drivers.c touches hardware. That is done by a struct
+ * rtos_board, rtos_drivers_zynq.c for the MicroZed and rtos_drivers_posix.c for
+ * the FreeRTOS POSIX port, so the same tasks can be run on the build host. The
+ * board callbacks given an isr call it from interrupt context (or what the port
+ * treats as one), so the isr may only use the FromISR API, and it ends with
+ * the board's isr_exit() rather than portYIELD_FROM_ISR() itself.
+ */
+
+#define RTOS_SCUTIMER_PERIOD_MS		1000
+#define RTOS_SCUTIMER_COUNT		10
+#define RTOS_TTC_HZ			100
+#define RTOS_XADC_PERIOD_MS		100
+#define RTOS_REPORT_MS			1000
+/* How long the idle task is left alone to find out what 100% idle looks like */
+#define RTOS_CALIBRATE_MS		1000
+#define RTOS_GPIO_EVENTS		16
+
+struct rtos_gpio_event {
+	uint32_t pin;
+	uint32_t level;
+	uint32_t timestamp;
+};
+
+/* Raw 16-bit XADC codes, as XAdcPs_GetAdcData() returns them */
+struct rtos_xadc_sample {
+	uint16_t temp;
+	uint16_t vccint;
+	uint16_t vccaux;
+};
+
+struct rtos_board {
+	const char *name;
+	/* Periodic interrupt, which on the MicroZed cannot be the private timer since the tick has that */
+	int (*scutimer_start)(uint32_t period_ms, void (*isr)(void *arg), void *arg);
+	void (*scutimer_stop)(void);
+	int (*ttc_start)(uint32_t hz, void (*isr)(void *arg), void *arg);
+	void (*ttc_stop)(void);
+	/* isr is called for both edges of the push button, with the level after the edge */
+	int (*gpio_start)(void (*isr)(void *arg, uint32_t pin, uint32_t level), void *arg);
+	/*
+	 * Last thing in every isr, woken being what the FromISR calls returned.
+	 * portYIELD_FROM_ISR() on the Zynq; nothing on the POSIX port, whose
+	 * interrupts run in the tick hook, where the kernel already switches
+	 * tasks once the tick is done if a FromISR call asked for it.
+	 */
+	void (*isr_exit)(uint32_t woken);
+	void (*led_write)(uint32_t on);
+	int (*xadc_read)(struct rtos_xadc_sample *sample);
+	/* Free running, for timestamping GPIO edges */
+	uint32_t (*timestamp)(void);
+	uint32_t timestamp_hz;
+};
+
+/* Creates the tasks, returns 0 or -1. The caller then starts the scheduler */
+int rtos_drivers_start(const struct rtos_board *board);
+
+/* To be called from vApplicationIdleHook(), for the CPU idle percentage */
+void rtos_drivers_idle_hook(void);
+
+#endif /* RTOS_DRIVERS_H_ */
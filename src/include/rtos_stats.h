@@ -0,0 +1,89 @@
+#ifndef RTOS_STATS_H_
+#define RTOS_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * FreeRTOS run-time statistics on a 64-bit counter
+ *
+ * The kernel's own run-time stats keep 32-bit totals, which on the global timer
+ * (333MHz) wrap every 13 seconds. This keeps 64-bit totals of its own: CPU time
+ * and context switches per task, from the kernel's trace hooks
+ * (rtos_stats_trace.h), and time and count per interrupt ID, from the interrupt
+ * dispatcher calling rtos_stats_irq_enter() and rtos_stats_irq_exit().
+ * Interrupt time is taken out of whichever task it interrupted, and a nested
+ * interrupt's time out of the one it interrupted, so every count of the clock
+ * is charged to exactly one task or interrupt.
+ *
+ * The hooks also time themselves, so the snapshot says what keeping the
+ * statistics costs. Snapshots are plain binary, the same on the board and the
+ * host, for rtos_stats_dump() and examples/rtos_stats_decode.c.
+ */
+
+#define RTOS_STATS_MAGIC		0x52545354
+#define RTOS_STATS_VERSION		1
+#define RTOS_STATS_MAX_TASKS		16
+#define RTOS_STATS_MAX_IRQS		96
+#define RTOS_STATS_MAX_NESTING		8
+#define RTOS_STATS_NAME_LEN		16
+
+struct rtos_stats_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t hz;
+	/* Counter at rtos_stats_init() and at the snapshot */
+	uint64_t start;
+	uint64_t now;
+	uint64_t irq_time;
+	/* Counts spent in the hooks themselves, and how many times they ran */
+	uint64_t overhead;
+	uint32_t overhead_events;
+	uint32_t switches;
+	uint32_t tasks;
+	uint32_t irqs;
+};
+
+struct rtos_stats_task {
+	char name[RTOS_STATS_NAME_LEN];
+	uint64_t time;
+	uint32_t switches;
+	/* Zero once the task has been deleted */
+	uint32_t alive;
+};
+
+struct rtos_stats_irq {
+	uint64_t time;
+	uint64_t max;
+	uint32_t id;
+	uint32_t count;
+};
+
+/* Tasks and interrupts that have not run are left out */
+struct rtos_stats_snapshot {
+	struct rtos_stats_header header;
+	struct rtos_stats_task tasks[RTOS_STATS_MAX_TASKS];
+	struct rtos_stats_irq irqs[RTOS_STATS_MAX_IRQS];
+};
+
+void rtos_stats_init(uint64_t (*counter)(void), uint64_t hz);
+
+/* Called with interrupts masked at the CPU, around the handler for id */
+void rtos_stats_irq_enter(uint32_t id);
+void rtos_stats_irq_exit(uint32_t id);
+
+void rtos_stats_snapshot(struct rtos_stats_snapshot *snapshot);
+/* The snapshot packed into buf, header then tasks then interrupts, returns the length or 0 */
+size_t rtos_stats_dump(const struct rtos_stats_snapshot *snapshot, void *buf, size_t len);
+
+/*
+ * One line of the text report into buf, for line = 0, 1, 2, ... until it
+ * returns 0. For both the console and a FreeRTOS+CLI command.
+ */
+int rtos_stats_format(const struct rtos_stats_snapshot *snapshot, uint32_t line, char *buf, size_t len);
+void rtos_stats_print(const struct rtos_stats_snapshot *snapshot);
+
+/* "stats" and "stats-dump" commands, from rtos_stats_cli.c, which needs FreeRTOS+CLI */
+void rtos_stats_cli_register(void);
+
+#endif /* RTOS_STATS_H_ */
@@ -0,0 +1,22 @@
+#ifndef RTOS_STATS_TRACE_H_
+#define RTOS_STATS_TRACE_H_
+
+#include <stdint.h>
+
+/*
+ * Kernel trace hooks for rtos_stats.h. Include at the end of FreeRTOSConfig.h,
+ * with configUSE_TRACE_FACILITY set so that every task has a uxTaskNumber for
+ * rtos_stats.c to keep its slot in. Only the kernel's own tasks.c sees
+ * pxCurrentTCB, which is the only place these macros are expanded.
+ */
+
+void rtos_stats_switched_out(void);
+uint32_t rtos_stats_switched_in(void *task, uint32_t number);
+void rtos_stats_task_deleted(void *task);
+
+#define traceTASK_SWITCHED_OUT()	rtos_stats_switched_out()
+#define traceTASK_SWITCHED_IN()		pxCurrentTCB->uxTaskNumber = \
+		rtos_stats_switched_in(pxCurrentTCB, pxCurrentTCB->uxTaskNumber)
+#define traceTASK_DELETE(pxTCB)		rtos_stats_task_deleted(pxTCB)
+
+#endif /* RTOS_STATS_TRACE_H_ */
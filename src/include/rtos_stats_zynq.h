@@ -0,0 +1,13 @@
+#ifndef RTOS_STATS_ZYNQ_H_
+#define RTOS_STATS_ZYNQ_H_
+
+#include <stdint.h>
+
+#include "rtos_stats.h"
+
+/* Statistics on the global timer, to be started before the scheduler */
+void rtos_stats_zynq_init(void);
+/* In place of the demo's vApplicationIRQHandler() body, see rtos_stats_zynq.c */
+void rtos_stats_zynq_irq(uint32_t iar);
+
+#endif /* RTOS_STATS_ZYNQ_H_ */
@@ -0,0 +1,65 @@
+#ifndef RTOS_TICKLESS_H_
+#define RTOS_TICKLESS_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/*
+ * Tickless idle for FreeRTOS on a free running 64-bit counter with a
+ * comparator, which on the A9 is the global timer (rtos_tickless_zynq.c).
+ *
+ * The comparator drives the ordinary tick too, auto-incrementing by one tick
+ * period each time it fires, so it always holds the time of the next tick.
+ * When the kernel has nothing to do for a while, rtos_tickless_sleep() moves
+ * the comparator out to the first tick that has work, waits for an interrupt,
+ * and afterwards steps the tick count by the whole periods that really went
+ * by. Since the counter never stops or reloads, that count is exact, and the
+ * comparator is always put back on the same grid of tick times, so no error
+ * builds up however often or however long the CPU sleeps.
+ *
+ * FreeRTOSConfig.h needs configUSE_TICKLESS_IDLE 2 and
+ * #define portSUPPRESS_TICKS_AND_SLEEP(x) rtos_tickless_sleep(x).
+ */
+
+struct rtos_tickless_timer {
+	uint64_t (*counter)(void);
+	uint64_t (*comparator)(void);
+	void (*set_comparator)(uint64_t value);
+	/* Comparator has fired and the tick interrupt is pending */
+	int (*fired)(void);
+	/*
+	 * Interrupts masked at the CPU, where a pending one still ends the wait
+	 * for an interrupt. A priority mask would keep it from doing that.
+	 */
+	void (*irq_mask)(void);
+	void (*irq_unmask)(void);
+	void (*wait)(void);
+	uint64_t hz;
+	/* Counts per tick */
+	uint32_t period;
+	/* The comparator is never set closer than this to the counter */
+	uint32_t margin;
+};
+
+struct rtos_tickless_stats {
+	/* Returns from waiting for an interrupt in the idle task, ticked or not */
+	uint32_t wakeups;
+	uint32_t sleeps;
+	uint32_t aborted;
+	/* Woken by something other than the comparator */
+	uint32_t early;
+	uint32_t suppressed;
+};
+
+void rtos_tickless_init(const struct rtos_tickless_timer *timer);
+void rtos_tickless_sleep(TickType_t expected);
+/* To be called from vApplicationIdleHook(), waits for an interrupt in the ticked build */
+void rtos_tickless_idle(void);
+/* Counts the timer ran ahead of the tick count since rtos_tickless_init() */
+int64_t rtos_tickless_drift(void);
+void rtos_tickless_get_stats(struct rtos_tickless_stats *stats);
+/* Reports wakeups per second and drift every period_ms from a task of its own */
+int rtos_tickless_start_report(uint32_t period_ms);
+
+#endif /* RTOS_TICKLESS_H_ */
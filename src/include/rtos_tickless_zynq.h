@@ -0,0 +1,10 @@
+#ifndef RTOS_TICKLESS_ZYNQ_H_
+#define RTOS_TICKLESS_ZYNQ_H_
+
+#include "rtos_tickless.h"
+
+/* configSETUP_TICK_INTERRUPT() and configCLEAR_TICK_INTERRUPT(), see rtos_tickless_zynq.c */
+void rtos_tickless_zynq_setup(void);
+void rtos_tickless_zynq_clear(void);
+
+#endif /* RTOS_TICKLESS_ZYNQ_H_ */
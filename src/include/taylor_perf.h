@@ -0,0 +1,30 @@
+#ifndef TAYLOR_PERF_H_
+#define TAYLOR_PERF_H_
+
+#include <stdint.h>
+
+/*
+ * Each snapshot costs the PL one write (the snapshot request) and one read for
+ * every counter word that is fetched afterwards. These get counted by the
+ * hardware like any other access, so taylor_perf_diff() removes them.
+ */
+#define TAYLOR_PERF_SNAPSHOT_WRITES		1
+#define TAYLOR_PERF_SNAPSHOT_READS		7
+
+/* Copy of the peripheral performance counters at one point in time */
+struct taylor_perf {
+	uint64_t cycles;
+	uint32_t wr_count;
+	uint32_t rd_count;
+	uint32_t wr_stall;
+	uint32_t rd_stall;
+	uint32_t results;
+};
+
+void taylor_perf_clear(uint32_t base);
+void taylor_perf_snapshot(uint32_t base, struct taylor_perf *snap);
+void taylor_perf_diff(const struct taylor_perf *start, const struct taylor_perf *stop,
+		struct taylor_perf *delta);
+void taylor_perf_print(const struct taylor_perf *snap);
+
+#endif /* TAYLOR_PERF_H_ */
@@ -12,6 +12,20 @@
 #define TAYLOR_UZED_S00_AXI_SLV_REG2_OFFSET 8
 #define TAYLOR_UZED_S00_AXI_SLV_REG3_OFFSET 12
 
+/* Read-only performance counters (see taylor_uzed_v1_0_S00_AXI.vhd) */
+#define TAYLOR_UZED_S00_AXI_PERF_CTRL_OFFSET 16
+#define TAYLOR_UZED_S00_AXI_PERF_CYCLES_LO_OFFSET 20
+#define TAYLOR_UZED_S00_AXI_PERF_CYCLES_HI_OFFSET 24
+#define TAYLOR_UZED_S00_AXI_PERF_WR_COUNT_OFFSET 28
+#define TAYLOR_UZED_S00_AXI_PERF_RD_COUNT_OFFSET 32
+#define TAYLOR_UZED_S00_AXI_PERF_WR_STALL_OFFSET 36
+#define TAYLOR_UZED_S00_AXI_PERF_RD_STALL_OFFSET 40
+#define TAYLOR_UZED_S00_AXI_PERF_RESULTS_OFFSET 44
+
+/* Bits written to the performance counter control register */
+#define TAYLOR_UZED_PERF_CTRL_SNAPSHOT 0x00000001
+#define TAYLOR_UZED_PERF_CTRL_CLEAR 0x00000002
+
 
 /**************************** Type Definitions *****************************/
 /**
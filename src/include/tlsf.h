@@ -0,0 +1,86 @@
+#ifndef TLSF_H_
+#define TLSF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Two-level segregated fit allocator (Masmano, Ripoll, Crespo and Real, 2004)
+ *
+ * Free blocks are kept in lists by size class: the first level is the power of
+ * two below the size, the second splits that range into TLSF_SL_COUNT equal
+ * parts. A bitmap per level says which lists are non-empty, so finding a list
+ * with a block that is big enough takes two find-first-set operations (CLZ on
+ * the A9) whatever the state of the heap, and freeing merges with at most two
+ * physical neighbours. Both are constant time, where newlib's malloc() walks
+ * lists and can call sbrk().
+ *
+ * The pool is any region handed to tlsf_create(), OCM or DDR, which also holds
+ * the control structure. Blocks carry TLSF_ALIGN bytes of overhead and are
+ * TLSF_ALIGN aligned. The search starts at the size class above the request,
+ * so the first block found always fits, at the cost of passing over blocks in
+ * the request's own class that would have. The largest request is
+ * TLSF_BLOCK_MAX.
+ *
+ * Not thread safe. See heap_tlsf.c for the FreeRTOS heap built on it.
+ */
+
+#define TLSF_ALIGN_LOG2			3
+#define TLSF_ALIGN			(1 << TLSF_ALIGN_LOG2)
+#define TLSF_SL_COUNT_LOG2		5
+#define TLSF_SL_COUNT			(1 << TLSF_SL_COUNT_LOG2)
+/* Sizes below this all map to first level 0, in steps of TLSF_ALIGN */
+#define TLSF_FL_SHIFT			(TLSF_SL_COUNT_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_MAX			30
+#define TLSF_FL_COUNT			(TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define TLSF_BLOCK_MAX			((size_t) 1 << TLSF_FL_MAX)
+
+/* Per-pool counters, left out with TLSF_STATS set to 0 */
+#ifndef TLSF_STATS
+#define TLSF_STATS			1
+#endif
+
+struct tlsf_block;
+
+struct tlsf_stats {
+	/* Bytes the pool can give out, and how many of them are out now and at most */
+	size_t size;
+	size_t used;
+	size_t peak;
+	uint32_t allocs;
+	uint32_t frees;
+	uint32_t failures;
+};
+
+struct tlsf {
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap[TLSF_FL_COUNT];
+	struct tlsf_block *lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+	/* The first block, for tlsf_check() */
+	struct tlsf_block *first;
+#if TLSF_STATS
+	struct tlsf_stats stats;
+#endif
+};
+
+/* The control structure goes at the start of mem, returns NULL if bytes is too small */
+struct tlsf *tlsf_create(void *mem, size_t bytes);
+
+void *tlsf_malloc(struct tlsf *tlsf, size_t size);
+void tlsf_free(struct tlsf *tlsf, void *ptr);
+/* Usable size of an allocated block, at least what was asked for */
+size_t tlsf_block_size(const void *ptr);
+
+void tlsf_get_stats(const struct tlsf *tlsf, struct tlsf_stats *stats);
+/*
+ * Walks every block checking the links, flags and bitmaps, returns 0 if all
+ * is well. Linear in the number of blocks, so for tests and reports only.
+ * Also gives the free total and the largest free block, a measure of
+ * fragmentation, if those are not NULL.
+ */
+int tlsf_check(const struct tlsf *tlsf, size_t *free_bytes, size_t *largest_free);
+
+/* From heap_tlsf.c, the FreeRTOS heap on this allocator */
+void heap_tlsf_get_stats(struct tlsf_stats *stats);
+
+#endif /* TLSF_H_ */
@@ -0,0 +1,85 @@
+#ifndef TTC_MODEL_H_
+#define TTC_MODEL_H_
+
+#include <stdint.h>
+
+/*
+ * Host model of the six TTC counters, for trying out pwm.h and anything else
+ * that programs the counters without a board
+ *
+ * Time is in input clock ticks, one clock for every counter, and the model
+ * moves from one event to the next (a count reaching a match register or the
+ * end of its interval) rather than a tick at a time, so seconds of a slow
+ * output cost no more than a few edges. Registers are read and written at
+ * offsets from each counter's base, as on the board, and behave as the TRM
+ * describes them:
+ *
+ * - counting starts the prescaled tick after the counter is enabled or reset
+ * - in interval mode the count wraps to 0 on reaching the interval, and runs
+ *   on to 0xFFFF first if the interval is set below the count
+ * - with the waveform enabled, match 1 and the wrap change the output, high
+ *   until the match with the polarity bit set and low until it without
+ * - the interrupt status register clears when read
+ * - an enabled status bit reaches irq irq_latency ticks after it is set,
+ *   at the same tick if it is 0, and a handler then sees the count as it
+ *   is at that tick
+ *
+ * Decrement mode and the event timer are not modelled.
+ */
+
+#define TTC_MODEL_COUNTERS		6
+
+#define TTC_MODEL_CLK_CTRL		0x00
+#define TTC_MODEL_CNT_CTRL		0x0C
+#define TTC_MODEL_COUNTER		0x18
+#define TTC_MODEL_INTERVAL		0x24
+#define TTC_MODEL_MATCH_1		0x30
+#define TTC_MODEL_MATCH_2		0x3C
+#define TTC_MODEL_MATCH_3		0x48
+#define TTC_MODEL_ISR			0x54
+#define TTC_MODEL_IER			0x60
+
+#define TTC_MODEL_IXR_INTERVAL		0x01
+#define TTC_MODEL_IXR_MATCH_1		0x02
+#define TTC_MODEL_IXR_MATCH_2		0x04
+#define TTC_MODEL_IXR_MATCH_3		0x08
+#define TTC_MODEL_IXR_OVERFLOW		0x10
+
+struct ttc_model_counter {
+	uint32_t clk_ctrl;
+	uint32_t cnt_ctrl;
+	uint32_t count;
+	uint32_t interval;
+	uint32_t match[3];
+	uint32_t isr;
+	uint32_t ier;
+	/* Output level, whether or not the waveform is enabled */
+	uint32_t wave;
+	/* Input tick at which the count last changed, or was last worked out */
+	uint64_t origin;
+	/* When the pending interrupt reaches irq, UINT64_MAX with none pending */
+	uint64_t irq_due;
+};
+
+struct ttc_model {
+	struct ttc_model_counter counters[TTC_MODEL_COUNTERS];
+	uint64_t now;
+	/* Called on every change of an enabled waveform output */
+	void (*edge)(void *arg, uint32_t counter, uint64_t tick, uint32_t level);
+	/* Called when a status bit is set that is enabled in IER */
+	void (*irq)(void *arg, uint32_t counter);
+	void *arg;
+	uint64_t irq_latency;
+};
+
+/* Every counter disabled, as out of reset, and no interrupt latency */
+void ttc_model_init(struct ttc_model *model);
+
+/* The same shape as the pwm_ops callbacks, with model as ctx */
+uint32_t ttc_model_read(void *ctx, uint32_t counter, uint32_t offset);
+void ttc_model_write(void *ctx, uint32_t counter, uint32_t offset, uint32_t val);
+
+/* Runs the counters on for ticks of the input clock, calling edge and irq as things happen */
+void ttc_model_run(struct ttc_model *model, uint64_t ticks);
+
+#endif /* TTC_MODEL_H_ */
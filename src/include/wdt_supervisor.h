@@ -0,0 +1,64 @@
+#ifndef WDT_SUPERVISOR_H_
+#define WDT_SUPERVISOR_H_
+
+#include <stdint.h>
+
+/*
+ * Nothing in here refers to the Xilinx drivers. Time is whatever the caller
+ * passes to wdt_supervisor_check() (global timer ticks on the board, a plain
+ * counter for a host test) and the hardware watchdog is only reached through
+ * the kick callback.
+ */
+
+#define WDT_SUPERVISOR_MAX_CLIENTS	16
+#define WDT_SUPERVISOR_NONE		-1
+
+struct wdt_supervisor_client {
+	const char *name;
+	/* Longest the client may go without checking in, in supervisor time */
+	uint32_t deadline;
+	/* Only ever written by the client, only ever read by the supervisor */
+	volatile uint32_t checkins;
+	/* Supervisor side - check-in count last seen and when it last moved */
+	uint32_t seen;
+	uint32_t last_progress;
+};
+
+struct wdt_supervisor {
+	struct wdt_supervisor_client clients[WDT_SUPERVISOR_MAX_CLIENTS];
+	uint32_t num_clients;
+
+	void (*kick)(void *ctx);
+	void *ctx;
+	uint32_t kicks;
+
+	/* First client to miss its deadline, after which the watchdog is left to expire */
+	int late;
+	uint32_t late_time;
+	uint32_t late_overdue;
+};
+
+void wdt_supervisor_init(struct wdt_supervisor *sup, void (*kick)(void *ctx), void *ctx);
+/* Returns the client ID to check in with, or -1 */
+int wdt_supervisor_register(struct wdt_supervisor *sup, const char *name, uint32_t deadline,
+		uint32_t now);
+
+/*
+ * Called by the client, from a task or an interrupt handler. Each client ID
+ * must only be checked in from one context, since this is a plain increment.
+ */
+static inline void wdt_supervisor_checkin(struct wdt_supervisor *sup, int id)
+{
+	sup->clients[id].checkins++;
+}
+
+/*
+ * Called periodically, faster than the hardware watchdog timeout. Kicks the
+ * watchdog and returns 0 if every client has made progress within its deadline,
+ * otherwise returns -1 and never kicks again.
+ */
+int wdt_supervisor_check(struct wdt_supervisor *sup, uint32_t now);
+
+void wdt_supervisor_print(const struct wdt_supervisor *sup, uint32_t now);
+
+#endif /* WDT_SUPERVISOR_H_ */
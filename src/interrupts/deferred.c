@@ -0,0 +1,205 @@
+/*
+ * Deferred work for interrupt handlers
+ *
+ * Anything slow that a handler does, printing above all, stretches the time the
+ * whole system spends with IRQs masked, and with it the latency of every other
+ * interrupt. Queueing a work item instead costs an atomic swap and a couple of
+ * stores, so the handler is done in a few hundred cycles and the rest of the
+ * work runs from deferred_run() with interrupts enabled.
+ *
+ * Each priority has its own intrusive MPSC queue after Dmitry Vyukov's design.
+ * A producer publishes its item by swapping it into the head and then links the
+ * previous head to it. Between those two steps the consumer sees the item as
+ * not there yet, which only happens if the producer is on another core or is
+ * the code that deferred_run() itself interrupted, and it is picked up on the
+ * next call.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "deferred.h"
+
+static void deferred_push(struct deferred_queue *q, struct deferred_work *work)
+{
+	struct deferred_work *prev = NULL;
+
+	work->next = NULL;
+	/* __sync_lock_test_and_set() is only an acquire barrier, the item has to be complete first */
+	__sync_synchronize();
+	prev = __sync_lock_test_and_set(&q->head, work);
+	prev->next = work;
+	return;
+}
+
+static struct deferred_work *deferred_pop(struct deferred_queue *q)
+{
+	struct deferred_work *tail = q->tail;
+	struct deferred_work *next = tail->next;
+
+	if ( tail == &q->stub ) {
+		if ( next == NULL ) {
+			return NULL;
+		}
+		q->tail = next;
+		tail = next;
+		next = next->next;
+	}
+	if ( next != NULL ) {
+		q->tail = next;
+		return tail;
+	}
+	/* A producer is between its swap and its link */
+	if ( tail != q->head ) {
+		return NULL;
+	}
+	/* Last one in the queue, put the stub behind it so it can be taken */
+	deferred_push(q, &q->stub);
+	next = tail->next;
+	if ( next != NULL ) {
+		q->tail = next;
+		return tail;
+	}
+	return NULL;
+}
+
+void deferred_init(struct deferred *d, uint32_t (*clock)(void))
+{
+	struct deferred_queue *q = NULL;
+	uint32_t i = 0;
+
+	for (i = 0; i < DEFERRED_PRIORITIES; i++) {
+		q = &d->queues[i];
+		q->stub.next = NULL;
+		q->head = &q->stub;
+		q->tail = &q->stub;
+		q->depth = 0;
+		q->stats.queued = 0;
+		q->stats.coalesced = 0;
+		q->stats.run = 0;
+		q->stats.max_depth = 0;
+		q->stats.latency = 0;
+		q->stats.max_latency = 0;
+		q->stats.max_run = 0;
+	}
+	d->clock = clock;
+	return;
+}
+
+int deferred_work_init(struct deferred_work *work, const char *name, void (*func)(void *arg),
+		void *arg, uint32_t priority)
+{
+	if ( ( func == NULL ) || ( priority >= DEFERRED_PRIORITIES ) ) {
+		return -1;
+	}
+	work->next = NULL;
+	work->func = func;
+	work->arg = arg;
+	work->priority = priority;
+	work->pending = 0;
+	work->queued_at = 0;
+	work->name = name;
+	return 0;
+}
+
+int deferred_queue(struct deferred *d, struct deferred_work *work)
+{
+	struct deferred_queue *q = &d->queues[work->priority];
+	uint32_t depth = 0;
+
+	if ( __sync_lock_test_and_set(&work->pending, 1) != 0 ) {
+		__sync_add_and_fetch(&q->stats.coalesced, 1);
+		return 0;
+	}
+	if ( d->clock != NULL ) {
+		work->queued_at = d->clock();
+	}
+	deferred_push(q, work);
+
+	__sync_add_and_fetch(&q->stats.queued, 1);
+	depth = __sync_add_and_fetch(&q->depth, 1);
+	/* Can lose to a nested handler, it is a statistic */
+	if ( depth > q->stats.max_depth ) {
+		q->stats.max_depth = depth;
+	}
+	return 1;
+}
+
+uint32_t deferred_run(struct deferred *d, uint32_t budget)
+{
+	struct deferred_queue *q = NULL;
+	struct deferred_work *work = NULL;
+	uint32_t start = 0;
+	uint32_t elapsed = 0;
+	uint32_t run = 0;
+	uint32_t i = 0;
+
+	while ( run < budget ) {
+		work = NULL;
+		for (i = 0; i < DEFERRED_PRIORITIES; i++) {
+			q = &d->queues[i];
+			work = deferred_pop(q);
+			if ( work != NULL ) {
+				break;
+			}
+		}
+		if ( work == NULL ) {
+			break;
+		}
+		__sync_sub_and_fetch(&q->depth, 1);
+
+		/* From here on a handler may queue it again, and it will run again */
+		work->pending = 0;
+		__sync_synchronize();
+
+		if ( d->clock != NULL ) {
+			start = d->clock();
+			elapsed = start - work->queued_at;
+			q->stats.latency += elapsed;
+			if ( elapsed > q->stats.max_latency ) {
+				q->stats.max_latency = elapsed;
+			}
+		}
+		work->func(work->arg);
+		if ( d->clock != NULL ) {
+			elapsed = d->clock() - start;
+			if ( elapsed > q->stats.max_run ) {
+				q->stats.max_run = elapsed;
+			}
+		}
+		q->stats.run++;
+		run++;
+	}
+	return run;
+}
+
+uint32_t deferred_pending(const struct deferred *d)
+{
+	uint32_t pending = 0;
+	uint32_t i = 0;
+
+	for (i = 0; i < DEFERRED_PRIORITIES; i++) {
+		pending += d->queues[i].depth;
+	}
+	return pending;
+}
+
+void deferred_print_stats(const struct deferred *d)
+{
+	const struct deferred_stats *stats = NULL;
+	uint32_t i = 0;
+
+	printf("%-10s%-10s%-10s%-10s%-10s%-10s%-14s%-14s%-14s\n", "Priority", "Queued", "Coalesced",
+			"Run", "Depth", "Max depth", "Mean latency", "Max latency", "Max run");
+	for (i = 0; i < DEFERRED_PRIORITIES; i++) {
+		stats = &d->queues[i].stats;
+		printf("%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-10"PRIu32"%-14"PRIu64
+				"%-14"PRIu32"%-14"PRIu32"\n", i, stats->queued, stats->coalesced, stats->run,
+				d->queues[i].depth, stats->max_depth,
+				( stats->run == 0 ) ? 0 : stats->latency / stats->run,
+				stats->max_latency, stats->max_run);
+	}
+	return;
+}
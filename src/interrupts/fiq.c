@@ -0,0 +1,184 @@
+/*
+ * FIQ fast path for a single interrupt source
+ *
+ * The GIC in the Zynq has security extensions, and with FIQEn set in the CPU
+ * interface control register it signals group 0 (secure) interrupts as FIQ and
+ * group 1 (non-secure) interrupts as IRQ. Everything comes out of reset in
+ * group 0, so routing one source to FIQ means moving every other source to
+ * group 1. Since we run secure, AckCtl lets the IRQ side keep acknowledging
+ * group 1 interrupts exactly as it did before.
+ *
+ * The group alone is not enough. The GIC only signals an interrupt above the
+ * running priority, and everything starts at the same default, so while any
+ * IRQ handler is active the FIQ source would wait for its EOI just like the
+ * rest. The FIQ source is therefore raised to FIQ_PRIORITY, which no other
+ * source may share. With AckCtl set, the acknowledge on the FIQ side returns
+ * whatever is highest pending, so if the FIQ source is withdrawn between
+ * signalling the FIQ and the acknowledge, it returns a group 1 interrupt
+ * instead. That one is handed to its driver handler rather than dropped.
+ *
+ * The BSP FIQ vector saves every register and goes through the exception
+ * table. Instead the vector is patched to branch directly to fiq_entry(), which
+ * the compiler builds as a FIQ handler, so it only saves the registers it
+ * actually uses and returns with the right adjustment of the link register.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xil_cache.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+
+#include "fiq.h"
+
+/* CPU interface control register bits */
+#define GIC_ICCICR_ENABLE_S		0x00000001
+#define GIC_ICCICR_ENABLE_NS		0x00000002
+#define GIC_ICCICR_ACK_CTL		0x00000004
+#define GIC_ICCICR_FIQ_EN		0x00000008
+
+/* Interrupt security registers, one bit per interrupt, set for group 1 */
+#define GIC_ICDISR(n)			(XSCUGIC_SECURITY_OFFSET + ((n) * 4))
+#define GIC_ICDISR_COUNT		((XSCUGIC_MAX_NUM_INTR_INPUTS + 31) / 32)
+
+/* The FIQ entry is the last one in the vector table */
+#define FIQ_VECTOR_OFFSET		0x1C
+#define ARM_B_OPCODE			0xEA000000
+#define ARM_B_OFFSET_MASK		0x00FFFFFF
+/* A branch reaches +/- 32MB, in words */
+#define ARM_B_RANGE			0x00800000
+
+/* Above every group 1 source, which must stay numerically greater */
+#define FIQ_PRIORITY			0x00
+/* The Zynq GIC implements the top five bits of each priority */
+#define FIQ_PRIORITY_MASK		0xF8
+
+static void (*fiq_handler)(void);
+static XScuGic_VectorTableEntry *fiq_irq_table;
+static uint32_t fiq_cpu_base;
+static uint32_t fiq_id;
+static uint8_t fiq_saved_priority;
+
+static volatile uint32_t *fiq_vector;
+static uint32_t fiq_saved_vector;
+
+static void __attribute__((interrupt("FIQ"))) fiq_entry(void)
+{
+	uint32_t ack = Xil_In32(fiq_cpu_base + XSCUGIC_INT_ACK_OFFSET);
+	uint32_t id = ack & XSCUGIC_ACK_INTID_MASK;
+
+	if ( id == fiq_id ) {
+		fiq_handler();
+	} else if ( id < XSCUGIC_MAX_NUM_INTR_INPUTS ) {
+		/* A group 1 interrupt, acknowledged now, so it has to be handled here, in FIQ mode */
+		fiq_irq_table[id].Handler(fiq_irq_table[id].CallBackRef);
+	}
+	Xil_Out32(fiq_cpu_base + XSCUGIC_EOI_OFFSET, ack);
+}
+
+static uint32_t fiq_get_vbar(void)
+{
+	uint32_t vbar = 0;
+
+	__asm__ volatile ("mrc p15, 0, %0, c12, c0, 0" : "=r" (vbar));
+	return vbar;
+}
+
+static void fiq_write_vector(uint32_t instruction)
+{
+	*fiq_vector = instruction;
+	/* The vector is fetched through the instruction side, which does not see the data cache */
+	Xil_DCacheFlushRange((INTPTR) fiq_vector, sizeof(*fiq_vector));
+	Xil_ICacheInvalidateRange((INTPTR) fiq_vector, sizeof(*fiq_vector));
+	return;
+}
+
+static void fiq_set_groups(XScuGic *gic, uint32_t group0_id)
+{
+	uint32_t group1 = 0;
+	uint32_t n = 0;
+
+	for (n = 0; n < GIC_ICDISR_COUNT; n++) {
+		group1 = 0xFFFFFFFF;
+		if ( ( group0_id / 32 ) == n ) {
+			group1 &= ~(1u << (group0_id % 32));
+		}
+		XScuGic_DistWriteReg(gic, GIC_ICDISR(n), group1);
+	}
+	return;
+}
+
+int fiq_init(XScuGic *gic, uint32_t intr_id, void (*handler)(void))
+{
+	int32_t offset = 0;
+	uint8_t priority = 0;
+	uint8_t trigger = 0;
+	uint32_t id = 0;
+
+	if ( ( intr_id >= XSCUGIC_MAX_NUM_INTR_INPUTS ) || ( handler == NULL ) ) {
+		return XST_FAILURE;
+	}
+	/* Another source at the same priority could win the FIQ side acknowledge on its ID */
+	for (id = 0; id < XSCUGIC_MAX_NUM_INTR_INPUTS; id++) {
+		XScuGic_GetPriorityTriggerType(gic, id, &priority, &trigger);
+		if ( ( id != intr_id ) && ( ( priority & FIQ_PRIORITY_MASK ) == FIQ_PRIORITY ) ) {
+			fprintf(stderr, "Interrupt %"PRIu32" shares the FIQ priority\n", id);
+			return XST_FAILURE;
+		}
+	}
+	fiq_vector = (volatile uint32_t *) (fiq_get_vbar() + FIQ_VECTOR_OFFSET);
+	offset = ((int32_t) ((uint32_t) fiq_entry - ((uint32_t) fiq_vector + 8))) >> 2;
+	if ( ( offset >= ARM_B_RANGE ) || ( offset < -ARM_B_RANGE ) ) {
+		fprintf(stderr, "FIQ handler is out of branch range of the vector table\n");
+		return XST_FAILURE;
+	}
+
+	Xil_ExceptionDisableMask(XIL_EXCEPTION_FIQ);
+	XScuGic_Disable(gic, intr_id);
+
+	fiq_handler = handler;
+	fiq_irq_table = gic->Config->HandlerTable;
+	fiq_cpu_base = gic->Config->CpuBaseAddress;
+	fiq_id = intr_id;
+	fiq_saved_vector = *fiq_vector;
+	fiq_write_vector(ARM_B_OPCODE | (offset & ARM_B_OFFSET_MASK));
+
+	XScuGic_GetPriorityTriggerType(gic, intr_id, &fiq_saved_priority, &trigger);
+	XScuGic_SetPriorityTriggerType(gic, intr_id, FIQ_PRIORITY, trigger);
+	fiq_set_groups(gic, intr_id);
+	XScuGic_CPUWriteReg(gic, XSCUGIC_CONTROL_OFFSET, GIC_ICCICR_ENABLE_S | GIC_ICCICR_ENABLE_NS |
+			GIC_ICCICR_ACK_CTL | GIC_ICCICR_FIQ_EN);
+
+	XScuGic_Enable(gic, intr_id);
+	Xil_ExceptionEnableMask(XIL_EXCEPTION_FIQ);
+	return XST_SUCCESS;
+}
+
+void fiq_release(XScuGic *gic)
+{
+	uint32_t n = 0;
+	uint8_t priority = 0;
+	uint8_t trigger = 0;
+
+	if ( fiq_handler == NULL ) {
+		return;
+	}
+	Xil_ExceptionDisableMask(XIL_EXCEPTION_FIQ);
+	XScuGic_Disable(gic, fiq_id);
+
+	XScuGic_CPUWriteReg(gic, XSCUGIC_CONTROL_OFFSET, GIC_ICCICR_ENABLE_S | GIC_ICCICR_ENABLE_NS |
+			GIC_ICCICR_ACK_CTL);
+	for (n = 0; n < GIC_ICDISR_COUNT; n++) {
+		XScuGic_DistWriteReg(gic, GIC_ICDISR(n), 0);
+	}
+	XScuGic_GetPriorityTriggerType(gic, fiq_id, &priority, &trigger);
+	XScuGic_SetPriorityTriggerType(gic, fiq_id, fiq_saved_priority, trigger);
+	fiq_write_vector(fiq_saved_vector);
+	fiq_handler = NULL;
+	return;
+}
@@ -0,0 +1,95 @@
+/*
+ * Interrupt latency and jitter, IRQ path versus the FIQ fast path
+ *
+ * TTC0 counter 0 runs in interval mode and interrupts every time it wraps, after
+ * which it keeps counting up from zero. So the counter value read first thing
+ * in the handler is how long the interrupt took to get there. That is measured
+ * four ways - through the usual IRQ path and through fiq.c, each with the
+ * system idle and with a private timer interrupt handler that regularly keeps
+ * the processor busy for a while, which is what any slow IRQ handler does to
+ * everything else. The measurement itself is in irq_latency.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+
+#include "irq_latency.h"
+#include "fiq.h"
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+
+/* TTC interrupt rate */
+#define TTC_RATE_HZ			10000
+
+/* The load - 100us of busy handler every 1ms */
+#define LOAD_PERIOD_US			1000
+#define LOAD_BUSY_US			100
+
+#define ASCII_ESC			27
+
+static XScuGic gic;
+
+static int setup_system(void)
+{
+	XScuGic_Config *gic_config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+
+	if ( gic_config == NULL ) {
+		fprintf(stderr, "Could not find device configurations\n");
+		return XST_FAILURE;
+	}
+	if ( XScuGic_CfgInitialize(&gic, gic_config, gic_config->CpuBaseAddress) != XST_SUCCESS ) {
+		fprintf(stderr, "Could not initialize GIC device ID %d\n", GIC_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT,
+			(Xil_ExceptionHandler) XScuGic_InterruptHandler, &gic);
+
+	if ( irq_latency_init(&gic, TTC_RATE_HZ, LOAD_PERIOD_US, LOAD_BUSY_US) != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+	XScuGic_Connect(&gic, IRQ_LATENCY_LOAD_IRQ_ID, (Xil_InterruptHandler) irq_latency_load_handler, NULL);
+	return XST_SUCCESS;
+}
+
+int main(int args, char *argv[])
+{
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("FIQ versus IRQ Latency\n");
+	printf("----------------------\n");
+
+	if ( setup_system() != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+	printf("TTC0 at %d Hz, load of %dus every %dus\n\n", TTC_RATE_HZ, LOAD_BUSY_US, LOAD_PERIOD_US);
+	irq_latency_print_header("");
+
+	Xil_ExceptionEnableMask(XIL_EXCEPTION_IRQ);
+
+	XScuGic_Connect(&gic, IRQ_LATENCY_TTC_IRQ_ID, (Xil_InterruptHandler) irq_latency_ttc_handler, NULL);
+	XScuGic_Enable(&gic, IRQ_LATENCY_TTC_IRQ_ID);
+	irq_latency_run("IRQ idle", 0);
+	irq_latency_run("IRQ loaded", 1);
+	XScuGic_Disable(&gic, IRQ_LATENCY_TTC_IRQ_ID);
+	XScuGic_Disconnect(&gic, IRQ_LATENCY_TTC_IRQ_ID);
+
+	if ( fiq_init(&gic, IRQ_LATENCY_TTC_IRQ_ID, irq_latency_sample) != XST_SUCCESS ) {
+		fprintf(stderr, "Could not route TTC0 to FIQ\n");
+		return XST_FAILURE;
+	}
+	irq_latency_run("FIQ idle", 0);
+	irq_latency_run("FIQ loaded", 1);
+	fiq_release(&gic);
+
+	Xil_ExceptionDisableMask(XIL_EXCEPTION_IRQ);
+	cleanup_platform();
+	return XST_SUCCESS;
+}
@@ -0,0 +1,113 @@
+/*
+ * GIC priority, target and nesting management
+ *
+ * By default every source sits at the same priority and handlers run with IRQs
+ * masked, so whichever handler is running holds off every other interrupt in
+ * the system for as long as it takes. Giving sources distinct priorities is
+ * only half of the fix. The GIC will signal a more urgent interrupt while a
+ * less urgent one is active, but the CPU will not take it until the running
+ * handler unmasks IRQs.
+ *
+ * Nesting uses the save and restore documented for the standalone BSP,
+ * Xil_EnableNestedInterrupts() and Xil_DisableNestedInterrupts(). The first
+ * saves the IRQ mode return state on the IRQ stack, then switches to system
+ * mode with IRQs unmasked. The handler then runs on the system stack, which is
+ * also where any interrupt nested inside it ends up, so the stack has to allow
+ * for one handler frame per priority level in use. The acknowledge and end of
+ * interrupt stay in XScuGic_InterruptHandler() (or irq_prof_handler()), outside
+ * the nested region, which keeps the GIC's running priority right throughout.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+
+#include "gic_prio.h"
+
+/* Four byte-wide fields per distributor word, for both priority and targets */
+#define GIC_PRIO_WORDS			((XSCUGIC_MAX_NUM_INTR_INPUTS + 3) / 4)
+/* Below this the target registers are read only (SGIs and PPIs go to the CPU that owns them) */
+#define GIC_PRIO_FIRST_SPI		32
+
+int gic_prio_apply(XScuGic *gic, const struct gic_prio_entry *table, uint32_t count)
+{
+	uint32_t priority[GIC_PRIO_WORDS];
+	uint32_t targets[GIC_PRIO_WORDS];
+	uint8_t priority_dirty[GIC_PRIO_WORDS];
+	uint8_t targets_dirty[GIC_PRIO_WORDS];
+	uint32_t word = 0;
+	uint32_t shift = 0;
+	uint32_t writes = 0;
+	uint32_t i = 0;
+
+	memset(priority_dirty, 0, sizeof(priority_dirty));
+	memset(targets_dirty, 0, sizeof(targets_dirty));
+
+	for (i = 0; i < count; i++) {
+		if ( ( table[i].id >= XSCUGIC_MAX_NUM_INTR_INPUTS ) ||
+				( table[i].priority & ~GIC_PRIO_MASK ) || ( table[i].priority > GIC_PRIO_LOWEST ) ) {
+			fprintf(stderr, "Invalid priority 0x%02x for interrupt ID %u\n",
+					(unsigned int) table[i].priority, (unsigned int) table[i].id);
+			return -1;
+		}
+		word = table[i].id / 4;
+		shift = (table[i].id % 4) * 8;
+
+		if ( !priority_dirty[word] ) {
+			priority[word] = XScuGic_DistReadReg(gic, XSCUGIC_PRIORITY_OFFSET + (word * 4));
+			priority_dirty[word] = 1;
+		}
+		priority[word] = (priority[word] & ~(0xFFu << shift)) | ((uint32_t) table[i].priority << shift);
+
+		if ( ( table[i].targets == 0 ) || ( table[i].id < GIC_PRIO_FIRST_SPI ) ) {
+			continue;
+		}
+		if ( !targets_dirty[word] ) {
+			targets[word] = XScuGic_DistReadReg(gic, XSCUGIC_SPI_TARGET_OFFSET + (word * 4));
+			targets_dirty[word] = 1;
+		}
+		targets[word] = (targets[word] & ~(0xFFu << shift)) | ((uint32_t) table[i].targets << shift);
+	}
+
+	for (word = 0; word < GIC_PRIO_WORDS; word++) {
+		if ( priority_dirty[word] ) {
+			XScuGic_DistWriteReg(gic, XSCUGIC_PRIORITY_OFFSET + (word * 4), priority[word]);
+			writes++;
+		}
+		if ( targets_dirty[word] ) {
+			XScuGic_DistWriteReg(gic, XSCUGIC_SPI_TARGET_OFFSET + (word * 4), targets[word]);
+			writes++;
+		}
+	}
+	return writes;
+}
+
+/*
+ * The handler and its reference are picked up before the mode switch. After
+ * it the stack pointer is the system mode one, so nothing may be left that the
+ * compiler would look for relative to the IRQ mode stack pointer.
+ */
+static void gic_prio_nested_handler(void *callback_ref)
+{
+	struct gic_prio_nested *nested = callback_ref;
+	Xil_InterruptHandler handler = nested->handler;
+	void *handler_ref = nested->callback_ref;
+
+	Xil_EnableNestedInterrupts();
+	handler(handler_ref);
+	Xil_DisableNestedInterrupts();
+	return;
+}
+
+int gic_prio_connect_nested(XScuGic *gic, uint32_t id, struct gic_prio_nested *nested,
+		Xil_InterruptHandler handler, void *callback_ref)
+{
+	nested->handler = handler;
+	nested->callback_ref = callback_ref;
+	return XScuGic_Connect(gic, id, (Xil_InterruptHandler) gic_prio_nested_handler, (void *) nested);
+}
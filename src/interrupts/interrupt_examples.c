@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
+#include <stdint.h>
+#include <inttypes.h>
 
 #include "xparameters.h"
 #include "xil_types.h"
@@ -8,7 +9,14 @@
 #include "xstatus.h"
 #include "xgpiops.h"
 #include "xscugic.h"
+#include "xscutimer.h"
 #include "xil_exception.h"
+#include "xtime_l.h"
+
+#include "debounce.h"
+#include "debounce_gpiops.h"
+#include "irq_prof.h"
+#include "dev_pool.h"
 
 /* Microzed GPIO pins */
 #define GPIO_USER_LED		47 /* Bank 1, MIO 47 */
@@ -21,17 +29,25 @@
 #define GPIO_PIN_OFF		0
 #define GPIO_PIN_ON		1
 
+/* Debounce by sampling every 1ms and wanting 20 identical samples in a row */
+#define DEBOUNCE_PERIOD_US	1000
+#define DEBOUNCE_SAMPLES	20
+
 /* Avnet FMC carrier card GPIO pins */
 #define ASCII_ESC		27
 
+static struct debounce Debounce;
+
 static void GpioPbswHandler(void *CallbackRef, u32 Bank, u32 Status);
 
 static void GpioPbswHandler(void *CallbackRef, u32 Bank, u32 Status)
 {
-	static int PressCnt = 0;
-	fprintf(stderr, "Button pressed %d\n", ++PressCnt);
-	/* Sleep 200ms to avoid bouncing switches */
-	usleep(200000);
+	/*
+	 * Sleeping here to wait out the bounce would hold off every other interrupt
+	 * for the duration, so just mask the pin and let the debounce timer decide
+	 * what the switch did
+	 */
+	debounce_gpiops_edges((struct debounce *) CallbackRef, Bank, Status);
 	return;
 }
 
@@ -47,32 +63,34 @@ int main(int argc, char *argv[])
 	XScuGic_Config *GicConfig;
 	XScuGic *Gic;
 
+	/* Private timer instance used to sample the switch */
+	XScuTimer *Timer;
+
+	struct debounce_event Event;
+	XTime Start;
+	XTime Now;
+	XTime Stop;
+
 	int i;
 	int Status;
+	int PressCnt = 0;
 
 	printf("%c[2J", ASCII_ESC);
 	printf("Interrupt Examples\n");
 	printf("------------------\n");
 
 	/* Set up GPIO driver */
-	Gpio = malloc(sizeof(XGpioPs));
-	if (Gpio == NULL) {
-		fprintf(stderr, "Could not allocate memory for GPIO instance\n");
-		return XST_FAILURE;
-	}
-
+	Gpio = dev_pool_gpiops(XPAR_XGPIOPS_0_DEVICE_ID);
 	GpioConfig = XGpioPs_LookupConfig(XPAR_XGPIOPS_0_DEVICE_ID);
 	Status = XGpioPs_CfgInitialize(Gpio, GpioConfig, GpioConfig->BaseAddr);
 
 	if (Status != XST_SUCCESS) {
 		fprintf(stderr, "Could not initialize GPIO instance\n");
-		free(Gpio);
 		return XST_FAILURE;
 	} else {
 		Status = XGpioPs_SelfTest(Gpio);
 		if (Status != XST_SUCCESS) {
 			printf("GPIO self test\t\tFAIL\n");
-			free(Gpio);
 			return XST_FAILURE;
 		} else {
 			printf("GPIO self test\t\tSUCCESS\n");
@@ -90,24 +108,17 @@ int main(int argc, char *argv[])
 	XGpioPs_WritePin(Gpio, GPIO_USER_LED, GPIO_PIN_OFF);
 
 	/* Set up GIC driver */
-	Gic = malloc(sizeof(XScuGic));
-	if (Gic == NULL) {
-		fprintf(stderr, "Could not allocate memory for GIC instance\n");
-		return XST_FAILURE;
-	}
-
+	Gic = dev_pool_gic(XPAR_SCUGIC_SINGLE_DEVICE_ID);
 	GicConfig = XScuGic_LookupConfig(XPAR_SCUGIC_SINGLE_DEVICE_ID);
 	Status = XScuGic_CfgInitialize(Gic, GicConfig, GicConfig->CpuBaseAddress);
 
 	if (Status != XST_SUCCESS) {
 		fprintf(stderr, "Could not initialize GIC instance\n");
-		free(Gic);
 		return XST_FAILURE;
 	} else {
 		Status = XScuGic_SelfTest(Gic);
 		if (Status != XST_SUCCESS) {
 			printf("GIC self test\t\tFAIL\n");
-			free(Gic);
 			return XST_FAILURE;
 		} else {
 			printf("GIC self test\t\tSUCCESS\n");
@@ -118,12 +129,10 @@ int main(int argc, char *argv[])
 
 	/*
 	 * Registers the GIC interrupt handler with the exception handling logic
-	 * within the ARM Cortex A9 processor
+	 * within the ARM Cortex A9 processor - the profiling version, which works
+	 * out how long each interrupt source keeps the processor busy
 	 */
-	Xil_ExceptionRegisterHandler(
-			XIL_EXCEPTION_ID_INT,
-			(Xil_ExceptionHandler) XScuGic_InterruptHandler,
-			Gic);
+	irq_prof_init(Gic);
 
 	/*
 	 * There is a meaningful distinction between callback functions and interrupt
@@ -141,11 +150,20 @@ int main(int argc, char *argv[])
 		fprintf(stderr, "Could not connect GPIO interrupt handler to interrupt controller\n");
 	}
 
-	/* Define a rising edge for GPIO interrupts on the PBSW pin */
+	/* Both edges are needed so that the debouncer sees releases as well as presses */
 	XGpioPs_SetIntrTypePin(
 			Gpio,
 			GPIO_USER_PBSW,
-			XGPIOPS_IRQ_TYPE_EDGE_RISING);
+			XGPIOPS_IRQ_TYPE_EDGE_BOTH);
+
+	debounce_init(&Debounce, &debounce_gpiops_ops, (void *) Gpio);
+	debounce_add_pin(&Debounce, GPIO_USER_PBSW, GPIO_PIN_ON, DEBOUNCE_SAMPLES);
+
+	Timer = dev_pool_scutimer(XPAR_XSCUTIMER_0_DEVICE_ID);
+	Status = debounce_gpiops_tick_init(&Debounce, Gic, Timer, DEBOUNCE_PERIOD_US);
+	if (Status != XST_SUCCESS) {
+		fprintf(stderr, "Could not start debounce timer\n");
+	}
 
 	/*
 	 * Define the function to be called by the GPIO interrupt handler when an
@@ -164,7 +182,7 @@ int main(int argc, char *argv[])
 	 * The application instead 'registers' the callback with the library, which
 	 * is then called to provide application-specific functionality.
 	 */
-	XGpioPs_SetCallbackHandler(Gpio, (void *) Gpio, GpioPbswHandler);
+	XGpioPs_SetCallbackHandler(Gpio, (void *) &Debounce, GpioPbswHandler);
 
 	/* Enable interrupts for the GPIO pin that the switch is attached to */
 	XGpioPs_IntrEnablePin(Gpio, GPIO_USER_PBSW);
@@ -189,13 +207,31 @@ int main(int argc, char *argv[])
 		printf("Interrupts enabled for GPIO pin %d\n", GPIO_USER_PBSW);
 	}
 
+	dev_pool_report();
 	printf("Waiting for button press...\n");
-	/* Stall for 12 seconds and then finish up */
-	usleep(12*1e6);
+	/* Report debounced switch events for 12 seconds and then finish up */
+	XTime_GetTime(&Start);
+	Now = Start;
+	Stop = Now + 12 * (XTime) COUNTS_PER_SECOND;
+	while (Now < Stop) {
+		if (debounce_get_event(&Debounce, &Event)) {
+			if (Event.type == DEBOUNCE_PRESS) {
+				printf("Button pressed %d\n", ++PressCnt);
+				XGpioPs_WritePin(Gpio, GPIO_USER_LED, PressCnt & 1);
+			} else {
+				printf("Button released\n");
+			}
+		}
+		XTime_GetTime(&Now);
+	}
+	if (Debounce.dropped != 0) {
+		printf("Dropped %"PRIu32" switch events\n", Debounce.dropped);
+	}
+	printf("\n");
+	irq_prof_print(Now - Start);
 	printf("Finished\n");
 
-	free(Gpio);
-	free(Gic);
+	XScuTimer_Stop(Timer);
 
 	cleanup_platform();
 
@@ -0,0 +1,163 @@
+/*
+ * Interrupt latency measurement, see irq_latency.h
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xscugic.h"
+#include "xscutimer.h"
+#include "xttcps.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "irq_latency.h"
+
+#define TTC_DEVICE_ID			XPAR_XTTCPS_0_DEVICE_ID
+#define TIMER_DEVICE_ID			XPAR_XSCUTIMER_0_DEVICE_ID
+
+struct latency {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint64_t sum_sq;
+};
+
+static XScuGic *latency_gic;
+static XTtcPs ttc;
+static XScuTimer timer;
+
+static uint32_t ttc_base;
+static uint32_t busy_ticks;
+static volatile struct latency latency;
+
+static void latency_reset(void)
+{
+	latency.count = 0;
+	latency.min = UINT32_MAX;
+	latency.max = 0;
+	latency.sum = 0;
+	latency.sum_sq = 0;
+	return;
+}
+
+/* Read the counter before anything else, then clear the interrupt */
+void irq_latency_sample(void)
+{
+	uint32_t ticks = Xil_In32(ttc_base + XTTCPS_COUNT_VALUE_OFFSET);
+
+	/* Clear on read */
+	Xil_In32(ttc_base + XTTCPS_ISR_OFFSET);
+
+	latency.count++;
+	latency.sum += ticks;
+	latency.sum_sq += (uint64_t) ticks * ticks;
+	if ( ticks < latency.min ) {
+		latency.min = ticks;
+	}
+	if ( ticks > latency.max ) {
+		latency.max = ticks;
+	}
+	return;
+}
+
+void irq_latency_ttc_handler(void *callback_ref)
+{
+	irq_latency_sample();
+	return;
+}
+
+void irq_latency_load_handler(void *callback_ref)
+{
+	uint32_t start = gtimer_read_lo();
+
+	XScuTimer_ClearInterruptStatus(&timer);
+	while ( ( gtimer_read_lo() - start ) < busy_ticks ) {
+		;
+	}
+	return;
+}
+
+int irq_latency_init(XScuGic *gic, uint32_t ttc_rate_hz, uint32_t load_period_us, uint32_t load_busy_us)
+{
+	XTtcPs_Config *ttc_config = XTtcPs_LookupConfig(TTC_DEVICE_ID);
+	XScuTimer_Config *timer_config = XScuTimer_LookupConfig(TIMER_DEVICE_ID);
+
+	if ( ( ttc_config == NULL ) || ( timer_config == NULL ) ) {
+		fprintf(stderr, "Could not find timer configurations\n");
+		return XST_FAILURE;
+	}
+	latency_gic = gic;
+	busy_ticks = (COUNTS_PER_SECOND / 1000000) * load_busy_us;
+
+	/* Left running by a previous launch is fine, everything is set up again below */
+	if ( XTtcPs_CfgInitialize(&ttc, ttc_config, ttc_config->BaseAddress) != XST_SUCCESS ) {
+		XTtcPs_Stop(&ttc);
+		XTtcPs_CfgInitialize(&ttc, ttc_config, ttc_config->BaseAddress);
+	}
+	ttc_base = ttc_config->BaseAddress;
+	XTtcPs_DisableInterrupts(&ttc, XTTCPS_IXR_ALL_MASK);
+	XTtcPs_SetOptions(&ttc, XTTCPS_OPTION_INTERVAL_MODE | XTTCPS_OPTION_WAVE_DISABLE);
+	XTtcPs_SetPrescaler(&ttc, XTTCPS_CLK_CNTRL_PS_DISABLE);
+	XTtcPs_SetInterval(&ttc, ttc_config->InputClockHz / ttc_rate_hz);
+
+	if ( XScuTimer_CfgInitialize(&timer, timer_config, timer_config->BaseAddr) != XST_SUCCESS ) {
+		XScuTimer_Stop(&timer);
+	}
+	XScuTimer_EnableAutoReload(&timer);
+	XScuTimer_LoadTimer(&timer, (COUNTS_PER_SECOND / 1000000) * load_period_us);
+	XScuTimer_EnableInterrupt(&timer);
+	return XST_SUCCESS;
+}
+
+void irq_latency_print_header(const char *title)
+{
+	printf("%-30s%-10s%-12s%-12s%-12s%-12s\n", title, "Count", "Min (ns)", "Mean (ns)", "Max (ns)",
+			"Jitter (ns)");
+	return;
+}
+
+void irq_latency_run(const char *name, uint32_t loaded)
+{
+	uint32_t hz = ttc.Config.InputClockHz;
+	double mean = 0;
+	double var = 0;
+	XTime start = 0;
+	XTime now = 0;
+
+	latency_reset();
+	if ( loaded ) {
+		XScuGic_Enable(latency_gic, IRQ_LATENCY_LOAD_IRQ_ID);
+		XScuTimer_Start(&timer);
+	}
+	XTtcPs_ClearInterruptStatus(&ttc, XTTCPS_IXR_ALL_MASK);
+	XTtcPs_EnableInterrupts(&ttc, XTTCPS_IXR_INTERVAL_MASK);
+	XTtcPs_Start(&ttc);
+
+	XTime_GetTime(&start);
+	do {
+		XTime_GetTime(&now);
+	} while ( ( now - start ) < (XTime) IRQ_LATENCY_RUN_SECONDS * COUNTS_PER_SECOND );
+
+	XTtcPs_Stop(&ttc);
+	XTtcPs_DisableInterrupts(&ttc, XTTCPS_IXR_ALL_MASK);
+	XScuTimer_Stop(&timer);
+	XScuGic_Disable(latency_gic, IRQ_LATENCY_LOAD_IRQ_ID);
+
+	if ( latency.count == 0 ) {
+		printf("%-30s%s\n", name, "no interrupts");
+		return;
+	}
+	mean = (double) latency.sum / latency.count;
+	var = ((double) latency.sum_sq / latency.count) - (mean * mean);
+	printf("%-30s%-10"PRIu32"%-12.0f%-12.0f%-12.0f%-12.1f\n", name, latency.count,
+			1e9 * latency.min / hz, 1e9 * mean / hz, 1e9 * latency.max / hz,
+			( var > 0 ) ? 1e9 * sqrt(var) / hz : 0.0);
+	return;
+}
@@ -0,0 +1,196 @@
+/*
+ * Per-interrupt profiling dispatcher
+ *
+ * Does what XScuGic_InterruptHandler() does - acknowledge, look the handler up
+ * in the driver's table, call it, end of interrupt - and times the handler with
+ * the PMU cycle counter on the way. Time spent in interrupts that nest inside a
+ * handler is charged to them rather than to the handler they interrupted.
+ *
+ * Each interrupt's statistics sit behind their own sequence counter, which is
+ * odd while the handler is updating them. Readers copy the statistics and try
+ * again if the counter moved, so nothing has to be stopped or masked to look.
+ * An interrupt never nests inside itself, so there is only ever one writer.
+ *
+ * No floating point in here - the standalone BSP does not save the VFP
+ * registers on interrupt entry.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "xtime_l.h"
+
+#include "pmu.h"
+#include "irq_prof.h"
+
+/* More than the number of GIC priority levels anyone is likely to use */
+#define IRQ_PROF_MAX_DEPTH		16
+
+/* The global timer (XTime) runs at half the CPU clock */
+#define CYCLES_PER_TICK			(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / COUNTS_PER_SECOND)
+
+struct irq_prof_entry {
+	volatile uint32_t seq;
+	struct irq_prof_stats stats;
+};
+
+static struct irq_prof_entry prof_table[XSCUGIC_MAX_NUM_INTR_INPUTS];
+static volatile uint32_t spurious;
+
+/* Current nesting depth, and cycles spent in interrupts nested at each depth */
+static volatile uint32_t depth;
+static uint32_t nested_cycles[IRQ_PROF_MAX_DEPTH + 1];
+
+static const struct {
+	uint32_t id;
+	const char *name;
+} irq_names[] = {
+	{XPS_GLOBAL_TMR_INT_ID, "Global timer"},
+	{XPS_SCU_TMR_INT_ID, "SCU private timer"},
+	{XPS_SCU_WDT_INT_ID, "SCU private WDT"},
+	{XPS_TTC0_0_INT_ID, "TTC0 counter 0"},
+	{XPS_TTC0_1_INT_ID, "TTC0 counter 1"},
+	{XPS_TTC0_2_INT_ID, "TTC0 counter 2"},
+	{XPS_GPIO_INT_ID, "GPIO"},
+	{XPS_UART0_INT_ID, "UART0"},
+	{XPS_TTC1_0_INT_ID, "TTC1 counter 0"},
+	{XPS_TTC1_1_INT_ID, "TTC1 counter 1"},
+	{XPS_TTC1_2_INT_ID, "TTC1 counter 2"},
+	{XPS_UART1_INT_ID, "UART1"},
+};
+
+int irq_prof_init(XScuGic *gic)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < XSCUGIC_MAX_NUM_INTR_INPUTS; i++) {
+		prof_table[i].seq = 0;
+		prof_table[i].stats.count = 0;
+		prof_table[i].stats.cycles = 0;
+		prof_table[i].stats.max_cycles = 0;
+		prof_table[i].stats.max_depth = 0;
+	}
+	spurious = 0;
+	depth = 0;
+
+	pmu_cycles_enable();
+	Xil_ExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT,
+			(Xil_ExceptionHandler) irq_prof_handler, (void *) gic);
+	return XST_SUCCESS;
+}
+
+void irq_prof_handler(void *callback_ref)
+{
+	XScuGic *gic = callback_ref;
+	XScuGic_VectorTableEntry *entry = NULL;
+	struct irq_prof_entry *prof = NULL;
+	uint32_t ack = 0;
+	uint32_t id = 0;
+	uint32_t level = 0;
+	uint32_t start = 0;
+	uint32_t total = 0;
+	uint32_t self = 0;
+
+	ack = XScuGic_CPUReadReg(gic, XSCUGIC_INT_ACK_OFFSET);
+	id = ack & XSCUGIC_ACK_INTID_MASK;
+	if ( id >= XSCUGIC_MAX_NUM_INTR_INPUTS ) {
+		/* Nothing pending by the time we asked, and the GIC ignores the end of interrupt */
+		spurious++;
+		XScuGic_CPUWriteReg(gic, XSCUGIC_EOI_OFFSET, ack);
+		return;
+	}
+
+	level = ++depth;
+	if ( level > IRQ_PROF_MAX_DEPTH ) {
+		level = IRQ_PROF_MAX_DEPTH;
+	}
+	nested_cycles[level] = 0;
+
+	start = pmu_cycles();
+	entry = &gic->Config->HandlerTable[id];
+	entry->Handler(entry->CallBackRef);
+	total = pmu_cycles() - start;
+
+	self = total - nested_cycles[level];
+	nested_cycles[level - 1] += total;
+	depth--;
+
+	prof = &prof_table[id];
+	prof->seq++;
+	__sync_synchronize();
+	prof->stats.count++;
+	prof->stats.cycles += self;
+	if ( self > prof->stats.max_cycles ) {
+		prof->stats.max_cycles = self;
+	}
+	if ( level > prof->stats.max_depth ) {
+		prof->stats.max_depth = level;
+	}
+	__sync_synchronize();
+	prof->seq++;
+
+	XScuGic_CPUWriteReg(gic, XSCUGIC_EOI_OFFSET, ack);
+	return;
+}
+
+void irq_prof_read(uint32_t id, struct irq_prof_stats *stats)
+{
+	struct irq_prof_entry *prof = NULL;
+	uint32_t seq = 0;
+
+	if ( id >= XSCUGIC_MAX_NUM_INTR_INPUTS ) {
+		return;
+	}
+	prof = &prof_table[id];
+	do {
+		seq = prof->seq;
+		__sync_synchronize();
+		*stats = prof->stats;
+		__sync_synchronize();
+	} while ( ( seq & 1 ) || ( seq != prof->seq ) );
+	return;
+}
+
+uint32_t irq_prof_spurious(void)
+{
+	return spurious;
+}
+
+static const char *irq_prof_name(uint32_t id)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < sizeof(irq_names) / sizeof(irq_names[0]); i++) {
+		if ( irq_names[i].id == id ) {
+			return irq_names[i].name;
+		}
+	}
+	return "";
+}
+
+void irq_prof_print(uint64_t elapsed_ticks)
+{
+	struct irq_prof_stats stats;
+	uint64_t elapsed_cycles = elapsed_ticks * CYCLES_PER_TICK;
+	uint32_t id = 0;
+
+	printf("%-6s%-20s%-12s%-12s%-12s%-8s%-8s\n",
+			"ID", "Source", "Count", "Mean cyc", "Max cyc", "Depth", "CPU %");
+	for (id = 0; id < XSCUGIC_MAX_NUM_INTR_INPUTS; id++) {
+		irq_prof_read(id, &stats);
+		if ( stats.count == 0 ) {
+			continue;
+		}
+		printf("%-6"PRIu32"%-20s%-12"PRIu32"%-12"PRIu64"%-12"PRIu32"%-8"PRIu32"%-8.3f\n",
+				id, irq_prof_name(id), stats.count, stats.cycles / stats.count,
+				stats.max_cycles, stats.max_depth,
+				( elapsed_cycles != 0 ) ? (100.0 * stats.cycles) / elapsed_cycles : 0.0);
+	}
+	printf("%-26s%"PRIu32"\n", "Spurious", spurious);
+	return;
+}
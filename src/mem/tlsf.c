@@ -0,0 +1,431 @@
+/*
+ * Two-level segregated fit allocator, see tlsf.h
+ *
+ * Block layout, after Conte's implementation of the same paper: the header is
+ * a pointer to the previous block in memory, the size of this one, and the
+ * free list links. Only the size is kept while a block is in use. The payload
+ * starts right after it, and the previous-block pointer of the next block
+ * lives in the end of this one's payload, where it is only written once this
+ * block is free. The two low bits of the size, which is always a multiple of
+ * TLSF_ALIGN, say whether this block and the one before it are free. Both
+ * pointer and size take TLSF_ALIGN bytes, padded on the A9, so that every
+ * payload stays aligned.
+ *
+ * The pool ends in a zero size block that is always in use, so merging never
+ * runs off the end, and the first block's "previous is free" bit is never set,
+ * so it never runs off the start.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "tlsf.h"
+
+#define BLOCK_FREE			((size_t) 1)
+#define BLOCK_PREV_FREE			((size_t) 2)
+#define BLOCK_FLAGS			(BLOCK_FREE | BLOCK_PREV_FREE)
+
+struct tlsf_block {
+	struct tlsf_block *prev_phys;
+	size_t size __attribute__((aligned(TLSF_ALIGN)));
+	struct tlsf_block *next_free __attribute__((aligned(TLSF_ALIGN)));
+	struct tlsf_block *prev_free;
+};
+
+/* Room for prev_phys at the end of the previous block */
+#define BLOCK_PREV_SIZE			offsetof(struct tlsf_block, size)
+#define BLOCK_START			offsetof(struct tlsf_block, next_free)
+/* What a block in use costs on top of its payload */
+#define BLOCK_OVERHEAD			(BLOCK_START - BLOCK_PREV_SIZE)
+/* Enough payload for the free list links and the next block's prev_phys */
+#define BLOCK_SIZE_MIN			(sizeof(struct tlsf_block) - BLOCK_START + BLOCK_PREV_SIZE)
+#define SMALL_BLOCK_SIZE		((size_t) 1 << TLSF_FL_SHIFT)
+
+static uint32_t fls_size(size_t size)
+{
+	return (uint32_t) (sizeof(unsigned long) * 8 - 1 - __builtin_clzl((unsigned long) size));
+}
+
+static uint32_t ffs_word(uint32_t word)
+{
+	return (uint32_t) __builtin_ctz(word);
+}
+
+static size_t align_up(size_t x)
+{
+	return (x + TLSF_ALIGN - 1) & ~((size_t) TLSF_ALIGN - 1);
+}
+
+static size_t block_size(const struct tlsf_block *block)
+{
+	return block->size & ~BLOCK_FLAGS;
+}
+
+static void block_set_size(struct tlsf_block *block, size_t size)
+{
+	block->size = size | (block->size & BLOCK_FLAGS);
+	return;
+}
+
+static void *block_to_ptr(const struct tlsf_block *block)
+{
+	return (uint8_t *) block + BLOCK_START;
+}
+
+static struct tlsf_block *block_from_ptr(const void *ptr)
+{
+	return (struct tlsf_block *) ((uint8_t *) ptr - BLOCK_START);
+}
+
+static struct tlsf_block *block_next(const struct tlsf_block *block)
+{
+	return (struct tlsf_block *) ((uint8_t *) block_to_ptr(block) + block_size(block) - BLOCK_PREV_SIZE);
+}
+
+/* Tells the next block where this one starts, returns the next block */
+static struct tlsf_block *block_link_next(struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_next(block);
+
+	next->prev_phys = block;
+	return next;
+}
+
+static void block_mark_free(struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_link_next(block);
+
+	next->size |= BLOCK_PREV_FREE;
+	block->size |= BLOCK_FREE;
+	return;
+}
+
+static void block_mark_used(struct tlsf_block *block)
+{
+	struct tlsf_block *next = block_next(block);
+
+	next->size &= ~BLOCK_PREV_FREE;
+	block->size &= ~BLOCK_FREE;
+	return;
+}
+
+/* First and second level of the list a free block of this size goes in */
+static void mapping_insert(size_t size, uint32_t *fl, uint32_t *sl)
+{
+	uint32_t f = 0;
+
+	if ( size < SMALL_BLOCK_SIZE ) {
+		*fl = 0;
+		*sl = (uint32_t) (size / (SMALL_BLOCK_SIZE / TLSF_SL_COUNT));
+		return;
+	}
+	f = fls_size(size);
+	*sl = (uint32_t) (size >> (f - TLSF_SL_COUNT_LOG2)) ^ TLSF_SL_COUNT;
+	*fl = f - (TLSF_FL_SHIFT - 1);
+	return;
+}
+
+/* The same, rounded up to the next list so that any block in it is big enough */
+static void mapping_search(size_t size, uint32_t *fl, uint32_t *sl)
+{
+	if ( size >= SMALL_BLOCK_SIZE ) {
+		size += ((size_t) 1 << (fls_size(size) - TLSF_SL_COUNT_LOG2)) - 1;
+	}
+	mapping_insert(size, fl, sl);
+	return;
+}
+
+static struct tlsf_block *search_suitable(struct tlsf *tlsf, uint32_t *fl, uint32_t *sl)
+{
+	uint32_t sl_map = 0;
+	uint32_t fl_map = 0;
+
+	if ( *fl >= TLSF_FL_COUNT ) {
+		return NULL;
+	}
+	sl_map = tlsf->sl_bitmap[*fl] & (~(uint32_t) 0 << *sl);
+	if ( sl_map == 0 ) {
+		/* Nothing left at this level, so the smallest list at a higher one */
+		fl_map = ( *fl + 1 < 32 ) ? tlsf->fl_bitmap & (~(uint32_t) 0 << (*fl + 1)) : 0;
+		if ( fl_map == 0 ) {
+			return NULL;
+		}
+		*fl = ffs_word(fl_map);
+		sl_map = tlsf->sl_bitmap[*fl];
+	}
+	*sl = ffs_word(sl_map);
+	return tlsf->lists[*fl][*sl];
+}
+
+static void remove_free(struct tlsf *tlsf, struct tlsf_block *block, uint32_t fl, uint32_t sl)
+{
+	struct tlsf_block *prev = block->prev_free;
+	struct tlsf_block *next = block->next_free;
+
+	if ( next != NULL ) {
+		next->prev_free = prev;
+	}
+	if ( prev != NULL ) {
+		prev->next_free = next;
+	} else {
+		tlsf->lists[fl][sl] = next;
+		if ( next == NULL ) {
+			tlsf->sl_bitmap[fl] &= ~((uint32_t) 1 << sl);
+			if ( tlsf->sl_bitmap[fl] == 0 ) {
+				tlsf->fl_bitmap &= ~((uint32_t) 1 << fl);
+			}
+		}
+	}
+	return;
+}
+
+static void insert_free(struct tlsf *tlsf, struct tlsf_block *block, uint32_t fl, uint32_t sl)
+{
+	struct tlsf_block *head = tlsf->lists[fl][sl];
+
+	block->next_free = head;
+	block->prev_free = NULL;
+	if ( head != NULL ) {
+		head->prev_free = block;
+	}
+	tlsf->lists[fl][sl] = block;
+	tlsf->fl_bitmap |= (uint32_t) 1 << fl;
+	tlsf->sl_bitmap[fl] |= (uint32_t) 1 << sl;
+	return;
+}
+
+static void block_remove(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	remove_free(tlsf, block, fl, sl);
+	return;
+}
+
+static void block_insert(struct tlsf *tlsf, struct tlsf_block *block)
+{
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+
+	mapping_insert(block_size(block), &fl, &sl);
+	insert_free(tlsf, block, fl, sl);
+	return;
+}
+
+/* Splits a free block so that it is size long, returns the free remainder, not yet in any list */
+static struct tlsf_block *block_split(struct tlsf_block *block, size_t size)
+{
+	struct tlsf_block *rest = (struct tlsf_block *) ((uint8_t *) block_to_ptr(block) + size - BLOCK_PREV_SIZE);
+	size_t rest_size = block_size(block) - (size + BLOCK_OVERHEAD);
+
+	rest->size = rest_size;
+	block_mark_free(rest);
+	block_set_size(block, size);
+	return rest;
+}
+
+/* Merges block into prev, which comes right before it in memory */
+static struct tlsf_block *block_absorb(struct tlsf_block *prev, struct tlsf_block *block)
+{
+	prev->size += block_size(block) + BLOCK_OVERHEAD;
+	block_link_next(prev);
+	return prev;
+}
+
+static size_t adjust_size(size_t size)
+{
+	size_t adjusted = 0;
+
+	if ( ( size == 0 ) || ( size >= TLSF_BLOCK_MAX ) ) {
+		return 0;
+	}
+	adjusted = align_up(size);
+	return ( adjusted < BLOCK_SIZE_MIN ) ? BLOCK_SIZE_MIN : adjusted;
+}
+
+struct tlsf *tlsf_create(void *mem, size_t bytes)
+{
+	struct tlsf *tlsf = NULL;
+	struct tlsf_block *block = NULL;
+	struct tlsf_block *end = NULL;
+	uintptr_t start = align_up((uintptr_t) mem);
+	size_t control = align_up(sizeof(struct tlsf));
+	size_t pool = 0;
+
+	/* Room for the control structure, one block's overhead, the smallest payload and the end block */
+	if ( ( mem == NULL ) || ( bytes < (start - (uintptr_t) mem) + control + 2 * BLOCK_OVERHEAD +
+			BLOCK_SIZE_MIN ) ) {
+		return NULL;
+	}
+	pool = (bytes - (start - (uintptr_t) mem) - control - 2 * BLOCK_OVERHEAD) & ~((size_t) TLSF_ALIGN - 1);
+	if ( pool >= TLSF_BLOCK_MAX ) {
+		pool = TLSF_BLOCK_MAX - TLSF_ALIGN;
+	}
+
+	tlsf = (struct tlsf *) start;
+	memset(tlsf, 0, sizeof(*tlsf));
+
+	/* The first block's prev_phys would sit in the end of the control structure, but is never used */
+	block = (struct tlsf_block *) (start + control - BLOCK_PREV_SIZE);
+	block->size = pool;
+	block_mark_free(block);
+	block_insert(tlsf, block);
+	tlsf->first = block;
+
+	end = block_link_next(block);
+	end->size = BLOCK_PREV_FREE;
+#if TLSF_STATS
+	tlsf->stats.size = pool;
+#endif
+	return tlsf;
+}
+
+void *tlsf_malloc(struct tlsf *tlsf, size_t size)
+{
+	struct tlsf_block *block = NULL;
+	struct tlsf_block *rest = NULL;
+	size_t adjusted = adjust_size(size);
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+
+	if ( adjusted != 0 ) {
+		mapping_search(adjusted, &fl, &sl);
+		block = search_suitable(tlsf, &fl, &sl);
+	}
+	if ( block == NULL ) {
+#if TLSF_STATS
+		tlsf->stats.failures++;
+#endif
+		return NULL;
+	}
+	remove_free(tlsf, block, fl, sl);
+
+	/* Whatever is left over goes back as a free block of its own, if it is big enough to be one */
+	if ( block_size(block) >= adjusted + BLOCK_OVERHEAD + BLOCK_SIZE_MIN ) {
+		rest = block_split(block, adjusted);
+		block_link_next(block);
+		block_insert(tlsf, rest);
+	}
+	block_mark_used(block);
+#if TLSF_STATS
+	tlsf->stats.allocs++;
+	tlsf->stats.used += block_size(block);
+	if ( tlsf->stats.used > tlsf->stats.peak ) {
+		tlsf->stats.peak = tlsf->stats.used;
+	}
+#endif
+	return block_to_ptr(block);
+}
+
+void tlsf_free(struct tlsf *tlsf, void *ptr)
+{
+	struct tlsf_block *block = NULL;
+	struct tlsf_block *next = NULL;
+
+	if ( ptr == NULL ) {
+		return;
+	}
+	block = block_from_ptr(ptr);
+#if TLSF_STATS
+	tlsf->stats.frees++;
+	tlsf->stats.used -= block_size(block);
+#endif
+	block_mark_free(block);
+
+	if ( block->size & BLOCK_PREV_FREE ) {
+		block_remove(tlsf, block->prev_phys);
+		block = block_absorb(block->prev_phys, block);
+	}
+	next = block_next(block);
+	if ( next->size & BLOCK_FREE ) {
+		block_remove(tlsf, next);
+		block = block_absorb(block, next);
+	}
+	block_insert(tlsf, block);
+	return;
+}
+
+size_t tlsf_block_size(const void *ptr)
+{
+	return ( ptr != NULL ) ? block_size(block_from_ptr(ptr)) : 0;
+}
+
+void tlsf_get_stats(const struct tlsf *tlsf, struct tlsf_stats *stats)
+{
+#if TLSF_STATS
+	*stats = tlsf->stats;
+#else
+	memset(stats, 0, sizeof(*stats));
+#endif
+	return;
+}
+
+int tlsf_check(const struct tlsf *tlsf, size_t *free_bytes, size_t *largest_free)
+{
+	const struct tlsf_block *block = tlsf->first;
+	const struct tlsf_block *next = NULL;
+	const struct tlsf_block *list = NULL;
+	size_t total = 0;
+	size_t largest = 0;
+	size_t listed = 0;
+	uint32_t prev_free = 0;
+	uint32_t fl = 0;
+	uint32_t sl = 0;
+
+	/* In memory order: flags agree with the neighbours, no two free blocks side by side */
+	for (; block_size(block) != 0; block = next) {
+		next = block_next(block);
+		if ( ( ( block->size & BLOCK_PREV_FREE ) != 0 ) != prev_free ) {
+			return -1;
+		}
+		if ( block->size & BLOCK_FREE ) {
+			if ( prev_free || ( next->prev_phys != block ) ) {
+				return -1;
+			}
+			total += block_size(block);
+			if ( block_size(block) > largest ) {
+				largest = block_size(block);
+			}
+		}
+		prev_free = ( block->size & BLOCK_FREE ) != 0;
+	}
+	if ( ( ( block->size & BLOCK_PREV_FREE ) != 0 ) != prev_free ) {
+		return -1;
+	}
+
+	/* By list: every listed block is free and in the right list, and the bitmaps match */
+	for (fl = 0; fl < TLSF_FL_COUNT; fl++) {
+		if ( ( ( tlsf->fl_bitmap >> fl ) & 1 ) != ( tlsf->sl_bitmap[fl] != 0 ) ) {
+			return -1;
+		}
+		for (sl = 0; sl < TLSF_SL_COUNT; sl++) {
+			list = tlsf->lists[fl][sl];
+			if ( ( ( tlsf->sl_bitmap[fl] >> sl ) & 1 ) != ( list != NULL ) ) {
+				return -1;
+			}
+			for (; list != NULL; list = list->next_free) {
+				uint32_t list_fl = 0;
+				uint32_t list_sl = 0;
+
+				mapping_insert(block_size(list), &list_fl, &list_sl);
+				if ( !( list->size & BLOCK_FREE ) || ( list_fl != fl ) || ( list_sl != sl ) ) {
+					return -1;
+				}
+				listed += block_size(list);
+			}
+		}
+	}
+	if ( listed != total ) {
+		return -1;
+	}
+	if ( free_bytes != NULL ) {
+		*free_bytes = total;
+	}
+	if ( largest_free != NULL ) {
+		*largest_free = largest;
+	}
+	return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Statically allocated driver instances, see dev_pool.h
+ *
+ * The malloc() figures in the report are what newlib's allocator would have
+ * carved out of the heap for the instances handed out so far: the request plus
+ * a 4 byte size word, rounded up to 8 bytes, 16 at the least. The heap itself
+ * is still linked in for stdio, so the saving is in what the heap has to be
+ * sized for, not in the heap going away.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "dev_pool.h"
+
+#define MALLOC_HEADER			4
+#define MALLOC_ALIGN			8
+#define MALLOC_MIN_CHUNK		16
+
+#define DEV_POOL_SLOT(type)		struct { type dev; } __attribute__((aligned(DEV_POOL_ALIGN)))
+
+struct pool {
+	const char *name;
+	uint32_t count;
+	uint32_t size;
+	uint32_t stride;
+	/* Bit per device ID handed out */
+	uint32_t used;
+};
+
+static DEV_POOL_SLOT(XScuGic) gic_pool[DEV_POOL_GIC_COUNT];
+static DEV_POOL_SLOT(XScuTimer) scutimer_pool[DEV_POOL_SCUTIMER_COUNT];
+static DEV_POOL_SLOT(XScuWdt) scuwdt_pool[DEV_POOL_SCUWDT_COUNT];
+static DEV_POOL_SLOT(XTtcPs) ttc_pool[DEV_POOL_TTC_COUNT];
+static DEV_POOL_SLOT(XGpioPs) gpiops_pool[DEV_POOL_GPIOPS_COUNT];
+
+enum {
+	POOL_GIC,
+	POOL_SCUTIMER,
+	POOL_SCUWDT,
+	POOL_TTC,
+	POOL_GPIOPS,
+	POOL_COUNT
+};
+
+static struct pool pools[POOL_COUNT] = {
+	[POOL_GIC] = {"XScuGic", DEV_POOL_GIC_COUNT, sizeof(XScuGic), sizeof(gic_pool[0]), 0},
+	[POOL_SCUTIMER] = {"XScuTimer", DEV_POOL_SCUTIMER_COUNT, sizeof(XScuTimer), sizeof(scutimer_pool[0]), 0},
+	[POOL_SCUWDT] = {"XScuWdt", DEV_POOL_SCUWDT_COUNT, sizeof(XScuWdt), sizeof(scuwdt_pool[0]), 0},
+	[POOL_TTC] = {"XTtcPs", DEV_POOL_TTC_COUNT, sizeof(XTtcPs), sizeof(ttc_pool[0]), 0},
+	[POOL_GPIOPS] = {"XGpioPs", DEV_POOL_GPIOPS_COUNT, sizeof(XGpioPs), sizeof(gpiops_pool[0]), 0},
+};
+
+/* From the BSP's lscript.ld */
+extern char __bss_start;
+extern char __bss_end;
+extern char _heap_start;
+extern char _heap_end;
+
+static void *pool_get(uint32_t pool, void *base, uint16_t device_id)
+{
+	if ( device_id >= pools[pool].count ) {
+		return NULL;
+	}
+	pools[pool].used |= 1UL << device_id;
+	return (uint8_t *) base + device_id * pools[pool].stride;
+}
+
+XScuGic *dev_pool_gic(uint16_t device_id)
+{
+	return pool_get(POOL_GIC, gic_pool, device_id);
+}
+
+XScuTimer *dev_pool_scutimer(uint16_t device_id)
+{
+	return pool_get(POOL_SCUTIMER, scutimer_pool, device_id);
+}
+
+XScuWdt *dev_pool_scuwdt(uint16_t device_id)
+{
+	return pool_get(POOL_SCUWDT, scuwdt_pool, device_id);
+}
+
+XTtcPs *dev_pool_ttc(uint16_t device_id)
+{
+	return pool_get(POOL_TTC, ttc_pool, device_id);
+}
+
+XGpioPs *dev_pool_gpiops(uint16_t device_id)
+{
+	return pool_get(POOL_GPIOPS, gpiops_pool, device_id);
+}
+
+static uint32_t malloc_chunk(uint32_t size)
+{
+	uint32_t chunk = (size + MALLOC_HEADER + MALLOC_ALIGN - 1) & ~(MALLOC_ALIGN - 1);
+
+	return ( chunk < MALLOC_MIN_CHUNK ) ? MALLOC_MIN_CHUNK : chunk;
+}
+
+static uint32_t bits_set(uint32_t bits)
+{
+	uint32_t n = 0;
+
+	for (; bits != 0; bits &= bits - 1) {
+		n++;
+	}
+	return n;
+}
+
+void dev_pool_report(void)
+{
+	const struct pool *pool = NULL;
+	uint32_t used = 0;
+	uint32_t total = 0;
+	uint32_t heap = 0;
+	uint32_t i = 0;
+
+	printf("%-12s%-10s%-8s%-8s%-8s%-10s%-10s\n", "Driver", "Devices", "Used", "Size", "Slot", "Static",
+			"malloc");
+	for (i = 0; i < POOL_COUNT; i++) {
+		pool = &pools[i];
+		used = bits_set(pool->used);
+		printf("%-12s%-10"PRIu32"%-8"PRIu32"%-8"PRIu32"%-8"PRIu32"%-10"PRIu32"%-10"PRIu32"\n", pool->name,
+				pool->count, used, pool->size, pool->stride, pool->count * pool->stride,
+				used * malloc_chunk(pool->size));
+		total += pool->count * pool->stride;
+		heap += used * malloc_chunk(pool->size);
+	}
+	printf("%-30s%"PRIu32" bytes in .bss\n", "Static pools", total);
+	printf("%-30s%"PRIu32" bytes of heap\n", "Same instances from malloc", heap);
+	printf("%-30s%"PRIu32" bytes\n", "Linked .bss", (uint32_t) (&__bss_end - &__bss_start));
+	printf("%-30s%"PRIu32" bytes\n", "Linked heap", (uint32_t) (&_heap_end - &_heap_start));
+	return;
+}
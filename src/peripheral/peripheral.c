@@ -12,8 +12,15 @@
 
 /* Debug and workaround codes */
 #include "ps7_dbg.h"
+#include "dev_pool.h"
+#include "console_uartps.h"
 
 #include "taylor_uzed.h"
+#include "taylor_perf.h"
+
+/* What the PS saw during the timing loop */
+#include "pmu_scope.h"
+#include "pmu_a9.h"
 
 /* Necessary for creating driver instances */
 #define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
@@ -33,25 +40,24 @@
 
 void clear_console()
 {
-        fprintf(stdout, "%c[2J", ASCII_ESC);
-        fflush(stdout);
-
+        console_printf(&console_uart, "%c[2J", ASCII_ESC);
+        return;
 }
 void print_operation(char *str)
 {
-        fprintf(stdout, "%-30s", str);
-        fflush(stdout);
+        console_printf(&console_uart, "%-30s", str);
+        return;
 }
 void print_result(char *str)
 {
-        fprintf(stdout, "%10s\n", str);
-        fflush(stdout);
+        console_printf(&console_uart, "%10s\n", str);
+        return;
 }
 void print_diff(uint32_t actual, uint32_t expected)
 {
-		fprintf(stdout, "Actual: 0x%08"PRIx32" Expected: 0x%08"PRIx32"\n",
+		console_printf(&console_uart, "Actual: 0x%08"PRIx32" Expected: 0x%08"PRIx32"\n",
 				(uint32_t) actual, (uint32_t) expected);
-		fflush(stdout);
+		return;
 }
 
 uint32_t peripheral_scratch(uint32_t *p_ptr, uint32_t val)
@@ -111,10 +117,30 @@ int main(int args, char *argv[])
 
 	uint32_t result = 0;
 	uint32_t scratch32;
+	uint32_t iterations = 0;
+	uint64_t elapsed = 0;
+
+	/* What the PL saw during the timing loop */
+	struct taylor_perf perf_start;
+	struct taylor_perf perf_stop;
+	struct taylor_perf perf_delta;
+
+	/* Cycles, stalls and cache refills on the PS side of the same accesses */
+	static const uint32_t pmu_events[] = {
+		PMU_INSTRUCTIONS,
+		PMU_STALL_BACKEND,
+		PMU_L1D_REFILL,
+		PMU_DTLB_REFILL,
+	};
+	struct pmu_a9 pmu_a9;
+	struct pmu pmu;
+	struct pmu_scope pmu_access;
 
 	XScuTimer_Config *timer_config = NULL;
 	XScuTimer *timer = NULL;
 
+	/* No interrupt controller here, so the console stays polled, as stdio was */
+	console_uartps_init(CONSOLE_BLOCK);
 	clear_console();
 
 	/* ------------ PS interface check  --------------------------------------- */
@@ -139,14 +165,9 @@ int main(int args, char *argv[])
 		print_result("FAIL");
 		printf("Could not initialize private timer %d\n", TIMER_DEVICE_ID);
 	} else {
-		timer = malloc(sizeof(XScuTimer));
-		if ( timer == NULL ) {
-			print_result("FAIL");
-			printf("Could not allocate memory for private timer %d\n", TIMER_DEVICE_ID);
-		} else {
-			XScuTimer_CfgInitialize(timer, timer_config, timer_config->BaseAddr);
-			print_result("OK");
-		}
+		timer = dev_pool_scutimer(TIMER_DEVICE_ID);
+		XScuTimer_CfgInitialize(timer, timer_config, timer_config->BaseAddr);
+		print_result("OK");
 	}
 
 	/* Private timer clock is always CPU_3X2X clock (333 or 250MHz) */
@@ -155,18 +176,53 @@ int main(int args, char *argv[])
 	printf("%-10s%-15s%-15s\n", "----", "----------", "-------");
 	XScuTimer_SetPrescaler(timer, 0);
 	XScuTimer_DisableAutoReload(timer);
+	pmu_a9_init(&pmu_a9);
+	pmu_init(&pmu, &pmu_a9_ops, &pmu_a9);
+	pmu_scope_init(&pmu, &pmu_access, "PL write and read (and timer start and stop)", pmu_events,
+			sizeof(pmu_events) / sizeof(pmu_events[0]));
+	pmu_scope_calibrate(&pmu, &pmu_access, 16);
+	taylor_perf_snapshot(PERIPHERAL_BASE, &perf_start);
 	for (i = 0; i < 2560; i = i + 25) {
 		XScuTimer_LoadTimer(timer, 0xFFFFFFFF);
 		start_time = XScuTimer_GetCounterValue(timer);
+		/* Outside the timer, so the timer ticks are what they always were */
+		pmu_scope_begin(&pmu, &pmu_access);
 		XScuTimer_Start(timer);
 		TAYLOR_UZED_mWriteReg(PERIPHERAL_BASE, 0x4, i);
 		result = TAYLOR_UZED_mReadReg(PERIPHERAL_BASE, 0xC);
 		XScuTimer_Stop(timer);
+		pmu_scope_end(&pmu, &pmu_access);
 		stop_time = XScuTimer_GetCounterValue(timer);
 		printf("%-10d%-12f%-12"PRIu32"\n", (int) i, (float) result / 256, start_time - stop_time);
+		elapsed += start_time - stop_time;
+		iterations++;
+	}
+	taylor_perf_snapshot(PERIPHERAL_BASE, &perf_stop);
+	taylor_perf_diff(&perf_start, &perf_stop, &perf_delta);
+
+	/*
+	 * Every iteration should be exactly one write, one read and one result as
+	 * far as the PL is concerned - anything else means the PS side timing above
+	 * is not measuring what we think it is
+	 */
+	printf("\n");
+	taylor_perf_print(&perf_delta);
+	printf("%-20s%"PRIu64"\n", "PS timer ticks", elapsed);
+	printf("\n");
+	pmu_scope_print(&pmu_access);
+	printf("\n");
+	print_operation("PL accesses per iteration");
+	if ( ( perf_delta.wr_count == iterations ) && ( perf_delta.rd_count == iterations )
+			&& ( perf_delta.results == iterations ) ) {
+		print_result("OK");
+	} else {
+		print_result("FAIL");
+		print_diff(perf_delta.wr_count, iterations);
+		print_diff(perf_delta.rd_count, iterations);
+		print_diff(perf_delta.results, iterations);
 	}
 
-	free(timer);
+	dev_pool_report();
 
 	return 0;
 }
@@ -0,0 +1,77 @@
+/*
+ * Driver for the performance counters inside the taylor_uzed AXI4-Lite slave
+ *
+ * The hardware keeps free running counters of clock cycles, AXI handshakes,
+ * address channel stalls and results produced by the user logic. Reading them
+ * directly would tear the 64-bit cycle count (and the other counters keep
+ * moving between reads), so the PS first requests a snapshot, which the PL
+ * latches into shadow registers in a single clock, and then reads the shadow
+ * copy back at its leisure.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xil_io.h"
+
+#include "taylor_uzed.h"
+#include "taylor_perf.h"
+
+/* Zero the live counters (the shadow copy keeps the last snapshot) */
+void taylor_perf_clear(uint32_t base)
+{
+	TAYLOR_UZED_mWriteReg(base, TAYLOR_UZED_S00_AXI_PERF_CTRL_OFFSET,
+			TAYLOR_UZED_PERF_CTRL_CLEAR);
+	return;
+}
+
+/* Latch every counter in the PL and then read the latched values back */
+void taylor_perf_snapshot(uint32_t base, struct taylor_perf *snap)
+{
+	uint32_t lo = 0;
+	uint32_t hi = 0;
+
+	TAYLOR_UZED_mWriteReg(base, TAYLOR_UZED_S00_AXI_PERF_CTRL_OFFSET,
+			TAYLOR_UZED_PERF_CTRL_SNAPSHOT);
+
+	lo = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_CYCLES_LO_OFFSET);
+	hi = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_CYCLES_HI_OFFSET);
+	snap->cycles = ((uint64_t) hi << 32) | lo;
+	snap->wr_count = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_WR_COUNT_OFFSET);
+	snap->rd_count = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_RD_COUNT_OFFSET);
+	snap->wr_stall = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_WR_STALL_OFFSET);
+	snap->rd_stall = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_RD_STALL_OFFSET);
+	snap->results = TAYLOR_UZED_mReadReg(base, TAYLOR_UZED_S00_AXI_PERF_RESULTS_OFFSET);
+
+	return;
+}
+
+/*
+ * Difference between two snapshots, less the accesses that taking the snapshots
+ * generated. Counters are 32-bit in the PL, so unsigned subtraction handles a
+ * single wrap between snapshots. Stall cycles caused by the snapshot reads
+ * themselves cannot be separated out and remain in the result.
+ */
+void taylor_perf_diff(const struct taylor_perf *start, const struct taylor_perf *stop,
+		struct taylor_perf *delta)
+{
+	delta->cycles = stop->cycles - start->cycles;
+	delta->wr_count = stop->wr_count - start->wr_count - TAYLOR_PERF_SNAPSHOT_WRITES;
+	delta->rd_count = stop->rd_count - start->rd_count - TAYLOR_PERF_SNAPSHOT_READS;
+	delta->wr_stall = stop->wr_stall - start->wr_stall;
+	delta->rd_stall = stop->rd_stall - start->rd_stall;
+	delta->results = stop->results - start->results;
+	return;
+}
+
+void taylor_perf_print(const struct taylor_perf *snap)
+{
+	printf("%-20s%"PRIu64"\n", "PL cycles", snap->cycles);
+	printf("%-20s%"PRIu32"\n", "AXI writes", snap->wr_count);
+	printf("%-20s%"PRIu32"\n", "AXI reads", snap->rd_count);
+	printf("%-20s%"PRIu32"\n", "Write stalls", snap->wr_stall);
+	printf("%-20s%"PRIu32"\n", "Read stalls", snap->rd_stall);
+	printf("%-20s%"PRIu32"\n", "Results", snap->results);
+	return;
+}
@@ -10,7 +10,7 @@ entity taylor_uzed_v1_0 is
 		-- Do not modify the parameters beyond this line
 		-- Parameters of Axi Slave Bus Interface S00_AXI
 		C_S00_AXI_DATA_WIDTH	: integer	:= 32;
-		C_S00_AXI_ADDR_WIDTH	: integer	:= 4
+		C_S00_AXI_ADDR_WIDTH	: integer	:= 6
 	);
 	port (
 		-- Users to add ports here
@@ -49,7 +49,7 @@ architecture arch_imp of taylor_uzed_v1_0 is
 	component taylor_uzed_v1_0_S00_AXI is
 		generic (
       C_S_AXI_DATA_WIDTH	: integer	:= 32;
-      C_S_AXI_ADDR_WIDTH	: integer	:= 4
+      C_S_AXI_ADDR_WIDTH	: integer	:= 6
 		);
 		port (
       -- User interface
@@ -57,6 +57,8 @@ architecture arch_imp of taylor_uzed_v1_0 is
       reg1          : out std_logic_vector(C_S_AXI_DATA_WIDTH-1 downto 0);
       reg2          : out std_logic_vector(C_S_AXI_DATA_WIDTH-1 downto 0);
       reg3          : in  std_logic_vector(C_S_AXI_DATA_WIDTH-1 downto 0);
+      reg1_wr       : out std_logic;
+      result_vld    : in  std_logic;
 
       -- AXI interface
       S_AXI_ACLK	  : in  std_logic;
@@ -94,6 +96,13 @@ architecture arch_imp of taylor_uzed_v1_0 is
   signal reg2         : std_logic_vector(31 downto 0);
   signal reg3         : std_logic_vector(31 downto 0);
 
+  -- A write to reg1 produces a result four clocks later (squared / p1, p2,
+  -- int, result), so the strobe is delayed by the same amount and counted by
+  -- the performance counters in the AXI slave
+  signal reg1_wr      : std_logic;
+  signal result_pipe  : std_logic_vector(3 downto 0) := (others => '0');
+  signal result_vld   : std_logic;
+
   constant  C         : signed(16 downto 0) := to_signed(-577, 17);
   constant  B         : signed(16 downto 0) := to_signed(57910, 17);
   constant  A         : signed(16 downto 0) := to_signed(33610, 17);
@@ -110,6 +119,7 @@ begin
   p0        <= A;
   reg3      <= std_logic_vector(result);
   interrupt <= '0';
+  result_vld <= result_pipe(3);
 
   process (s00_axi_aclk) begin
     if rising_edge(s00_axi_aclk) then
@@ -117,12 +127,13 @@ begin
       -- 2nd order term in the quadratic
       p2      <= squared * C;
       -- 1st order term in the quadratic
-      p1      <= signed('0' & reg1(15 downto 0) * B;
+      p1      <= signed('0' & reg1(15 downto 0)) * B;
       -- Going to incur one cycle of latency beyond whatever the adder and
       -- multiplier bring
       int     <= p2(48 downto 32) + ("000" & p1(32 downto 19)) + p0;
       -- On the next cycle, we get the result
       result(15 downto 0) <= int(15 downto 0);
+      result_pipe <= result_pipe(2 downto 0) & reg1_wr;
     else
       null;
     end if;
@@ -159,6 +170,8 @@ begin
       reg1          => reg1,
       reg2          => reg2,
       reg3          => reg3,
+      reg1_wr       => reg1_wr,
+      result_vld    => result_vld,
       S_AXI_ACLK	  => s00_axi_aclk,
       S_AXI_ARESETN	=> s00_axi_aresetn,
       S_AXI_AWADDR	=> s00_axi_awaddr,
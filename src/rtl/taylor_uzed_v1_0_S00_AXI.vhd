@@ -12,7 +12,7 @@ entity taylor_uzed_v1_0_S00_AXI is
 		-- Width of S_AXI data bus
 		C_S_AXI_DATA_WIDTH	: integer	:= 32;
 		-- Width of S_AXI address bus
-		C_S_AXI_ADDR_WIDTH	: integer	:= 4
+		C_S_AXI_ADDR_WIDTH	: integer	:= 6
 	);
 	port (
 		-- Users to add ports here
@@ -21,6 +21,11 @@ entity taylor_uzed_v1_0_S00_AXI is
     reg2  : out std_logic_vector((C_S_AXI_DATA_WIDTH-1) downto 0);
     reg3  : in  std_logic_vector((C_S_AXI_DATA_WIDTH-1) downto 0);
 
+    -- Pulses for one clock when reg1 (the operand) is written by the PS
+    reg1_wr     : out std_logic;
+    -- Pulses for one clock when user logic has produced a new result
+    result_vld  : in  std_logic;
+
 		-- User ports ends
 		-- Do not modify the ports beyond this line
 
@@ -107,7 +112,7 @@ architecture arch_imp of taylor_uzed_v1_0_S00_AXI is
 	-- ADDR_LSB = 2 for 32 bits (n downto 2)
 	-- ADDR_LSB = 3 for 64 bits (n downto 3)
 	constant ADDR_LSB  : integer := (C_S_AXI_DATA_WIDTH/32)+ 1;
-	constant OPT_MEM_ADDR_BITS : integer := 1;
+	constant OPT_MEM_ADDR_BITS : integer := 3;
 	------------------------------------------------
 	---- Signals for user logic register space example
 	--------------------------------------------------
@@ -122,6 +127,38 @@ architecture arch_imp of taylor_uzed_v1_0_S00_AXI is
 	signal byte_index	: integer;
 	signal aw_en	: std_logic;
 
+	------------------------------------------------
+	---- Performance counters
+	--------------------------------------------------
+	-- Register map (byte offsets) beyond the four user registers:
+	--
+	--   0x10  PERF_CTRL      W: bit 0 snapshot, bit 1 clear   R: 0
+	--   0x14  CYCLES_LO      clock cycles since reset [31:0]
+	--   0x18  CYCLES_HI      clock cycles since reset [63:32]
+	--   0x1C  WR_COUNT       completed write address/data handshakes
+	--   0x20  RD_COUNT       completed read address handshakes
+	--   0x24  WR_STALL       cycles with AWVALID high and AWREADY low
+	--   0x28  RD_STALL       cycles with ARVALID high and ARREADY low
+	--   0x2C  RESULTS        results produced by the user logic
+	--
+	-- All counters run continuously. Reads return a shadow copy that is only
+	-- updated by a snapshot request, so that a multi-word read by the PS is
+	-- coherent (i.e., CYCLES_HI and CYCLES_LO come from the same clock).
+	signal perf_snap	: std_logic;
+	signal perf_clr	: std_logic;
+	signal cnt_cycles	: unsigned(63 downto 0);
+	signal cnt_wr	: unsigned(31 downto 0);
+	signal cnt_rd	: unsigned(31 downto 0);
+	signal cnt_wr_stall	: unsigned(31 downto 0);
+	signal cnt_rd_stall	: unsigned(31 downto 0);
+	signal cnt_results	: unsigned(31 downto 0);
+	signal snap_cycles	: std_logic_vector(63 downto 0);
+	signal snap_wr	: std_logic_vector(31 downto 0);
+	signal snap_rd	: std_logic_vector(31 downto 0);
+	signal snap_wr_stall	: std_logic_vector(31 downto 0);
+	signal snap_rd_stall	: std_logic_vector(31 downto 0);
+	signal snap_results	: std_logic_vector(31 downto 0);
+
 begin
 	-- I/O Connections assignments
 
@@ -230,11 +267,18 @@ begin
 	      slv_reg1 <= (others => '0');
 	      slv_reg2 <= (others => '0');
 	      -- slv_reg3 <= (others => '0');
+	      reg1_wr   <= '0';
+	      perf_snap <= '0';
+	      perf_clr  <= '0';
 	    else
+	      -- Strobes only last for the cycle following the write
+	      reg1_wr   <= '0';
+	      perf_snap <= '0';
+	      perf_clr  <= '0';
 	      loc_addr := axi_awaddr(ADDR_LSB + OPT_MEM_ADDR_BITS downto ADDR_LSB);
 	      if (slv_reg_wren = '1') then
 	        case loc_addr is
-	          when b"00" =>
+	          when b"0000" =>
 	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
 	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
 	                -- Respective byte enables are asserted as per write strobes                   
@@ -242,7 +286,8 @@ begin
 	                slv_reg0(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
 	              end if;
 	            end loop;
-	          when b"01" =>
+	          when b"0001" =>
+	            reg1_wr <= '1';
 	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
 	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
 	                -- Respective byte enables are asserted as per write strobes                   
@@ -250,7 +295,7 @@ begin
 	                slv_reg1(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
 	              end if;
 	            end loop;
-	          when b"10" =>
+	          when b"0010" =>
 	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
 	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
 	                -- Respective byte enables are asserted as per write strobes                   
@@ -258,7 +303,7 @@ begin
 	                slv_reg2(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
 	              end if;
 	            end loop;
-	          when b"11" =>
+	          when b"0011" =>
 	            for byte_index in 0 to (C_S_AXI_DATA_WIDTH/8-1) loop
 	              if ( S_AXI_WSTRB(byte_index) = '1' ) then
 	                -- Respective byte enables are asserted as per write strobes                   
@@ -266,6 +311,12 @@ begin
 	                -- slv_reg3(byte_index*8+7 downto byte_index*8) <= S_AXI_WDATA(byte_index*8+7 downto byte_index*8);
 	              end if;
 	            end loop;
+	          when b"0100" =>
+	            -- Performance counter control is a strobe, not storage
+	            if ( S_AXI_WSTRB(0) = '1' ) then
+	              perf_snap <= S_AXI_WDATA(0);
+	              perf_clr  <= S_AXI_WDATA(1);
+	            end if;
 	          when others =>
 	            slv_reg0 <= slv_reg0;
 	            slv_reg1 <= slv_reg1;
@@ -358,20 +409,35 @@ begin
 	-- and the slave is ready to accept the read address.
 	slv_reg_rden <= axi_arready and S_AXI_ARVALID and (not axi_rvalid) ;
 
-	process (slv_reg0, slv_reg1, slv_reg2, slv_reg3, axi_araddr, S_AXI_ARESETN, slv_reg_rden)
+	process (slv_reg0, slv_reg1, slv_reg2, slv_reg3, snap_cycles, snap_wr, snap_rd,
+	         snap_wr_stall, snap_rd_stall, snap_results, axi_araddr, S_AXI_ARESETN, slv_reg_rden)
 	variable loc_addr :std_logic_vector(OPT_MEM_ADDR_BITS downto 0);
 	begin
 	    -- Address decoding for reading registers
 	    loc_addr := axi_araddr(ADDR_LSB + OPT_MEM_ADDR_BITS downto ADDR_LSB);
 	    case loc_addr is
-	      when b"00" =>
+	      when b"0000" =>
 	        reg_data_out <= slv_reg0;
-	      when b"01" =>
+	      when b"0001" =>
 	        reg_data_out <= slv_reg1;
-	      when b"10" =>
+	      when b"0010" =>
 	        reg_data_out <= slv_reg2;
-	      when b"11" =>
+	      when b"0011" =>
 	        reg_data_out <= slv_reg3;
+	      when b"0101" =>
+	        reg_data_out <= snap_cycles(31 downto 0);
+	      when b"0110" =>
+	        reg_data_out <= snap_cycles(63 downto 32);
+	      when b"0111" =>
+	        reg_data_out <= snap_wr;
+	      when b"1000" =>
+	        reg_data_out <= snap_rd;
+	      when b"1001" =>
+	        reg_data_out <= snap_wr_stall;
+	      when b"1010" =>
+	        reg_data_out <= snap_rd_stall;
+	      when b"1011" =>
+	        reg_data_out <= snap_results;
 	      when others =>
 	        reg_data_out  <= (others => '0');
 	    end case;
@@ -398,6 +464,60 @@ begin
 
 	-- Add user logic here
 
+	-- Performance counters - a clear takes priority over counting, and a
+	-- snapshot captures the counts as they stood before the current cycle
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then
+	    if ( S_AXI_ARESETN = '0' or perf_clr = '1' ) then
+	      cnt_cycles    <= (others => '0');
+	      cnt_wr        <= (others => '0');
+	      cnt_rd        <= (others => '0');
+	      cnt_wr_stall  <= (others => '0');
+	      cnt_rd_stall  <= (others => '0');
+	      cnt_results   <= (others => '0');
+	    else
+	      cnt_cycles <= cnt_cycles + 1;
+	      if (slv_reg_wren = '1') then
+	        cnt_wr <= cnt_wr + 1;
+	      end if;
+	      if (slv_reg_rden = '1') then
+	        cnt_rd <= cnt_rd + 1;
+	      end if;
+	      if (S_AXI_AWVALID = '1' and axi_awready = '0') then
+	        cnt_wr_stall <= cnt_wr_stall + 1;
+	      end if;
+	      if (S_AXI_ARVALID = '1' and axi_arready = '0') then
+	        cnt_rd_stall <= cnt_rd_stall + 1;
+	      end if;
+	      if (result_vld = '1') then
+	        cnt_results <= cnt_results + 1;
+	      end if;
+	    end if;
+	  end if;
+	end process;
+
+	process (S_AXI_ACLK)
+	begin
+	  if rising_edge(S_AXI_ACLK) then
+	    if S_AXI_ARESETN = '0' then
+	      snap_cycles   <= (others => '0');
+	      snap_wr       <= (others => '0');
+	      snap_rd       <= (others => '0');
+	      snap_wr_stall <= (others => '0');
+	      snap_rd_stall <= (others => '0');
+	      snap_results  <= (others => '0');
+	    elsif (perf_snap = '1') then
+	      snap_cycles   <= std_logic_vector(cnt_cycles);
+	      snap_wr       <= std_logic_vector(cnt_wr);
+	      snap_rd       <= std_logic_vector(cnt_rd);
+	      snap_wr_stall <= std_logic_vector(cnt_wr_stall);
+	      snap_rd_stall <= std_logic_vector(cnt_rd_stall);
+	      snap_results  <= std_logic_vector(cnt_results);
+	    end if;
+	  end if;
+	end process;
+
 	-- User logic ends
 
 end arch_imp;
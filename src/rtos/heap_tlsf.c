@@ -0,0 +1,97 @@
+/*
+ * FreeRTOS heap on the TLSF allocator (tlsf.h), in place of heap_4.c
+ *
+ * Same interface and locking as the kernel's own heaps: the scheduler is
+ * suspended around each call, so tasks can allocate from any priority but
+ * interrupt handlers cannot. What is held that way is a constant time
+ * operation rather than heap_4's walk of the free list. The pool is
+ * configTOTAL_HEAP_SIZE bytes of ucHeap, which the application can place
+ * itself (in OCM, say) with configAPPLICATION_ALLOCATED_HEAP.
+ *
+ * Build with exactly one heap, so leave heap_N.c out of the project.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "tlsf.h"
+
+#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+extern uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+#else
+static uint8_t ucHeap[configTOTAL_HEAP_SIZE] __attribute__((aligned(TLSF_ALIGN)));
+#endif
+
+static struct tlsf *heap;
+
+/* Called with the scheduler suspended */
+static struct tlsf *heap_get(void)
+{
+	if ( heap == NULL ) {
+		heap = tlsf_create(ucHeap, sizeof(ucHeap));
+		configASSERT(heap != NULL);
+	}
+	return heap;
+}
+
+void *pvPortMalloc(size_t xWantedSize)
+{
+	void *p = NULL;
+
+	vTaskSuspendAll();
+	p = tlsf_malloc(heap_get(), xWantedSize);
+	traceMALLOC(p, xWantedSize);
+	(void) xTaskResumeAll();
+#if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+	if ( p == NULL ) {
+		extern void vApplicationMallocFailedHook(void);
+		vApplicationMallocFailedHook();
+	}
+#endif
+	return p;
+}
+
+void vPortFree(void *pv)
+{
+	if ( pv == NULL ) {
+		return;
+	}
+	vTaskSuspendAll();
+	traceFREE(pv, tlsf_block_size(pv));
+	tlsf_free(heap_get(), pv);
+	(void) xTaskResumeAll();
+	return;
+}
+
+void heap_tlsf_get_stats(struct tlsf_stats *stats)
+{
+	vTaskSuspendAll();
+	tlsf_get_stats(heap_get(), stats);
+	(void) xTaskResumeAll();
+	return;
+}
+
+/* Without TLSF_STATS these two report a full heap */
+size_t xPortGetFreeHeapSize(void)
+{
+	struct tlsf_stats stats;
+
+	heap_tlsf_get_stats(&stats);
+	return stats.size - stats.used;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+	struct tlsf_stats stats;
+
+	heap_tlsf_get_stats(&stats);
+	return stats.size - stats.peak;
+}
+
+void vPortInitialiseBlocks(void)
+{
+	return;
+}
@@ -0,0 +1,260 @@
+/*
+ * Task side of the FreeRTOS timer, GPIO and XADC examples, see rtos_drivers.h
+ *
+ * The monitor task runs first, at the highest priority, and measures how often
+ * the idle hook runs in RTOS_CALIBRATE_MS with nothing else to do. Only then
+ * does it create the other tasks and start reporting the idle share against
+ * that reference. Whatever the tick interrupt costs is in the reference too, so
+ * the figure is the share of what is left over after the tick.
+ *
+ * All output goes through report(), which holds a mutex so lines from
+ * different tasks do not interleave. None of it happens in interrupt context.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+
+#include "rtos_drivers.h"
+
+#define MONITOR_PRIORITY		(configMAX_PRIORITIES - 1)
+#define DRIVER_PRIORITY			(tskIDLE_PRIORITY + 3)
+#define XADC_PRIORITY			(tskIDLE_PRIORITY + 1)
+/* printf() needs more than the minimum */
+#define TASK_STACK			(configMINIMAL_STACK_SIZE * 4)
+
+#define PBSW_ON				1
+
+static const struct rtos_board *rtos_board;
+
+static SemaphoreHandle_t print_mutex;
+static StreamBufferHandle_t gpio_stream;
+static TaskHandle_t scutimer_handle;
+static TaskHandle_t ttc_handle;
+
+static volatile uint32_t idle_loops;
+static volatile uint32_t gpio_dropped;
+
+void rtos_drivers_idle_hook(void)
+{
+	idle_loops++;
+	return;
+}
+
+static void report(const char *format, ...)
+{
+	va_list args;
+
+	xSemaphoreTake(print_mutex, portMAX_DELAY);
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	fflush(stdout);
+	xSemaphoreGive(print_mutex);
+	return;
+}
+
+static void scutimer_isr(void *arg)
+{
+	BaseType_t woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(scutimer_handle, &woken);
+	rtos_board->isr_exit(woken);
+	return;
+}
+
+static void ttc_isr(void *arg)
+{
+	BaseType_t woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(ttc_handle, &woken);
+	rtos_board->isr_exit(woken);
+	return;
+}
+
+static void gpio_isr(void *arg, uint32_t pin, uint32_t level)
+{
+	struct rtos_gpio_event event = {pin, level, rtos_board->timestamp()};
+	BaseType_t woken = pdFALSE;
+
+	/* The only writer, so the space cannot shrink before the send and no event is ever split */
+	if ( xStreamBufferSpacesAvailable(gpio_stream) < sizeof(event) ) {
+		gpio_dropped++;
+		return;
+	}
+	xStreamBufferSendFromISR(gpio_stream, &event, sizeof(event), &woken);
+	rtos_board->isr_exit(woken);
+	return;
+}
+
+/* private.c: ten one second expiries, then stop */
+static void scutimer_task(void *arg)
+{
+	uint32_t count = 0;
+	uint32_t pending = 0;
+
+	if ( rtos_board->scutimer_start(RTOS_SCUTIMER_PERIOD_MS, scutimer_isr, NULL) != 0 ) {
+		report("Could not start the timer\n");
+		vTaskDelete(NULL);
+	}
+	while ( count < RTOS_SCUTIMER_COUNT ) {
+		pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(2 * RTOS_SCUTIMER_PERIOD_MS));
+		if ( pending == 0 ) {
+			report("Timer did not expire within %d ms\n", 2 * RTOS_SCUTIMER_PERIOD_MS);
+			continue;
+		}
+		count += pending;
+		report("Timer expired, count = %"PRIu32"\n", count);
+	}
+	rtos_board->scutimer_stop();
+	report("Timer stopped\n");
+	vTaskDelete(NULL);
+}
+
+/* ttc_interval.c, every interval handled by the task rather than the handler */
+static void ttc_task(void *arg)
+{
+	uint32_t intervals = 0;
+	uint32_t coalesced = 0;
+	uint32_t pending = 0;
+	uint32_t seconds = 0;
+
+	if ( rtos_board->ttc_start(RTOS_TTC_HZ, ttc_isr, NULL) != 0 ) {
+		report("Could not start the TTC\n");
+		vTaskDelete(NULL);
+	}
+	for (;;) {
+		pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		/* More than one means the task did not get to run between two intervals */
+		if ( pending > 1 ) {
+			coalesced += pending - 1;
+		}
+		intervals += pending;
+		if ( intervals >= (seconds + 1) * RTOS_TTC_HZ ) {
+			seconds++;
+			report("TTC interval %"PRIu32", %"PRIu32" s, %"PRIu32" coalesced\n", intervals, seconds,
+					coalesced);
+		}
+	}
+}
+
+/* gpio_examples.c, the LED toggled on each press */
+static void gpio_task(void *arg)
+{
+	struct rtos_gpio_event event;
+	uint32_t led = 0;
+	uint32_t last = 0;
+
+	if ( rtos_board->gpio_start(gpio_isr, NULL) != 0 ) {
+		report("Could not start GPIO\n");
+		vTaskDelete(NULL);
+	}
+	last = rtos_board->timestamp();
+	for (;;) {
+		if ( xStreamBufferReceive(gpio_stream, &event, sizeof(event), portMAX_DELAY) != sizeof(event) ) {
+			continue;
+		}
+		if ( event.level == PBSW_ON ) {
+			led = !led;
+			rtos_board->led_write(led);
+		}
+		report("Pin %"PRIu32" %s, %"PRIu32" us since the last edge, LED %s, %"PRIu32" dropped\n",
+				event.pin, ( event.level == PBSW_ON ) ? "pressed" : "released",
+				(uint32_t) ((uint64_t) (event.timestamp - last) * 1000000 / rtos_board->timestamp_hz),
+				led ? "on" : "off", gpio_dropped);
+		last = event.timestamp;
+	}
+}
+
+/* XADC transfer functions in integer arithmetic, millidegrees and millivolts */
+static int32_t xadc_mdeg(uint16_t raw)
+{
+	return (int32_t) (((uint32_t) raw * 503975) >> 16) - 273150;
+}
+
+static uint32_t xadc_mv(uint16_t raw)
+{
+	return ((uint32_t) raw * 3000) >> 16;
+}
+
+/* xadc_summary.c, sampled on a fixed period */
+static void xadc_task(void *arg)
+{
+	struct rtos_xadc_sample sample;
+	TickType_t wake = xTaskGetTickCount();
+	int32_t max_mdeg = INT32_MIN;
+	int32_t mdeg = 0;
+	uint32_t samples = 0;
+
+	for (;;) {
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(RTOS_XADC_PERIOD_MS));
+		if ( rtos_board->xadc_read(&sample) != 0 ) {
+			continue;
+		}
+		mdeg = xadc_mdeg(sample.temp);
+		if ( mdeg > max_mdeg ) {
+			max_mdeg = mdeg;
+		}
+		if ( ++samples % (RTOS_REPORT_MS / RTOS_XADC_PERIOD_MS) == 0 ) {
+			report("XADC %"PRId32" mC (max %"PRId32"), VCCINT %"PRIu32" mV, VCCAUX %"PRIu32" mV\n",
+					mdeg, max_mdeg, xadc_mv(sample.vccint), xadc_mv(sample.vccaux));
+		}
+	}
+}
+
+static void monitor_task(void *arg)
+{
+	TickType_t wake = 0;
+	uint32_t reference = 0;
+	uint32_t loops = 0;
+	uint32_t last = 0;
+	uint32_t permille = 0;
+
+	last = idle_loops;
+	vTaskDelay(pdMS_TO_TICKS(RTOS_CALIBRATE_MS));
+	reference = idle_loops - last;
+	report("%s, %"PRIu32" idle loops in %d ms with nothing running\n", rtos_board->name, reference,
+			RTOS_CALIBRATE_MS);
+	if ( reference == 0 ) {
+		report("Idle hook never ran, is configUSE_IDLE_HOOK set?\n");
+		reference = 1;
+	}
+
+	xTaskCreate(scutimer_task, "scutimer", TASK_STACK, NULL, DRIVER_PRIORITY, &scutimer_handle);
+	xTaskCreate(ttc_task, "ttc", TASK_STACK, NULL, DRIVER_PRIORITY, &ttc_handle);
+	xTaskCreate(gpio_task, "gpio", TASK_STACK, NULL, DRIVER_PRIORITY, NULL);
+	xTaskCreate(xadc_task, "xadc", TASK_STACK, NULL, XADC_PRIORITY, NULL);
+
+	wake = xTaskGetTickCount();
+	last = idle_loops;
+	for (;;) {
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(RTOS_REPORT_MS));
+		loops = idle_loops;
+		permille = (uint32_t) ((uint64_t) (loops - last) * 1000 * RTOS_CALIBRATE_MS /
+				((uint64_t) reference * RTOS_REPORT_MS));
+		last = loops;
+		report("CPU idle %"PRIu32".%"PRIu32"%%\n", permille / 10, permille % 10);
+	}
+}
+
+int rtos_drivers_start(const struct rtos_board *board)
+{
+	rtos_board = board;
+	print_mutex = xSemaphoreCreateMutex();
+	/* Wake the GPIO task for every whole event */
+	gpio_stream = xStreamBufferCreate(RTOS_GPIO_EVENTS * sizeof(struct rtos_gpio_event),
+			sizeof(struct rtos_gpio_event));
+	if ( ( print_mutex == NULL ) || ( gpio_stream == NULL ) ) {
+		return -1;
+	}
+	if ( xTaskCreate(monitor_task, "monitor", TASK_STACK, NULL, MONITOR_PRIORITY, NULL) != pdPASS ) {
+		return -1;
+	}
+	return 0;
+}
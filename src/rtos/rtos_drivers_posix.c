@@ -0,0 +1,216 @@
+/*
+ * Build host board for rtos_drivers.c, on the FreeRTOS POSIX port
+ *
+ * The POSIX port runs the tick from a signal and treats the tick hook as
+ * interrupt context, so that is where the timer and GPIO interrupts are made
+ * up: the timers fire every so many ticks, and the push button is pressed for
+ * PRESS_MS every PRESS_PERIOD_MS. The XADC readings are synthetic. Since the
+ * tick is the only source of interrupts, the TTC rate is limited to the tick
+ * rate. The run-time statistics (rtos_stats.h) run on CLOCK_MONOTONIC, with
+ * the made up interrupts under the IDs they have on the Zynq, and are printed
+ * every STATS_REPORT_MS. See examples/Makefile (rtos_drivers_posix) for the build.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "rtos_drivers.h"
+#include "rtos_stats.h"
+
+#define PBSW_PIN			51
+#define PRESS_PERIOD_MS			700
+#define PRESS_MS			80
+#define STATS_REPORT_MS			5000
+
+/* Where the same interrupts are on the Zynq, for the statistics */
+#define SCUTIMER_INTR_ID		30
+#define TTC_INTR_ID			42
+#define GPIO_INTR_ID			52
+
+struct tick_source {
+	uint32_t id;
+	volatile uint32_t period;
+	uint32_t count;
+	void (*isr)(void *arg);
+	void *arg;
+};
+
+static struct tick_source scutimer = { .id = SCUTIMER_INTR_ID };
+static struct tick_source ttc = { .id = TTC_INTR_ID };
+static void (*volatile gpio_isr)(void *arg, uint32_t pin, uint32_t level);
+static void *gpio_arg;
+static uint32_t ticks;
+static uint32_t xadc_samples;
+
+static int tick_source_start(struct tick_source *source, uint32_t period_ms, void (*isr)(void *arg), void *arg)
+{
+	if ( period_ms == 0 ) {
+		return -1;
+	}
+	source->count = 0;
+	source->isr = isr;
+	source->arg = arg;
+	source->period = pdMS_TO_TICKS(period_ms);
+	return ( source->period == 0 ) ? -1 : 0;
+}
+
+static void tick_source_run(struct tick_source *source)
+{
+	if ( ( source->period != 0 ) && ( ++source->count >= source->period ) ) {
+		source->count = 0;
+		rtos_stats_irq_enter(source->id);
+		source->isr(source->arg);
+		rtos_stats_irq_exit(source->id);
+	}
+	return;
+}
+
+static int posix_scutimer_start(uint32_t period_ms, void (*isr)(void *arg), void *arg)
+{
+	return tick_source_start(&scutimer, period_ms, isr, arg);
+}
+
+static void posix_scutimer_stop(void)
+{
+	scutimer.period = 0;
+	return;
+}
+
+static int posix_ttc_start(uint32_t hz, void (*isr)(void *arg), void *arg)
+{
+	return tick_source_start(&ttc, 1000 / hz, isr, arg);
+}
+
+static void posix_ttc_stop(void)
+{
+	ttc.period = 0;
+	return;
+}
+
+static int posix_gpio_start(void (*isr)(void *arg, uint32_t pin, uint32_t level), void *arg)
+{
+	gpio_arg = arg;
+	gpio_isr = isr;
+	return 0;
+}
+
+/* vPortYield() from inside xTaskIncrementTick() would switch threads half way through the tick */
+static void posix_isr_exit(uint32_t woken)
+{
+	return;
+}
+
+static void posix_led_write(uint32_t on)
+{
+	return;
+}
+
+/* A slow temperature ramp with a little noise, around what the die reads at room temperature */
+static int posix_xadc_read(struct rtos_xadc_sample *sample)
+{
+	xadc_samples++;
+	sample->temp = (uint16_t) (40000 + (xadc_samples % 200) * 4 + (rand() % 16));
+	sample->vccint = (uint16_t) (21845 + (rand() % 32));
+	sample->vccaux = (uint16_t) (39322 + (rand() % 32));
+	return 0;
+}
+
+static uint32_t posix_timestamp(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t) ((uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static uint64_t posix_counter(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* There is no command line here, so the statistics are just printed now and then */
+static void stats_task(void *arg)
+{
+	static struct rtos_stats_snapshot snapshot;
+	TickType_t wake = xTaskGetTickCount();
+
+	for (;;) {
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(STATS_REPORT_MS));
+		rtos_stats_snapshot(&snapshot);
+		rtos_stats_print(&snapshot);
+	}
+}
+
+static const struct rtos_board posix_board = {
+	"POSIX port",
+	posix_scutimer_start,
+	posix_scutimer_stop,
+	posix_ttc_start,
+	posix_ttc_stop,
+	posix_gpio_start,
+	posix_isr_exit,
+	posix_led_write,
+	posix_xadc_read,
+	posix_timestamp,
+	1000000,
+};
+
+void vApplicationTickHook(void)
+{
+	uint32_t phase = 0;
+
+	ticks++;
+	tick_source_run(&scutimer);
+	tick_source_run(&ttc);
+	if ( gpio_isr != NULL ) {
+		phase = ticks % pdMS_TO_TICKS(PRESS_PERIOD_MS);
+		if ( ( phase == 0 ) || ( phase == pdMS_TO_TICKS(PRESS_MS) ) ) {
+			rtos_stats_irq_enter(GPIO_INTR_ID);
+			gpio_isr(gpio_arg, PBSW_PIN, phase == 0);
+			rtos_stats_irq_exit(GPIO_INTR_ID);
+		}
+	}
+	return;
+}
+
+void vApplicationIdleHook(void)
+{
+	rtos_drivers_idle_hook();
+	return;
+}
+
+void vApplicationMallocFailedHook(void)
+{
+	fprintf(stderr, "Out of FreeRTOS heap\n");
+	abort();
+}
+
+void vAssertCalled(const char *file, unsigned long line)
+{
+	fprintf(stderr, "Assertion failed at %s:%lu\n", file, line);
+	abort();
+}
+
+int main(int argc, char *argv[])
+{
+	rtos_stats_init(posix_counter, 1000000000);
+	if ( xTaskCreate(stats_task, "stats", configMINIMAL_STACK_SIZE * 4, NULL, tskIDLE_PRIORITY + 1, NULL) !=
+			pdPASS ) {
+		fprintf(stderr, "Could not create the statistics task\n");
+		return 1;
+	}
+	if ( rtos_drivers_start(&posix_board) != 0 ) {
+		fprintf(stderr, "Could not create the driver tasks\n");
+		return 1;
+	}
+	vTaskStartScheduler();
+	return 1;
+}
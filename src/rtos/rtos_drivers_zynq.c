@@ -0,0 +1,318 @@
+/*
+ * MicroZed board for rtos_drivers.c, in the FreeRTOS Zynq demo application
+ *
+ * Built as part of the RTOSDemo project from rtos/README.md, with
+ * mainSELECTED_APPLICATION in main.c set to run main_drivers() and
+ * vApplicationIdleHook() calling rtos_drivers_idle_hook(). The demo's
+ * FreeRTOS_tick_config.c owns the GIC instance (xInterruptController) and uses
+ * the SCU private timer for the tick, so the periodic interrupt private.c gets
+ * from the private timer comes from the private watchdog in timer mode here,
+ * which is the same kind of counter on the same clock.
+ *
+ * Defining RTOS_STATS_CLI adds run-time statistics (rtos_stats_zynq.c) and the
+ * demo's UART command console to read them through.
+ *
+ * Every interrupt is given the lowest usable priority, as the tick is, which
+ * keeps them all below configMAX_API_CALL_INTERRUPT_PRIORITY and so allowed to
+ * use the FromISR API.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xscugic.h"
+#include "xttcps.h"
+#include "xgpiops.h"
+#include "xadcps.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "ttc_dbg.h"
+#include "rtos_drivers.h"
+#ifdef RTOS_TICKLESS_REPORT_MS
+#include "rtos_tickless.h"
+#endif
+#ifdef RTOS_STATS_CLI
+#include "rtos_stats_zynq.h"
+#endif
+
+/* Private watchdog in timer mode, Cortex-A9 MPCore TRM 4.3 */
+#define SCUWDT_BASE			0xF8F00620
+#define SCUWDT_LOAD			(SCUWDT_BASE + 0x00)
+#define SCUWDT_CONTROL			(SCUWDT_BASE + 0x08)
+#define SCUWDT_ISR			(SCUWDT_BASE + 0x0C)
+#define SCUWDT_DISABLE			(SCUWDT_BASE + 0x14)
+#define SCUWDT_CONTROL_ENABLE		0x00000001
+#define SCUWDT_CONTROL_AUTO_RELOAD	0x00000002
+#define SCUWDT_CONTROL_IRQ_ENABLE	0x00000004
+#define SCUWDT_ISR_EVENT		0x00000001
+/* Writing these in turn takes the watchdog out of watchdog mode */
+#define SCUWDT_DISABLE_KEY_1		0x12345678
+#define SCUWDT_DISABLE_KEY_2		0x87654321
+#define SCUWDT_INTR_ID			30
+
+#define TTC_DEVICE_ID			XPAR_XTTCPS_0_DEVICE_ID
+#define TTC_INTR_ID			XPS_TTC0_0_INT_ID
+#define TTC_MAX_INTERVAL		0xFFFF
+/* Prescale values 0 - 15 divide by 2 - 65536 */
+#define TTC_MAX_PRESCALER		15
+#define TTC_CNT_CTRL_INTERVAL		0x00000002
+
+#define GPIO_DEVICE_ID			XPAR_XGPIOPS_0_DEVICE_ID
+#define GPIO_INTR_ID			XPS_GPIO_INT_ID
+#define GPIO_UZED_LED			47
+#define GPIO_UZED_PBSW			51
+#define GPIO_INPUT			0
+#define GPIO_OUTPUT			1
+
+#define XADC_DEVICE_ID			XPAR_XADCPS_0_DEVICE_ID
+
+#define GIC_TRIGGER_LEVEL		0x1
+#define GIC_TRIGGER_EDGE		0x3
+
+/* Missing prototypes from the XADC driver API, as in xadc_summary.c */
+void XAdcPs_SetSequencerMode(XAdcPs *, uint8_t);
+void XAdcPs_SetAlarmEnables(XAdcPs *, uint16_t);
+int XAdcPs_SetSeqChEnables(XAdcPs *, uint32_t);
+
+/* From the demo's FreeRTOS_tick_config.c */
+extern XScuGic xInterruptController;
+
+#ifdef RTOS_STATS_CLI
+/* From the demo's UARTCommandConsole.c */
+extern void vUARTCommandConsoleStart(uint16_t usStackSize, UBaseType_t uxPriority);
+#define CLI_STACK			(configMINIMAL_STACK_SIZE * 3)
+#endif
+
+struct isr_ref {
+	void (*isr)(void *arg);
+	void *arg;
+};
+
+static struct isr_ref scutimer_ref;
+static struct isr_ref ttc_ref;
+static void (*gpio_isr)(void *arg, uint32_t pin, uint32_t level);
+static void *gpio_arg;
+
+static XTtcPs ttc;
+static XGpioPs gpio;
+static XAdcPs xadc;
+
+static void connect(uint32_t id, Xil_InterruptHandler handler, void *ref, uint8_t trigger)
+{
+	XScuGic_SetPriorityTriggerType(&xInterruptController, id,
+			portLOWEST_USABLE_INTERRUPT_PRIORITY << portPRIORITY_SHIFT, trigger);
+	XScuGic_Connect(&xInterruptController, id, handler, ref);
+	XScuGic_Enable(&xInterruptController, id);
+	return;
+}
+
+static void scutimer_handler(void *callback_ref)
+{
+	struct isr_ref *ref = callback_ref;
+
+	Xil_Out32(SCUWDT_ISR, SCUWDT_ISR_EVENT);
+	ref->isr(ref->arg);
+	return;
+}
+
+static int zynq_scutimer_start(uint32_t period_ms, void (*isr)(void *arg), void *arg)
+{
+	scutimer_ref.isr = isr;
+	scutimer_ref.arg = arg;
+
+	Xil_Out32(SCUWDT_DISABLE, SCUWDT_DISABLE_KEY_1);
+	Xil_Out32(SCUWDT_DISABLE, SCUWDT_DISABLE_KEY_2);
+	Xil_Out32(SCUWDT_CONTROL, 0);
+	Xil_Out32(SCUWDT_ISR, SCUWDT_ISR_EVENT);
+	/* Clocked from CPU_3x2x, as the global timer is */
+	Xil_Out32(SCUWDT_LOAD, (uint32_t) ((uint64_t) COUNTS_PER_SECOND * period_ms / 1000) - 1);
+	connect(SCUWDT_INTR_ID, scutimer_handler, &scutimer_ref, GIC_TRIGGER_EDGE);
+	Xil_Out32(SCUWDT_CONTROL, SCUWDT_CONTROL_ENABLE | SCUWDT_CONTROL_AUTO_RELOAD |
+			SCUWDT_CONTROL_IRQ_ENABLE);
+	return 0;
+}
+
+static void zynq_scutimer_stop(void)
+{
+	Xil_Out32(SCUWDT_CONTROL, 0);
+	XScuGic_Disable(&xInterruptController, SCUWDT_INTR_ID);
+	return;
+}
+
+static void ttc_handler(void *callback_ref)
+{
+	struct isr_ref *ref = callback_ref;
+
+	/* Reading the status clears it */
+	if ( XTtcPs_GetInterruptStatus(&ttc) & XTTCPS_IXR_INTERVAL_MASK ) {
+		ref->isr(ref->arg);
+	}
+	return;
+}
+
+static int zynq_ttc_start(uint32_t hz, void (*isr)(void *arg), void *arg)
+{
+	XTtcPs_Config *config = XTtcPs_LookupConfig(TTC_DEVICE_ID);
+	uint32_t interval = 0;
+	uint32_t prescaler = 0;
+
+	if ( ( config == NULL ) || ( XTtcPs_CfgInitialize(&ttc, config, config->BaseAddress) != XST_SUCCESS ) ) {
+		return -1;
+	}
+	ttc_ref.isr = isr;
+	ttc_ref.arg = arg;
+
+	/* Not XTtcPs_CalcIntervalFromFreq(), which gets this wrong, see ttc_interval.c */
+	interval = config->InputClockHz / hz;
+	if ( interval <= TTC_MAX_INTERVAL ) {
+		XTtcPs_SetPrescaler(&ttc, XTTCPS_CLK_CNTRL_PS_DISABLE);
+	} else {
+		for (prescaler = 0; prescaler <= TTC_MAX_PRESCALER; prescaler++) {
+			interval = config->InputClockHz / (2U << prescaler) / hz;
+			if ( interval <= TTC_MAX_INTERVAL ) {
+				break;
+			}
+		}
+		if ( prescaler > TTC_MAX_PRESCALER ) {
+			return -1;
+		}
+		XTtcPs_SetPrescaler(&ttc, prescaler);
+	}
+	XTtcPs_SetInterval(&ttc, interval);
+	ttc_dbg_set_cnt_ctrl(0, 0, ttc_dbg_cnt_ctrl(0, 0) | TTC_CNT_CTRL_INTERVAL);
+
+	connect(TTC_INTR_ID, ttc_handler, &ttc_ref, GIC_TRIGGER_LEVEL);
+	XTtcPs_EnableInterrupts(&ttc, XTTCPS_IXR_INTERVAL_MASK);
+	XTtcPs_Start(&ttc);
+	return 0;
+}
+
+static void zynq_ttc_stop(void)
+{
+	XTtcPs_Stop(&ttc);
+	XTtcPs_DisableInterrupts(&ttc, XTTCPS_IXR_INTERVAL_MASK);
+	XScuGic_Disable(&xInterruptController, TTC_INTR_ID);
+	return;
+}
+
+/* Called by XGpioPs_IntrHandler() with the bank status already cleared */
+static void gpio_handler(void *callback_ref, uint32_t bank, uint32_t status)
+{
+	if ( ( bank == GPIO_UZED_PBSW / 32 ) && ( status & (1U << (GPIO_UZED_PBSW % 32)) ) ) {
+		gpio_isr(gpio_arg, GPIO_UZED_PBSW, XGpioPs_ReadPin(&gpio, GPIO_UZED_PBSW));
+	}
+	return;
+}
+
+static int zynq_gpio_start(void (*isr)(void *arg, uint32_t pin, uint32_t level), void *arg)
+{
+	XGpioPs_Config *config = XGpioPs_LookupConfig(GPIO_DEVICE_ID);
+
+	if ( ( config == NULL ) || ( XGpioPs_CfgInitialize(&gpio, config, config->BaseAddr) != XST_SUCCESS ) ) {
+		return -1;
+	}
+	gpio_isr = isr;
+	gpio_arg = arg;
+
+	XGpioPs_SetDirectionPin(&gpio, GPIO_UZED_LED, GPIO_OUTPUT);
+	XGpioPs_SetOutputEnablePin(&gpio, GPIO_UZED_LED, 1);
+	XGpioPs_WritePin(&gpio, GPIO_UZED_LED, 0);
+
+	XGpioPs_SetDirectionPin(&gpio, GPIO_UZED_PBSW, GPIO_INPUT);
+	XGpioPs_SetIntrTypePin(&gpio, GPIO_UZED_PBSW, XGPIOPS_IRQ_TYPE_EDGE_BOTH);
+	XGpioPs_IntrClearPin(&gpio, GPIO_UZED_PBSW);
+	XGpioPs_SetCallbackHandler(&gpio, NULL, (XGpioPs_Handler) gpio_handler);
+	connect(GPIO_INTR_ID, (Xil_InterruptHandler) XGpioPs_IntrHandler, &gpio, GIC_TRIGGER_LEVEL);
+	XGpioPs_IntrEnablePin(&gpio, GPIO_UZED_PBSW);
+	return 0;
+}
+
+static void zynq_isr_exit(uint32_t woken)
+{
+	portYIELD_FROM_ISR(woken);
+	return;
+}
+
+static void zynq_led_write(uint32_t on)
+{
+	XGpioPs_WritePin(&gpio, GPIO_UZED_LED, on);
+	return;
+}
+
+static int zynq_xadc_read(struct rtos_xadc_sample *sample)
+{
+	sample->temp = XAdcPs_GetAdcData(&xadc, XADCPS_CH_TEMP);
+	sample->vccint = XAdcPs_GetAdcData(&xadc, XADCPS_CH_VCCINT);
+	sample->vccaux = XAdcPs_GetAdcData(&xadc, XADCPS_CH_VCCAUX);
+	return 0;
+}
+
+static int setup_xadc(void)
+{
+	XAdcPs_Config *config = XAdcPs_LookupConfig(XADC_DEVICE_ID);
+
+	if ( ( config == NULL ) || ( XAdcPs_CfgInitialize(&xadc, config, config->BaseAddress) != XST_SUCCESS ) ) {
+		return XST_FAILURE;
+	}
+	/* Let the sequencer convert everything in turn, and just pick up the latest results */
+	XAdcPs_SetSequencerMode(&xadc, XADCPS_SEQ_MODE_SAFE);
+	XAdcPs_SetAlarmEnables(&xadc, 0);
+	XAdcPs_SetSeqChEnables(&xadc, XADCPS_SEQ_CH_TEMP | XADCPS_SEQ_CH_VCCINT | XADCPS_SEQ_CH_VCCAUX);
+	XAdcPs_SetSequencerMode(&xadc, XADCPS_SEQ_MODE_CONTINPASS);
+	return XST_SUCCESS;
+}
+
+static uint32_t zynq_timestamp(void)
+{
+	return gtimer_read_lo();
+}
+
+static const struct rtos_board zynq_board = {
+	"MicroZed",
+	zynq_scutimer_start,
+	zynq_scutimer_stop,
+	zynq_ttc_start,
+	zynq_ttc_stop,
+	zynq_gpio_start,
+	zynq_isr_exit,
+	zynq_led_write,
+	zynq_xadc_read,
+	zynq_timestamp,
+	COUNTS_PER_SECOND,
+};
+
+void main_drivers(void)
+{
+#ifdef RTOS_STATS_CLI
+	/* Before any task exists, so that every one of them is counted from the start */
+	rtos_stats_zynq_init();
+	rtos_stats_cli_register();
+	vUARTCommandConsoleStart(CLI_STACK, tskIDLE_PRIORITY);
+#endif
+	if ( setup_xadc() != XST_SUCCESS ) {
+		fprintf(stderr, "Could not set up the XADC\n");
+		return;
+	}
+	if ( rtos_drivers_start(&zynq_board) != 0 ) {
+		fprintf(stderr, "Could not create the driver tasks\n");
+		return;
+	}
+#ifdef RTOS_TICKLESS_REPORT_MS
+	if ( rtos_tickless_start_report(RTOS_TICKLESS_REPORT_MS) != 0 ) {
+		fprintf(stderr, "Could not create the tickless report task\n");
+		return;
+	}
+#endif
+	vTaskStartScheduler();
+
+	/* Only if there was not enough heap for the idle task */
+	for (;;) {
+	}
+}
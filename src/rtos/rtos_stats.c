@@ -0,0 +1,348 @@
+/*
+ * FreeRTOS run-time statistics on a 64-bit counter, see rtos_stats.h
+ *
+ * The running task is charged the counts from its switch in to its switch out,
+ * less the interrupt time in between. Interrupt time is kept as the total of
+ * all outermost handlers, plus however far into the current outermost handler
+ * the counter has got, so a switch made from inside a handler (as the POSIX
+ * port does from the tick) splits that handler cleanly between the two tasks'
+ * deductions rather than charging it twice.
+ *
+ * Everything here runs with interrupts masked, from the kernel's switch hooks
+ * or around a handler, apart from rtos_stats_snapshot(), which takes a
+ * critical section. Interrupts above configMAX_API_CALL_INTERRUPT_PRIORITY are
+ * not held off by that, so their figures can be torn in a snapshot.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "rtos_stats.h"
+#include "rtos_stats_trace.h"
+
+#define NO_SLOT				RTOS_STATS_MAX_TASKS
+
+struct task_slot {
+	void *task;
+	struct rtos_stats_task stats;
+};
+
+static uint64_t (*stats_counter)(void);
+static uint64_t stats_hz;
+static uint64_t stats_start;
+
+static struct task_slot task_slots[RTOS_STATS_MAX_TASKS];
+static struct rtos_stats_irq irq_stats[RTOS_STATS_MAX_IRQS];
+static uint32_t switches;
+
+static uint32_t current = NO_SLOT;
+static uint64_t current_in;
+static uint64_t current_irq;
+
+static uint64_t irq_time;
+static uint64_t nest_start[RTOS_STATS_MAX_NESTING];
+static uint64_t nest_child[RTOS_STATS_MAX_NESTING];
+static uint32_t nesting;
+
+static uint64_t overhead;
+static uint32_t overhead_events;
+
+void rtos_stats_init(uint64_t (*counter)(void), uint64_t hz)
+{
+	uint32_t i = 0;
+
+	stats_hz = hz;
+	stats_start = counter();
+	for (i = 0; i < RTOS_STATS_MAX_IRQS; i++) {
+		irq_stats[i].id = i;
+	}
+	stats_counter = counter;
+	return;
+}
+
+/* Interrupt time up to now, counting the handler in progress, if any */
+static uint64_t irq_elapsed(uint64_t now)
+{
+	return irq_time + ( ( nesting > 0 ) ? now - nest_start[0] : 0 );
+}
+
+static void charge_current(struct rtos_stats_task *stats, uint64_t now)
+{
+	stats->time += (now - current_in) - (irq_elapsed(now) - current_irq);
+	return;
+}
+
+void rtos_stats_switched_out(void)
+{
+	uint64_t now = 0;
+
+	if ( stats_counter == NULL ) {
+		return;
+	}
+	now = stats_counter();
+	if ( current != NO_SLOT ) {
+		charge_current(&task_slots[current].stats, now);
+	}
+	overhead += stats_counter() - now;
+	overhead_events++;
+	return;
+}
+
+/* Fresh slots first, then those of deleted tasks, so the deleted stay on show as long as possible */
+static uint32_t find_slot(void *task)
+{
+	uint32_t reuse = NO_SLOT;
+	uint32_t i = 0;
+
+	for (i = 0; i < RTOS_STATS_MAX_TASKS; i++) {
+		if ( task_slots[i].task == task ) {
+			return i;
+		}
+		if ( task_slots[i].task == NULL ) {
+			if ( task_slots[i].stats.name[0] == '\0' ) {
+				break;
+			}
+			if ( reuse == NO_SLOT ) {
+				reuse = i;
+			}
+		}
+	}
+	if ( i == RTOS_STATS_MAX_TASKS ) {
+		i = reuse;
+	}
+	if ( i == NO_SLOT ) {
+		return NO_SLOT;
+	}
+	memset(&task_slots[i], 0, sizeof(task_slots[i]));
+	task_slots[i].task = task;
+	strncpy(task_slots[i].stats.name, pcTaskGetName((TaskHandle_t) task), RTOS_STATS_NAME_LEN - 1);
+	task_slots[i].stats.alive = 1;
+	return i;
+}
+
+uint32_t rtos_stats_switched_in(void *task, uint32_t number)
+{
+	uint32_t slot = number - 1;
+	uint64_t now = 0;
+
+	if ( stats_counter == NULL ) {
+		return number;
+	}
+	now = stats_counter();
+	/* The number is only a hint, a fresh task starts with zero */
+	if ( ( number == 0 ) || ( slot >= RTOS_STATS_MAX_TASKS ) || ( task_slots[slot].task != task ) ) {
+		slot = find_slot(task);
+	}
+	if ( slot != NO_SLOT ) {
+		task_slots[slot].stats.switches++;
+	}
+	switches++;
+	current = slot;
+	current_in = now;
+	current_irq = irq_elapsed(now);
+	overhead += stats_counter() - now;
+	overhead_events++;
+	return ( slot != NO_SLOT ) ? slot + 1 : 0;
+}
+
+void rtos_stats_task_deleted(void *task)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < RTOS_STATS_MAX_TASKS; i++) {
+		if ( task_slots[i].task == task ) {
+			task_slots[i].task = NULL;
+			task_slots[i].stats.alive = 0;
+		}
+	}
+	return;
+}
+
+void rtos_stats_irq_enter(uint32_t id)
+{
+	uint64_t now = 0;
+
+	if ( stats_counter == NULL ) {
+		return;
+	}
+	now = stats_counter();
+	if ( nesting < RTOS_STATS_MAX_NESTING ) {
+		nest_start[nesting] = now;
+		nest_child[nesting] = 0;
+	}
+	nesting++;
+	overhead += stats_counter() - now;
+	overhead_events++;
+	return;
+}
+
+void rtos_stats_irq_exit(uint32_t id)
+{
+	struct rtos_stats_irq *irq = NULL;
+	uint64_t total = 0;
+	uint64_t self = 0;
+	uint64_t now = 0;
+
+	if ( ( stats_counter == NULL ) || ( nesting == 0 ) ) {
+		return;
+	}
+	now = stats_counter();
+	nesting--;
+	/* Anything nested deeper than that is left in the time of the handler it interrupted */
+	if ( nesting < RTOS_STATS_MAX_NESTING ) {
+		total = now - nest_start[nesting];
+		self = total - nest_child[nesting];
+		if ( id < RTOS_STATS_MAX_IRQS ) {
+			irq = &irq_stats[id];
+			irq->time += self;
+			irq->count++;
+			if ( self > irq->max ) {
+				irq->max = self;
+			}
+		}
+		if ( nesting > 0 ) {
+			nest_child[nesting - 1] += total;
+		} else {
+			irq_time += total;
+		}
+	}
+	overhead += stats_counter() - now;
+	overhead_events++;
+	return;
+}
+
+void rtos_stats_snapshot(struct rtos_stats_snapshot *snapshot)
+{
+	struct rtos_stats_header *header = &snapshot->header;
+	uint32_t i = 0;
+
+	memset(snapshot, 0, sizeof(*snapshot));
+	header->magic = RTOS_STATS_MAGIC;
+	header->version = RTOS_STATS_VERSION;
+	header->hz = stats_hz;
+	header->start = stats_start;
+	if ( stats_counter == NULL ) {
+		return;
+	}
+
+	taskENTER_CRITICAL();
+	header->now = stats_counter();
+	header->irq_time = irq_elapsed(header->now);
+	header->overhead = overhead;
+	header->overhead_events = overhead_events;
+	header->switches = switches;
+	for (i = 0; i < RTOS_STATS_MAX_TASKS; i++) {
+		if ( task_slots[i].stats.name[0] == '\0' ) {
+			continue;
+		}
+		snapshot->tasks[header->tasks] = task_slots[i].stats;
+		/* The caller is still running, and has been since it was last switched in */
+		if ( i == current ) {
+			charge_current(&snapshot->tasks[header->tasks], header->now);
+		}
+		header->tasks++;
+	}
+	for (i = 0; i < RTOS_STATS_MAX_IRQS; i++) {
+		if ( irq_stats[i].count != 0 ) {
+			snapshot->irqs[header->irqs++] = irq_stats[i];
+		}
+	}
+	taskEXIT_CRITICAL();
+	return;
+}
+
+size_t rtos_stats_dump(const struct rtos_stats_snapshot *snapshot, void *buf, size_t len)
+{
+	const struct rtos_stats_header *header = &snapshot->header;
+	size_t tasks = header->tasks * sizeof(snapshot->tasks[0]);
+	size_t irqs = header->irqs * sizeof(snapshot->irqs[0]);
+	uint8_t *p = buf;
+
+	if ( len < sizeof(*header) + tasks + irqs ) {
+		return 0;
+	}
+	memcpy(p, header, sizeof(*header));
+	memcpy(p + sizeof(*header), snapshot->tasks, tasks);
+	memcpy(p + sizeof(*header) + tasks, snapshot->irqs, irqs);
+	return sizeof(*header) + tasks + irqs;
+}
+
+/* Hundredths of a percent, in integers so that no task needs a floating point context */
+static uint32_t share(uint64_t part, uint64_t whole)
+{
+	return ( whole != 0 ) ? (uint32_t) (part * 10000 / whole) : 0;
+}
+
+int rtos_stats_format(const struct rtos_stats_snapshot *snapshot, uint32_t line, char *buf, size_t len)
+{
+	const struct rtos_stats_header *header = &snapshot->header;
+	const struct rtos_stats_task *task = NULL;
+	const struct rtos_stats_irq *irq = NULL;
+	uint64_t elapsed = header->now - header->start;
+	uint64_t us = ( header->hz != 0 ) ? header->hz / 1000000 : 1;
+	uint32_t percent = 0;
+
+	if ( us == 0 ) {
+		us = 1;
+	}
+	if ( line == 0 ) {
+		snprintf(buf, len, "%-18s%-14s%-10s%-12s\n", "Task", "Time (us)", "CPU %", "Switches");
+		return 1;
+	}
+	line--;
+	if ( line < header->tasks ) {
+		task = &snapshot->tasks[line];
+		percent = share(task->time, elapsed);
+		snprintf(buf, len, "%-16s%-2s%-14"PRIu64"%3"PRIu32".%02"PRIu32"    %-12"PRIu32"\n", task->name,
+				task->alive ? "" : "*", task->time / us, percent / 100, percent % 100, task->switches);
+		return 1;
+	}
+	line -= header->tasks;
+	if ( line == 0 ) {
+		snprintf(buf, len, "%-18s%-14s%-10s%-12s%-12s\n", "Interrupt ID", "Time (us)", "CPU %", "Count",
+				"Max (us)");
+		return 1;
+	}
+	line--;
+	if ( line < header->irqs ) {
+		irq = &snapshot->irqs[line];
+		percent = share(irq->time, elapsed);
+		snprintf(buf, len, "%-18"PRIu32"%-14"PRIu64"%3"PRIu32".%02"PRIu32"    %-12"PRIu32"%-12"PRIu64"\n",
+				irq->id, irq->time / us, percent / 100, percent % 100, irq->count, irq->max / us);
+		return 1;
+	}
+	line -= header->irqs;
+	switch ( line ) {
+	case 0:
+		snprintf(buf, len, "%-30s%"PRIu64" us, %"PRIu32" context switches\n", "Elapsed", elapsed / us,
+				header->switches);
+		return 1;
+	case 1:
+		percent = share(header->overhead, elapsed);
+		snprintf(buf, len, "%-30s%"PRIu32" hooks, %"PRIu64" ns each, %"PRIu32".%02"PRIu32"%% of CPU\n",
+				"Statistics overhead", header->overhead_events,
+				( ( header->overhead_events != 0 ) && ( header->hz != 0 ) ) ?
+						header->overhead * 1000000000 / header->hz / header->overhead_events : 0,
+				percent / 100, percent % 100);
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+void rtos_stats_print(const struct rtos_stats_snapshot *snapshot)
+{
+	char buf[128];
+	uint32_t line = 0;
+
+	while ( rtos_stats_format(snapshot, line++, buf, sizeof(buf)) ) {
+		fputs(buf, stdout);
+	}
+	fflush(stdout);
+	return;
+}
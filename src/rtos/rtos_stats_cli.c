@@ -0,0 +1,89 @@
+/*
+ * FreeRTOS+CLI commands for rtos_stats.h
+ *
+ * "stats" prints the text report one line per call, as the CLI expects of
+ * long output. "stats-dump" prints the binary snapshot from rtos_stats_dump()
+ * as hex, framed the same way as the flight recorder dump, so that it can be
+ * picked out of a console log by examples/rtos_stats_decode.c.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "FreeRTOS.h"
+#include "FreeRTOS_CLI.h"
+
+#include "rtos_stats.h"
+
+#define DUMP_BYTES_PER_LINE		32
+
+static struct rtos_stats_snapshot cli_snapshot;
+static uint8_t cli_dump[sizeof(struct rtos_stats_snapshot)];
+
+static BaseType_t stats_command(char *out, size_t len, const char *command)
+{
+	static uint32_t line = 0;
+
+	if ( line == 0 ) {
+		rtos_stats_snapshot(&cli_snapshot);
+	}
+	if ( rtos_stats_format(&cli_snapshot, line, out, len) ) {
+		line++;
+		return pdTRUE;
+	}
+	out[0] = '\0';
+	line = 0;
+	return pdFALSE;
+}
+
+static BaseType_t dump_command(char *out, size_t len, const char *command)
+{
+	static size_t dump_len = 0;
+	static size_t offset = 0;
+	static int started = 0;
+	size_t used = 0;
+	size_t end = 0;
+
+	if ( !started ) {
+		rtos_stats_snapshot(&cli_snapshot);
+		dump_len = rtos_stats_dump(&cli_snapshot, cli_dump, sizeof(cli_dump));
+		offset = 0;
+		started = 1;
+		snprintf(out, len, "rtos_stats begin %u\r\n", (unsigned int) dump_len);
+		return pdTRUE;
+	}
+	if ( offset >= dump_len ) {
+		snprintf(out, len, "rtos_stats end\r\n");
+		started = 0;
+		return pdFALSE;
+	}
+	end = ( offset + DUMP_BYTES_PER_LINE < dump_len ) ? offset + DUMP_BYTES_PER_LINE : dump_len;
+	used = snprintf(out, len, "rtos_stats ");
+	for (; ( offset < end ) && ( used + 3 < len ); offset++) {
+		used += snprintf(out + used, len - used, "%02x", cli_dump[offset]);
+	}
+	snprintf(out + used, len - used, "\r\n");
+	return pdTRUE;
+}
+
+static const CLI_Command_Definition_t stats_definition = {
+	"stats",
+	"\r\nstats:\r\n Task and interrupt run time, context switches and the cost of counting them\r\n",
+	stats_command,
+	0
+};
+
+static const CLI_Command_Definition_t dump_definition = {
+	"stats-dump",
+	"\r\nstats-dump:\r\n The same as binary, in hex, for examples/rtos_stats_decode\r\n",
+	dump_command,
+	0
+};
+
+void rtos_stats_cli_register(void)
+{
+	FreeRTOS_CLIRegisterCommand(&stats_definition);
+	FreeRTOS_CLIRegisterCommand(&dump_definition);
+	return;
+}
@@ -0,0 +1,61 @@
+/*
+ * rtos_stats.h on the MicroZed
+ *
+ * Counts on the global timer, which runs at COUNTS_PER_SECOND and is 64 bits
+ * wide, so totals do not wrap in the life of the board. Interrupts are timed
+ * by dispatching them through rtos_stats_zynq_irq(), which does what the
+ * RTOSDemo's vApplicationIRQHandler() does with the timing added, so that
+ * function only has to call it:
+ *
+ *   void vApplicationIRQHandler(uint32_t ulICCIAR)
+ *   {
+ *   	rtos_stats_zynq_irq(ulICCIAR);
+ *   }
+ *
+ * As in the demo, interrupts are enabled again while the handler runs, and
+ * the statistics take nesting into account.
+ */
+
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xscugic.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "rtos_stats.h"
+#include "rtos_stats_zynq.h"
+
+#define GIC_INTR_ID_MASK		0x000003FF
+
+/* From the demo's FreeRTOS_tick_config.c */
+extern XScuGic xInterruptController;
+
+static uint64_t zynq_counter(void)
+{
+	return gtimer_read();
+}
+
+void rtos_stats_zynq_init(void)
+{
+	rtos_stats_init(zynq_counter, COUNTS_PER_SECOND);
+	return;
+}
+
+void rtos_stats_zynq_irq(uint32_t iar)
+{
+	const XScuGic_VectorTableEntry *entry = NULL;
+	uint32_t id = iar & GIC_INTR_ID_MASK;
+
+	if ( id >= XSCUGIC_MAX_NUM_INTR_INPUTS ) {
+		return;
+	}
+	entry = &xInterruptController.Config->HandlerTable[id];
+
+	rtos_stats_irq_enter(id);
+	__asm__ volatile ("cpsie i" ::: "memory");
+	entry->Handler(entry->CallBackRef);
+	__asm__ volatile ("cpsid i" ::: "memory");
+	rtos_stats_irq_exit(id);
+	return;
+}
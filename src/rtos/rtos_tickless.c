@@ -0,0 +1,145 @@
+/*
+ * Tickless idle on a 64-bit counter and comparator, see rtos_tickless.h
+ *
+ * After the wait there are three cases. The comparator fired: the tick
+ * interrupt is pending and will count the last tick itself, so step all but
+ * one. Something else woke the CPU on the last period before the comparator:
+ * the same, the comparator is left alone and fires as planned. Something woke
+ * it earlier: step the whole periods that went by and bring the comparator
+ * back to the next tick after now. If that tick is too close to set safely,
+ * count it now and aim for the one after, which puts the tick count ahead by
+ * less than the margin until the counter catches up.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "rtos_tickless.h"
+
+#define REPORT_PRIORITY			(tskIDLE_PRIORITY + 1)
+#define REPORT_STACK			(configMINIMAL_STACK_SIZE * 4)
+
+static const struct rtos_tickless_timer *tickless_timer;
+static struct rtos_tickless_stats tickless_stats;
+/* Counter value of tick zero */
+static uint64_t tickless_base;
+
+void rtos_tickless_init(const struct rtos_tickless_timer *timer)
+{
+	tickless_timer = timer;
+	tickless_base = timer->comparator() - timer->period - (uint64_t) xTaskGetTickCount() * timer->period;
+	return;
+}
+
+void rtos_tickless_sleep(TickType_t expected)
+{
+	const struct rtos_tickless_timer *timer = tickless_timer;
+	uint64_t last = 0;
+	uint64_t wake = 0;
+	uint64_t next = 0;
+	uint64_t now = 0;
+	TickType_t elapsed = 0;
+
+	timer->irq_mask();
+	if ( eTaskConfirmSleepModeStatus() == eAbortSleep ) {
+		tickless_stats.aborted++;
+		timer->irq_unmask();
+		return;
+	}
+
+	last = timer->comparator() - timer->period;
+	wake = last + (uint64_t) expected * timer->period;
+	if ( timer->fired() || ( wake < timer->counter() + timer->margin ) ) {
+		/* The next tick is already due, let it happen */
+		tickless_stats.aborted++;
+		timer->irq_unmask();
+		return;
+	}
+	timer->set_comparator(wake);
+	timer->wait();
+	tickless_stats.wakeups++;
+	tickless_stats.sleeps++;
+
+	now = timer->counter();
+	elapsed = (TickType_t) ((now - last) / timer->period);
+	if ( timer->fired() || ( elapsed + 1 >= expected ) ) {
+		vTaskStepTick(expected - 1);
+		tickless_stats.suppressed += expected - 1;
+	} else {
+		next = last + ((uint64_t) elapsed + 1) * timer->period;
+		if ( next < now + timer->margin ) {
+			elapsed++;
+			next += timer->period;
+		}
+		/* Past the margin check the comparator cannot be passed before it is set */
+		if ( next != wake ) {
+			timer->set_comparator(next);
+		}
+		vTaskStepTick(elapsed);
+		tickless_stats.suppressed += elapsed;
+		tickless_stats.early++;
+	}
+	timer->irq_unmask();
+	return;
+}
+
+void rtos_tickless_idle(void)
+{
+#if configUSE_TICKLESS_IDLE == 0
+	/* The tick wakes it again, so this is what the ticked build costs in wakeups */
+	tickless_timer->wait();
+	tickless_stats.wakeups++;
+#endif
+	return;
+}
+
+int64_t rtos_tickless_drift(void)
+{
+	uint64_t now = tickless_timer->counter();
+	TickType_t ticks = xTaskGetTickCount();
+
+	return (int64_t) (now - tickless_base) - (int64_t) ((uint64_t) ticks * tickless_timer->period);
+}
+
+void rtos_tickless_get_stats(struct rtos_tickless_stats *stats)
+{
+	*stats = tickless_stats;
+	return;
+}
+
+static void report_task(void *arg)
+{
+	uint32_t period_ms = (uint32_t) (uintptr_t) arg;
+	struct rtos_tickless_stats stats;
+	TickType_t wake = xTaskGetTickCount();
+	uint32_t wakeups = 0;
+	int64_t drift = 0;
+
+	printf("%s idle, %"PRIu32" Hz tick\n", ( configUSE_TICKLESS_IDLE != 0 ) ? "Tickless" : "Ticked",
+			(uint32_t) configTICK_RATE_HZ);
+	printf("%-14s%-14s%-14s%-14s%-14s\n", "Wakeups/s", "Sleeps", "Early", "Suppressed", "Drift (us)");
+	for (;;) {
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(period_ms));
+		rtos_tickless_get_stats(&stats);
+		/* Within one tick period in either build, unless ticks are being lost or made up */
+		drift = rtos_tickless_drift() * 1000000 / (int64_t) tickless_timer->hz;
+		printf("%-14"PRIu32"%-14"PRIu32"%-14"PRIu32"%-14"PRIu32"%-14"PRId64"\n",
+				(stats.wakeups - wakeups) * 1000 / period_ms, stats.sleeps, stats.early, stats.suppressed,
+				drift);
+		fflush(stdout);
+		wakeups = stats.wakeups;
+	}
+}
+
+int rtos_tickless_start_report(uint32_t period_ms)
+{
+	if ( xTaskCreate(report_task, "tickless", REPORT_STACK, (void *) (uintptr_t) period_ms, REPORT_PRIORITY,
+			NULL) != pdPASS ) {
+		return -1;
+	}
+	return 0;
+}
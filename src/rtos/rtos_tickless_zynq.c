@@ -0,0 +1,144 @@
+/*
+ * FreeRTOS tick from the A9 global timer comparator, see rtos_tickless.h
+ *
+ * Takes over from the demo's FreeRTOS_tick_config.c, which ticks from the SCU
+ * private timer. The private timer counts down from a reload value, so it
+ * loses track of time whenever it is reprogrammed for a longer sleep, while
+ * the global timer keeps counting through everything. A TTC would do as well
+ * as a comparator, but with 16-bit counters it could not sleep much longer
+ * than a tick without a prescaler too coarse for the tick itself.
+ *
+ * In the RTOSDemo project's FreeRTOSConfig.h, after including rtos_tickless_zynq.h:
+ *
+ *   #define configSETUP_TICK_INTERRUPT()		rtos_tickless_zynq_setup()
+ *   #define configCLEAR_TICK_INTERRUPT()		rtos_tickless_zynq_clear()
+ *   #define configUSE_TICKLESS_IDLE		2
+ *   #define portSUPPRESS_TICKS_AND_SLEEP(x)	rtos_tickless_sleep(x)
+ *
+ * with configUSE_TICKLESS_IDLE 0 for the ticked build, where vApplicationIdleHook()
+ * calls rtos_tickless_idle() instead, so both builds wait for interrupts the
+ * same way and their wakeups can be compared. Defining RTOS_TICKLESS_REPORT_MS
+ * as well has main_drivers() report the wakeups and drift that often.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xscugic.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "rtos_tickless.h"
+#include "rtos_tickless_zynq.h"
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define GIC_TRIGGER_EDGE		0x3
+
+/* Far more than it takes to get from reading the counter to writing the comparator */
+#define COMPARATOR_MARGIN		(COUNTS_PER_SECOND / 100000)
+
+/* From the demo's FreeRTOS_tick_config.c and the port */
+extern XScuGic xInterruptController;
+extern void FreeRTOS_Tick_Handler(void);
+
+static uint64_t zynq_counter(void)
+{
+	return gtimer_read();
+}
+
+static uint64_t zynq_comparator(void)
+{
+	return ((uint64_t) Xil_In32(GTIMER_COMPARATOR_HI) << 32) | Xil_In32(GTIMER_COMPARATOR_LO);
+}
+
+/* Per the TRM, with the comparator disabled while its two halves are written */
+static void zynq_set_comparator(uint64_t value)
+{
+	uint32_t control = Xil_In32(GTIMER_CONTROL);
+
+	Xil_Out32(GTIMER_CONTROL, control & ~GTIMER_CONTROL_COMP_ENABLE);
+	Xil_Out32(GTIMER_COMPARATOR_LO, (uint32_t) value);
+	Xil_Out32(GTIMER_COMPARATOR_HI, (uint32_t) (value >> 32));
+	Xil_Out32(GTIMER_CONTROL, control | GTIMER_CONTROL_COMP_ENABLE);
+	return;
+}
+
+static int zynq_fired(void)
+{
+	return ( Xil_In32(GTIMER_ISR) & GTIMER_ISR_EVENT ) != 0;
+}
+
+static void zynq_irq_mask(void)
+{
+	__asm__ volatile ("cpsid i" ::: "memory");
+	return;
+}
+
+static void zynq_irq_unmask(void)
+{
+	__asm__ volatile ("cpsie i" ::: "memory");
+	return;
+}
+
+static void zynq_wait(void)
+{
+	__asm__ volatile ("dsb\n\twfi\n\tisb" ::: "memory");
+	return;
+}
+
+static const struct rtos_tickless_timer zynq_timer = {
+	zynq_counter,
+	zynq_comparator,
+	zynq_set_comparator,
+	zynq_fired,
+	zynq_irq_mask,
+	zynq_irq_unmask,
+	zynq_wait,
+	COUNTS_PER_SECOND,
+	COUNTS_PER_SECOND / configTICK_RATE_HZ,
+	COMPARATOR_MARGIN,
+};
+
+void rtos_tickless_zynq_setup(void)
+{
+	XScuGic_Config *config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+	uint32_t control = 0;
+	int status = XST_FAILURE;
+
+	/* As FreeRTOS_tick_config.c would, since nothing else brings up the GIC */
+	configASSERT(config != NULL);
+	status = XScuGic_CfgInitialize(&xInterruptController, config, config->CpuBaseAddress);
+	configASSERT(status == XST_SUCCESS);
+
+	/* The counter itself is left running, XTime_GetTime() depends on it */
+	control = Xil_In32(GTIMER_CONTROL) | GTIMER_CONTROL_ENABLE;
+	control &= ~(GTIMER_CONTROL_COMP_ENABLE | GTIMER_CONTROL_IRQ_ENABLE | GTIMER_CONTROL_AUTO_INCREMENT);
+	Xil_Out32(GTIMER_CONTROL, control);
+	Xil_Out32(GTIMER_ISR, GTIMER_ISR_EVENT);
+	Xil_Out32(GTIMER_AUTO_INCREMENT, zynq_timer.period);
+	Xil_Out32(GTIMER_CONTROL, control | GTIMER_CONTROL_IRQ_ENABLE | GTIMER_CONTROL_AUTO_INCREMENT);
+	zynq_set_comparator(gtimer_read() + zynq_timer.period);
+
+	XScuGic_SetPriorityTriggerType(&xInterruptController, GTIMER_INTR_ID,
+			portLOWEST_USABLE_INTERRUPT_PRIORITY << portPRIORITY_SHIFT, GIC_TRIGGER_EDGE);
+	status = XScuGic_Connect(&xInterruptController, GTIMER_INTR_ID, (Xil_ExceptionHandler) FreeRTOS_Tick_Handler,
+			NULL);
+	configASSERT(status == XST_SUCCESS);
+	XScuGic_Enable(&xInterruptController, GTIMER_INTR_ID);
+
+	rtos_tickless_init(&zynq_timer);
+	return;
+}
+
+void rtos_tickless_zynq_clear(void)
+{
+	/* The comparator has already moved itself on to the next tick */
+	Xil_Out32(GTIMER_ISR, GTIMER_ISR_EVENT);
+	return;
+}
@@ -0,0 +1,118 @@
+/*
+ * Direct digital synthesis on a TTC PWM channel, see dds.h
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "pwm.h"
+#include "dds.h"
+
+#define DDS_PHASE_SPAN			4294967296.0
+
+static int16_t sine[1 << DDS_TABLE_MAX_LOG2];
+
+int dds_init(struct dds *dds, struct pwm_engine *engine, uint32_t channel, uint32_t latency_ticks)
+{
+	const struct pwm_channel *ch = NULL;
+	uint32_t i = 0;
+	int status = PWM_OK;
+
+	status = pwm_sync_enable(engine, channel, latency_ticks);
+	if ( status != PWM_OK ) {
+		return status;
+	}
+	ch = &engine->channels[channel];
+	dds->engine = engine;
+	dds->channel = channel;
+	dds->lo = ch->guard;
+	dds->hi = ch->solution.steps - 1;
+	dds->phase = 0;
+	dds->step = 0;
+	dds->interp = 0;
+	dds->samples = 0;
+	dds->table_log2 = DDS_TABLE_MIN_LOG2;
+	dds->shift = 32 - dds->table_log2;
+	for (i = 0; i <= (1 << DDS_TABLE_MIN_LOG2); i++) {
+		dds->table[i] = (dds->lo + dds->hi) / 2;
+	}
+	dds->next_match = dds_next(dds);
+	return PWM_OK;
+}
+
+int dds_set_table(struct dds *dds, const int16_t *samples, uint32_t table_log2)
+{
+	uint32_t span = dds->hi - dds->lo;
+	uint32_t len = 1 << table_log2;
+	uint32_t i = 0;
+
+	if ( ( table_log2 < DDS_TABLE_MIN_LOG2 ) || ( table_log2 > DDS_TABLE_MAX_LOG2 ) ) {
+		return PWM_EINVAL;
+	}
+	/*
+	 * Filled in while the handler may be reading it, so an entry can be from
+	 * either table for a sample or two; the size changes only once it is full
+	 */
+	for (i = 0; i < len; i++) {
+		dds->table[i] = dds->lo + ((uint32_t) (samples[i] - DDS_SAMPLE_MIN) * span + 32767) / 65535;
+	}
+	dds->table[len] = dds->table[0];
+	if ( table_log2 != dds->table_log2 ) {
+		dds->table_log2 = table_log2;
+		dds->shift = 32 - table_log2;
+	}
+	return PWM_OK;
+}
+
+int dds_set_sine(struct dds *dds, uint32_t table_log2, uint32_t amplitude_ppm)
+{
+	uint32_t len = 1 << table_log2;
+	double scale = DDS_SAMPLE_MAX * (double) amplitude_ppm / PWM_DUTY_FULL;
+	uint32_t i = 0;
+
+	if ( ( table_log2 < DDS_TABLE_MIN_LOG2 ) || ( table_log2 > DDS_TABLE_MAX_LOG2 ) ||
+			( amplitude_ppm > PWM_DUTY_FULL ) ) {
+		return PWM_EINVAL;
+	}
+	for (i = 0; i < len; i++) {
+		sine[i] = (int16_t) lrint(scale * sin(2 * M_PI * i / len));
+	}
+	return dds_set_table(dds, sine, table_log2);
+}
+
+uint64_t dds_sample_rate_mhz(const struct dds *dds)
+{
+	return dds->engine->channels[dds->channel].solution.freq_mhz;
+}
+
+int dds_set_freq(struct dds *dds, uint64_t freq_mhz)
+{
+	const struct pwm_channel *ch = &dds->engine->channels[dds->channel];
+	/* The exact sample period rather than the rounded frequency */
+	double period_ticks = (double) ((uint64_t) ch->solution.steps << ch->solution.prescale_log2);
+	double step = (double) freq_mhz / 1000 * period_ticks / ch->clock_hz * DDS_PHASE_SPAN;
+
+	if ( step >= DDS_PHASE_SPAN / 2 ) {
+		return PWM_ERANGE;
+	}
+	dds->step = (uint32_t) llrint(step);
+	return PWM_OK;
+}
+
+void dds_set_interp(struct dds *dds, uint32_t interp)
+{
+	dds->interp = interp;
+	return;
+}
+
+void dds_isr(struct dds *dds)
+{
+	struct pwm_engine *engine = dds->engine;
+
+	engine->ops->read(engine->ctx, dds->channel, PWM_TTC_ISR);
+	engine->ops->write(engine->ctx, dds->channel, PWM_TTC_MATCH_1, dds->next_match);
+	dds->next_match = dds_next(dds);
+	dds->samples++;
+	return;
+}
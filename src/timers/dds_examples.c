@@ -0,0 +1,127 @@
+/*
+ * Audio-rate waveforms from a TTC output, see dds.h
+ *
+ * Channel 0 runs a 100kHz PWM carrier and the interval interrupt writes a
+ * new sample to it every period. Plays a sine, then a triangle and a
+ * sawtooth from tables built here, for a few seconds each, and prints the
+ * handler's cost from irq_prof as it goes and its share of the CPU at the
+ * end. An RC low-pass filter on the output, around 5kHz, turns the duty
+ * cycle back into the waveform.
+ *
+ * examples/dds_model.c runs the same synthesis on the host against the TTC
+ * model and measures its spectral purity and update rate limits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "sleep.h"
+
+#include "pwm.h"
+#include "pwm_ttc.h"
+#include "dds.h"
+#include "dds_ttc.h"
+#include "dev_pool.h"
+#include "gtimer.h"
+#include "irq_prof.h"
+
+#define ASCII_ESC			27
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define DDS_CHANNEL			0
+#define DDS_IRQ_ID			XPS_TTC0_0_INT_ID
+#define CARRIER_MHZ			PWM_MHZ(100000)
+/* Interval interrupt to the match write, in TTC clock ticks (~1.4us), check against irq_prof */
+#define DDS_LATENCY_TICKS		150
+#define TONE_MHZ			PWM_MHZ(1000)
+#define TABLE_LOG2			10
+#define PLAY_SECONDS			4
+
+static struct pwm_engine engine;
+static struct dds dds;
+static int16_t wave[1 << TABLE_LOG2];
+
+static void report(const char *name)
+{
+	struct irq_prof_stats stats;
+
+	irq_prof_read(DDS_IRQ_ID, &stats);
+	printf("%-20s%-12"PRIu32"%-12"PRIu64"%-12"PRIu32"\n", name, dds.samples,
+			( stats.count == 0 ) ? 0 : stats.cycles / stats.count, stats.max_cycles);
+	return;
+}
+
+int main(int args, char *argv[])
+{
+	XScuGic *gic = dev_pool_gic(GIC_DEVICE_ID);
+	XScuGic_Config *gic_config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+	uint32_t len = 1 << TABLE_LOG2;
+	uint64_t start = 0;
+	uint32_t i = 0;
+
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("TTC DDS\n");
+	printf("-------\n");
+
+	if ( ( gic_config == NULL ) || ( XScuGic_CfgInitialize(gic, gic_config, gic_config->CpuBaseAddress) != XST_SUCCESS ) ) {
+		printf("Could not initialize GIC device ID %d\n", GIC_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	irq_prof_init(gic);
+	if ( pwm_ttc_init(&engine) != XST_SUCCESS ) {
+		printf("Could not find the TTC configuration\n");
+		return XST_FAILURE;
+	}
+	if ( ( pwm_configure(&engine, DDS_CHANNEL, CARRIER_MHZ, 500000) != PWM_OK ) ||
+			( dds_init(&dds, &engine, DDS_CHANNEL, DDS_LATENCY_TICKS) != PWM_OK ) ||
+			( dds_ttc_connect(&dds, gic) != XST_SUCCESS ) ) {
+		printf("Could not set up DDS on channel %d\n", DDS_CHANNEL);
+		return XST_FAILURE;
+	}
+	pwm_print(&engine);
+	printf("\n%-30s%"PRIu64" mHz\n", "Sample rate", dds_sample_rate_mhz(&dds));
+	printf("%-30s%"PRIu32" to %"PRIu32"\n", "Match range", dds.lo, dds.hi);
+
+	dds_set_sine(&dds, TABLE_LOG2, PWM_DUTY_FULL);
+	dds_set_interp(&dds, 1);
+	dds_set_freq(&dds, TONE_MHZ);
+	Xil_ExceptionEnable();
+	start = gtimer_read();
+	pwm_start(&engine, 1 << DDS_CHANNEL);
+
+	printf("\n%-20s%-12s%-12s%-12s\n", "Waveform", "Samples", "Mean cyc", "Max cyc");
+	sleep(PLAY_SECONDS);
+	report("sine");
+
+	/* Tables change while playing */
+	for (i = 0; i < len; i++) {
+		wave[i] = ( i < len / 2 ) ? DDS_SAMPLE_MIN + (int32_t) (i * 2 * 65535 / len) :
+				DDS_SAMPLE_MAX - (int32_t) ((i - len / 2) * 2 * 65535 / len);
+	}
+	dds_set_table(&dds, wave, TABLE_LOG2);
+	sleep(PLAY_SECONDS);
+	report("triangle");
+
+	for (i = 0; i < len; i++) {
+		wave[i] = DDS_SAMPLE_MIN + (int32_t) (i * 65535 / (len - 1));
+	}
+	dds_set_table(&dds, wave, TABLE_LOG2);
+	sleep(PLAY_SECONDS);
+	report("sawtooth");
+
+	pwm_stop(&engine, 1 << DDS_CHANNEL);
+	printf("\n");
+	irq_prof_print(gtimer_read() - start);
+
+	cleanup_platform();
+	return 0;
+}
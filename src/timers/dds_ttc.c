@@ -0,0 +1,69 @@
+/*
+ * DDS interval interrupt handler on the Zynq TTCs, see dds_ttc.h
+ *
+ * The handler reads the interrupt status to clear it, writes the sample
+ * worked out last time to match 1, and works out the next one, with the
+ * register addresses worked out beforehand.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xttcps.h"
+#include "xscugic.h"
+
+#include "pwm.h"
+#include "dds.h"
+#include "dds_ttc.h"
+
+/* What the GIC hands dds_ttc_handler() */
+struct dds_ttc_irq {
+	struct dds *dds;
+	uint32_t isr_addr;
+	uint32_t match_addr;
+};
+
+static const uint32_t channel_irq_id[PWM_CHANNELS] = {
+	XPS_TTC0_0_INT_ID,
+	XPS_TTC0_1_INT_ID,
+	XPS_TTC0_2_INT_ID,
+	XPS_TTC1_0_INT_ID,
+	XPS_TTC1_1_INT_ID,
+	XPS_TTC1_2_INT_ID,
+};
+
+static struct dds_ttc_irq channel_irq[PWM_CHANNELS];
+
+static void dds_ttc_handler(void *callback_ref)
+{
+	struct dds_ttc_irq *irq = callback_ref;
+	struct dds *dds = irq->dds;
+
+	Xil_In32(irq->isr_addr);
+	Xil_Out32(irq->match_addr, dds->next_match);
+	dds->next_match = dds_next(dds);
+	dds->samples++;
+	return;
+}
+
+int dds_ttc_connect(struct dds *dds, XScuGic *gic)
+{
+	XTtcPs_Config *config = XTtcPs_LookupConfig(dds->channel);
+	struct dds_ttc_irq *irq = &channel_irq[dds->channel];
+
+	if ( config == NULL ) {
+		return XST_FAILURE;
+	}
+	irq->dds = dds;
+	irq->isr_addr = config->BaseAddress + PWM_TTC_ISR;
+	irq->match_addr = config->BaseAddress + PWM_TTC_MATCH_1;
+	if ( XScuGic_Connect(gic, channel_irq_id[dds->channel], (Xil_InterruptHandler) dds_ttc_handler,
+			irq) != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+	XScuGic_Enable(gic, channel_irq_id[dds->channel]);
+	return XST_SUCCESS;
+}
@@ -15,6 +15,8 @@
 /* Definitions for hard peripherals attached to the Cortex A9 (e.g., interrupts) */
 #include "xparameters_ps.h"
 
+#include "dev_pool.h"
+
 /* Canonical device ID definitions from xparameters.h */
 #define TIMER_DEVICE_ID		XPAR_XSCUTIMER_0_DEVICE_ID
 #define GIC_DEVICE_ID		XPAR_SCUGIC_0_DEVICE_ID
@@ -34,7 +36,6 @@
 #define MAX_TIMER_COUNT     10
 
 /* Function declarations */
-void MemCleanup(void *ptra, void *ptrb);
 int SetupTimerSystem(XScuTimer *Timer, XScuTimer_Config *TimerConfig);
 int SetupIntrSystem(XScuGic *Gic, XScuGic_Config *GicConfig);
 static void TimerIntrHandler(void *CallBackRef);
@@ -57,17 +58,6 @@ uint32_t Timer_GetControlReg(XScuTimer *Timer){return Xil_In32((Timer->Config.Ba
 
 static int TimerCount = 0;
 
-void MemCleanup(void *ptra, void *ptrb)
-{
-	if (ptra != NULL) {
-		free(ptra);
-	}
-	if (ptrb != NULL) {
-		free(ptrb);
-	}
-	return;
-}
-
 /* Initialize the timer subsystem and perform a timer self-test */
 int SetupTimerSystem(XScuTimer *Timer, XScuTimer_Config *TimerConfig)
 {
@@ -236,38 +226,27 @@ int main(int args, char *argv[])
 	printf("----------------------\n");
 
 	/* Create a private timer instance */
-	Timer = malloc(sizeof(XScuTimer));
-	if (Timer == NULL) {
-		fprintf(stderr, "Could not allocate memory for timer subsystem\n");
-		MemCleanup(Gic, Timer);
-		return XST_FAILURE;
-	}
+	Timer = dev_pool_scutimer(TIMER_DEVICE_ID);
 	Status = SetupTimerSystem(Timer, TimerConfig);
 	fprintf(stdout, "Initialize private timer subsystem\t\t");
 	if (Status == XST_FAILURE) {
 		fprintf(stdout, "FAILED\n");
-		MemCleanup(Gic, Timer);
 		return XST_FAILURE;
 	} else {
 		fprintf(stdout, "COMPLETE\n");
 	}
 
 	/* Create a generic interrupt controller instance */
-	Gic = malloc(sizeof(XScuGic));
-	if (Gic == NULL) {
-		fprintf(stderr, "Could not allocate memory for GIC subsystem\n");
-		MemCleanup(Gic, Timer);
-		return XST_FAILURE;
-	}
+	Gic = dev_pool_gic(GIC_DEVICE_ID);
 	Status = SetupIntrSystem(Gic, GicConfig);
 	fprintf(stdout, "Initialize GIC subsystem\t\t\t");
 	if (Status == XST_FAILURE) {
 		fprintf(stdout, "FAILED\n");
-		MemCleanup(Gic, Timer);
 		return XST_FAILURE;
 	} else {
 		fprintf(stdout, "COMPLETE\n");
 	}
+	dev_pool_report();
 
 	/*
 	 * Register the GIC interrupt handler with the exception handling logic
@@ -334,7 +313,6 @@ int main(int args, char *argv[])
 	}
 	printf("Counted %d interrupts\n", TimerCount);
 
-	MemCleanup(Gic, Timer);
 	cleanup_platform();
 
 	return 0;
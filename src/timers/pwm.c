@@ -0,0 +1,302 @@
+/*
+ * Multi-channel PWM on the TTC counters, see pwm.h
+ *
+ * The solver works out the period in counts for each prescaler from the
+ * millihertz frequency, then compares the candidates by the frequency they
+ * actually give in nanohertz, which a 32-bit clock in hertz times 10^9 still
+ * fits in 64 bits. Neither needs floating point, which the A9 would have to
+ * save and restore if this were ever called from a handler.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "pwm.h"
+
+#define NHZ_PER_HZ			1000000000ULL
+#define NHZ_PER_MHZ			1000000ULL
+#define PWM_MIN_STEPS			2
+
+static uint64_t abs_diff(uint64_t a, uint64_t b)
+{
+	return ( a > b ) ? a - b : b - a;
+}
+
+/* Nearest match for duty_ppm, kept between least and one short of steps */
+static uint32_t duty_to_match(uint32_t steps, uint32_t duty_ppm, uint32_t least)
+{
+	uint64_t match = ((uint64_t) steps * duty_ppm + PWM_DUTY_FULL / 2) / PWM_DUTY_FULL;
+
+	if ( match < least ) {
+		match = least;
+	}
+	if ( match > steps - 1 ) {
+		match = steps - 1;
+	}
+	return match;
+}
+
+static uint32_t match_to_duty(uint32_t steps, uint32_t match)
+{
+	return ((uint64_t) match * PWM_DUTY_FULL + steps / 2) / steps;
+}
+
+int pwm_solve(uint32_t clock_hz, uint64_t freq_mhz, uint32_t duty_ppm, uint32_t min_steps,
+		struct pwm_solution *solution)
+{
+	uint64_t clock_mhz = (uint64_t) clock_hz * 1000;
+	uint64_t clock_nhz = (uint64_t) clock_hz * NHZ_PER_HZ;
+	uint64_t want_nhz = freq_mhz * NHZ_PER_MHZ;
+	uint64_t best_error = UINT64_MAX;
+	uint64_t best_nhz = 0;
+	uint64_t counts = 0;
+	uint64_t actual = 0;
+	uint32_t best_log2 = 0;
+	uint32_t best_counts = 0;
+	uint32_t log2 = 0;
+	uint32_t i = 0;
+
+	if ( ( clock_hz == 0 ) || ( freq_mhz == 0 ) || ( freq_mhz > clock_mhz ) || ( duty_ppm > PWM_DUTY_FULL ) ) {
+		return PWM_EINVAL;
+	}
+	if ( min_steps < PWM_MIN_STEPS ) {
+		min_steps = PWM_MIN_STEPS;
+	}
+	for (log2 = 0; log2 <= PWM_PRESCALE_MAX_LOG2; log2++) {
+		/* The counts either side of the exact period, whichever is nearer in frequency */
+		counts = clock_mhz / (freq_mhz << log2);
+		for (i = 0; i < 2; i++, counts++) {
+			if ( ( counts < min_steps ) || ( counts > PWM_INTERVAL_MAX + 1 ) ) {
+				continue;
+			}
+			actual = clock_nhz / (counts << log2);
+			if ( abs_diff(actual, want_nhz) < best_error ) {
+				best_error = abs_diff(actual, want_nhz);
+				best_nhz = actual;
+				best_log2 = log2;
+				best_counts = counts;
+			}
+		}
+	}
+	if ( best_counts == 0 ) {
+		return PWM_ERANGE;
+	}
+
+	solution->prescale_log2 = best_log2;
+	solution->interval = best_counts - 1;
+	solution->match = duty_to_match(best_counts, duty_ppm, 1);
+	solution->freq_mhz = (best_nhz + NHZ_PER_MHZ / 2) / NHZ_PER_MHZ;
+	solution->duty_ppm = match_to_duty(best_counts, solution->match);
+	solution->error_ppm = (int32_t) ((int64_t) (best_nhz - want_nhz) / (int64_t) (want_nhz / 1000000));
+	solution->steps = best_counts;
+	return PWM_OK;
+}
+
+void pwm_init(struct pwm_engine *engine, const struct pwm_ops *ops, void *ctx, uint32_t clock_hz)
+{
+	struct pwm_channel *ch = NULL;
+	uint32_t i = 0;
+
+	engine->ops = ops;
+	engine->ctx = ctx;
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		ch = &engine->channels[i];
+		ch->clock_hz = clock_hz;
+		ch->external = 0;
+		ch->min_steps = PWM_MIN_STEPS;
+		ch->configured = 0;
+		ch->pending = 0;
+		ch->sync = 0;
+		ch->guard = 1;
+		ch->irqs = 0;
+		ch->commits = 0;
+		ch->late = 0;
+		/* Per the TRM, the disable bit goes in before anything else is changed */
+		ops->write(ctx, i, PWM_TTC_CNT_CTRL, PWM_CNT_CTRL_DIS | PWM_CNT_CTRL_WAVE_DIS);
+		ops->write(ctx, i, PWM_TTC_CLK_CTRL, 0);
+	}
+	return;
+}
+
+int pwm_set_clock(struct pwm_engine *engine, uint32_t channel, uint32_t clock_hz, uint32_t external)
+{
+	if ( ( channel >= PWM_CHANNELS ) || ( clock_hz == 0 ) ) {
+		return PWM_EINVAL;
+	}
+	engine->channels[channel].clock_hz = clock_hz;
+	engine->channels[channel].external = external;
+	return PWM_OK;
+}
+
+int pwm_set_min_steps(struct pwm_engine *engine, uint32_t channel, uint32_t min_steps)
+{
+	if ( ( channel >= PWM_CHANNELS ) || ( min_steps > PWM_INTERVAL_MAX + 1 ) ) {
+		return PWM_EINVAL;
+	}
+	engine->channels[channel].min_steps = min_steps;
+	return PWM_OK;
+}
+
+int pwm_configure(struct pwm_engine *engine, uint32_t channel, uint64_t freq_mhz, uint32_t duty_ppm)
+{
+	struct pwm_channel *ch = NULL;
+	struct pwm_solution solution;
+	uint32_t clk_ctrl = 0;
+	int status = PWM_OK;
+
+	if ( channel >= PWM_CHANNELS ) {
+		return PWM_EINVAL;
+	}
+	ch = &engine->channels[channel];
+	status = pwm_solve(ch->clock_hz, freq_mhz, duty_ppm, ch->min_steps, &solution);
+	if ( status != PWM_OK ) {
+		return status;
+	}
+	/* The prescaler field N divides by 2^(N + 1) */
+	if ( solution.prescale_log2 != 0 ) {
+		clk_ctrl = PWM_CLK_CTRL_PS_EN | ((solution.prescale_log2 - 1) << PWM_CLK_CTRL_PS_SHIFT);
+	}
+	if ( ch->external ) {
+		clk_ctrl |= PWM_CLK_CTRL_SRC_EXT;
+	}
+	engine->ops->write(engine->ctx, channel, PWM_TTC_CNT_CTRL, PWM_CNT_CTRL_DIS | PWM_CNT_CTRL_WAVE_DIS);
+	engine->ops->write(engine->ctx, channel, PWM_TTC_IER, 0);
+	engine->ops->write(engine->ctx, channel, PWM_TTC_CLK_CTRL, clk_ctrl);
+	engine->ops->write(engine->ctx, channel, PWM_TTC_INTERVAL, solution.interval);
+	engine->ops->write(engine->ctx, channel, PWM_TTC_MATCH_1, solution.match);
+	ch->solution = solution;
+	ch->configured = 1;
+	ch->pending = 0;
+	ch->sync = 0;
+	ch->guard = 1;
+	return PWM_OK;
+}
+
+void pwm_start(struct pwm_engine *engine, uint32_t mask)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		if ( ( mask & (1 << i) ) && engine->channels[i].configured ) {
+			engine->ops->write(engine->ctx, i, PWM_TTC_CNT_CTRL,
+					PWM_CNT_CTRL_INT | PWM_CNT_CTRL_MATCH | PWM_CNT_CTRL_RST | PWM_CNT_CTRL_WAVE_POL);
+		}
+	}
+	return;
+}
+
+void pwm_stop(struct pwm_engine *engine, uint32_t mask)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		if ( mask & (1 << i) ) {
+			engine->ops->write(engine->ctx, i, PWM_TTC_CNT_CTRL,
+					engine->ops->read(engine->ctx, i, PWM_TTC_CNT_CTRL) | PWM_CNT_CTRL_DIS);
+		}
+	}
+	return;
+}
+
+int pwm_sync_enable(struct pwm_engine *engine, uint32_t channel, uint32_t latency_ticks)
+{
+	struct pwm_channel *ch = NULL;
+	uint32_t guard = 0;
+
+	if ( ( channel >= PWM_CHANNELS ) || !engine->channels[channel].configured ) {
+		return PWM_EINVAL;
+	}
+	ch = &engine->channels[channel];
+	/* The count has moved on by at most this many when match 1 is written */
+	guard = (latency_ticks >> ch->solution.prescale_log2) + 1;
+	if ( guard > ch->solution.steps - 1 ) {
+		return PWM_ERANGE;
+	}
+	ch->guard = guard;
+	ch->pending = 0;
+	ch->sync = 1;
+	/* Anything left over from before is stale */
+	engine->ops->read(engine->ctx, channel, PWM_TTC_ISR);
+	engine->ops->write(engine->ctx, channel, PWM_TTC_IER, PWM_IXR_INTERVAL);
+	return PWM_OK;
+}
+
+int pwm_set_duty(struct pwm_engine *engine, uint32_t channel, uint32_t duty_ppm)
+{
+	struct pwm_channel *ch = NULL;
+	uint32_t match = 0;
+
+	if ( ( channel >= PWM_CHANNELS ) || !engine->channels[channel].configured || ( duty_ppm > PWM_DUTY_FULL ) ) {
+		return PWM_EINVAL;
+	}
+	ch = &engine->channels[channel];
+	match = duty_to_match(ch->solution.steps, duty_ppm, ch->guard);
+	if ( ch->sync ) {
+		/* The flag last, so pwm_isr() never takes a half written update */
+		ch->pending_duty_ppm = match_to_duty(ch->solution.steps, match);
+		ch->pending_match = match;
+		ch->pending = 1;
+	} else {
+		engine->ops->write(engine->ctx, channel, PWM_TTC_MATCH_1, match);
+		ch->solution.match = match;
+		ch->solution.duty_ppm = match_to_duty(ch->solution.steps, match);
+	}
+	return PWM_OK;
+}
+
+void pwm_isr(struct pwm_engine *engine, uint32_t channel)
+{
+	struct pwm_channel *ch = &engine->channels[channel];
+	uint32_t status = engine->ops->read(engine->ctx, channel, PWM_TTC_ISR);
+	uint32_t match = 0;
+
+	ch->irqs++;
+	if ( !(status & PWM_IXR_INTERVAL) || !ch->pending ) {
+		return;
+	}
+	match = ch->pending_match;
+	/*
+	 * Too late for this period if the count is already there, the output would
+	 * miss its match and stay high. Only a latency beyond the guard gets here.
+	 */
+	if ( engine->ops->read(engine->ctx, channel, PWM_TTC_COUNTER) >= match ) {
+		ch->late++;
+		return;
+	}
+	engine->ops->write(engine->ctx, channel, PWM_TTC_MATCH_1, match);
+	ch->pending = 0;
+	ch->solution.match = match;
+	ch->solution.duty_ppm = ch->pending_duty_ppm;
+	ch->commits++;
+	return;
+}
+
+const struct pwm_solution *pwm_get(const struct pwm_engine *engine, uint32_t channel)
+{
+	if ( ( channel >= PWM_CHANNELS ) || !engine->channels[channel].configured ) {
+		return NULL;
+	}
+	return &engine->channels[channel].solution;
+}
+
+void pwm_print(const struct pwm_engine *engine)
+{
+	const struct pwm_channel *ch = NULL;
+	uint32_t i = 0;
+
+	printf("%-4s%-12s%-10s%-10s%-8s%-18s%-12s%-10s%-8s\n", "Ch", "Clock (Hz)", "Prescale", "Interval",
+			"Match", "Frequency (Hz)", "Error (ppm)", "Duty (%)", "Steps");
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		ch = &engine->channels[i];
+		if ( !ch->configured ) {
+			continue;
+		}
+		printf("%-4"PRIu32"%-12"PRIu32"%-10"PRIu32"%-10"PRIu16"%-8"PRIu16"%10"PRIu64".%03"PRIu64"     "
+				"%-12"PRId32"%3"PRIu32".%04"PRIu32"  %-8"PRIu32"\n", i, ch->clock_hz,
+				(uint32_t) 1 << ch->solution.prescale_log2, ch->solution.interval, ch->solution.match,
+				ch->solution.freq_mhz / 1000, ch->solution.freq_mhz % 1000, ch->solution.error_ppm,
+				ch->solution.duty_ppm / 10000, ch->solution.duty_ppm % 10000, ch->solution.steps);
+	}
+	return;
+}
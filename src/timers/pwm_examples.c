@@ -0,0 +1,159 @@
+/*
+ * Six PWM outputs from the two TTCs, see pwm.h
+ *
+ * Works out and starts one output per counter, prints what the registers
+ * give, then leaves the counters to it: there are no interrupts and the CPU
+ * does nothing from then on. The outputs only reach pins if the hardware
+ * design routes the TTC waveform outputs out over MIO or EMIO.
+ *
+ * With PWM_SWEEP, channel 0 instead sweeps a servo back and forth through
+ * pwm_set_duty(), about a step a period. The interval interrupt commits each
+ * step at the start of a period, and irq_prof reports what that costs.
+ *
+ * The same channels run on the host against the TTC model in
+ * examples/pwm_model.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xscugic.h"
+#include "xil_exception.h"
+#include "sleep.h"
+
+#include "ttc_dbg.h"
+#include "pwm.h"
+#include "pwm_ttc.h"
+#include "dev_pool.h"
+#include "irq_prof.h"
+
+#define ASCII_ESC			27
+
+/* Print every counter's registers as ttc_dbg reads them back */
+//#define PWM_DEBUG
+
+/* Sweep channel 0 with glitch-free duty cycle updates */
+//#define PWM_SWEEP
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+/* Interval interrupt to the match write, generously, in TTC clock ticks (~9us) */
+#define PWM_LATENCY_TICKS		1000
+/* 1 to 2ms of a 20ms servo period */
+#define SWEEP_MIN_PPM			50000
+#define SWEEP_MAX_PPM			100000
+#define SWEEP_STEP_PPM			500
+#define SWEEP_PERIOD_US			20000
+#define SWEEP_CYCLES			10
+
+struct pwm_request {
+	uint64_t freq_mhz;
+	uint32_t duty_ppm;
+	uint32_t min_steps;
+};
+
+/* A servo, a fan, audio-rate tones, a fast clock and a slow blink */
+static const struct pwm_request requests[PWM_CHANNELS] = {
+	{PWM_MHZ(50), 75000, 1000},
+	{PWM_MHZ(25000), 250000, 0},
+	{PWM_MHZ(440), 100000, 0},
+	{PWM_MHZ(1000), 500000, 0},
+	{PWM_MHZ(1000000), 333333, 0},
+	{500, 900000, 0},
+};
+
+static struct pwm_engine engine;
+
+#ifdef PWM_SWEEP
+static void sweep(void)
+{
+	XScuGic *gic = dev_pool_gic(GIC_DEVICE_ID);
+	XScuGic_Config *gic_config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+	const struct pwm_channel *ch = &engine.channels[0];
+	struct irq_prof_stats stats;
+	uint32_t duty = SWEEP_MIN_PPM;
+	uint32_t cycle = 0;
+	int step = SWEEP_STEP_PPM;
+
+	if ( ( gic_config == NULL ) || ( XScuGic_CfgInitialize(gic, gic_config, gic_config->CpuBaseAddress) != XST_SUCCESS ) ) {
+		printf("Could not initialize GIC device ID %d\n", GIC_DEVICE_ID);
+		return;
+	}
+	irq_prof_init(gic);
+	if ( ( pwm_ttc_connect(&engine, gic, 1 << 0) != XST_SUCCESS ) ||
+			( pwm_sync_enable(&engine, 0, PWM_LATENCY_TICKS) != PWM_OK ) ) {
+		printf("Could not enable duty cycle updates on channel 0\n");
+		return;
+	}
+	Xil_ExceptionEnable();
+
+	printf("\nSweeping channel 0 from %d to %d ppm\n", SWEEP_MIN_PPM, SWEEP_MAX_PPM);
+	while ( cycle < SWEEP_CYCLES ) {
+		pwm_set_duty(&engine, 0, duty);
+		usleep(SWEEP_PERIOD_US);
+		if ( ( duty + step > SWEEP_MAX_PPM ) || ( duty + step < SWEEP_MIN_PPM ) ) {
+			step = -step;
+			cycle++;
+		}
+		duty += step;
+	}
+
+	irq_prof_read(XPS_TTC0_0_INT_ID, &stats);
+	printf("%-30s%"PRIu32"\n", "Interrupts", ch->irqs);
+	printf("%-30s%"PRIu32"\n", "Updates committed", ch->commits);
+	printf("%-30s%"PRIu32"\n", "Updates held over (late)", ch->late);
+	printf("%-30s%"PRIu32"\n", "Guard (counts)", ch->guard);
+	if ( stats.count != 0 ) {
+		printf("%-30s%"PRIu64"\n", "Handler mean (cycles)", stats.cycles / stats.count);
+		printf("%-30s%"PRIu32"\n", "Handler max (cycles)", stats.max_cycles);
+	}
+	return;
+}
+#endif /* PWM_SWEEP */
+
+int main(int args, char *argv[])
+{
+	uint32_t i = 0;
+	int status = PWM_OK;
+
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("TTC PWM\n");
+	printf("-------\n");
+
+	if ( pwm_ttc_init(&engine) != XST_SUCCESS ) {
+		printf("Could not find the TTC configuration\n");
+		return XST_FAILURE;
+	}
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		pwm_set_min_steps(&engine, i, requests[i].min_steps);
+		status = pwm_configure(&engine, i, requests[i].freq_mhz, requests[i].duty_ppm);
+		if ( status != PWM_OK ) {
+			printf("Channel %"PRIu32" cannot do %"PRIu64" mHz (%d)\n", i, requests[i].freq_mhz, status);
+		}
+	}
+	pwm_start(&engine, (1 << PWM_CHANNELS) - 1);
+	pwm_print(&engine);
+
+#ifdef PWM_DEBUG
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		printf("\nTTC%"PRIu32" counter %"PRIu32"\n", i / PWM_COUNTERS_PER_TTC, i % PWM_COUNTERS_PER_TTC);
+		ttc_dbg_print_summary(i / PWM_COUNTERS_PER_TTC, i % PWM_COUNTERS_PER_TTC);
+	}
+#endif /* PWM_DEBUG */
+
+#ifdef PWM_SWEEP
+	sweep();
+#endif /* PWM_SWEEP */
+
+	for (;;) {
+	}
+
+	cleanup_platform();
+	return 0;
+}
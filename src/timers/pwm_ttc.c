@@ -0,0 +1,100 @@
+/*
+ * pwm.h on the Zynq TTCs, see pwm_ttc.h
+ *
+ * The BSP gives every counter its own device ID, with a base address four
+ * bytes on from the previous counter's (0xF8001000, 0xF8001004, ...), so the
+ * register offsets in pwm.h apply to each channel's base as they are. No
+ * XTtcPs instances are needed, the engine writes the registers itself.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xttcps.h"
+#include "xscugic.h"
+
+#include "pwm.h"
+#include "pwm_ttc.h"
+
+/* What the GIC hands pwm_ttc_handler() */
+struct pwm_ttc_irq {
+	struct pwm_engine *engine;
+	uint32_t channel;
+};
+
+static const uint32_t channel_irq_id[PWM_CHANNELS] = {
+	XPS_TTC0_0_INT_ID,
+	XPS_TTC0_1_INT_ID,
+	XPS_TTC0_2_INT_ID,
+	XPS_TTC1_0_INT_ID,
+	XPS_TTC1_1_INT_ID,
+	XPS_TTC1_2_INT_ID,
+};
+
+static uint32_t channel_base[PWM_CHANNELS];
+static struct pwm_ttc_irq channel_irq[PWM_CHANNELS];
+
+static void pwm_ttc_write(void *ctx, uint32_t channel, uint32_t offset, uint32_t val)
+{
+	Xil_Out32(channel_base[channel] + offset, val);
+	return;
+}
+
+static uint32_t pwm_ttc_read(void *ctx, uint32_t channel, uint32_t offset)
+{
+	return Xil_In32(channel_base[channel] + offset);
+}
+
+static const struct pwm_ops pwm_ttc_ops = {
+	pwm_ttc_write,
+	pwm_ttc_read,
+};
+
+int pwm_ttc_init(struct pwm_engine *engine)
+{
+	XTtcPs_Config *config[PWM_CHANNELS];
+	uint32_t i = 0;
+
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		config[i] = XTtcPs_LookupConfig(i);
+		if ( config[i] == NULL ) {
+			return XST_FAILURE;
+		}
+		channel_base[i] = config[i]->BaseAddress;
+	}
+	pwm_init(engine, &pwm_ttc_ops, NULL, config[0]->InputClockHz);
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		pwm_set_clock(engine, i, config[i]->InputClockHz, 0);
+	}
+	return XST_SUCCESS;
+}
+
+static void pwm_ttc_handler(void *callback_ref)
+{
+	struct pwm_ttc_irq *irq = callback_ref;
+
+	pwm_isr(irq->engine, irq->channel);
+	return;
+}
+
+int pwm_ttc_connect(struct pwm_engine *engine, XScuGic *gic, uint32_t mask)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		if ( !(mask & (1 << i)) ) {
+			continue;
+		}
+		channel_irq[i].engine = engine;
+		channel_irq[i].channel = i;
+		if ( XScuGic_Connect(gic, channel_irq_id[i], (Xil_InterruptHandler) pwm_ttc_handler,
+				&channel_irq[i]) != XST_SUCCESS ) {
+			return XST_FAILURE;
+		}
+		XScuGic_Enable(gic, channel_irq_id[i]);
+	}
+	return XST_SUCCESS;
+}
@@ -17,10 +17,14 @@
 /* Triple timer counter libraries */
 #include "xttcps.h"
 #include "platform.h"
+#include "xtime_l.h"
 
 /* Debug and workaround codes */
 #include "ttc_dbg.h"
 #include "ps7_dbg.h"
+#include "irq_prof.h"
+#include "dev_pool.h"
+#include "console_uartps.h"
 
 /* Necessary for creating driver instances */
 #define GIC_DEVICE_ID				XPAR_SCUGIC_SINGLE_DEVICE_ID
@@ -39,19 +43,18 @@ static int expired = 0;
 
 void clear_console()
 {
-	fprintf(stdout, "%c[2J", ASCII_ESC);
-	fflush(stdout);
-
+	console_printf(&console_uart, "%c[2J", ASCII_ESC);
+	return;
 }
 void print_operation(char *str)
 {
-	fprintf(stdout, "%-50s", str);
-	fflush(stdout);
+	console_printf(&console_uart, "%-50s", str);
+	return;
 }
 void print_result(char *str)
 {
-	fprintf(stdout, "%10s\n", str);
-	fflush(stdout);
+	console_printf(&console_uart, "%10s\n", str);
+	return;
 }
 
 /* Creates and registers a GIC instance with the Cortex-A9 exception handler */
@@ -75,11 +78,10 @@ void setup_generic_intr_ctrl(XScuGic *gic, XScuGic_Config *gic_config)
 			if ( ( status != XST_SUCCESS ) || ( gic == NULL ) ) {
 				fprintf(stderr, "Could not initialize GIC for GIC device ID %d\n", GIC_DEVICE_ID);
 			} else {
-				/* Register and confirm the exception handler with the processor */
-				Xil_ExceptionRegisterHandler(
-						XIL_EXCEPTION_ID_IRQ_INT, (Xil_ExceptionHandler) XScuGic_InterruptHandler, gic);
+				/* Register and confirm the (profiling) exception handler with the processor */
+				irq_prof_init(gic);
 				Xil_GetExceptionRegisterHandler(XIL_EXCEPTION_ID_IRQ_INT, &check_intr_handler, &check_data);
-				if ( ( check_intr_handler != (Xil_ExceptionHandler) XScuGic_InterruptHandler) || ( check_data != gic ) ) {
+				if ( ( check_intr_handler != (Xil_ExceptionHandler) irq_prof_handler) || ( check_data != gic ) ) {
 					fprintf(stderr, "Could not register GIC instance with CPU exception handler\n");
 				} else {
 					Xil_ExceptionDisable();
@@ -193,7 +195,6 @@ static void ttc_intr_handler(void *callback_ref)
 			fprintf(stdout, "Received some other TTC interrupt\n");
 		}
 	}
-	fflush(stdout);
 	return;
 }
 
@@ -202,16 +203,21 @@ int main(int args, char *argv[])
 	/* Storage for reading and writing values to control registers */
 	uint32_t val32 = 0;
 
+	/* For the share of time spent in the TTC interrupt */
+	XTime start = 0;
+	XTime stop = 0;
+
 	XScuGic *gic = NULL;
 	XScuGic_Config *gic_config = NULL;
 
 	XTtcPs *ttc = NULL;
 	XTtcPs_Config *ttc_config = NULL;
 
-	gic = malloc(sizeof(XScuGic));
-	ttc = malloc(sizeof(XTtcPs));
+	gic = dev_pool_gic(GIC_DEVICE_ID);
+	ttc = dev_pool_ttc(TTC_DEVICE_ID);
 
 	init_platform();
+	console_uartps_init(CONSOLE_BLOCK);
 
 	clear_console();
 
@@ -227,6 +233,8 @@ int main(int args, char *argv[])
 
 	/* Connect an interrupt handler for the IRQ ID of the chosen timer */
 	XScuGic_Connect(gic, TTC0_IRQ_ID, (Xil_InterruptHandler) ttc_intr_handler, (void *) ttc);
+	/* From here on console output is drained by the UART interrupt */
+	console_uartps_start(gic);
 	/* Enable interrupt exceptions in the processor */
 	Xil_ExceptionEnable();
 	/* Enable interrupts at the GIC */
@@ -238,6 +246,7 @@ int main(int args, char *argv[])
 	fprintf(stdout, "%-20s0x%01"PRIx32"\n", "Silicon Rev", ps7_dbg_get_ps_version());
 	fprintf(stdout, "%-20s0x%02"PRIx32"\n", "Manufacturer ID", ps7_dbg_get_mfr_id());
 	fprintf(stdout, "%-20s0x%02"PRIx32"\n", "Device Code", ps7_dbg_get_device_code());
+	dev_pool_report();
 
 	ttc_dbg_print_input_freq(ttc);
 	ttc_dbg_print_interval(ttc);
@@ -266,6 +275,7 @@ int main(int args, char *argv[])
 	ttc_dbg_set_cnt_ctrl(0, 0, val32);
 
 	printf("Starting timer...\n");
+	XTime_GetTime(&start);
 	XTtcPs_Start(ttc);
 
 	ttc_dbg_print_summary(0, 0);
@@ -274,11 +284,11 @@ int main(int args, char *argv[])
 			break;
 		}
 	}
+	XTime_GetTime(&stop);
+	/* Mostly the time spent printing from inside the handler */
+	irq_prof_print(stop - start);
 	printf("Done\n");
 
-	free(gic);
-	free(ttc);
-
 	cleanup_platform();
 
 	return 0;
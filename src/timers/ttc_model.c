@@ -0,0 +1,296 @@
+/*
+ * Host model of the TTC counters, see ttc_model.h
+ *
+ * Each counter keeps the count it had at origin, an input tick on its
+ * prescaled clock, and counts once every prescale ticks from there. Nothing
+ * but an event changes what a counter does next, so the model works out when
+ * the earliest one is due, jumps there, and the counts in between are
+ * arithmetic when a register is read.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ttc_model.h"
+
+#define CLK_CTRL_PS_EN			0x01
+#define CLK_CTRL_PS_SHIFT		1
+#define CLK_CTRL_PS_MASK		0x0F
+
+#define CNT_CTRL_DIS			0x01
+#define CNT_CTRL_INT			0x02
+#define CNT_CTRL_MATCH			0x08
+#define CNT_CTRL_RST			0x10
+#define CNT_CTRL_WAVE_DIS		0x20
+#define CNT_CTRL_WAVE_POL		0x40
+
+#define COUNT_MAX			0xFFFF
+
+static uint32_t prescale(const struct ttc_model_counter *c)
+{
+	if ( c->clk_ctrl & CLK_CTRL_PS_EN ) {
+		return 2 << ((c->clk_ctrl >> CLK_CTRL_PS_SHIFT) & CLK_CTRL_PS_MASK);
+	}
+	return 1;
+}
+
+static int enabled(const struct ttc_model_counter *c)
+{
+	return !(c->cnt_ctrl & CNT_CTRL_DIS);
+}
+
+/* Where the count wraps, past the interval it runs on to overflow */
+static uint32_t top(const struct ttc_model_counter *c)
+{
+	if ( ( c->cnt_ctrl & CNT_CTRL_INT ) && ( c->count <= c->interval ) ) {
+		return c->interval;
+	}
+	return COUNT_MAX;
+}
+
+/* Level from the start of a period until match 1 */
+static uint32_t initial_level(const struct ttc_model_counter *c)
+{
+	return ( c->cnt_ctrl & CNT_CTRL_WAVE_POL ) ? 1 : 0;
+}
+
+/* Counts until the next match or wrap */
+static uint32_t counts_to_event(const struct ttc_model_counter *c)
+{
+	uint32_t t = top(c);
+	uint32_t k = t - c->count + 1;
+	uint32_t i = 0;
+
+	if ( c->cnt_ctrl & CNT_CTRL_MATCH ) {
+		for (i = 0; i < 3; i++) {
+			/* A match at 0 comes with the wrap */
+			if ( ( c->match[i] > c->count ) && ( c->match[i] <= t ) && ( c->match[i] - c->count < k ) ) {
+				k = c->match[i] - c->count;
+			}
+		}
+	}
+	return k;
+}
+
+static void set_wave(struct ttc_model *model, uint32_t index, uint32_t level)
+{
+	struct ttc_model_counter *c = &model->counters[index];
+
+	if ( c->wave != level ) {
+		c->wave = level;
+		if ( !(c->cnt_ctrl & CNT_CTRL_WAVE_DIS) && ( model->edge != NULL ) ) {
+			model->edge(model->arg, index, model->now, level);
+		}
+	}
+	return;
+}
+
+/* Brings count and origin up to now, which no event lies before */
+static void sync(struct ttc_model *model, struct ttc_model_counter *c)
+{
+	uint64_t counts = 0;
+
+	if ( enabled(c) ) {
+		counts = (model->now - c->origin) / prescale(c);
+		c->count += counts;
+		c->origin += counts * prescale(c);
+	}
+	return;
+}
+
+/* The counter's next event, which is due at model->now */
+static void process(struct ttc_model *model, uint32_t index)
+{
+	struct ttc_model_counter *c = &model->counters[index];
+	uint32_t t = top(c);
+	uint32_t k = counts_to_event(c);
+	uint32_t flags = 0;
+	uint32_t i = 0;
+
+	c->origin += (uint64_t) k * prescale(c);
+	if ( c->count + k > t ) {
+		c->count = 0;
+		flags |= ( ( c->cnt_ctrl & CNT_CTRL_INT ) && ( t == c->interval ) ) ? TTC_MODEL_IXR_INTERVAL :
+				TTC_MODEL_IXR_OVERFLOW;
+		set_wave(model, index, initial_level(c));
+	} else {
+		c->count += k;
+	}
+	if ( c->cnt_ctrl & CNT_CTRL_MATCH ) {
+		for (i = 0; i < 3; i++) {
+			if ( c->count == c->match[i] ) {
+				flags |= TTC_MODEL_IXR_MATCH_1 << i;
+			}
+		}
+		if ( c->count == c->match[0] ) {
+			set_wave(model, index, !initial_level(c));
+		}
+	}
+	c->isr |= flags;
+	/* Another event before the handler runs joins the interrupt already pending */
+	if ( ( flags & c->ier ) && ( model->irq != NULL ) && ( c->irq_due == UINT64_MAX ) ) {
+		c->irq_due = model->now + model->irq_latency;
+	}
+	return;
+}
+
+void ttc_model_init(struct ttc_model *model)
+{
+	struct ttc_model_counter *c = NULL;
+	uint32_t i = 0;
+
+	model->now = 0;
+	model->irq_latency = 0;
+	for (i = 0; i < TTC_MODEL_COUNTERS; i++) {
+		c = &model->counters[i];
+		c->clk_ctrl = 0;
+		c->cnt_ctrl = CNT_CTRL_DIS | CNT_CTRL_WAVE_DIS;
+		c->count = 0;
+		c->interval = 0;
+		c->match[0] = 0;
+		c->match[1] = 0;
+		c->match[2] = 0;
+		c->isr = 0;
+		c->ier = 0;
+		c->wave = 0;
+		c->origin = 0;
+		c->irq_due = UINT64_MAX;
+	}
+	return;
+}
+
+uint32_t ttc_model_read(void *ctx, uint32_t counter, uint32_t offset)
+{
+	struct ttc_model *model = ctx;
+	struct ttc_model_counter *c = NULL;
+	uint32_t val = 0;
+
+	if ( counter >= TTC_MODEL_COUNTERS ) {
+		return 0;
+	}
+	c = &model->counters[counter];
+	switch ( offset ) {
+	case TTC_MODEL_CLK_CTRL:
+		val = c->clk_ctrl;
+		break;
+	case TTC_MODEL_CNT_CTRL:
+		val = c->cnt_ctrl;
+		break;
+	case TTC_MODEL_COUNTER:
+		val = c->count;
+		if ( enabled(c) ) {
+			val += (model->now - c->origin) / prescale(c);
+		}
+		break;
+	case TTC_MODEL_INTERVAL:
+		val = c->interval;
+		break;
+	case TTC_MODEL_MATCH_1:
+	case TTC_MODEL_MATCH_2:
+	case TTC_MODEL_MATCH_3:
+		val = c->match[(offset - TTC_MODEL_MATCH_1) / (TTC_MODEL_MATCH_2 - TTC_MODEL_MATCH_1)];
+		break;
+	case TTC_MODEL_ISR:
+		val = c->isr;
+		c->isr = 0;
+		break;
+	case TTC_MODEL_IER:
+		val = c->ier;
+		break;
+	default:
+		break;
+	}
+	return val;
+}
+
+void ttc_model_write(void *ctx, uint32_t counter, uint32_t offset, uint32_t val)
+{
+	struct ttc_model *model = ctx;
+	struct ttc_model_counter *c = NULL;
+	int was_enabled = 0;
+
+	if ( counter >= TTC_MODEL_COUNTERS ) {
+		return;
+	}
+	c = &model->counters[counter];
+	sync(model, c);
+	switch ( offset ) {
+	case TTC_MODEL_CLK_CTRL:
+		c->clk_ctrl = val & 0x7F;
+		/* The prescaler starts over */
+		c->origin = model->now;
+		break;
+	case TTC_MODEL_CNT_CTRL:
+		was_enabled = enabled(c);
+		/* Reset clears itself */
+		c->cnt_ctrl = val & 0x7F & ~CNT_CTRL_RST;
+		if ( val & CNT_CTRL_RST ) {
+			c->count = 0;
+			c->origin = model->now;
+			set_wave(model, counter, initial_level(c));
+		} else if ( !was_enabled && enabled(c) ) {
+			c->origin = model->now;
+		}
+		break;
+	case TTC_MODEL_INTERVAL:
+		c->interval = val & COUNT_MAX;
+		break;
+	case TTC_MODEL_MATCH_1:
+	case TTC_MODEL_MATCH_2:
+	case TTC_MODEL_MATCH_3:
+		c->match[(offset - TTC_MODEL_MATCH_1) / (TTC_MODEL_MATCH_2 - TTC_MODEL_MATCH_1)] = val & COUNT_MAX;
+		break;
+	case TTC_MODEL_IER:
+		c->ier = val & 0x3F;
+		break;
+	default:
+		/* The counter and interrupt status are read only */
+		break;
+	}
+	return;
+}
+
+void ttc_model_run(struct ttc_model *model, uint64_t ticks)
+{
+	struct ttc_model_counter *c = NULL;
+	uint64_t end = model->now + ticks;
+	uint64_t next = 0;
+	uint64_t next_irq = 0;
+	uint64_t due = 0;
+	uint32_t index = 0;
+	uint32_t index_irq = 0;
+	uint32_t i = 0;
+
+	for (;;) {
+		next = UINT64_MAX;
+		next_irq = UINT64_MAX;
+		for (i = 0; i < TTC_MODEL_COUNTERS; i++) {
+			c = &model->counters[i];
+			if ( c->irq_due < next_irq ) {
+				next_irq = c->irq_due;
+				index_irq = i;
+			}
+			if ( !enabled(c) ) {
+				continue;
+			}
+			due = c->origin + (uint64_t) counts_to_event(c) * prescale(c);
+			if ( due < next ) {
+				next = due;
+				index = i;
+			}
+		}
+		/* Counter events at a tick go before handlers, so a handler sees what they did */
+		if ( ( next_irq < next ) && ( next_irq <= end ) ) {
+			model->now = next_irq;
+			model->counters[index_irq].irq_due = UINT64_MAX;
+			model->irq(model->arg, index_irq);
+		} else if ( next <= end ) {
+			model->now = next;
+			process(model, index);
+		} else {
+			break;
+		}
+	}
+	model->now = end;
+	return;
+}
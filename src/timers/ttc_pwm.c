@@ -18,6 +18,8 @@
 /* Debug and workaround codes */
 #include "ttc_dbg.h"
 #include "ps7_dbg.h"
+#include "dev_pool.h"
+#include "console_uartps.h"
 
 /* Necessary for creating driver instances */
 #define GIC_DEVICE_ID				XPAR_SCUGIC_SINGLE_DEVICE_ID
@@ -38,19 +40,18 @@ static uint32_t calls = 0;
 
 void clear_console()
 {
-        fprintf(stdout, "%c[2J", ASCII_ESC);
-        fflush(stdout);
-
+        console_printf(&console_uart, "%c[2J", ASCII_ESC);
+        return;
 }
 void print_operation(char *str)
 {
-        fprintf(stdout, "%-50s", str);
-        fflush(stdout);
+        console_printf(&console_uart, "%-50s", str);
+        return;
 }
 void print_result(char *str)
 {
-        fprintf(stdout, "%10s\n", str);
-        fflush(stdout);
+        console_printf(&console_uart, "%10s\n", str);
+        return;
 }
 
 /* Creates and registers a GIC instance with the Cortex-A9 exception handler */
@@ -208,7 +209,6 @@ static void ttc_intr_handler(void *callback_ref)
 		fprintf(stdout, "Received interrupt - calls = %"PRId32"\n", calls++);
 		#endif // TTC_DEBUG
 	}
-	fflush(stdout);
 	return;
 }
 
@@ -220,10 +220,12 @@ int main(int args, char *argv[])
 	XTtcPs *ttc = NULL;
 	XTtcPs_Config *ttc_config = NULL;
 
-	gic = malloc(sizeof(XScuGic));
-	ttc = malloc(sizeof(XTtcPs));
+	gic = dev_pool_gic(GIC_DEVICE_ID);
+	ttc = dev_pool_ttc(TTC_DEVICE_ID);
 
 	init_platform();
+	/* A dot per interrupt is not worth waiting for, so output that does not fit is dropped */
+	console_uartps_init(CONSOLE_DROP);
 
 	clear_console();
 
@@ -242,6 +244,8 @@ int main(int args, char *argv[])
 
 	/* Connect an interrupt handler for the IRQ ID of the chosen timer */
 	XScuGic_Connect(gic, TTC0_IRQ_ID, (Xil_InterruptHandler) ttc_intr_handler, (void *) ttc);
+	/* From here on console output is drained by the UART interrupt */
+	console_uartps_start(gic);
 	/* Enable interrupt exceptions in the processor */
 	Xil_ExceptionEnable();
 	/* Enable interrupts at the GIC */
@@ -258,6 +262,7 @@ int main(int args, char *argv[])
 	ttc_dbg_print_summary(0, 0);
 	*/
 
+	dev_pool_report();
 	printf("Starting");
 	XTtcPs_Start(ttc);
 	for (;;) {
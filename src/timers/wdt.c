@@ -15,6 +15,7 @@
 /* Subsystem drivers */
 #include "xscugic.h"
 #include "xscuwdt.h"
+#include "xscutimer.h"
 #include "xgpiops.h"
 
 /* Low level Xilinx IO */
@@ -23,6 +24,7 @@
 #define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
 #define WDT_DEVICE_ID			XPAR_SCUWDT_0_DEVICE_ID
 #define GPIOPS_DEVICE_ID		XPAR_XGPIOPS_0_DEVICE_ID
+#define TIMER_DEVICE_ID			XPAR_XSCUTIMER_0_DEVICE_ID
 
 /* Interrupt ID from xparameters_ps.h - recall that GPIO is a shared peripheral
  * interrupt and that private WDT are private peripheral interrupts (i.e., there
@@ -31,8 +33,27 @@
 #define GPIO_INTR_ID			XPS_GPIO_INT_ID
 #define WDT_INTR_ID				XPS_SCU_WDT_INT_ID
 
+/* Switch is sampled every 1ms and has to agree with itself 20 times in a row */
+#define GPIO_DEBOUNCE_PERIOD_US	1000
+#define GPIO_DEBOUNCE_SAMPLES	20
+
+/*
+ * The watchdog is only fed while the main loop keeps running and the push button
+ * keeps being pressed. The supervisor looks every 100ms, and once either misses
+ * its deadline the 5 second watchdog timeout runs out.
+ */
+#define WDT_TIMEOUT_SEC			5
+#define SUPERVISOR_PERIOD_MS	100
+#define MAIN_LOOP_DEADLINE_MS	1000
+#define PBSW_DEADLINE_MS		10000
+
+/* Most deferred work items run per pass of the main loop */
+#define DEFERRED_BUDGET			4
+
+/* Timer number the supervisor period shows up as in the flight recorder */
+#define SUPERVISOR_TIMER		0
+
 /* Other useful constants */
-#define GPIO_DEBOUNCE_TIME		100000
 #define ASCII_ESC				27
 
 /* Per the schematic, PS MIO 51 is pulled down to ground through a 5k resistor
@@ -42,6 +63,7 @@
 #define GPIO_UZED_PBSW			51
 #define GPIO_INPUT				0
 #define GPIO_OUTPUT				1
+#define GPIO_PBSW_ON			1
 
 #define SLCR_BASE_ADDR      0xF8000000
 #define CLK_621_TRUE        0x000001C4
@@ -50,15 +72,36 @@
 #define CLK_300_NS          3.333
 
 #include "wdt_dbg.h"
+#include "debounce.h"
+#include "debounce_gpiops.h"
+#include "gtimer.h"
+#include "xtime_l.h"
+#include "wdt_supervisor.h"
+#include "flight_rec.h"
+#include "flight_rec_zynq.h"
+#include "dev_pool.h"
+#include "deferred.h"
 
 /*
- * GPIO PS interrupt handler needs to be able to interact with the WDT. So in addition
- * to the GPIO PS instance, which is necessary to clear the interrupt (and debounce the
- * push button) we need to bundle the WDT instance as well.
+ * GPIO PS interrupt handler needs to be able to check in with the watchdog supervisor.
+ * So in addition to the GPIO PS instance, which is necessary to clear the interrupt (and
+ * debounce the push button) we need to bundle the supervisor and our client ID as well.
+ * The handler only counts what happened, the reporting is deferred work run from the
+ * main loop.
  */
 struct GpioPs_Wdt_Intr_CallbackRef {
 	XGpioPs *GpioPs;
-	XScuWdt *Wdt;
+	struct wdt_supervisor *Supervisor;
+	int SupervisorId;
+	struct debounce *Debounce;
+	struct deferred *Deferred;
+	struct deferred_work Report;
+	volatile uint32_t Interrupts;
+	volatile uint32_t Checkins;
+	volatile uint32_t Spurious;
+	/* Deferred side - counts already reported */
+	uint32_t Reported;
+	uint32_t ReportedSpurious;
 };
 
 /*
@@ -104,10 +147,11 @@ int SetupIntrSystem(XScuGic *Gic, XScuGic_Config *GicConfig)
 	 * NOTE: A future example should register an IRQ and an FIQ interrupt handler and try
 	 * enabling and handling multiple interrupt sources.
 	 */
+	/* Goes through the GIC handler, logging every interrupt to the flight recorder */
 	fprintf(stdout, "Register GIC with CPU exception handler\t\t");
 	Xil_ExceptionRegisterHandler(
 			XIL_EXCEPTION_ID_IRQ_INT,
-			(Xil_ExceptionHandler) XScuGic_InterruptHandler,
+			(Xil_ExceptionHandler) flight_rec_zynq_irq_handler,
 			(void *) Gic);
 
 	Xil_GetExceptionRegisterHandler(
@@ -115,7 +159,7 @@ int SetupIntrSystem(XScuGic *Gic, XScuGic_Config *GicConfig)
 			&CheckHandler,
 			&CheckData);
 
-	if ( ( CheckData != Gic ) || ( CheckHandler != (Xil_ExceptionHandler) XScuGic_InterruptHandler ) ) {
+	if ( ( CheckData != Gic ) || ( CheckHandler != (Xil_ExceptionHandler) flight_rec_zynq_irq_handler ) ) {
 		fprintf(stdout, "FAIL\n");
 		Ret = XST_FAILURE;
 	} else {
@@ -345,33 +389,65 @@ void ConfigWdtTimeout(XScuWdt *Wdt, uint32_t Seconds)
 	}
 }
 
-void MemFree(void *Ptr)
+/* Only ever called by the supervisor, once every client is known to be alive */
+static void WdtKick(void *Ref)
+{
+	XScuWdt_RestartWdt((XScuWdt *) Ref);
+}
+
+static uint32_t MsToTicks(uint32_t Ms)
+{
+	return (COUNTS_PER_SECOND / 1000) * Ms;
+}
+
+/* Global timer low word, the clock for deferred work latencies */
+static uint32_t DeferredClock(void)
+{
+	return gtimer_read_lo();
+}
+
+/*
+ * Deferred work queued by the GPIO PS handler. Several interrupts may have come in since
+ * it was queued, so it reports the counts rather than a single event.
+ */
+static void GpioPs_Report(void *Arg)
 {
-	if (Ptr != NULL) {
-		free(Ptr);
+	struct GpioPs_Wdt_Intr_CallbackRef *Ref = Arg;
+	uint32_t Interrupts = Ref->Interrupts;
+	uint32_t Spurious = Ref->Spurious;
+
+	if ( Interrupts != Ref->Reported ) {
+		fprintf(stdout, "Received GPIO PS interrupt %"PRIu32"\n", Interrupts);
+		fprintf(stdout, "Checked in with watchdog supervisor %"PRIu32" times\n", Ref->Checkins);
+		Ref->Reported = Interrupts;
+	}
+	if ( Spurious != Ref->ReportedSpurious ) {
+		fprintf(stderr, "Received %"PRIu32" spurious GPIO PS interrupts\n",
+				Spurious - Ref->ReportedSpurious);
+		Ref->ReportedSpurious = Spurious;
 	}
 }
 
+/*
+ * Called by XGpioPs_IntrHandler(), which has already cleared the bank status, so the
+ * pending pins are only known from Status. Debouncing is left to the private timer
+ * rather than sleeping in here, and printing is left to the main loop.
+ */
 static void GpioPs_IntrHandler(void *CallbackRef, uint32_t Bank, uint32_t Status)
 {
-	static int count = 0;
-	XGpioPs *GpioPs = ((struct GpioPs_Wdt_Intr_CallbackRef *) CallbackRef)->GpioPs;
-	XScuWdt *Wdt = ((struct GpioPs_Wdt_Intr_CallbackRef *) CallbackRef)->Wdt;
-
-	fprintf(stdout, "Received GPIO PS interrupt %d\n", ++count);
-	if ( XGpioPs_IntrGetStatusPin(GpioPs, GPIO_UZED_PBSW) ) {
-		fprintf(stdout, "Restarting watchdog timer\n");
-		fflush(stdout);
-		XScuWdt_RestartWdt(Wdt);
-		usleep(GPIO_DEBOUNCE_TIME);
-		XGpioPs_IntrClearPin(GpioPs, GPIO_UZED_PBSW);
+	struct GpioPs_Wdt_Intr_CallbackRef *Ref = CallbackRef;
+
+	Ref->Interrupts++;
+	if ( debounce_gpiops_edges(Ref->Debounce, Bank, Status) != 0 ) {
+		wdt_supervisor_checkin(Ref->Supervisor, Ref->SupervisorId);
+		flight_rec_log(FLIGHT_REC_WDT_CHECKIN, Ref->SupervisorId);
+		Ref->Checkins++;
 	} else {
-		fprintf(stderr, "Received spurious GPIO PS interrupt\n");
-		fflush(stderr);
+		Ref->Spurious++;
 	}
+	deferred_queue(Ref->Deferred, &Ref->Report);
 }
 
-
 int main()
 {
 	init_platform();
@@ -383,62 +459,65 @@ int main()
 	XScuWdt *Wdt = NULL;
 	XGpioPs_Config *GpioPsConfig = NULL;
 	XGpioPs *GpioPs = NULL;
+	XScuTimer *Timer = NULL;
+
+	/* Push button debouncing */
+	static struct debounce Debounce;
+	struct debounce_event Event;
+	int Presses = 0;
+
+	/* Watchdog is fed by the supervisor rather than directly */
+	static struct wdt_supervisor Supervisor;
+	int MainLoopId = WDT_SUPERVISOR_NONE;
+	uint32_t LastCheck = 0;
+	uint32_t Now = 0;
+	int Reported = 0;
+
+	/* Work queued by interrupt handlers, run from the main loop */
+	static struct deferred Deferred;
+
+	/* Handed to the GPIO driver for its callback */
+	static struct GpioPs_Wdt_Intr_CallbackRef GpioPs_CallbackRef;
 
 	printf("%c[2J", ASCII_ESC);
 	printf("Private Watchdog Examples\n");
 	printf("-------------------------\n");
 
-	Gic = malloc(sizeof(XScuGic));
-	if (Gic == NULL) {
-		fprintf(stderr, "Could not allocate memory for GIC driver instance\n");
-		return -1;
-	}
+	Gic = dev_pool_gic(GIC_DEVICE_ID);
 	if (SetupIntrSystem(Gic, GicConfig) != XST_SUCCESS) {
 		fprintf(stderr, "Could not initialize exception or interrupt handling\n");
-		MemFree(Gic);
 		return -1;
 	}
 
-	Wdt = malloc(sizeof(XScuWdt));
-	if (Wdt == NULL) {
-		fprintf(stderr, "Could not allocate memory for private watchdog driver instance\n");
-		MemFree(Gic);
-		return -1;
-	}
+	Wdt = dev_pool_scuwdt(WDT_DEVICE_ID);
 	if (SetupWdtSystem(Wdt, WdtConfig) != XST_SUCCESS) {
 		fprintf(stderr, "Could not initialize private watchdog timer\n");
-		MemFree(Wdt);
-		MemFree(Gic);
 		return -1;
 	}
 
-	GpioPs = malloc(sizeof(XGpioPs));
-	if (GpioPs == NULL) {
-		fprintf(stderr, "Could not allocate memory for GPIO driver instance\n");
-		MemFree(Wdt);
-		MemFree(Gic);
-		return -1;
+	/* Has to come before anything else touches the reset status */
+	if (flight_rec_zynq_boot(Wdt)) {
+		fprintf(stdout, "Decode the above with examples/flight_rec_decode\n");
 	}
+
+	GpioPs = dev_pool_gpiops(GPIOPS_DEVICE_ID);
 	if (SetupGpioPsSystem(GpioPs, GpioPsConfig) != XST_SUCCESS) {
 		fprintf(stderr, "Could not initialize GPIO\n");
-		MemFree(GpioPs);
-		MemFree(Wdt);
-		MemFree(Gic);
 		return -1;
 	}
 
-	struct GpioPs_Wdt_Intr_CallbackRef *GpioPs_CallbackRef;
-	GpioPs_CallbackRef = malloc(sizeof(GpioPs_CallbackRef));
-	if (GpioPs_CallbackRef == NULL) {
-		fprintf(stderr, "Could not allocate memory for GPIO PS callback reference\n");
-		MemFree(Wdt);
-		MemFree(Gic);
-		return -1;
-	} else {
-		GpioPs_CallbackRef->Wdt = Wdt;
-		GpioPs_CallbackRef->GpioPs = GpioPs;
-	}
+	GpioPs_CallbackRef.Supervisor = &Supervisor;
+	GpioPs_CallbackRef.SupervisorId = WDT_SUPERVISOR_NONE;
+	GpioPs_CallbackRef.GpioPs = GpioPs;
+	GpioPs_CallbackRef.Debounce = &Debounce;
+	GpioPs_CallbackRef.Deferred = &Deferred;
+	deferred_init(&Deferred, DeferredClock);
+	deferred_work_init(&GpioPs_CallbackRef.Report, "gpio report", GpioPs_Report,
+			(void *) &GpioPs_CallbackRef, DEFERRED_PRIO_NORMAL);
 
+	Timer = dev_pool_scutimer(TIMER_DEVICE_ID);
+	dev_pool_report();
+	fprintf(stdout, "\n");
 
 	/*
 	 * Remaining:
@@ -458,18 +537,35 @@ int main()
 
 	/* Configure GPIO pushbutton as an input and capable of generating interrupts */
 	ConfigGpioPsPin(GpioPs, GPIO_UZED_PBSW, GPIO_INPUT);
-	ConfigGpioPsIntr(GpioPs, GPIO_UZED_PBSW, XGPIOPS_IRQ_TYPE_EDGE_RISING);
+	ConfigGpioPsIntr(GpioPs, GPIO_UZED_PBSW, XGPIOPS_IRQ_TYPE_EDGE_BOTH);
+
+	/* Releases are debounced too, so that a press is only reported once */
+	debounce_init(&Debounce, &debounce_gpiops_ops, (void *) GpioPs);
+	debounce_add_pin(&Debounce, GPIO_UZED_PBSW, GPIO_PBSW_ON, GPIO_DEBOUNCE_SAMPLES);
+	if (debounce_gpiops_tick_init(&Debounce, Gic, Timer, GPIO_DEBOUNCE_PERIOD_US) != XST_SUCCESS) {
+		fprintf(stderr, "Could not start push button debounce timer\n");
+	}
 
 	/*
-	 * Connect the GPIO interrupt handler (which is called when GPIO interrupts need to be serviced)
-	 * to the GIC interrupt handler. Need to couple the GPIO interrupt handler with the watchdog
-	 * timer instance as well so that the interrupt handler can restart the watchdog (this is the
-	 * magic step that I've not seen an example of how to do, so I'm sort of making this up as I go).
+	 * Connect the GPIO driver interrupt handler (which is called when GPIO interrupts need to be
+	 * serviced) to the GIC interrupt handler, and then hand our own callback to the GPIO driver.
+	 * Need to couple the GPIO callback with the watchdog timer instance as well so that it can
+	 * restart the watchdog (this is the magic step that I've not seen an example of how to do, so
+	 * I'm sort of making this up as I go).
 	 */
-	XScuGic_Connect(Gic, GPIO_INTR_ID, (Xil_ExceptionHandler) GpioPs_IntrHandler, (void *) GpioPs_CallbackRef);
+	XScuGic_Connect(Gic, GPIO_INTR_ID, (Xil_ExceptionHandler) XGpioPs_IntrHandler, (void *) GpioPs);
+	XGpioPs_SetCallbackHandler(GpioPs, (void *) &GpioPs_CallbackRef, (XGpioPs_Handler) GpioPs_IntrHandler);
 
 	/* Configure watchdog timer for interrupt duration */
-	ConfigWdtTimeout(Wdt, 5);
+	ConfigWdtTimeout(Wdt, WDT_TIMEOUT_SEC);
+
+	/* Register everything that has to stay alive before anything can check in */
+	Now = gtimer_read_lo();
+	wdt_supervisor_init(&Supervisor, WdtKick, (void *) Wdt);
+	MainLoopId = wdt_supervisor_register(&Supervisor, "main loop", MsToTicks(MAIN_LOOP_DEADLINE_MS), Now);
+	GpioPs_CallbackRef.SupervisorId = wdt_supervisor_register(&Supervisor, "push button",
+			MsToTicks(PBSW_DEADLINE_MS), Now);
+	LastCheck = Now;
 
 	/* Enable GPIO interrupts at the GPIO device */
 	XGpioPs_IntrEnablePin(GpioPs, GPIO_UZED_PBSW);
@@ -483,8 +579,31 @@ int main()
 	/* Enable the watchdog timer to actually start counting down */
 	XScuWdt_Start(Wdt);
 
-	/* Loop indefinitely */
-	for (;;);
+	/* Loop indefinitely, reporting debounced presses and running the supervisor */
+	for (;;) {
+		wdt_supervisor_checkin(&Supervisor, MainLoopId);
+		deferred_run(&Deferred, DEFERRED_BUDGET);
+		if ( debounce_get_event(&Debounce, &Event) && ( Event.type == DEBOUNCE_PRESS ) ) {
+			fprintf(stdout, "Push button pressed %d\n", ++Presses);
+		}
+
+		Now = gtimer_read_lo();
+		if ( ( Now - LastCheck ) < MsToTicks(SUPERVISOR_PERIOD_MS) ) {
+			continue;
+		}
+		LastCheck = Now;
+		flight_rec_log(FLIGHT_REC_TIMER, SUPERVISOR_TIMER);
+		if ( wdt_supervisor_check(&Supervisor, Now) == 0 ) {
+			flight_rec_log(FLIGHT_REC_WDT_KICK, Supervisor.kicks);
+		} else if ( !Reported ) {
+			Reported = 1;
+			flight_rec_log(FLIGHT_REC_WDT_LATE, Supervisor.late);
+			fprintf(stdout, "Watchdog supervisor stopped feeding the watchdog\n");
+			wdt_supervisor_print(&Supervisor, Now);
+			fprintf(stdout, "\n");
+			deferred_print_stats(&Deferred);
+		}
+	}
 
 	cleanup_platform();
 	return 0;
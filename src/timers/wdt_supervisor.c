@@ -0,0 +1,108 @@
+/*
+ * Watchdog supervisor - feed the hardware watchdog only while every registered
+ * activity is alive
+ *
+ * Each client (a task, an interrupt handler, a main loop) gets a counter that
+ * only it increments, so checking in is a load, an add and a store with no lock
+ * and no atomics. The supervisor is the only reader. It remembers the count it
+ * last saw for each client and the time it last changed, and a client whose
+ * count has not moved for longer than its deadline is late.
+ *
+ * The first late client is recorded and from then on the watchdog is never fed
+ * again, even if the client recovers. A missed deadline is a fault, and the
+ * reset that follows is the recovery.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "wdt_supervisor.h"
+
+void wdt_supervisor_init(struct wdt_supervisor *sup, void (*kick)(void *ctx), void *ctx)
+{
+	sup->num_clients = 0;
+	sup->kick = kick;
+	sup->ctx = ctx;
+	sup->kicks = 0;
+	sup->late = WDT_SUPERVISOR_NONE;
+	sup->late_time = 0;
+	sup->late_overdue = 0;
+	return;
+}
+
+int wdt_supervisor_register(struct wdt_supervisor *sup, const char *name, uint32_t deadline,
+		uint32_t now)
+{
+	struct wdt_supervisor_client *client = NULL;
+
+	if ( ( sup->num_clients >= WDT_SUPERVISOR_MAX_CLIENTS ) || ( deadline == 0 ) ) {
+		return WDT_SUPERVISOR_NONE;
+	}
+	client = &sup->clients[sup->num_clients];
+	client->name = name;
+	client->deadline = deadline;
+	client->checkins = 0;
+	client->seen = 0;
+	/* Registering counts as the first check-in */
+	client->last_progress = now;
+	return sup->num_clients++;
+}
+
+int wdt_supervisor_check(struct wdt_supervisor *sup, uint32_t now)
+{
+	struct wdt_supervisor_client *client = NULL;
+	uint32_t checkins = 0;
+	uint32_t idle = 0;
+	uint32_t i = 0;
+	int healthy = 1;
+
+	if ( sup->late != WDT_SUPERVISOR_NONE ) {
+		return -1;
+	}
+	for (i = 0; i < sup->num_clients; i++) {
+		client = &sup->clients[i];
+		checkins = client->checkins;
+		if ( checkins != client->seen ) {
+			client->seen = checkins;
+			client->last_progress = now;
+			continue;
+		}
+		idle = now - client->last_progress;
+		if ( idle > client->deadline ) {
+			/* Keep going so the other clients' progress is still tracked */
+			if ( healthy ) {
+				sup->late = i;
+				sup->late_time = now;
+				sup->late_overdue = idle - client->deadline;
+			}
+			healthy = 0;
+		}
+	}
+	if ( !healthy ) {
+		return -1;
+	}
+	sup->kick(sup->ctx);
+	sup->kicks++;
+	return 0;
+}
+
+void wdt_supervisor_print(const struct wdt_supervisor *sup, uint32_t now)
+{
+	const struct wdt_supervisor_client *client = NULL;
+	uint32_t i = 0;
+
+	printf("%-20s%-12s%-12s%-12s\n", "Client", "Deadline", "Check-ins", "Idle");
+	for (i = 0; i < sup->num_clients; i++) {
+		client = &sup->clients[i];
+		printf("%-20s%-12"PRIu32"%-12"PRIu32"%-12"PRIu32"\n", client->name, client->deadline,
+				client->checkins, now - client->last_progress);
+	}
+	printf("%-20s%"PRIu32"\n", "Watchdog kicks", sup->kicks);
+	if ( sup->late != WDT_SUPERVISOR_NONE ) {
+		printf("%-20s%s, %"PRIu32" over its deadline\n", "First late",
+				sup->clients[sup->late].name, sup->late_overdue);
+	}
+	return;
+}
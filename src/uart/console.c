@@ -0,0 +1,223 @@
+/*
+ * Buffered, interrupt-driven console output, see console.h
+ *
+ * The ring has one index for each side: head is moved by writers, under the
+ * lock, and tail by whoever feeds the FIFO, which is the interrupt handler or
+ * a writer under the lock. tx_active says the interrupt is enabled and will
+ * come back for the rest, so a writer only has to prime the FIFO itself when
+ * it is not.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "console.h"
+
+#define RING_MASK			(CONSOLE_BUF_LEN - 1)
+
+/* Everything below that touches the ring is called with the lock held or from the interrupt */
+static void fill_fifo(struct console *con)
+{
+	while ( ( con->tail != con->head ) && !con->ops->tx_full(con->ctx) ) {
+		con->ops->tx_put(con->ctx, con->buf[con->tail & RING_MASK]);
+		con->tail++;
+	}
+	return;
+}
+
+static void kick(struct console *con)
+{
+	if ( con->tx_active ) {
+		return;
+	}
+	fill_fifo(con);
+	if ( con->tail != con->head ) {
+		con->tx_active = 1;
+		con->ops->tx_irq(con->ctx, 1);
+	}
+	return;
+}
+
+/* For when the interrupt cannot run: empties the ring by waiting on the FIFO */
+static void drain_polled(struct console *con)
+{
+	while ( con->tail != con->head ) {
+		while ( con->ops->tx_full(con->ctx) ) {
+		}
+		con->ops->tx_put(con->ctx, con->buf[con->tail & RING_MASK]);
+		con->tail++;
+	}
+	return;
+}
+
+static void put_polled(struct console *con, const uint8_t *p, size_t len)
+{
+	size_t i = 0;
+
+	for (i = 0; i < len; i++) {
+		while ( con->ops->tx_full(con->ctx) ) {
+		}
+		con->ops->tx_put(con->ctx, p[i]);
+	}
+	return;
+}
+
+static size_t ring_put(struct console *con, const uint8_t *p, size_t len)
+{
+	uint32_t room = CONSOLE_BUF_LEN - (con->head - con->tail);
+	uint32_t start = con->head & RING_MASK;
+	size_t first = 0;
+
+	if ( len > room ) {
+		len = room;
+	}
+	/* Up to the end of the buffer, then whatever wraps around to the start */
+	first = ( len < CONSOLE_BUF_LEN - start ) ? len : CONSOLE_BUF_LEN - start;
+	memcpy(&con->buf[start], p, first);
+	memcpy(con->buf, p + first, len - first);
+	con->head += len;
+	if ( con->head - con->tail > con->stats.high_water ) {
+		con->stats.high_water = con->head - con->tail;
+	}
+	return len;
+}
+
+void console_init(struct console *con, const struct console_ops *ops, void *ctx, uint32_t policy)
+{
+	memset(con, 0, sizeof(*con));
+	con->ops = ops;
+	con->ctx = ctx;
+	con->policy = policy;
+	return;
+}
+
+void console_start(struct console *con)
+{
+	con->started = 1;
+	return;
+}
+
+size_t console_write(struct console *con, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+	uint32_t state = 0;
+	uint32_t waited = 0;
+	size_t done = 0;
+
+	if ( !con->started || con->panicked ) {
+		state = con->ops->lock(con->ctx);
+		put_polled(con, p, len);
+		con->stats.written += len;
+		con->ops->unlock(con->ctx, state);
+		return len;
+	}
+
+	for (;;) {
+		state = con->ops->lock(con->ctx);
+		done += ring_put(con, p + done, len - done);
+		kick(con);
+		if ( done == len ) {
+			break;
+		}
+		if ( con->policy == CONSOLE_DROP ) {
+			con->stats.dropped += len - done;
+			break;
+		}
+		if ( state != 0 ) {
+			/* Called with interrupts masked, so the handler is not going to make room */
+			con->stats.polled++;
+			drain_polled(con);
+			con->ops->unlock(con->ctx, state);
+			continue;
+		}
+		if ( !waited ) {
+			con->stats.blocked++;
+			waited = 1;
+		}
+		con->ops->unlock(con->ctx, state);
+		while ( con->head - con->tail == CONSOLE_BUF_LEN ) {
+		}
+	}
+	con->stats.written += done;
+	con->ops->unlock(con->ctx, state);
+	return done;
+}
+
+/* Terminals want CR LF, as the BSP's stdout sends */
+int console_printf(struct console *con, const char *fmt, ...)
+{
+	char line[CONSOLE_LINE_LEN];
+	va_list args;
+	int len = 0;
+	int start = 0;
+	int i = 0;
+
+	va_start(args, fmt);
+	len = vsnprintf(line, sizeof(line), fmt, args);
+	va_end(args);
+	if ( len < 0 ) {
+		return len;
+	}
+	if ( len >= (int) sizeof(line) ) {
+		len = sizeof(line) - 1;
+	}
+	for (i = 0; i < len; i++) {
+		if ( line[i] == '\n' ) {
+			console_write(con, &line[start], i - start);
+			console_write(con, "\r\n", 2);
+			start = i + 1;
+		}
+	}
+	console_write(con, &line[start], len - start);
+	return len;
+}
+
+void console_flush(struct console *con)
+{
+	uint32_t state = 0;
+
+	if ( con->started && !con->panicked ) {
+		state = con->ops->lock(con->ctx);
+		if ( state != 0 ) {
+			drain_polled(con);
+		}
+		con->ops->unlock(con->ctx, state);
+		while ( con->tail != con->head ) {
+		}
+	}
+	while ( !con->ops->tx_idle(con->ctx) ) {
+	}
+	return;
+}
+
+void console_panic(struct console *con)
+{
+	/* Never unlocked, nothing is going to run after this but more output */
+	(void) con->ops->lock(con->ctx);
+	con->panicked = 1;
+	con->ops->tx_irq(con->ctx, 0);
+	con->tx_active = 0;
+	drain_polled(con);
+	while ( !con->ops->tx_idle(con->ctx) ) {
+	}
+	return;
+}
+
+void console_tx_isr(struct console *con)
+{
+	con->stats.irqs++;
+	fill_fifo(con);
+	if ( con->tail == con->head ) {
+		con->tx_active = 0;
+		con->ops->tx_irq(con->ctx, 0);
+	}
+	return;
+}
+
+void console_get_stats(const struct console *con, struct console_stats *stats)
+{
+	*stats = con->stats;
+	return;
+}
@@ -0,0 +1,224 @@
+/*
+ * Console output cost - polled stdio with fflush() against console.h
+ *
+ * Prints the same status lines five ways, the way print_operation() and
+ * print_result() do in the timer examples:
+ *
+ *  - printf() and fflush() per call, polled, which is what those helpers did:
+ *    the caller waits on the UART FIFO for every character
+ *  - console_printf() into the ring, a burst that fits in it
+ *  - console_printf(), far more than fits, waiting for room (CONSOLE_BLOCK)
+ *  - the same, dropping what does not fit (CONSOLE_DROP)
+ *  - printf() through the outbyte() override, one console_write() per byte
+ *
+ * Each run is timed from the first call until the UART has sent the last
+ * byte. The CPU is busy for the calls themselves and for the UART interrupt
+ * once they have returned; the rest of the time the CPU was free while the
+ * line drained. The table comes after all the runs so it is not mixed in with
+ * their output.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+#include "xtime_l.h"
+
+#include "gtimer.h"
+#include "irq_prof.h"
+#include "console.h"
+#include "console_uartps.h"
+
+#define GIC_DEVICE_ID			XPAR_SCUGIC_SINGLE_DEVICE_ID
+#define UART_IRQ_ID			XPS_UART1_INT_ID
+
+/* The global timer (XTime) runs at half the CPU clock */
+#define CYCLES_PER_TICK			(XPAR_CPU_CORTEXA9_0_CPU_CLK_FREQ_HZ / COUNTS_PER_SECOND)
+
+/* About 62 bytes a line, so a burst is ~3.7KB of the 4KB ring and a run ~12KB */
+#define BURST_LINES			60
+#define RUN_LINES			200
+
+#define ASCII_ESC			27
+
+struct method {
+	const char *name;
+	uint32_t policy;
+	uint32_t lines;
+	void (*line)(uint32_t i);
+};
+
+struct result {
+	uint64_t call_ticks;
+	uint64_t drain_ticks;
+	uint64_t isr_ticks;
+	uint32_t bytes;
+	uint32_t dropped;
+	uint32_t irqs;
+};
+
+static XScuGic gic;
+
+static void line_stdio_fflush(uint32_t i)
+{
+	char msg[50];
+
+	snprintf(msg, sizeof(msg), "Status line %"PRIu32, i);
+	printf("%-50s", msg);
+	fflush(stdout);
+	printf("%10s\n", "OK");
+	fflush(stdout);
+	return;
+}
+
+static void line_console(uint32_t i)
+{
+	char msg[50];
+
+	snprintf(msg, sizeof(msg), "Status line %"PRIu32, i);
+	console_printf(&console_uart, "%-50s", msg);
+	console_printf(&console_uart, "%10s\n", "OK");
+	return;
+}
+
+static void line_stdio(uint32_t i)
+{
+	char msg[50];
+
+	snprintf(msg, sizeof(msg), "Status line %"PRIu32, i);
+	printf("%-50s", msg);
+	printf("%10s\n", "OK");
+	return;
+}
+
+/* The first method runs before console_uartps_start(), so it is polled */
+static const struct method methods[] = {
+	{"stdio + fflush, polled", CONSOLE_BLOCK, RUN_LINES, line_stdio_fflush},
+	{"console, burst", CONSOLE_BLOCK, BURST_LINES, line_console},
+	{"console, block", CONSOLE_BLOCK, RUN_LINES, line_console},
+	{"console, drop", CONSOLE_DROP, RUN_LINES, line_console},
+	{"stdio via outbyte, block", CONSOLE_BLOCK, RUN_LINES, line_stdio},
+};
+
+static uint64_t isr_cycles(void)
+{
+	struct irq_prof_stats stats;
+
+	irq_prof_read(UART_IRQ_ID, &stats);
+	return stats.cycles;
+}
+
+static void run(const struct method *method, struct result *result)
+{
+	struct console_stats before;
+	struct console_stats after;
+	uint64_t cycles = 0;
+	uint64_t start = 0;
+	uint64_t written = 0;
+	uint64_t stop = 0;
+	uint32_t i = 0;
+
+	console_uart.policy = method->policy;
+	console_get_stats(&console_uart, &before);
+	start = gtimer_read();
+	for (i = 0; i < method->lines; i++) {
+		method->line(i);
+	}
+	written = gtimer_read();
+	/* Interrupts taken during the calls are already in their time */
+	cycles = isr_cycles();
+	console_flush(&console_uart);
+	stop = gtimer_read();
+	console_get_stats(&console_uart, &after);
+
+	result->call_ticks = written - start;
+	result->drain_ticks = stop - written;
+	result->isr_ticks = (isr_cycles() - cycles) / CYCLES_PER_TICK;
+	result->bytes = after.written - before.written;
+	result->dropped = after.dropped - before.dropped;
+	result->irqs = after.irqs - before.irqs;
+	return;
+}
+
+static void print_result(const char *name, const struct result *result)
+{
+	uint64_t total = result->call_ticks + result->drain_ticks;
+	uint64_t busy = result->call_ticks + result->isr_ticks;
+
+	if ( total == 0 ) {
+		return;
+	}
+	printf("%-26s%-8"PRIu32"%-12"PRIu64"%-12"PRIu64"%-8.1f%-10"PRIu64"%-8"PRIu32"%-8"PRIu32"\n", name,
+			result->bytes, (result->call_ticks * 1000000) / COUNTS_PER_SECOND,
+			(total * 1000000) / COUNTS_PER_SECOND, (100.0 * busy) / total,
+			((uint64_t) result->bytes * COUNTS_PER_SECOND) / total, result->irqs, result->dropped);
+	return;
+}
+
+static int setup_gic(void)
+{
+	XScuGic_Config *gic_config = XScuGic_LookupConfig(GIC_DEVICE_ID);
+
+	if ( gic_config == NULL ) {
+		fprintf(stderr, "Could not find configuration for GIC device ID %d\n", GIC_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	if ( XScuGic_CfgInitialize(&gic, gic_config, gic_config->CpuBaseAddress) != XST_SUCCESS ) {
+		fprintf(stderr, "Could not initialize GIC device ID %d\n", GIC_DEVICE_ID);
+		return XST_FAILURE;
+	}
+	/* The profiling dispatcher gives the time spent in the UART interrupt */
+	irq_prof_init(&gic);
+	return XST_SUCCESS;
+}
+
+int main(int args, char *argv[])
+{
+	static struct result results[sizeof(methods) / sizeof(methods[0])];
+	struct console_stats stats;
+	uint32_t i = 0;
+
+	init_platform();
+	console_uartps_init(CONSOLE_BLOCK);
+
+	printf("%c[2J", ASCII_ESC);
+	printf("Console Output\n");
+	printf("--------------\n");
+
+	if ( setup_gic() != XST_SUCCESS ) {
+		return XST_FAILURE;
+	}
+
+	run(&methods[0], &results[0]);
+
+	if ( console_uartps_start(&gic) != XST_SUCCESS ) {
+		fprintf(stderr, "Could not connect the UART interrupt\n");
+		return XST_FAILURE;
+	}
+	Xil_ExceptionEnable();
+	for (i = 1; i < sizeof(methods) / sizeof(methods[0]); i++) {
+		run(&methods[i], &results[i]);
+	}
+
+	console_uart.policy = CONSOLE_BLOCK;
+	printf("\n%-26s%-8s%-12s%-12s%-8s%-10s%-8s%-8s\n", "Method", "Bytes", "Call (us)", "Total (us)", "CPU %",
+			"Bytes/s", "IRQs", "Dropped");
+	for (i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+		print_result(methods[i].name, &results[i]);
+	}
+
+	console_get_stats(&console_uart, &stats);
+	printf("\n%-30s%"PRIu32" bytes\n", "Ring size", (uint32_t) CONSOLE_BUF_LEN);
+	printf("%-30s%"PRIu32" bytes\n", "Ring high water", stats.high_water);
+	printf("%-30s%"PRIu32" waited, %"PRIu32" polled\n", "Writes short of room", stats.blocked, stats.polled);
+	console_flush(&console_uart);
+
+	cleanup_platform();
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * console.h on the PS UART
+ *
+ * The TX-empty interrupt refills the 64 byte FIFO, so at 115200 baud there is
+ * an interrupt every 5.5ms while there is output, rather than the CPU waiting
+ * out every character. stdout is made unbuffered, since buffering in newlib
+ * on top of the ring would only hold lines back, and each printf() then
+ * reaches outbyte() as one _write() of the whole string.
+ *
+ * Xilinx asserts are pointed at console_uartps_panic(), so what was printed
+ * just before a failed assert is not lost in the ring.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "xparameters.h"
+#include "xparameters_ps.h"
+#include "xil_io.h"
+#include "xil_assert.h"
+#include "xil_exception.h"
+#include "xscugic.h"
+#include "xuartps_hw.h"
+
+#include "console.h"
+#include "console_uartps.h"
+
+#define UART_BASE			STDOUT_BASEADDRESS
+/* Whichever UART the BSP put stdout on, or every blocking write would wait for an interrupt that never comes */
+#if STDOUT_BASEADDRESS == XPS_UART0_BASEADDR
+#define UART_INTR_ID			XPS_UART0_INT_ID
+#elif STDOUT_BASEADDRESS == XPS_UART1_BASEADDR
+#define UART_INTR_ID			XPS_UART1_INT_ID
+#else
+#error "console_uartps needs stdout on PS UART0 or UART1"
+#endif
+
+#define CPSR_I				0x00000080
+
+struct console console_uart;
+
+static uint32_t uart_lock(void *ctx)
+{
+	uint32_t cpsr = 0;
+
+	__asm__ volatile ("mrs %0, cpsr\n\tcpsid i" : "=r" (cpsr) :: "memory");
+	return cpsr & CPSR_I;
+}
+
+static void uart_unlock(void *ctx, uint32_t state)
+{
+	if ( state == 0 ) {
+		__asm__ volatile ("cpsie i" ::: "memory");
+	}
+	return;
+}
+
+static int uart_tx_full(void *ctx)
+{
+	return ( Xil_In32(UART_BASE + XUARTPS_SR_OFFSET) & XUARTPS_SR_TXFULL ) != 0;
+}
+
+static void uart_tx_put(void *ctx, uint8_t c)
+{
+	Xil_Out32(UART_BASE + XUARTPS_FIFO_OFFSET, c);
+	return;
+}
+
+static int uart_tx_idle(void *ctx)
+{
+	uint32_t sr = Xil_In32(UART_BASE + XUARTPS_SR_OFFSET);
+
+	return ( sr & XUARTPS_SR_TXEMPTY ) && !( sr & XUARTPS_SR_TACTIVE );
+}
+
+/* The status bit is sticky, so a stale one is cleared before the interrupt is enabled */
+static void uart_tx_irq(void *ctx, int enable)
+{
+	if ( enable ) {
+		Xil_Out32(UART_BASE + XUARTPS_ISR_OFFSET, XUARTPS_IXR_TXEMPTY);
+		Xil_Out32(UART_BASE + XUARTPS_IER_OFFSET, XUARTPS_IXR_TXEMPTY);
+	} else {
+		Xil_Out32(UART_BASE + XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY);
+	}
+	return;
+}
+
+static const struct console_ops uart_ops = {
+	uart_lock,
+	uart_unlock,
+	uart_tx_full,
+	uart_tx_put,
+	uart_tx_idle,
+	uart_tx_irq,
+};
+
+static void uart_isr(void *callback_ref)
+{
+	uint32_t status = Xil_In32(UART_BASE + XUARTPS_ISR_OFFSET) & Xil_In32(UART_BASE + XUARTPS_IMR_OFFSET);
+
+	Xil_Out32(UART_BASE + XUARTPS_ISR_OFFSET, status);
+	if ( status & XUARTPS_IXR_TXEMPTY ) {
+		console_tx_isr(callback_ref);
+	}
+	return;
+}
+
+static void assert_callback(const char8 *file, s32 line)
+{
+	char msg[CONSOLE_LINE_LEN];
+
+	snprintf(msg, sizeof(msg), "Assertion failed at %s:%ld\r\n", file, (long) line);
+	console_uartps_panic(msg);
+	return;
+}
+
+/* Replaces the BSP's polled outbyte(), which everything in stdio ends up in */
+void outbyte(char c)
+{
+	console_write(&console_uart, &c, 1);
+	return;
+}
+
+void console_uartps_init(uint32_t policy)
+{
+	Xil_Out32(UART_BASE + XUARTPS_IDR_OFFSET, XUARTPS_IXR_TXEMPTY);
+	console_init(&console_uart, &uart_ops, NULL, policy);
+	setvbuf(stdout, NULL, _IONBF, 0);
+	Xil_AssertSetCallback(assert_callback);
+	return;
+}
+
+int console_uartps_start(XScuGic *gic)
+{
+	int status = 0;
+
+	status = XScuGic_Connect(gic, UART_INTR_ID, (Xil_InterruptHandler) uart_isr, (void *) &console_uart);
+	if ( status != XST_SUCCESS ) {
+		return status;
+	}
+	XScuGic_Enable(gic, UART_INTR_ID);
+	console_start(&console_uart);
+	return XST_SUCCESS;
+}
+
+void console_uartps_panic(const char *msg)
+{
+	console_panic(&console_uart);
+	console_write(&console_uart, msg, strlen(msg));
+	return;
+}
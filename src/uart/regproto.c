@@ -0,0 +1,339 @@
+/*
+ * Framing and the on-target agent for regproto.h
+ *
+ * COBS (Cheshire and Baker, 1999) turns the frame into runs of non-zero bytes,
+ * each led by a code byte saying how far it is to the next zero, so the
+ * overhead is one byte in 254 and a zero can only ever mean the end of a
+ * frame. The receiver collects bytes up to that zero and decodes in place,
+ * since a decoded byte never lands after the encoded one it came from.
+ *
+ * The agent checks every address of a request before touching any of them,
+ * so a request is carried out completely or not at all.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "regproto.h"
+
+#define OP_OFFSET			1
+#define STATUS_OFFSET			2
+#define REQUEST_HEADER			2
+#define RESPONSE_HEADER			3
+
+/* CRC-16/CCITT-FALSE a nibble at a time, 32 bytes of table rather than 512 */
+static const uint16_t crc_nibble[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t regproto_crc16(const uint8_t *data, size_t len)
+{
+	uint16_t crc = 0xFFFF;
+	size_t i = 0;
+
+	for (i = 0; i < len; i++) {
+		crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (crc << 4) ^ crc_nibble[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+	return crc;
+}
+
+size_t regproto_cobs_encode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+	size_t code_pos = 0;
+	size_t out = 1;
+	uint8_t code = 1;
+	size_t i = 0;
+
+	for (i = 0; i < len; i++) {
+		if ( src[i] == 0 ) {
+			dst[code_pos] = code;
+			code_pos = out++;
+			code = 1;
+		} else {
+			dst[out++] = src[i];
+			code++;
+			/* A full run of 254 has no zero after it */
+			if ( code == 0xFF ) {
+				dst[code_pos] = code;
+				code_pos = out++;
+				code = 1;
+			}
+		}
+	}
+	dst[code_pos] = code;
+	return out;
+}
+
+int regproto_cobs_decode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+	size_t out = 0;
+	size_t i = 0;
+	uint8_t code = 0;
+
+	while ( i < len ) {
+		code = src[i++];
+		if ( ( code == 0 ) || ( i + code - 1 > len ) ) {
+			return -1;
+		}
+		/* memmove, since decoding in place overlaps */
+		memmove(&dst[out], &src[i], code - 1);
+		out += code - 1;
+		i += code - 1;
+		if ( ( code != 0xFF ) && ( i < len ) ) {
+			dst[out++] = 0;
+		}
+	}
+	return out;
+}
+
+size_t regproto_frame(const uint8_t *payload, size_t len, uint8_t *frame)
+{
+	uint8_t raw[REGPROTO_PAYLOAD_MAX + 2];
+	uint16_t crc = regproto_crc16(payload, len);
+	size_t out = 0;
+
+	memcpy(raw, payload, len);
+	raw[len] = crc;
+	raw[len + 1] = crc >> 8;
+	out = regproto_cobs_encode(raw, len + 2, frame);
+	frame[out++] = 0;
+	return out;
+}
+
+void regproto_rx_init(struct regproto_rx *rx)
+{
+	rx->len = 0;
+	rx->overflow = 0;
+	rx->errors = 0;
+	return;
+}
+
+int regproto_rx_byte(struct regproto_rx *rx, uint8_t c, uint8_t *payload)
+{
+	int len = 0;
+
+	if ( c != 0 ) {
+		if ( rx->len < sizeof(rx->buf) ) {
+			rx->buf[rx->len++] = c;
+		} else {
+			rx->overflow = 1;
+		}
+		return 0;
+	}
+	/* Zeros between frames are harmless, a sender can use them to resynchronize */
+	if ( rx->len == 0 ) {
+		return 0;
+	}
+	len = rx->overflow ? -1 : regproto_cobs_decode(rx->buf, rx->len, rx->buf);
+	rx->len = 0;
+	rx->overflow = 0;
+	if ( ( len < REQUEST_HEADER + 2 ) || ( len > REGPROTO_PAYLOAD_MAX + 2 ) ||
+			( regproto_crc16(rx->buf, len - 2) != ( rx->buf[len - 2] | ( rx->buf[len - 1] << 8 ) ) ) ) {
+		rx->errors++;
+		return 0;
+	}
+	memcpy(payload, rx->buf, len - 2);
+	return len - 2;
+}
+
+void regproto_agent_init(struct regproto_agent *agent, const struct regproto_agent_ops *ops, void *ctx,
+		const struct regproto_map *maps, uint32_t map_count)
+{
+	agent->ops = ops;
+	agent->ctx = ctx;
+	agent->maps = maps;
+	agent->map_count = map_count;
+	agent->requests = 0;
+	regproto_rx_init(&agent->rx);
+	return;
+}
+
+static int word_ok(struct regproto_agent *agent, uint32_t addr, uint32_t words)
+{
+	return ( ( addr & 3 ) == 0 ) && agent->ops->access_ok(agent->ctx, addr, words * 4);
+}
+
+/* Returns the bytes used, or -1 if the name does not fit */
+static int put_name(uint8_t *dst, size_t room, const char *name)
+{
+	size_t len = strlen(name) + 1;
+
+	if ( len > room ) {
+		return -1;
+	}
+	memcpy(dst, name, len);
+	return len;
+}
+
+static uint8_t map_info(const struct regproto_map *map, uint8_t *out, size_t *out_len)
+{
+	size_t len = 5;
+	int used = 0;
+	uint32_t i = 0;
+
+	out[0] = map->count;
+	regproto_put32(&out[1], map->base);
+	used = put_name(&out[len], REGPROTO_MAX_DATA - len, map->name);
+	if ( used < 0 ) {
+		return REGPROTO_BAD_LENGTH;
+	}
+	len += used;
+	for (i = 0; i < map->count; i++) {
+		if ( len + 2 > REGPROTO_MAX_DATA ) {
+			return REGPROTO_BAD_LENGTH;
+		}
+		out[len] = map->regs[i].offset;
+		out[len + 1] = map->regs[i].offset >> 8;
+		len += 2;
+		used = put_name(&out[len], REGPROTO_MAX_DATA - len, map->regs[i].name);
+		if ( used < 0 ) {
+			return REGPROTO_BAD_LENGTH;
+		}
+		len += used;
+	}
+	*out_len = len;
+	return REGPROTO_OK;
+}
+
+static uint8_t snapshot(struct regproto_agent *agent, const struct regproto_map *map, uint8_t *out,
+		size_t *out_len)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < map->count; i++) {
+		if ( !word_ok(agent, map->base + map->regs[i].offset, 1) ) {
+			return REGPROTO_BAD_ADDR;
+		}
+	}
+	for (i = 0; i < map->count; i++) {
+		regproto_put32(&out[i * 4], agent->ops->read32(agent->ctx, map->base + map->regs[i].offset));
+	}
+	*out_len = map->count * 4;
+	return REGPROTO_OK;
+}
+
+size_t regproto_agent_handle(struct regproto_agent *agent, const uint8_t *req, size_t len, uint8_t *resp)
+{
+	const uint8_t *args = &req[REQUEST_HEADER];
+	uint8_t *out = &resp[RESPONSE_HEADER];
+	size_t args_len = 0;
+	size_t out_len = 0;
+	uint8_t status = REGPROTO_OK;
+	uint32_t addr = 0;
+	uint32_t count = 0;
+	uint32_t i = 0;
+
+	if ( len < REQUEST_HEADER ) {
+		return 0;
+	}
+	args_len = len - REQUEST_HEADER;
+	switch ( req[OP_OFFSET] ) {
+	case REGPROTO_PEEK:
+		count = args_len / 4;
+		if ( ( count == 0 ) || ( args_len % 4 != 0 ) ) {
+			status = REGPROTO_BAD_LENGTH;
+			break;
+		}
+		for (i = 0; ( i < count ) && ( status == REGPROTO_OK ); i++) {
+			if ( !word_ok(agent, regproto_get32(&args[i * 4]), 1) ) {
+				status = REGPROTO_BAD_ADDR;
+			}
+		}
+		for (i = 0; ( i < count ) && ( status == REGPROTO_OK ); i++) {
+			regproto_put32(&out[i * 4], agent->ops->read32(agent->ctx, regproto_get32(&args[i * 4])));
+		}
+		out_len = ( status == REGPROTO_OK ) ? count * 4 : 0;
+		break;
+	case REGPROTO_POKE:
+		count = args_len / 8;
+		if ( ( count == 0 ) || ( args_len % 8 != 0 ) ) {
+			status = REGPROTO_BAD_LENGTH;
+			break;
+		}
+		for (i = 0; ( i < count ) && ( status == REGPROTO_OK ); i++) {
+			if ( !word_ok(agent, regproto_get32(&args[i * 8]), 1) ) {
+				status = REGPROTO_BAD_ADDR;
+			}
+		}
+		for (i = 0; ( i < count ) && ( status == REGPROTO_OK ); i++) {
+			agent->ops->write32(agent->ctx, regproto_get32(&args[i * 8]), regproto_get32(&args[i * 8 + 4]));
+		}
+		break;
+	case REGPROTO_READ:
+		if ( args_len != 6 ) {
+			status = REGPROTO_BAD_LENGTH;
+			break;
+		}
+		addr = regproto_get32(args);
+		count = args[4] | ( args[5] << 8 );
+		if ( ( count == 0 ) || ( count > REGPROTO_READ_MAX ) ) {
+			status = REGPROTO_BAD_LENGTH;
+		} else if ( !word_ok(agent, addr, count) ) {
+			status = REGPROTO_BAD_ADDR;
+		} else {
+			for (i = 0; i < count; i++) {
+				regproto_put32(&out[i * 4], agent->ops->read32(agent->ctx, addr + i * 4));
+			}
+			out_len = count * 4;
+		}
+		break;
+	case REGPROTO_WRITE:
+		count = ( args_len > 4 ) ? ( args_len - 4 ) / 4 : 0;
+		if ( ( count == 0 ) || ( args_len % 4 != 0 ) ) {
+			status = REGPROTO_BAD_LENGTH;
+			break;
+		}
+		addr = regproto_get32(args);
+		if ( !word_ok(agent, addr, count) ) {
+			status = REGPROTO_BAD_ADDR;
+			break;
+		}
+		for (i = 0; i < count; i++) {
+			agent->ops->write32(agent->ctx, addr + i * 4, regproto_get32(&args[4 + i * 4]));
+		}
+		break;
+	case REGPROTO_MAP_INFO:
+	case REGPROTO_SNAPSHOT:
+		if ( args_len != 1 ) {
+			status = REGPROTO_BAD_LENGTH;
+		} else if ( args[0] >= agent->map_count ) {
+			status = REGPROTO_NOT_FOUND;
+		} else if ( agent->maps[args[0]].count > REGPROTO_READ_MAX ) {
+			status = REGPROTO_BAD_LENGTH;
+		} else if ( req[OP_OFFSET] == REGPROTO_MAP_INFO ) {
+			status = map_info(&agent->maps[args[0]], out, &out_len);
+		} else {
+			status = snapshot(agent, &agent->maps[args[0]], out, &out_len);
+		}
+		if ( status != REGPROTO_OK ) {
+			out_len = 0;
+		}
+		break;
+	default:
+		status = REGPROTO_BAD_OP;
+		break;
+	}
+
+	resp[0] = req[0];
+	resp[OP_OFFSET] = req[OP_OFFSET] | REGPROTO_RESPONSE;
+	resp[STATUS_OFFSET] = status;
+	return RESPONSE_HEADER + out_len;
+}
+
+void regproto_agent_rx(struct regproto_agent *agent, uint8_t c)
+{
+	size_t len = regproto_rx_byte(&agent->rx, c, agent->request);
+
+	if ( len == 0 ) {
+		return;
+	}
+	agent->requests++;
+	len = regproto_agent_handle(agent, agent->request, len, agent->response);
+	if ( len != 0 ) {
+		len = regproto_frame(agent->response, len, agent->frame);
+		agent->ops->tx(agent->ctx, agent->frame, len);
+	}
+	return;
+}
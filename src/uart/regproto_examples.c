@@ -0,0 +1,194 @@
+/*
+ * Register access agent - the board side of examples/regproto_cli.c
+ *
+ * Prints a banner at the usual 115200 baud, then switches the UART to
+ * REGPROTO_BAUD and serves regproto.h requests on it for good, so close the
+ * terminal once the banner is out and point regproto_cli at the same port
+ * with -b REGPROTO_BAUD. Replaces editing, rebuilding and rerunning
+ * print_summary() in peripheral.c to look at a register.
+ *
+ * The maps are the PS blocks the other examples use. Registers that change
+ * when read, the TTC interrupt status for one, are left out of them so a
+ * snapshot does not disturb a running program; peek still reaches them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "xparameters.h"
+#include "platform.h"
+#include "xstatus.h"
+
+#include "gtimer.h"
+#include "regproto.h"
+#include "regproto_zynq.h"
+
+/* 8N1 at 921600 is ~90KB/s, some 10000 register reads a second in batches */
+#define REGPROTO_BAUD			921600
+
+/* With a bitstream that has the taylor_uzed peripheral loaded */
+//#define REGPROTO_PL
+
+#define SLCR_BASE			0xF8000000
+#define TTC0_BASE			0xF8001000
+#define TTC1_BASE			0xF8002000
+#define SCU_PRIVATE_BASE		0xF8F00000
+#define GPIO_BASE			0xE000A000
+#define UART1_BASE			0xE0001000
+#define PERIPHERAL_BASE			0x43C10000
+
+#define ASCII_ESC			27
+
+#define TTC_COUNTER_REGS(n) \
+	{"CLK_CTRL_" #n, 0x00 + 4 * n}, \
+	{"CNT_CTRL_" #n, 0x0C + 4 * n}, \
+	{"COUNTER_" #n, 0x18 + 4 * n}, \
+	{"INTERVAL_" #n, 0x24 + 4 * n}, \
+	{"MATCH_1_" #n, 0x30 + 4 * n}, \
+	{"MATCH_2_" #n, 0x3C + 4 * n}, \
+	{"MATCH_3_" #n, 0x48 + 4 * n}, \
+	{"IER_" #n, 0x60 + 4 * n}, \
+	{"EVENT_CTRL_" #n, 0x6C + 4 * n}, \
+	{"EVENT_" #n, 0x78 + 4 * n}
+
+#define GPIO_BANK_REGS(n) \
+	{"DATA_" #n, 0x040 + 4 * n}, \
+	{"DATA_RO_" #n, 0x060 + 4 * n}, \
+	{"DIRM_" #n, 0x204 + 0x40 * n}, \
+	{"OEN_" #n, 0x208 + 0x40 * n}, \
+	{"INT_MASK_" #n, 0x20C + 0x40 * n}, \
+	{"INT_STAT_" #n, 0x218 + 0x40 * n}, \
+	{"INT_TYPE_" #n, 0x21C + 0x40 * n}, \
+	{"INT_POLARITY_" #n, 0x220 + 0x40 * n}, \
+	{"INT_ANY_" #n, 0x224 + 0x40 * n}
+
+static const struct regproto_reg slcr_regs[] = {
+	{"ARM_PLL_CTRL", 0x100},
+	{"DDR_PLL_CTRL", 0x104},
+	{"IO_PLL_CTRL", 0x108},
+	{"PLL_STATUS", 0x10C},
+	{"ARM_CLK_CTRL", 0x120},
+	{"DDR_CLK_CTRL", 0x124},
+	{"APER_CLK_CTRL", 0x12C},
+	{"UART_CLK_CTRL", 0x154},
+	{"FPGA0_CLK_CTRL", 0x170},
+	{"CLK_621_TRUE", 0x1C4},
+	{"PSS_IDCODE", 0x530},
+};
+
+static const struct regproto_reg ttc_regs[] = {
+	TTC_COUNTER_REGS(0),
+	TTC_COUNTER_REGS(1),
+	TTC_COUNTER_REGS(2),
+};
+
+/* The private timer and watchdog, then the global timer */
+static const struct regproto_reg scu_timer_regs[] = {
+	{"TIMER_LOAD", 0x600},
+	{"TIMER_COUNTER", 0x604},
+	{"TIMER_CONTROL", 0x608},
+	{"TIMER_ISR", 0x60C},
+	{"WDT_LOAD", 0x620},
+	{"WDT_COUNTER", 0x624},
+	{"WDT_CONTROL", 0x628},
+	{"WDT_ISR", 0x62C},
+	{"WDT_RESET_STATUS", 0x630},
+	{"GTIMER_COUNTER_LO", GTIMER_COUNTER_LO - SCU_PRIVATE_BASE},
+	{"GTIMER_COUNTER_HI", GTIMER_COUNTER_HI - SCU_PRIVATE_BASE},
+	{"GTIMER_CONTROL", GTIMER_CONTROL - SCU_PRIVATE_BASE},
+	{"GTIMER_ISR", GTIMER_ISR - SCU_PRIVATE_BASE},
+	{"GTIMER_COMPARATOR_LO", GTIMER_COMPARATOR_LO - SCU_PRIVATE_BASE},
+	{"GTIMER_COMPARATOR_HI", GTIMER_COMPARATOR_HI - SCU_PRIVATE_BASE},
+};
+
+static const struct regproto_reg gpio_regs[] = {
+	GPIO_BANK_REGS(0),
+	GPIO_BANK_REGS(1),
+	GPIO_BANK_REGS(2),
+	GPIO_BANK_REGS(3),
+};
+
+/* Everything but the FIFO, which a read would empty */
+static const struct regproto_reg uart_regs[] = {
+	{"CR", 0x00},
+	{"MR", 0x04},
+	{"IMR", 0x10},
+	{"ISR", 0x14},
+	{"BAUDGEN", 0x18},
+	{"RXTOUT", 0x1C},
+	{"RXWM", 0x20},
+	{"SR", 0x2C},
+	{"BAUDDIV", 0x34},
+	{"TXWM", 0x44},
+};
+
+static const struct regproto_reg peripheral_regs[] = {
+	{"SLV_REG0", 0x00},
+	{"SCRATCH", 0x04},
+	{"SLV_REG2", 0x08},
+	{"SLV_REG3", 0x0C},
+	{"PERF_CTRL", 0x10},
+	{"PERF_CYCLES_LO", 0x14},
+	{"PERF_CYCLES_HI", 0x18},
+	{"PERF_WR_COUNT", 0x1C},
+	{"PERF_RD_COUNT", 0x20},
+	{"PERF_WR_STALL", 0x24},
+	{"PERF_RD_STALL", 0x28},
+	{"PERF_RESULTS", 0x2C},
+};
+
+#define MAP(name, base, regs)		{name, base, regs, sizeof(regs) / sizeof(regs[0])}
+
+static const struct regproto_map maps[] = {
+	MAP("slcr", SLCR_BASE, slcr_regs),
+	MAP("ttc0", TTC0_BASE, ttc_regs),
+	MAP("ttc1", TTC1_BASE, ttc_regs),
+	MAP("scu_timers", SCU_PRIVATE_BASE, scu_timer_regs),
+	MAP("gpio", GPIO_BASE, gpio_regs),
+	MAP("uart1", UART1_BASE, uart_regs),
+	MAP("taylor_uzed", PERIPHERAL_BASE, peripheral_regs),
+};
+
+/* Whole 4KB register blocks, and DDR above the vectors */
+static const struct regproto_window windows[] = {
+	{SLCR_BASE, 0x1000},
+	{TTC0_BASE, 0x1000},
+	{TTC1_BASE, 0x1000},
+	/* SCU, GIC, global and private timers */
+	{SCU_PRIVATE_BASE, 0x2000},
+	{GPIO_BASE, 0x1000},
+	{UART1_BASE, 0x1000},
+	{XPAR_PS7_DDR_0_S_AXI_BASEADDR, XPAR_PS7_DDR_0_S_AXI_HIGHADDR - XPAR_PS7_DDR_0_S_AXI_BASEADDR + 1},
+#ifdef REGPROTO_PL
+	{PERIPHERAL_BASE, 0x1000},
+#endif
+};
+
+static struct regproto_agent agent;
+
+int main(int args, char *argv[])
+{
+	uint32_t i = 0;
+
+	init_platform();
+
+	printf("%c[2J", ASCII_ESC);
+	printf("Register Access Agent\n");
+	printf("---------------------\n");
+	for (i = 0; i < sizeof(maps) / sizeof(maps[0]); i++) {
+		printf("%-20s0x%08"PRIx32"%6"PRIu32" registers\n", maps[i].name, maps[i].base, maps[i].count);
+	}
+	printf("\nSwitching to %d baud, run regproto_cli -b %d\n", REGPROTO_BAUD, REGPROTO_BAUD);
+
+	if ( regproto_zynq_init(&agent, maps, sizeof(maps) / sizeof(maps[0]), windows,
+			sizeof(windows) / sizeof(windows[0]), REGPROTO_BAUD) != XST_SUCCESS ) {
+		printf("Could not set the UART to %d baud\n", REGPROTO_BAUD);
+		return XST_FAILURE;
+	}
+	regproto_zynq_run(&agent);
+
+	cleanup_platform();
+	return 0;
+}
@@ -0,0 +1,384 @@
+/*
+ * regproto_client.h on a POSIX serial port or pty
+ *
+ * Host builds only. The line is put in raw mode, 8N1 with no flow control,
+ * which is what the standalone BSP sets up on the board. Received bytes are
+ * read in blocks and fed to the framing one at a time, so a burst of answers
+ * costs one read() rather than one per byte.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "regproto.h"
+#include "regproto_client.h"
+
+static const struct {
+	uint32_t baud;
+	speed_t speed;
+} speeds[] = {
+	{9600, B9600},
+	{19200, B19200},
+	{38400, B38400},
+	{57600, B57600},
+	{115200, B115200},
+	{230400, B230400},
+	{460800, B460800},
+	{921600, B921600},
+};
+
+static int set_raw(int fd, uint32_t baud)
+{
+	struct termios tio;
+	uint32_t i = 0;
+
+	if ( tcgetattr(fd, &tio) != 0 ) {
+		return -1;
+	}
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if ( baud != 0 ) {
+		for (i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+			if ( speeds[i].baud == baud ) {
+				break;
+			}
+		}
+		if ( i == sizeof(speeds) / sizeof(speeds[0]) ) {
+			fprintf(stderr, "Unsupported baud rate %"PRIu32"\n", baud);
+			return -1;
+		}
+		cfsetispeed(&tio, speeds[i].speed);
+		cfsetospeed(&tio, speeds[i].speed);
+	}
+	if ( tcsetattr(fd, TCSANOW, &tio) != 0 ) {
+		return -1;
+	}
+	tcflush(fd, TCIOFLUSH);
+	return 0;
+}
+
+int regproto_client_open(struct regproto_client *client, const char *path, uint32_t baud)
+{
+	memset(client, 0, sizeof(*client));
+	client->timeout_ms = REGPROTO_TIMEOUT_MS;
+	regproto_rx_init(&client->rx);
+	client->fd = open(path, O_RDWR | O_NOCTTY);
+	if ( client->fd < 0 ) {
+		fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if ( isatty(client->fd) && ( set_raw(client->fd, baud) != 0 ) ) {
+		fprintf(stderr, "Could not set up %s\n", path);
+		close(client->fd);
+		client->fd = -1;
+		return -1;
+	}
+	return 0;
+}
+
+void regproto_client_close(struct regproto_client *client)
+{
+	if ( client->fd >= 0 ) {
+		close(client->fd);
+		client->fd = -1;
+	}
+	return;
+}
+
+static int send_all(struct regproto_client *client, const uint8_t *data, size_t len)
+{
+	ssize_t done = 0;
+
+	while ( len > 0 ) {
+		done = write(client->fd, data, len);
+		if ( done < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			return -1;
+		}
+		data += done;
+		len -= done;
+		client->stats.tx_bytes += done;
+	}
+	return 0;
+}
+
+static int64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Waits for the answer to seq, returns its payload length or -1 on a timeout */
+static int receive(struct regproto_client *client, uint8_t seq, uint8_t op)
+{
+	struct pollfd pfd = {client->fd, POLLIN, 0};
+	int64_t deadline = now_ms() + client->timeout_ms;
+	int64_t left = 0;
+	ssize_t got = 0;
+	int len = 0;
+
+	for (;;) {
+		while ( client->in_pos < client->in_len ) {
+			len = regproto_rx_byte(&client->rx, client->in[client->in_pos++], client->payload);
+			if ( len == 0 ) {
+				continue;
+			}
+			if ( ( len >= 3 ) && ( client->payload[0] == seq ) && ( client->payload[1] == ( op | REGPROTO_RESPONSE ) ) ) {
+				return len;
+			}
+			client->stats.stale++;
+		}
+		left = deadline - now_ms();
+		if ( ( left <= 0 ) || ( poll(&pfd, 1, left) <= 0 ) ) {
+			return -1;
+		}
+		got = read(client->fd, client->in, sizeof(client->in));
+		if ( got <= 0 ) {
+			return -1;
+		}
+		client->in_len = got;
+		client->in_pos = 0;
+		client->stats.rx_bytes += got;
+	}
+}
+
+/*
+ * One request, args already in place after the header, answer in
+ * client->payload. Returns the agent's status and the length of what came
+ * back after it, or REGPROTO_NO_ANSWER.
+ */
+static int transact(struct regproto_client *client, uint8_t op, size_t args_len, int retry, size_t *results_len)
+{
+	uint8_t request[REGPROTO_PAYLOAD_MAX];
+	size_t frame_len = 0;
+	int attempts = retry ? REGPROTO_RETRIES + 1 : 1;
+	int len = 0;
+
+	memcpy(request, client->payload, args_len + 2);
+	while ( attempts-- > 0 ) {
+		request[0] = ++client->seq;
+		request[1] = op;
+		frame_len = regproto_frame(request, args_len + 2, client->frame);
+		client->stats.requests++;
+		if ( send_all(client, client->frame, frame_len) != 0 ) {
+			return REGPROTO_NO_ANSWER;
+		}
+		len = receive(client, request[0], op);
+		if ( len >= 0 ) {
+			*results_len = len - 3;
+			return client->payload[2];
+		}
+		if ( attempts > 0 ) {
+			client->stats.retries++;
+		}
+	}
+	return REGPROTO_NO_ANSWER;
+}
+
+int regproto_peek(struct regproto_client *client, const uint32_t *addrs, uint32_t *values, uint32_t count)
+{
+	uint32_t batch = 0;
+	size_t len = 0;
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	while ( count > 0 ) {
+		batch = ( count > REGPROTO_PEEK_MAX ) ? REGPROTO_PEEK_MAX : count;
+		for (i = 0; i < batch; i++) {
+			regproto_put32(&client->payload[2 + i * 4], addrs[i]);
+		}
+		status = transact(client, REGPROTO_PEEK, batch * 4, 1, &len);
+		if ( status != REGPROTO_OK ) {
+			return status;
+		}
+		if ( len != batch * 4 ) {
+			return REGPROTO_BAD_LENGTH;
+		}
+		for (i = 0; i < batch; i++) {
+			values[i] = regproto_get32(&client->payload[3 + i * 4]);
+		}
+		addrs += batch;
+		values += batch;
+		count -= batch;
+	}
+	return REGPROTO_OK;
+}
+
+int regproto_poke(struct regproto_client *client, const uint32_t *addrs, const uint32_t *values, uint32_t count)
+{
+	uint32_t batch = 0;
+	size_t len = 0;
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	while ( count > 0 ) {
+		batch = ( count > REGPROTO_POKE_MAX ) ? REGPROTO_POKE_MAX : count;
+		for (i = 0; i < batch; i++) {
+			regproto_put32(&client->payload[2 + i * 8], addrs[i]);
+			regproto_put32(&client->payload[6 + i * 8], values[i]);
+		}
+		status = transact(client, REGPROTO_POKE, batch * 8, 0, &len);
+		if ( status != REGPROTO_OK ) {
+			return status;
+		}
+		addrs += batch;
+		values += batch;
+		count -= batch;
+	}
+	return REGPROTO_OK;
+}
+
+int regproto_read(struct regproto_client *client, uint32_t addr, uint32_t *values, uint32_t count)
+{
+	uint32_t batch = 0;
+	size_t len = 0;
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	while ( count > 0 ) {
+		batch = ( count > REGPROTO_READ_MAX ) ? REGPROTO_READ_MAX : count;
+		regproto_put32(&client->payload[2], addr);
+		client->payload[6] = batch;
+		client->payload[7] = batch >> 8;
+		status = transact(client, REGPROTO_READ, 6, 1, &len);
+		if ( status != REGPROTO_OK ) {
+			return status;
+		}
+		if ( len != batch * 4 ) {
+			return REGPROTO_BAD_LENGTH;
+		}
+		for (i = 0; i < batch; i++) {
+			values[i] = regproto_get32(&client->payload[3 + i * 4]);
+		}
+		addr += batch * 4;
+		values += batch;
+		count -= batch;
+	}
+	return REGPROTO_OK;
+}
+
+int regproto_write(struct regproto_client *client, uint32_t addr, const uint32_t *values, uint32_t count)
+{
+	uint32_t batch = 0;
+	size_t len = 0;
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	while ( count > 0 ) {
+		batch = ( count > REGPROTO_WRITE_MAX ) ? REGPROTO_WRITE_MAX : count;
+		regproto_put32(&client->payload[2], addr);
+		for (i = 0; i < batch; i++) {
+			regproto_put32(&client->payload[6 + i * 4], values[i]);
+		}
+		status = transact(client, REGPROTO_WRITE, 4 + batch * 4, 0, &len);
+		if ( status != REGPROTO_OK ) {
+			return status;
+		}
+		addr += batch * 4;
+		values += batch;
+		count -= batch;
+	}
+	return REGPROTO_OK;
+}
+
+/* Copies a NUL terminated name out of the answer, returns the bytes it took or -1 */
+static int get_name(const uint8_t *src, size_t room, char *name)
+{
+	size_t len = strnlen((const char *) src, room);
+
+	if ( len == room ) {
+		return -1;
+	}
+	snprintf(name, REGPROTO_NAME_LEN, "%s", (const char *) src);
+	return len + 1;
+}
+
+int regproto_map_info(struct regproto_client *client, uint8_t index, struct regproto_map_info *info)
+{
+	const uint8_t *p = &client->payload[3];
+	size_t len = 0;
+	size_t pos = 5;
+	int used = 0;
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	client->payload[2] = index;
+	status = transact(client, REGPROTO_MAP_INFO, 1, 1, &len);
+	if ( status != REGPROTO_OK ) {
+		return status;
+	}
+	if ( len < pos ) {
+		return REGPROTO_BAD_LENGTH;
+	}
+	info->count = p[0];
+	info->base = regproto_get32(&p[1]);
+	used = get_name(&p[pos], len - pos, info->name);
+	if ( used < 0 ) {
+		return REGPROTO_BAD_LENGTH;
+	}
+	pos += used;
+	for (i = 0; i < info->count; i++) {
+		if ( pos + 2 > len ) {
+			return REGPROTO_BAD_LENGTH;
+		}
+		info->offsets[i] = p[pos] | ( p[pos + 1] << 8 );
+		pos += 2;
+		used = get_name(&p[pos], len - pos, info->reg_names[i]);
+		if ( used < 0 ) {
+			return REGPROTO_BAD_LENGTH;
+		}
+		pos += used;
+	}
+	return REGPROTO_OK;
+}
+
+int regproto_snapshot(struct regproto_client *client, uint8_t index, uint32_t *values)
+{
+	size_t len = 0;
+	int status = REGPROTO_OK;
+	uint32_t i = 0;
+
+	client->payload[2] = index;
+	status = transact(client, REGPROTO_SNAPSHOT, 1, 1, &len);
+	if ( status != REGPROTO_OK ) {
+		return status;
+	}
+	for (i = 0; i < len / 4; i++) {
+		values[i] = regproto_get32(&client->payload[3 + i * 4]);
+	}
+	return REGPROTO_OK;
+}
+
+const char *regproto_status_name(int status)
+{
+	switch ( status ) {
+	case REGPROTO_OK:
+		return "OK";
+	case REGPROTO_BAD_OP:
+		return "unknown request";
+	case REGPROTO_BAD_LENGTH:
+		return "bad length";
+	case REGPROTO_BAD_ADDR:
+		return "address not allowed";
+	case REGPROTO_NOT_FOUND:
+		return "no such map";
+	case REGPROTO_NO_ANSWER:
+		return "no answer";
+	}
+	return "unknown status";
+}
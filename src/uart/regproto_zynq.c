@@ -0,0 +1,126 @@
+/*
+ * regproto.h agent on the Zynq PS UART, see regproto_zynq.h
+ *
+ * Polled in both directions. The host sends a request and waits for its
+ * answer, so the 64 byte RX FIFO only ever has to hold what arrives while
+ * the agent finishes sending, which is nothing. At 921600 baud a byte takes
+ * 11us, much longer than the agent takes over one.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_io.h"
+#include "xuartps.h"
+#include "xuartps_hw.h"
+
+#include "regproto.h"
+#include "regproto_zynq.h"
+
+#define UART_BASE			STDOUT_BASEADDRESS
+
+struct zynq_target {
+	const struct regproto_window *windows;
+	uint32_t window_count;
+};
+
+static struct zynq_target target;
+static XUartPs uart;
+
+static uint32_t zynq_read32(void *ctx, uint32_t addr)
+{
+	return Xil_In32(addr);
+}
+
+static void zynq_write32(void *ctx, uint32_t addr, uint32_t val)
+{
+	Xil_Out32(addr, val);
+	return;
+}
+
+static int zynq_access_ok(void *ctx, uint32_t addr, uint32_t bytes)
+{
+	struct zynq_target *t = ctx;
+	const struct regproto_window *w = NULL;
+	uint32_t i = 0;
+
+	for (i = 0; i < t->window_count; i++) {
+		w = &t->windows[i];
+		if ( ( addr >= w->base ) && ( addr - w->base < w->size ) && ( bytes <= w->size - (addr - w->base) ) ) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void zynq_tx(void *ctx, const uint8_t *data, size_t len)
+{
+	size_t i = 0;
+
+	for (i = 0; i < len; i++) {
+		while ( Xil_In32(UART_BASE + XUARTPS_SR_OFFSET) & XUARTPS_SR_TXFULL ) {
+		}
+		Xil_Out32(UART_BASE + XUARTPS_FIFO_OFFSET, data[i]);
+	}
+	return;
+}
+
+static const struct regproto_agent_ops zynq_ops = {
+	zynq_read32,
+	zynq_write32,
+	zynq_access_ok,
+	zynq_tx,
+};
+
+static void wait_tx_idle(void)
+{
+	while ( ( Xil_In32(UART_BASE + XUARTPS_SR_OFFSET) & (XUARTPS_SR_TXEMPTY | XUARTPS_SR_TACTIVE) ) !=
+			XUARTPS_SR_TXEMPTY ) {
+	}
+	return;
+}
+
+/* The driver instance for the stdout UART, which is not always device 0 */
+static int set_baud(uint32_t baud)
+{
+	XUartPs_Config *config = NULL;
+	uint32_t i = 0;
+
+	for (i = 0; i < XPAR_XUARTPS_NUM_INSTANCES; i++) {
+		config = XUartPs_LookupConfig(i);
+		if ( ( config != NULL ) && ( config->BaseAddress == UART_BASE ) ) {
+			break;
+		}
+	}
+	if ( ( i == XPAR_XUARTPS_NUM_INSTANCES ) ||
+			( XUartPs_CfgInitialize(&uart, config, config->BaseAddress) != XST_SUCCESS ) ) {
+		return XST_FAILURE;
+	}
+	return XUartPs_SetBaudRate(&uart, baud);
+}
+
+int regproto_zynq_init(struct regproto_agent *agent, const struct regproto_map *maps, uint32_t map_count,
+		const struct regproto_window *windows, uint32_t window_count, uint32_t baud)
+{
+	target.windows = windows;
+	target.window_count = window_count;
+	regproto_agent_init(agent, &zynq_ops, &target, maps, map_count);
+
+	fflush(stdout);
+	wait_tx_idle();
+	if ( baud != 0 ) {
+		return set_baud(baud);
+	}
+	return XST_SUCCESS;
+}
+
+void regproto_zynq_run(struct regproto_agent *agent)
+{
+	for (;;) {
+		if ( !( Xil_In32(UART_BASE + XUARTPS_SR_OFFSET) & XUARTPS_SR_RXEMPTY ) ) {
+			regproto_agent_rx(agent, Xil_In32(UART_BASE + XUARTPS_FIFO_OFFSET));
+		}
+	}
+}